@@ -943,6 +943,7 @@
 #define ZMAPSTANZA_BLIXEM_FS               "featuresets"
 
 #define ZMAPSTANZA_BLIXEM_FILE_OPT_GFF   "gffv3"
+#define ZMAPSTANZA_BLIXEM_FILE_OPT_GFF_BGZF "gffv3-bgzf"          /* bgzip'd, tabix indexed gffv3 */
 #define ZMAPSTANZA_BLIXEM_FILE_OPT_EXBLX "exblx"
 
 
@@ -343,6 +343,10 @@ typedef struct ZMapFeatureContextMergeStatsStructType
 } ZMapFeatureContextMergeStatsStruct, *ZMapFeatureContextMergeStats ;
 
 
+/* A merge being done off the GUI thread, see zMapFeatureContextMergeStart(). */
+typedef struct ZMapFeatureContextMergeJobStructType *ZMapFeatureContextMergeJob ;
+
+
 
 
 
@@ -489,6 +493,9 @@ typedef struct ZMapFeatureContextStructType
 
   ZMapFeatureAlignment master_align ;                      /* The target/master alignment out of the below set. */
 
+  ZMapFeatureContextMergeJob merge_job ;                   /* Set while a merge into this context
+                                                              is running in another thread. */
+
 } ZMapFeatureContextStruct, *ZMapFeatureContext ;
 
 
@@ -575,7 +582,8 @@ typedef struct ZMapFeatureSetStructType
   ZMapFeatureTypeStyle style;                              /* NOTE features point at this pointer */
 
   /* NB we don't expect to use both these on the same featureset but play safe... */
-  GList *masker_sorted_features;                           /* or NULL if not sorted */
+  GPtrArray *masker_sorted_features;                       /* or NULL if not sorted, see
+                                                            * zmapViewFeatureMask.cpp */
 
   GList *loaded;                                           /* strand and end coordinate pairs in numerical order
                                                             * of start coord we use ZMapSpanStruct (x1,x2) to
@@ -584,6 +592,9 @@ typedef struct ZMapFeatureSetStructType
   ZMapConfigSource source ;                                /* The source this featureset was
                                                             * loaded from */
 
+  GList *id_spaces ;                                       /* Strings for feature ids local to
+                                                            * this set, see zmapFeatureID.cpp */
+
 } ZMapFeatureSetStruct, *ZMapFeatureSet ;
 
 
@@ -1151,6 +1162,10 @@ GQuark zMapFeatureCreateID(ZMapStyleMode feature_type,
 			   ZMapStrand strand,
                            int start, int end,
 			   int query_start, int query_end) ;
+GQuark zMapFeatureSetCreateLocalID(ZMapFeatureSet feature_set, const char *id_str) ;
+gboolean zMapFeatureIDIsLocal(GQuark id) ;
+const char *zMapFeatureIDToString(GQuark id) ;
+void zMapFeatureIDGetStats(int *n_spaces_out, int *n_ids_out, gsize *n_bytes_out) ;
 bool zMapFeatureErrorIsFatal(GError **error) ;
 ZMapFeature zMapFeatureCreateEmpty(GError **error = NULL) ;
 ZMapFeature zMapFeatureCreateFromStandardData(const char *name, const char *sequence, const char *ontology,
@@ -1167,6 +1182,14 @@ gboolean zMapFeatureAddStandardData(ZMapFeature feature, const char *feature_nam
 				    int start, int end,
 				    gboolean has_score, double score,
 				    ZMapStrand strand) ;
+gboolean zMapFeatureAddStandardDataLocalIDs(ZMapFeatureSet feature_set, ZMapFeature feature,
+                                            const char *feature_name_id, const char *name,
+                                            const char *sequence, const char *ontology,
+                                            ZMapStyleMode feature_type,
+                                            ZMapFeatureTypeStyle *style,
+                                            int start, int end,
+                                            gboolean has_score, double score,
+                                            ZMapStrand strand) ;
 gboolean zMapFeatureAddKnownName(ZMapFeature feature, char *known_name) ;
 gboolean zMapFeatureAddSplice(ZMapFeature feature, ZMapBoundaryType boundary) ;
 
@@ -1361,6 +1384,13 @@ ZMapFeatureContextMergeCode zMapFeatureContextMerge(ZMapFeatureContext *current_
 						    ZMapFeatureContext *diff_context_out,
                                                     ZMapFeatureContextMergeStats *merge_stats_out,
 						    GList *featureset_names) ;
+ZMapFeatureContextMergeJob zMapFeatureContextMergeStart(ZMapFeatureContext current_context,
+                                                       ZMapFeatureContext new_context,
+                                                       GList *featureset_names) ;
+gboolean zMapFeatureContextMergeIsFinished(ZMapFeatureContextMergeJob merge_job) ;
+ZMapFeatureContextMergeCode zMapFeatureContextMergeFinish(ZMapFeatureContextMergeJob merge_job,
+                                                          ZMapFeatureContext *diff_context_out,
+                                                          ZMapFeatureContextMergeStats *merge_stats_out) ;
 gboolean zMapFeatureContextErase(ZMapFeatureContext *current_context_inout,
 				 ZMapFeatureContext remove_context,
 				 ZMapFeatureContext *diff_context_out);
@@ -213,6 +213,10 @@ gboolean zMapGFFDumpList(GList *dump_list, ZMapStyleTree &styles, char *sequence
   GIOChannel *file, GString *text_out, GError **error_out) ;
 gboolean zMapGFFDumpFeatureSets(ZMapFeatureAny, ZMapStyleTree &, GList*, ZMapSpan,
   GIOChannel *, GError **) ;
+gboolean zMapGFFDumpRegionBGZF(ZMapFeatureAny dump_set, ZMapStyleTree &styles,
+                               ZMapSpan region_span, const char *filename, GError **error_out) ;
+gboolean zMapGFFFileToBGZF(const char *gff_filename, const char *bgzf_filename, GError **error_out) ;
+gboolean zMapGFFIsBGZFFilename(const char *filename) ;
 
 gboolean zMapWriteAttributeURL(ZMapFeature, GString *) ;
 gboolean zMapWriteAttributeName(ZMapFeature, GString *) ;
@@ -124,6 +124,8 @@ GQuark zMap_g_quark_from_string(ZMapQuarkSet quark_set, gchar *string_arg);
 gchar *zMap_g_quark_to_string(ZMapQuarkSet quark_set, GQuark quark) ;
 void zMap_g_quark_destroy_set(ZMapQuarkSet quark_set) ;
 
+void zMap_g_thread_pool_run(GList *jobs, GFunc job_func, const char *what) ;
+
 #endif /* !ZMAP_GLIBUTILS_H */
 
 #ifdef __cplusplus
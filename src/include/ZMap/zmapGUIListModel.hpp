@@ -0,0 +1,80 @@
+/*  File: zmapGUIListModel.hpp
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: A list-only GtkTreeModel that holds one pointer per
+ *              row and asks a callback for cell values as the view
+ *              needs them, rather than copying every cell up front
+ *              as GtkListStore does. Sorting permutes the row order
+ *              without copying the data.
+ *
+ *-------------------------------------------------------------------
+ */
+
+#ifndef __ZMAP_GUILISTMODEL_H__
+#define __ZMAP_GUILISTMODEL_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gtk/gtk.h>
+
+
+/*
+ * Type checking and casting macros
+ */
+#define ZMAP_TYPE_GUILISTMODEL        (zMapGUIListModelGetType())
+#define ZMAP_GUILISTMODEL(obj)        G_TYPE_CHECK_INSTANCE_CAST((obj), zMapGUIListModelGetType(), zmapGUIListModel)
+#define ZMAP_IS_GUILISTMODEL(obj)     G_TYPE_CHECK_INSTANCE_TYPE((obj), zMapGUIListModelGetType())
+
+
+/* Called to fill in value (already initialised to the column type) for the given column of the
+ * row holding row_data. row_number is the 1 based order in which the row was appended. */
+typedef void (* ZMapGUIListModelValueFunc)(GValue *value, int column,
+                                           gpointer row_data, int row_number,
+                                           gpointer user_data) ;
+
+
+/*
+ * Main object structure
+ */
+typedef struct _zmapGUIListModelStruct *ZMapGUIListModel ;
+
+typedef struct _zmapGUIListModelStruct  zmapGUIListModel ;
+
+
+/*
+ * Public methods
+ */
+GType zMapGUIListModelGetType(void) ;
+
+ZMapGUIListModel zMapGUIListModelCreate(int n_columns, GType *column_types,
+                                        ZMapGUIListModelValueFunc value_func, gpointer value_data,
+                                        GDestroyNotify row_data_destroy) ;
+void zMapGUIListModelAppend(ZMapGUIListModel list_model, gpointer row_data, GtkTreeIter *iter_out) ;
+void zMapGUIListModelAppendRows(ZMapGUIListModel list_model, GList *row_data_list) ;
+void zMapGUIListModelSetRowData(ZMapGUIListModel list_model, GtkTreeIter *iter, gpointer row_data) ;
+gpointer zMapGUIListModelGetRowData(ZMapGUIListModel list_model, GtkTreeIter *iter) ;
+void zMapGUIListModelRemove(ZMapGUIListModel list_model, GtkTreeIter *iter) ;
+void zMapGUIListModelClear(ZMapGUIListModel list_model) ;
+
+#endif /* __ZMAP_GUILISTMODEL_H__ */
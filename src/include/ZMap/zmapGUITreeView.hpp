@@ -136,6 +136,16 @@ int zMapGUITreeViewGetColumnIndexByName(ZMapGUITreeView zmap_tv, const char *col
  */
 void zMapGUITreeViewUpdateTuple(ZMapGUITreeView zmap_tv, GtkTreeIter *iter, gpointer user_data);
 
+/*!
+ * \brief remove the row with the iterator.
+ */
+void zMapGUITreeViewRemoveTuple(ZMapGUITreeView zmap_tv, GtkTreeIter *iter);
+
+/*!
+ * \brief get the data a row was added with, only kept for a lazy-model.
+ */
+gpointer zMapGUITreeViewGetTupleData(ZMapGUITreeView zmap_tv, GtkTreeIter *iter);
+
 /*!
  * \brief free up everything...
  */
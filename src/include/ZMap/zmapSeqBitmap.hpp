@@ -23,9 +23,12 @@
  *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
  *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
  *  
- * Description: 
+ * Description: Records which parts of a sequence have been marked,
+ *              e.g. which regions of a column have been loaded. Held
+ *              as a sorted set of intervals so memory depends on the
+ *              number of separate marked regions, not the sequence length.
  *
- * Exported functions: See XXXXXXXXXXXXX.h
+ * Exported functions: See zmapUtils/zmapSeqBitmap.cpp
  *-------------------------------------------------------------------
  */
 
@@ -37,6 +40,13 @@
 typedef struct _zmapSeqBitmapStruct *ZMapSeqBitmap;
 
 
+/* A region returned by zmapSeqBitmapGetUnmarkedRegions(), coords are inclusive. */
+typedef struct ZMapSeqBitmapRegionStructType
+{
+  int start, end ;
+} ZMapSeqBitmapRegionStruct, *ZMapSeqBitmapRegion ;
+
+
 /* public */
 ZMapSeqBitmap zmapSeqBitmapCreate    (int start, int size, int bin_size);
 void          zmapSeqBitmapMarkRegion(ZMapSeqBitmap bitmap, int world1, int world2);
@@ -44,6 +54,7 @@ void          zmapSeqBitmapPrint     (ZMapSeqBitmap bitmap);
 ZMapSeqBitmap zmapSeqBitmapDestroy   (ZMapSeqBitmap bitmap);
 
 gboolean zmapSeqBitmapIsRegionFullyMarked(ZMapSeqBitmap bitmap, int world1, int world2);
+GList   *zmapSeqBitmapGetUnmarkedRegions (ZMapSeqBitmap bitmap, int world1, int world2);
 
 
 #endif /* __ZMAP_SEQ_BITMAP_H__ */
@@ -45,8 +45,8 @@ class ZMapStyleTree
 {
 public:
 
-  ZMapStyleTree() : m_style(NULL) {} ;
-  ZMapStyleTree(ZMapFeatureTypeStyle style) : m_style(style) {} ;
+  ZMapStyleTree() : m_style(NULL), m_index(NULL) {} ;
+  ZMapStyleTree(ZMapFeatureTypeStyle style) : m_style(style), m_index(NULL) {} ;
   ~ZMapStyleTree() ;
 
   gboolean has_children(ZMapFeatureTypeStyle style) const ;
@@ -74,6 +74,11 @@ private:
   ZMapFeatureTypeStyle m_style ;
   std::vector<ZMapStyleTree*> m_children ;
 
+  /* Style unique_id -> node for every node added below this one, only kept on the node that
+   * styles are added through (i.e. the root) so that find() is a hash lookup rather than a
+   * search of the whole tree. */
+  GHashTable *m_index ;
+
   gboolean is_style(ZMapFeatureTypeStyle style) const ;
   gboolean is_style(const GQuark style_id) const ;
 
@@ -86,7 +91,9 @@ private:
   void add_child(ZMapStyleTree *child) ;
   void remove_child(ZMapStyleTree *child) ;
 
-  void add_child_style(ZMapFeatureTypeStyle style) ;
+  ZMapStyleTree* add_child_style(ZMapFeatureTypeStyle style) ;
+  void index_node(ZMapStyleTree *node) ;
+  ZMapStyleTree* search(const GQuark style_id) ;
 
   void do_add_style(ZMapFeatureTypeStyle style, GHashTable *styles, ZMapStyleMergeMode merge_mode) ;
 };
@@ -61,6 +61,11 @@ void zMapWindowNavigatorSetCurrentWindow(ZMapWindowNavigator navigate, ZMapWindo
 void zMapWindowNavigatorMergeInFeatureSetNames(ZMapWindowNavigator navigate,
                                                GList *navigator_sets);
 void zMapWindowNavigatorSetStrand(ZMapWindowNavigator navigate, gboolean is_reversed);
+void zMapWindowNavigatorMergeFeatures(ZMapWindowNavigator navigate,
+                                      ZMapFeatureContext  full_context,
+                                      ZMapFeatureContext  diff_context);
+gboolean zMapWindowNavigatorRemoveFeatures(ZMapWindowNavigator navigate,
+                                           ZMapFeatureContext  diff_context);
 void zMapWindowNavigatorDrawFeatures(ZMapWindowNavigator navigate,
                                      ZMapFeatureContext  full_context,
 				     ZMapStyleTree       &styles);
@@ -96,6 +96,17 @@ typedef struct
 
 
 
+static gboolean addStandardData(ZMapFeatureSet feature_set, ZMapFeature feature,
+                                const char *feature_name_id, const char *name,
+                                const char *sequence, const char *SO_accession,
+                                ZMapStyleMode feature_mode,
+                                ZMapFeatureTypeStyle *style,
+                                int start, int end,
+                                gboolean has_score, double score,
+                                ZMapStrand strand) ;
+
+
+
 
 // 
 //                    Globals
@@ -278,51 +289,27 @@ gboolean zMapFeatureAddStandardData(ZMapFeature feature, const char *feature_nam
                                     gboolean has_score, double score,
                                     ZMapStrand strand)
 {
-  gboolean result = FALSE ;
-
-  if (!feature)
-    return result ;
-
-  if (feature->unique_id == ZMAPFEATURE_NULLQUARK)
-    {
-      feature->unique_id = g_quark_from_string(feature_name_id) ;
-      feature->original_id = g_quark_from_string(name) ;
-      feature->mode = feature_mode ;
-      feature->SO_accession = g_quark_from_string(SO_accession) ;
-      feature->style = style;
-      feature->x1 = start ;
-      feature->x2 = end ;
-      feature->strand = strand ;
-      if (has_score)
-        {
-          feature->flags.has_score = 1 ;
-          feature->score = (float) score ;
-        }
-
-      /* will need expanding.... */
-      switch (feature->mode)
-        {
-        case ZMAPSTYLE_MODE_TRANSCRIPT:
-          {
-            result = zMapFeatureTranscriptInit(feature) ;
-
-            break ;
-          }
-        default:
-          {
-            break ;
-          }
-        }
-
-      result = TRUE ;
-    }
+  return addStandardData(NULL, feature, feature_name_id, name, sequence, SO_accession, feature_mode, style,
+                         start, end, has_score, score, strand) ;
+}
 
-  /* UGH....WHAT IS THIS LOGIC....HORRIBLE...... */
-  if(feature->unique_id)      /* some DAS servers give use  Name "" which is an error */
-    result = TRUE ;
 
+/* As zMapFeatureAddStandardData() but the feature's ids are local to feature_set rather than
+ * quarks, use for high volume sets (e.g. short reads) whose features are only looked up within
+ * their set. The feature must be added to feature_set. */
+gboolean zMapFeatureAddStandardDataLocalIDs(ZMapFeatureSet feature_set, ZMapFeature feature,
+                                            const char *feature_name_id, const char *name,
+                                            const char *sequence, const char *SO_accession,
+                                            ZMapStyleMode feature_mode,
+                                            ZMapFeatureTypeStyle *style,
+                                            int start, int end,
+                                            gboolean has_score, double score,
+                                            ZMapStrand strand)
+{
+  zMapReturnValIfFail(feature_set, FALSE) ;
 
-  return result ;
+  return addStandardData(feature_set, feature, feature_name_id, name, sequence, SO_accession, feature_mode, style,
+                         start, end, has_score, score, strand) ;
 }
 
 
@@ -687,6 +674,74 @@ void zmapFeatureBasicDestroyFeature(ZMapFeature feature)
 
 
 
+/* Adds the standard data fields to an empty feature, the ids are local to feature_set if given. */
+static gboolean addStandardData(ZMapFeatureSet feature_set, ZMapFeature feature,
+                                const char *feature_name_id, const char *name,
+                                const char *sequence, const char *SO_accession,
+                                ZMapStyleMode feature_mode,
+                                ZMapFeatureTypeStyle *style,
+                                int start, int end,
+                                gboolean has_score, double score,
+                                ZMapStrand strand)
+{
+  gboolean result = FALSE ;
+
+  if (!feature)
+    return result ;
+
+  if (feature->unique_id == ZMAPFEATURE_NULLQUARK)
+    {
+      if (feature_set)
+        {
+          feature->unique_id = zMapFeatureSetCreateLocalID(feature_set, feature_name_id) ;
+          feature->original_id = zMapFeatureSetCreateLocalID(feature_set, name) ;
+        }
+      else
+        {
+          feature->unique_id = g_quark_from_string(feature_name_id) ;
+          feature->original_id = g_quark_from_string(name) ;
+        }
+      feature->mode = feature_mode ;
+      feature->SO_accession = g_quark_from_string(SO_accession) ;
+      feature->style = style;
+      feature->x1 = start ;
+      feature->x2 = end ;
+      feature->strand = strand ;
+      if (has_score)
+        {
+          feature->flags.has_score = 1 ;
+          feature->score = (float) score ;
+        }
+
+      /* will need expanding.... */
+      switch (feature->mode)
+        {
+        case ZMAPSTYLE_MODE_TRANSCRIPT:
+          {
+            result = zMapFeatureTranscriptInit(feature) ;
+
+            break ;
+          }
+        default:
+          {
+            break ;
+          }
+        }
+
+      result = TRUE ;
+    }
+
+  /* UGH....WHAT IS THIS LOGIC....HORRIBLE...... */
+  if(feature->unique_id)      /* some DAS servers give use  Name "" which is an error */
+    result = TRUE ;
+
+
+  return result ;
+}
+
+
+
+
 /* A GHashTableForeachFunc() to add a mode to the styles for all features in a set, note that
  * this is not efficient as we go through all features but we would need more information
  * stored in the feature set to avoid this as there may be several different types of
@@ -429,6 +429,8 @@ ZMapFeatureAny zmapFeatureAnyCopy(ZMapFeatureAny orig_feature_any, GDestroyNotif
 
         new_context->master_align = NULL ;
 
+        new_context->merge_job = NULL ;
+
         break ;
       }
     case ZMAPFEATURE_STRUCT_ALIGN:
@@ -466,6 +468,9 @@ ZMapFeatureAny zmapFeatureAnyCopy(ZMapFeatureAny orig_feature_any, GDestroyNotif
 
         new_set->loaded = copy_list;
 
+        /* The features keep their ids so the copy shares the original's id strings. */
+        new_set->id_spaces = zmapFeatureSetCopyIDSpaces(new_set->id_spaces) ;
+
         break;
       }
     case ZMAPFEATURE_STRUCT_FEATURE:
@@ -506,6 +511,7 @@ void zmapDestroyFeatureAny(gpointer data)
 {
   ZMapFeatureAny feature_any = (ZMapFeatureAny)data ;
   gulong nbytes = 0 ;
+  GList *id_spaces = NULL ;
 
   zMapReturnIfFail(feature_any);
   zMapReturnIfFail(zMapFeatureAnyHasMagic(feature_any));
@@ -531,7 +537,7 @@ void zmapDestroyFeatureAny(gpointer data)
         GList *l;
 
         if(feature_set->masker_sorted_features)
-          g_list_free(feature_set->masker_sorted_features);
+          g_ptr_array_free(feature_set->masker_sorted_features, TRUE);
         feature_set->masker_sorted_features = NULL;
 
         if(feature_set->loaded)
@@ -544,6 +550,10 @@ void zmapDestroyFeatureAny(gpointer data)
           }
         feature_set->loaded = NULL;
 
+        /* Freed after the features in case anything wants their names. */
+        id_spaces = feature_set->id_spaces ;
+        feature_set->id_spaces = NULL ;
+
         nbytes = sizeof(ZMapFeatureSetStruct) ;
 
         break;
@@ -563,6 +573,8 @@ void zmapDestroyFeatureAny(gpointer data)
       g_hash_table_destroy(feature_any->children) ;
     }
 
+  if (id_spaces)
+    zmapFeatureSetDestroyIDSpaces(id_spaces) ;
 
   logMemCalls(FALSE, feature_any) ;
 
@@ -773,7 +785,7 @@ static void printDestroyDebugInfo(ZMapFeatureAny feature_any, const char *who)
     length = g_hash_table_size(feature_any->children) ;
 
   if(destroy_debug_G)
-    zMapLogWarning("%s: (%p) '%s' datalist size %d", who, feature_any, g_quark_to_string(feature_any->unique_id), length) ;
+    zMapLogWarning("%s: (%p) '%s' datalist size %d", who, feature_any, zMapFeatureIDToString(feature_any->unique_id), length) ;
 
   return ;
 }
@@ -81,9 +81,57 @@ typedef struct
   /* don't know if it matters if we flag featuresets */
   int feature_count;/* this is a count of the new features */
 
+  /* When merging in another thread the view context must not be altered, instead the changes
+   * are queued here and applied in the GUI thread by mergeJobApply(). */
+  GQueue *view_changes ;
+
 } MergeContextDataStruct, *MergeContextData;
 
 
+/* Changes to the view context queued by a merge running in another thread. */
+typedef enum
+  {
+    MERGE_CHANGE_INVALID,
+    MERGE_CHANGE_ADD,                                       /* Add new_any to view_any's children. */
+    MERGE_CHANGE_ADD_ALL,                                   /* Add all new_any's children to view_any's. */
+    MERGE_CHANGE_SWAP_FEATURES,                             /* Swap the feature hashes of two sets. */
+    MERGE_CHANGE_LOADED,                                    /* Merge new_any's loaded ranges into view_any. */
+    MERGE_CHANGE_SEQUENCE,                                  /* Copy new_any's DNA into view_any. */
+    MERGE_CHANGE_ID_SPACES,                                 /* Add id_spaces to view_any's feature id spaces. */
+    MERGE_CHANGE_REQ_NAMES                                  /* Append names to view_any's requested sets. */
+  } MergeChangeType ;
+
+typedef struct
+{
+  MergeChangeType type ;
+  ZMapFeatureAny view_any ;
+  ZMapFeatureAny new_any ;
+  GList *names ;
+  GList *id_spaces ;
+} MergeChangeStruct, *MergeChange ;
+
+
+/* The merge is run by a thread that only reads the view context, everything it would have
+ * changed in the view is queued in view_changes so that the GUI can carry on drawing from
+ * the view context until zMapFeatureContextMergeFinish() swaps the new data in. */
+typedef struct ZMapFeatureContextMergeJobStructType
+{
+  GThread *thread ;
+  gint finished ;                                           /* Set by the thread when it's done. */
+  gboolean applied ;                                        /* view_changes have been applied. */
+
+  ZMapFeatureContext current_context ;
+  ZMapFeatureContext new_context ;
+  GList *featureset_names ;
+
+  GQueue *view_changes ;
+
+  ZMapFeatureContextMergeCode status ;
+  ZMapFeatureContext diff_context ;
+  ZMapFeatureContextMergeStats merge_stats ;
+} ZMapFeatureContextMergeJobStruct ;
+
+
 
 
 
@@ -146,7 +194,33 @@ static ZMapFeatureContextExecuteStatus addEmptySets(GQuark key,
                                                     gpointer user_data,
                                                     char **err_out);
 
+static ZMapFeatureContextMergeCode contextMerge(ZMapFeatureContext *merged_context_inout,
+                                                ZMapFeatureContext *new_context_inout,
+                                                ZMapFeatureContext *diff_context_out,
+                                                ZMapFeatureContextMergeStats *merge_stats_out,
+                                                GList *featureset_names,
+                                                GQueue *view_changes) ;
+static gpointer mergeJobThreadFunc(gpointer data) ;
+static void mergeJobApply(ZMapFeatureContextMergeJob merge_job) ;
+static void contextMergeWait(ZMapFeatureContext context) ;
+static MergeChange mergeViewChange(MergeContextData merge_data, MergeChangeType type,
+                                   ZMapFeatureAny view_any, ZMapFeatureAny new_any) ;
+static void mergeViewChangeApply(MergeChange change) ;
+static void mergeViewAddFeature(MergeContextData merge_data, ZMapFeatureAny view_parent, ZMapFeatureAny feature_any) ;
+static void mergeBlockAddEmptySets(MergeContextData merge_data, ZMapFeatureBlock new_block, ZMapFeatureBlock view_block) ;
+static void mergeBlockSequence(ZMapFeatureBlock view_block, ZMapFeatureBlock new_block) ;
 static void mergeFeatureSetLoaded(ZMapFeatureSet view_set, ZMapFeatureSet new_set) ;
+static void mergeFeatureSetSteal(MergeContextData merge_data, ZMapFeatureSet view_set, ZMapFeatureSet new_set) ;
+static void mergeFeatureSetFeatures(MergeContextData merge_data, ZMapFeatureSet new_set) ;
+static void mergeSetParentCB(gpointer key, gpointer value, gpointer user_data) ;
+static gboolean mergeFeatureCB(gpointer key, gpointer value, gpointer user_data) ;
+static gboolean mergeFeatureAddCB(gpointer key, gpointer value, gpointer user_data) ;
+static void mergeAddAllCB(gpointer key, gpointer value, gpointer user_data) ;
+static gboolean mergeFeatureSetsDisjoint(ZMapFeatureSet view_set, ZMapFeatureSet new_set) ;
+static gboolean mergeFeatureSetHasID(ZMapFeatureSet feature_set, GQuark id) ;
+static void mergeFeatureUnifyID(ZMapFeatureSet view_set, ZMapFeature feature) ;
+static void mergeFeatureSetIDSpaces(MergeContextData merge_data, ZMapFeatureSet view_set, ZMapFeatureSet new_set,
+                                    GHashTable *features) ;
 static ZMapFeatureContextExecuteStatus destroyIfEmptyContextCB(GQuark key,
                                                                gpointer data,
                                                                gpointer user_data,
@@ -309,6 +383,110 @@ ZMapFeatureContextMergeCode zMapFeatureContextMerge(ZMapFeatureContext *merged_c
                                                     GList *featureset_names)
 {
   ZMapFeatureContextMergeCode status = ZMAPFEATURE_CONTEXT_ERROR ;
+
+  if (!merged_context_inout || !new_context_inout || !diff_context_out)
+    return status ;
+
+  contextMergeWait(*merged_context_inout) ;
+
+  status = contextMerge(merged_context_inout, new_context_inout, diff_context_out, merge_stats_out,
+                        featureset_names, NULL) ;
+
+  return status ;
+}
+
+
+/* Does the same as zMapFeatureContextMerge() but in a separate thread so the GUI is not blocked
+ * while large sets of features are merged. The current context is only read by the thread so
+ * can still be used for drawing etc. until zMapFeatureContextMergeFinish() is called, but it
+ * must not be altered meanwhile, the context functions that alter it will wait for the merge
+ * to finish first.
+ *
+ * new_context belongs to the merge from now on. Poll with zMapFeatureContextMergeIsFinished()
+ * and then call zMapFeatureContextMergeFinish() from the GUI thread to update the current
+ * context and get the diff context, the finish call will wait for the thread if need be. */
+ZMapFeatureContextMergeJob zMapFeatureContextMergeStart(ZMapFeatureContext current_context,
+                                                       ZMapFeatureContext new_context,
+                                                       GList *featureset_names)
+{
+  ZMapFeatureContextMergeJob merge_job = NULL ;
+  GError *error = NULL ;
+
+  zMapReturnValIfFail((current_context && new_context), merge_job) ;
+
+  /* Only one merge into a context at a time. */
+  contextMergeWait(current_context) ;
+
+  merge_job = g_new0(ZMapFeatureContextMergeJobStruct, 1) ;
+  merge_job->current_context = current_context ;
+  merge_job->new_context = new_context ;
+  merge_job->featureset_names = featureset_names ;
+  merge_job->view_changes = g_queue_new() ;
+  merge_job->status = ZMAPFEATURE_CONTEXT_ERROR ;
+
+  current_context->merge_job = merge_job ;
+
+  if (!(merge_job->thread = g_thread_try_new("zmap-merge", mergeJobThreadFunc, merge_job, &error)))
+    {
+      zMapLogWarning("Could not create merge thread, merging in GUI thread instead: %s", error->message) ;
+      g_error_free(error) ;
+
+      mergeJobThreadFunc(merge_job) ;
+    }
+
+  return merge_job ;
+}
+
+gboolean zMapFeatureContextMergeIsFinished(ZMapFeatureContextMergeJob merge_job)
+{
+  gboolean finished = TRUE ;
+
+  zMapReturnValIfFail(merge_job, finished) ;
+
+  finished = (merge_job->applied || g_atomic_int_get(&(merge_job->finished))) ;
+
+  return finished ;
+}
+
+/* Must be called from the GUI thread, applies the merge to the current context and returns
+ * the results as for zMapFeatureContextMerge(). merge_job is freed. */
+ZMapFeatureContextMergeCode zMapFeatureContextMergeFinish(ZMapFeatureContextMergeJob merge_job,
+                                                          ZMapFeatureContext *diff_context_out,
+                                                          ZMapFeatureContextMergeStats *merge_stats_out)
+{
+  ZMapFeatureContextMergeCode status = ZMAPFEATURE_CONTEXT_ERROR ;
+
+  zMapReturnValIfFail((merge_job && diff_context_out), status) ;
+
+  mergeJobApply(merge_job) ;
+
+  status = merge_job->status ;
+
+  if (status == ZMAPFEATURE_CONTEXT_OK || status == ZMAPFEATURE_CONTEXT_NONE)
+    *diff_context_out = merge_job->diff_context ;
+
+  if (merge_stats_out)
+    *merge_stats_out = merge_job->merge_stats ;
+  else
+    g_free(merge_job->merge_stats) ;
+
+  g_free(merge_job) ;
+
+  return status ;
+}
+
+
+
+/* Does the work for zMapFeatureContextMerge(), if view_changes is non-NULL then all alterations
+ * to the current context are queued there instead of being made. */
+static ZMapFeatureContextMergeCode contextMerge(ZMapFeatureContext *merged_context_inout,
+                                                ZMapFeatureContext *new_context_inout,
+                                                ZMapFeatureContext *diff_context_out,
+                                                ZMapFeatureContextMergeStats *merge_stats_out,
+                                                GList *featureset_names,
+                                                GQueue *view_changes)
+{
+  ZMapFeatureContextMergeCode status = ZMAPFEATURE_CONTEXT_ERROR ;
   ZMapFeatureContext current_context, new_context, diff_context = NULL ;
   MergeContextDataStruct merge_data = {NULL} ;
 
@@ -367,20 +545,28 @@ ZMapFeatureContextMergeCode zMapFeatureContextMerge(ZMapFeatureContext *merged_c
       merge_data.new_features = FALSE ;
       merge_data.feature_count = 0;
       merge_data.req_featuresets   = new_context->req_feature_set_names;
+      merge_data.view_changes      = view_changes ;
 
 
       /* THIS LOOKS SUSPECT...WHY ISN'T THE NAMES LIST COPIED FROM NEW_CONTEXT....*/
       copy_features = g_list_copy(new_context->req_feature_set_names) ;
-      current_context->req_feature_set_names = g_list_concat(current_context->req_feature_set_names,
-                                                             copy_features) ;
+      if (view_changes)
+        mergeViewChange(&merge_data, MERGE_CHANGE_REQ_NAMES, (ZMapFeatureAny)current_context, NULL)->names = copy_features ;
+      else
+        current_context->req_feature_set_names = g_list_concat(current_context->req_feature_set_names,
+                                                               copy_features) ;
 
       if (merge_debug_G)
         zMapLogWarning("%s", "merging ...");
 
       /* Do the merge ! */
+      zMapLogTime(TIMER_LOAD, TIMER_START, 0, "Merge") ;
+
       zMapFeatureContextExecuteStealSafe((ZMapFeatureAny)new_context, ZMAPFEATURE_STRUCT_FEATURE,
                                          mergePreCB, NULL, &merge_data) ;
 
+      zMapLogTime(TIMER_LOAD, TIMER_STOP, merge_data.feature_count, "Merge") ;
+
       if (merge_debug_G)
         zMapLogWarning("%s", "finished ...");
 
@@ -493,6 +679,8 @@ gboolean zMapFeatureContextErase(ZMapFeatureContext *current_context_inout,
 
   current_context = *current_context_inout ;
 
+  contextMergeWait(current_context) ;
+
   diff_context = zMapFeatureContextCreate(NULL, 0, 0, NULL);
   diff_context->diff_context        = TRUE;
   diff_context->elements_to_destroy = g_hash_table_new_full(NULL, NULL, NULL, zmapDestroyFeatureAny);
@@ -556,6 +744,8 @@ void zMapFeatureContextDestroy(ZMapFeatureContext feature_context, gboolean free
   if (!feature_context || !zMapFeatureIsValid((ZMapFeatureAny)feature_context))
     return ;
 
+  contextMergeWait(feature_context) ;
+
   if (feature_context->diff_context)
     {
       zmapDestroyFeatureAny(feature_context) ;
@@ -584,6 +774,8 @@ void zMapFeatureContextReverseComplement(ZMapFeatureContext context)
 {
   RevCompDataStruct cb_data ;
 
+  contextMergeWait(context) ;
+
   cb_data.start = context->parent_span.x1;
   cb_data.end   = context->parent_span.x2 ;
 
@@ -1294,7 +1486,7 @@ static void revCompFeature(ZMapFeature feature, int start_coord, int end_coord)
         {
           if (feature->feature.homol.length != (int)strlen(feature->feature.homol.sequence))
             printf("%s: seq lengths differ: %d, %zd\n",
-                   g_quark_to_string(feature->original_id), feature->feature.homol.length,
+                   zMapFeatureIDToString(feature->original_id), feature->feature.homol.length,
                    strlen(feature->feature.homol.sequence));
 
           zMapDNAReverseComplement(feature->feature.homol.sequence, feature->feature.homol.length) ;
@@ -1462,7 +1654,7 @@ static gboolean  executeDataForeachFunc(gpointer key_ptr, gpointer data, gpointe
                       {
                         zMapLogWarning("%s", "Altering hash during foreach _not_ supported!");
                         zMapLogCritical("Hash traversal on the children of '%s' isn't going to work",
-                                        g_quark_to_string(feature_any->unique_id));
+                                        zMapFeatureIDToString(feature_any->unique_id));
                         zMapWarnIfReached();
                       }
                   }
@@ -1646,7 +1838,7 @@ static ZMapFeatureContextExecuteStatus eraseContextCB(GQuark key,
 
 
   if(merge_debug_G)
-    zMapLogWarning("checking %s", g_quark_to_string(feature_any->unique_id));
+    zMapLogWarning("checking %s", zMapFeatureIDToString(feature_any->unique_id));
 
   switch(feature_any->struct_type)
     {
@@ -1837,7 +2029,7 @@ static ZMapFeatureContextExecuteStatus destroyIfEmptyContextCB(GQuark key,
   ZMapFeatureSet         feature_set;
 
   if(merge_debug_G)
-    zMapLogWarning("checking %s", g_quark_to_string(feature_any->unique_id));
+    zMapLogWarning("checking %s", zMapFeatureIDToString(feature_any->unique_id));
 
   switch(feature_any->struct_type)
     {
@@ -1942,7 +2134,7 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
   ZMapFeatureContextExecuteStatus status = ZMAP_CONTEXT_EXEC_STATUS_OK ;
   MergeContextData merge_data = (MergeContextData)user_data ;
   ZMapFeatureAny feature_any = (ZMapFeatureAny)data ;
-  gboolean have_new = FALSE, children = FALSE ;
+  gboolean have_new = FALSE, children = FALSE, shared = FALSE ;
   ZMapFeatureAny *view_path_parent_ptr;
   ZMapFeatureAny *view_path_ptr = NULL;
   ZMapFeatureAny *diff_path_parent_ptr;
@@ -2033,11 +2225,7 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
 
                 /* We would use featureAnyAddFeature, but it does another
                  * g_hash_table_lookup... */
-                g_hash_table_insert((*view_path_parent_ptr)->children,
-                                    zmapFeature2HashKey(feature_any),
-                                    feature_any);
-                feature_any->parent = *view_path_parent_ptr;
-                /* end of featureAnyAddFeature bit... */
+                mergeViewAddFeature(merge_data, *view_path_parent_ptr, feature_any) ;
 
                 /* update the path */
                 *view_path_ptr      = feature_any;
@@ -2056,18 +2244,44 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
             else
               {
                 have_new = FALSE;/* Nothing new here */
-                /* If the feature is there we need to copy it and then recurse down until
-                 * we get to the individual feature level. */
-                diff_feature_any = zmapFeatureAnyCopy(feature_any, NULL);
 
-                zmapFeatureAnyAddToDestroyList(merge_data->diff_context, diff_feature_any);
+                if (feature_any->struct_type == ZMAPFEATURE_STRUCT_FEATURESET
+                    && !g_hash_table_size((*view_path_ptr)->children))
+                  {
+                    /* The view only has the empty placeholder made by addEmptySets() so
+                     * nothing can clash, take over the new features wholesale and share
+                     * the view set with the diff context just as for a new set. */
+                    mergeFeatureSetSteal(merge_data, (ZMapFeatureSet)(*view_path_ptr), (ZMapFeatureSet)feature_any) ;
+
+                    diff_feature_any = *view_path_ptr ;
+
+                    shared = TRUE ;
+                  }
+                else
+                  {
+                    /* If the feature is there we need to copy it and then recurse down until
+                     * we get to the featureset level. */
+                    diff_feature_any = zmapFeatureAnyCopy(feature_any, NULL);
+
+                    zmapFeatureAnyAddToDestroyList(merge_data->diff_context, diff_feature_any);
+                  }
+
+                /* Features are merged a whole set at a time below rather than by
+                 * descending to them one by one. */
+                if (feature_any->struct_type == ZMAPFEATURE_STRUCT_FEATURESET)
+                  status |= ZMAP_CONTEXT_EXEC_STATUS_DONT_DESCEND;
               }
 
 
             // mh17:
             // 1) featureAnyAddFeature checks to see if it's there first, which we just did :-(
             // 2) look at the comment 25 lines above about not using featureAnyAddFeature
-            zmapFeatureAnyAddFeature(*diff_path_parent_ptr, diff_feature_any);
+            /* A shared set is already in the view so its parent must not be touched. */
+            if (shared)
+              g_hash_table_insert((*diff_path_parent_ptr)->children,
+                                  zmapFeature2HashKey(diff_feature_any), diff_feature_any) ;
+            else
+              zmapFeatureAnyAddFeature(*diff_path_parent_ptr, diff_feature_any);
 
             /* update the path */
             *diff_path_ptr = diff_feature_any;
@@ -2108,11 +2322,10 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
                 // by analogy with the above we need to copy the sequence too, in fact any Block only data
                 // sequence contains a pointer to a (long) string - can we just copy it?
                 // seems to work without double frees...
-                if(!vptr->sequence.sequence)      // let's keep the first one, should be the same
-                  {
-                    //                memcpy(&vptr->block_to_sequence,&feat->block_to_sequence,sizeof(ZMapMapBlockStruct));
-                    memcpy(&vptr->sequence,&feat->sequence,sizeof(ZMapSequenceStruct));
-                  }
+                if (merge_data->view_changes)
+                  mergeViewChange(merge_data, MERGE_CHANGE_SEQUENCE, (ZMapFeatureAny)vptr, (ZMapFeatureAny)feat) ;
+                else
+                  mergeBlockSequence(vptr, feat) ;
               }
 #endif
           }
@@ -2124,7 +2337,7 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
             /* we get only featuresest with data from the server */
             /* and record empty ones with a seq region list of requested ranges in the features context */
             zmapFeatureBlockAddEmptySets((ZMapFeatureBlock) feature_any, (ZMapFeatureBlock)(*diff_path_ptr), merge_data->req_featuresets);
-            zmapFeatureBlockAddEmptySets((ZMapFeatureBlock) feature_any, (ZMapFeatureBlock)(*view_path_ptr), merge_data->req_featuresets);
+            mergeBlockAddEmptySets(merge_data, (ZMapFeatureBlock) feature_any, (ZMapFeatureBlock)(*view_path_ptr)) ;
           }
 
         if (feature_any->struct_type == ZMAPFEATURE_STRUCT_FEATURESET)
@@ -2140,7 +2353,13 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
 
             if(!have_new)
               {
-                mergeFeatureSetLoaded((ZMapFeatureSet)*view_path_ptr, (ZMapFeatureSet) feature_any);
+                if (children && !shared)
+                  mergeFeatureSetFeatures(merge_data, (ZMapFeatureSet)feature_any) ;
+
+                if (merge_data->view_changes)
+                  mergeViewChange(merge_data, MERGE_CHANGE_LOADED, *view_path_ptr, feature_any) ;
+                else
+                  mergeFeatureSetLoaded((ZMapFeatureSet)*view_path_ptr, (ZMapFeatureSet) feature_any);
               }
           }
 
@@ -2169,7 +2388,7 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
 
             zmapFeatureAnyAddFeature(*diff_path_parent_ptr, feature_any) ;
 
-            zmapFeatureAnyAddFeature(*view_path_parent_ptr, feature_any) ;
+            mergeViewAddFeature(merge_data, *view_path_parent_ptr, feature_any) ;
 
 
             if (merge_debug_G)
@@ -2196,14 +2415,14 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
     zMapLogWarning("%s (%p) '%s' is %s and has %s",
                    zMapFeatureLevelType2Str(feature_any->struct_type),
                    feature_any,
-                   g_quark_to_string(feature_any->unique_id),
+                   zMapFeatureIDToString(feature_any->unique_id),
                    (have_new == TRUE ? "new" : "old"),
                    (children ? "children and was added" : "no children and was not added"));
 #if 0
   printf("%s (%p) '%s' is %s and has %s\n",
          zMapFeatureLevelType2Str(feature_any->struct_type),
          feature_any,
-         g_quark_to_string(feature_any->unique_id),
+         zMapFeatureIDToString(feature_any->unique_id),
          (have_new == TRUE ? "new" : "old"),
          (children ? "children and was added" : "no children and was not added"));
 #endif
@@ -2215,6 +2434,441 @@ static ZMapFeatureContextExecuteStatus mergePreCB(GQuark key,
 
 
 
+/* The view set exists but is empty so the new set's features can be moved across by swapping
+ * the hash tables, only the parent/style links need fixing up. The new set is left with the empty
+ * table. When merging in another thread the swap is queued, the features are not yet in the
+ * view so their links can be set now. */
+static void mergeFeatureSetSteal(MergeContextData merge_data, ZMapFeatureSet view_set, ZMapFeatureSet new_set)
+{
+  GHashTable *features ;
+  int n_features ;
+
+  zMapStartTimer("MergeFeatureSet", g_quark_to_string(new_set->unique_id)) ;
+
+  if ((n_features = g_hash_table_size(new_set->features)))
+    {
+      g_hash_table_foreach(new_set->features, mergeSetParentCB, view_set) ;
+
+      merge_data->new_features = TRUE ;
+      merge_data->feature_count += n_features ;
+    }
+
+  mergeFeatureSetIDSpaces(merge_data, view_set, new_set, new_set->features) ;
+
+  if (merge_data->view_changes)
+    {
+      mergeViewChange(merge_data, MERGE_CHANGE_SWAP_FEATURES, (ZMapFeatureAny)view_set, (ZMapFeatureAny)new_set) ;
+    }
+  else
+    {
+      features = view_set->features ;
+      view_set->features = new_set->features ;
+      new_set->features = features ;
+    }
+
+  zMapStopTimer("MergeFeatureSet", g_quark_to_string(new_set->unique_id)) ;
+
+  return ;
+}
+
+/* Merge all the features of new_set into the current view and diff sets in one pass over the
+ * new set's hash, features not already in the view are stolen from new_set, duplicates are left
+ * in it. This replaces descending to every feature via zMapFeatureContextExecute().
+ *
+ * Often the new features are for a different region from those already in the view, one
+ * test over the smaller of the two sets shows this and then all the new features are moved
+ * without looking each one up in the view and are added to the view in one go. The view's
+ * table can't just be swapped for the new one as for an empty view set because it already
+ * owns features, and the diff set needs its own table of the new features for drawing. */
+static void mergeFeatureSetFeatures(MergeContextData merge_data, ZMapFeatureSet new_set)
+{
+  ZMapFeatureSet view_set = (ZMapFeatureSet)(merge_data->current_view_set) ;
+
+  zMapStartTimer("MergeFeatureSet", g_quark_to_string(new_set->unique_id)) ;
+
+  if (mergeFeatureSetsDisjoint(view_set, new_set))
+    {
+      g_hash_table_foreach_steal(new_set->features, mergeFeatureAddCB, merge_data) ;
+
+      if (merge_data->view_changes)
+        mergeViewChange(merge_data, MERGE_CHANGE_ADD_ALL, (ZMapFeatureAny)view_set, merge_data->current_diff_set) ;
+      else
+        g_hash_table_foreach(merge_data->current_diff_set->children, mergeAddAllCB, view_set->features) ;
+    }
+  else
+    {
+      g_hash_table_foreach_steal(new_set->features, mergeFeatureCB, merge_data) ;
+    }
+
+  /* Duplicates left in new_set are never looked at again so only the ids of the new features
+   * need to go to the view. */
+  mergeFeatureSetIDSpaces(merge_data, view_set, new_set, merge_data->current_diff_set->children) ;
+
+  zMapStopTimer("MergeFeatureSet", g_quark_to_string(new_set->unique_id)) ;
+
+  return ;
+}
+
+/* As in zmapFeatureAnyAddFeature() features reach their style via their featureset. */
+static void mergeSetParentCB(gpointer key, gpointer value, gpointer user_data)
+{
+  ZMapFeature feature = (ZMapFeature)value ;
+  ZMapFeatureSet feature_set = (ZMapFeatureSet)user_data ;
+
+  feature->parent = (ZMapFeatureAny)feature_set ;
+  feature->style = &(feature_set->style) ;
+
+  return ;
+}
+
+/* Called for each feature in the new set, we already know the feature is not in the diff set
+ * so only the view set needs looking in before the inserts. */
+static gboolean mergeFeatureCB(gpointer key, gpointer value, gpointer user_data)
+{
+  gboolean stolen = FALSE ;
+  MergeContextData merge_data = (MergeContextData)user_data ;
+  ZMapFeatureAny view_set = merge_data->current_view_set ;
+  ZMapFeatureAny diff_set = merge_data->current_diff_set ;
+
+  if (!mergeFeatureSetHasID((ZMapFeatureSet)view_set, GPOINTER_TO_UINT(key)))
+    {
+      mergeFeatureUnifyID((ZMapFeatureSet)view_set, (ZMapFeature)value) ;
+
+      g_hash_table_insert(diff_set->children, key, value) ;
+
+      mergeViewAddFeature(merge_data, view_set, (ZMapFeatureAny)value) ;
+
+      merge_data->new_features = TRUE ;
+      merge_data->feature_count++ ;
+
+      stolen = TRUE ;
+    }
+
+  return stolen ;
+}
+
+
+/* Called for each feature in the new set when none of them are in the view set, the feature
+ * goes into the diff set and the caller adds the whole diff set to the view. */
+static gboolean mergeFeatureAddCB(gpointer key, gpointer value, gpointer user_data)
+{
+  MergeContextData merge_data = (MergeContextData)user_data ;
+
+  mergeFeatureUnifyID((ZMapFeatureSet)(merge_data->current_view_set), (ZMapFeature)value) ;
+
+  g_hash_table_insert(merge_data->current_diff_set->children, key, value) ;
+
+  mergeSetParentCB(key, value, merge_data->current_view_set) ;
+
+  merge_data->new_features = TRUE ;
+  merge_data->feature_count++ ;
+
+  return TRUE ;
+}
+
+static void mergeAddAllCB(gpointer key, gpointer value, gpointer user_data)
+{
+  GHashTable *features = (GHashTable *)user_data ;
+
+  g_hash_table_insert(features, key, value) ;
+
+  return ;
+}
+
+/* TRUE if none of new_set's features are in view_set, the smaller set is looked up in the
+ * larger one. */
+static gboolean mergeFeatureSetsDisjoint(ZMapFeatureSet view_set, ZMapFeatureSet new_set)
+{
+  gboolean result = TRUE ;
+  ZMapFeatureSet small_set = new_set, large_set = view_set ;
+  GHashTableIter iter ;
+  gpointer key ;
+
+  if (g_hash_table_size(view_set->features) < g_hash_table_size(new_set->features))
+    {
+      small_set = view_set ;
+      large_set = new_set ;
+    }
+
+  g_hash_table_iter_init(&iter, small_set->features) ;
+
+  while (result && g_hash_table_iter_next(&iter, &key, NULL))
+    {
+      if (mergeFeatureSetHasID(large_set, GPOINTER_TO_UINT(key)))
+        result = FALSE ;
+    }
+
+  return result ;
+}
+
+/* Features with set local ids (see zmapFeatureID.cpp) will have different ids from each load so
+ * for these the set is searched for the id string as well. */
+static gboolean mergeFeatureSetHasID(ZMapFeatureSet feature_set, GQuark id)
+{
+  gboolean result = FALSE ;
+
+  if (g_hash_table_lookup(feature_set->features, GUINT_TO_POINTER(id)))
+    {
+      result = TRUE ;
+    }
+  else if (zMapFeatureIDIsLocal(id) || feature_set->id_spaces)
+    {
+      const char *id_str ;
+      GQuark set_id ;
+
+      if ((id_str = zMapFeatureIDToString(id))
+          && (set_id = zmapFeatureSetFindID(feature_set, id_str))
+          && g_hash_table_lookup(feature_set->features, GUINT_TO_POINTER(set_id)))
+        result = TRUE ;
+    }
+
+  return result ;
+}
+
+
+/* Features with the same name are linked, grouped for masking etc. by comparing their original
+ * ids, the same name will have a different local id in each load so a new feature is given the
+ * view set's id for its name if there is one. */
+static void mergeFeatureUnifyID(ZMapFeatureSet view_set, ZMapFeature feature)
+{
+  GQuark view_id ;
+
+  if (zMapFeatureIDIsLocal(feature->original_id)
+      && (view_id = zmapFeatureSetFindID(view_set, zMapFeatureIDToString(feature->original_id))))
+    feature->original_id = view_id ;
+
+  return ;
+}
+
+
+/* Features keep their ids when they move from new_set to view_set so the id spaces used by
+ * features (those being moved) must go with them. */
+static void mergeFeatureSetIDSpaces(MergeContextData merge_data, ZMapFeatureSet view_set, ZMapFeatureSet new_set,
+                                    GHashTable *features)
+{
+  GList *id_spaces ;
+
+  if ((id_spaces = zmapFeatureSetTakeIDSpaces(new_set, features)))
+    {
+      if (merge_data->view_changes)
+        {
+          MergeChange change ;
+
+          change = mergeViewChange(merge_data, MERGE_CHANGE_ID_SPACES, (ZMapFeatureAny)view_set, (ZMapFeatureAny)new_set) ;
+          change->id_spaces = id_spaces ;
+        }
+      else
+        {
+          zmapFeatureSetAddIDSpaces(view_set, id_spaces) ;
+        }
+    }
+
+  return ;
+}
+
+
+/* Runs the merge for zMapFeatureContextMergeStart(). */
+static gpointer mergeJobThreadFunc(gpointer data)
+{
+  ZMapFeatureContextMergeJob merge_job = (ZMapFeatureContextMergeJob)data ;
+  ZMapFeatureContext current_context = merge_job->current_context ;
+  ZMapFeatureContext new_context = merge_job->new_context ;
+
+  merge_job->status = contextMerge(&current_context, &new_context,
+                                   &(merge_job->diff_context), &(merge_job->merge_stats),
+                                   merge_job->featureset_names, merge_job->view_changes) ;
+
+  g_atomic_int_set(&(merge_job->finished), TRUE) ;
+
+  /* The GUI may be sitting in the main loop waiting for events. */
+  g_main_context_wakeup(NULL) ;
+
+  return NULL ;
+}
+
+/* Waits for the merge thread and then makes all the queued changes to the view context,
+ * there's not much to do here as whole featuresets are moved by swapping pointers. */
+static void mergeJobApply(ZMapFeatureContextMergeJob merge_job)
+{
+  MergeChange change ;
+
+  if (merge_job->applied)
+    return ;
+
+  if (merge_job->thread)
+    {
+      g_thread_join(merge_job->thread) ;
+      merge_job->thread = NULL ;
+    }
+
+  zMapStartTimer("MergeApply", "") ;
+
+  while ((change = (MergeChange)g_queue_pop_head(merge_job->view_changes)))
+    {
+      mergeViewChangeApply(change) ;
+
+      g_slice_free(MergeChangeStruct, change) ;
+    }
+
+  g_queue_free(merge_job->view_changes) ;
+  merge_job->view_changes = NULL ;
+
+  if (merge_job->current_context->merge_job == merge_job)
+    merge_job->current_context->merge_job = NULL ;
+
+  merge_job->applied = TRUE ;
+
+  zMapStopTimer("MergeApply", "") ;
+
+  return ;
+}
+
+/* Anything that alters a context must call this first in case a merge into it is running. */
+static void contextMergeWait(ZMapFeatureContext context)
+{
+  if (context && context->merge_job)
+    mergeJobApply(context->merge_job) ;
+
+  return ;
+}
+
+static MergeChange mergeViewChange(MergeContextData merge_data, MergeChangeType type,
+                                   ZMapFeatureAny view_any, ZMapFeatureAny new_any)
+{
+  MergeChange change ;
+
+  change = g_slice_new0(MergeChangeStruct) ;
+  change->type = type ;
+  change->view_any = view_any ;
+  change->new_any = new_any ;
+
+  g_queue_push_tail(merge_data->view_changes, change) ;
+
+  return change ;
+}
+
+static void mergeViewChangeApply(MergeChange change)
+{
+  switch (change->type)
+    {
+    case MERGE_CHANGE_ADD:
+      {
+        g_hash_table_insert(change->view_any->children, zmapFeature2HashKey(change->new_any), change->new_any) ;
+        break ;
+      }
+    case MERGE_CHANGE_ADD_ALL:
+      {
+        g_hash_table_foreach(change->new_any->children, mergeAddAllCB, change->view_any->children) ;
+        break ;
+      }
+    case MERGE_CHANGE_SWAP_FEATURES:
+      {
+        GHashTable *features = change->view_any->children ;
+
+        change->view_any->children = change->new_any->children ;
+        change->new_any->children = features ;
+        break ;
+      }
+    case MERGE_CHANGE_LOADED:
+      {
+        mergeFeatureSetLoaded((ZMapFeatureSet)(change->view_any), (ZMapFeatureSet)(change->new_any)) ;
+        break ;
+      }
+    case MERGE_CHANGE_SEQUENCE:
+      {
+        mergeBlockSequence((ZMapFeatureBlock)(change->view_any), (ZMapFeatureBlock)(change->new_any)) ;
+        break ;
+      }
+    case MERGE_CHANGE_ID_SPACES:
+      {
+        zmapFeatureSetAddIDSpaces((ZMapFeatureSet)(change->view_any), change->id_spaces) ;
+        break ;
+      }
+    case MERGE_CHANGE_REQ_NAMES:
+      {
+        ZMapFeatureContext context = (ZMapFeatureContext)(change->view_any) ;
+
+        context->req_feature_set_names = g_list_concat(context->req_feature_set_names, change->names) ;
+        break ;
+      }
+    default:
+      {
+        zMapWarnIfReached() ;
+        break ;
+      }
+    }
+
+  return ;
+}
+
+/* Add a new align/block/set/feature to its parent in the view context. The new one is not
+ * visible to anyone else yet so its links can be set even when the add itself is queued. */
+static void mergeViewAddFeature(MergeContextData merge_data, ZMapFeatureAny view_parent, ZMapFeatureAny feature_any)
+{
+  if (feature_any->struct_type == ZMAPFEATURE_STRUCT_FEATURE)
+    mergeSetParentCB(NULL, feature_any, view_parent) ;
+  else
+    feature_any->parent = view_parent ;
+
+  if (merge_data->view_changes)
+    mergeViewChange(merge_data, MERGE_CHANGE_ADD, view_parent, feature_any) ;
+  else
+    g_hash_table_insert(view_parent->children, zmapFeature2HashKey(feature_any), feature_any) ;
+
+  return ;
+}
+
+/* As zmapFeatureBlockAddEmptySets() but when merging in another thread the empty sets are
+ * made here and the adds queued. */
+static void mergeBlockAddEmptySets(MergeContextData merge_data, ZMapFeatureBlock new_block, ZMapFeatureBlock view_block)
+{
+  GList *l ;
+
+  if (!merge_data->view_changes)
+    {
+      zmapFeatureBlockAddEmptySets(new_block, view_block, merge_data->req_featuresets) ;
+
+      return ;
+    }
+
+  for (l = merge_data->req_featuresets ; l ; l = l->next)
+    {
+      char *set_name = (char *)g_quark_to_string(GPOINTER_TO_UINT(l->data)) ;
+      GQuark set_id = zMapFeatureSetCreateID(set_name) ;
+
+      /* See zmapFeatureBlockAddEmptySets() for why "prefix:" sets are skipped. */
+      if (!zMapFeatureBlockGetSetByID(new_block, set_id) && !zMapFeatureBlockGetSetByID(view_block, set_id)
+          && !strchr(set_name, ':'))
+        {
+          ZMapFeatureSet feature_set ;
+          ZMapSpan span ;
+
+          feature_set = zMapFeatureSetCreate(set_name, NULL) ;
+
+          span = g_new0(ZMapSpanStruct, 1) ;
+          span->x1 = view_block->block_to_sequence.block.x1 ;
+          span->x2 = view_block->block_to_sequence.block.x2 ;
+          feature_set->loaded = g_list_append(NULL, span) ;
+
+          mergeViewAddFeature(merge_data, (ZMapFeatureAny)view_block, (ZMapFeatureAny)feature_set) ;
+        }
+    }
+
+  return ;
+}
+
+/* The block's DNA comes from whichever source supplies it first. */
+static void mergeBlockSequence(ZMapFeatureBlock view_block, ZMapFeatureBlock new_block)
+{
+  if(!view_block->sequence.sequence)      // let's keep the first one, should be the same
+    {
+      memcpy(&view_block->sequence, &new_block->sequence, sizeof(ZMapSequenceStruct));
+    }
+
+  return ;
+}
+
+
 static void mergeFeatureSetLoaded(ZMapFeatureSet view_set, ZMapFeatureSet new_set)
 {
   GList *view_list,*new_list;
@@ -0,0 +1,462 @@
+/*  File: zmapFeatureID.cpp
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Feature ids local to a featureset.
+ *
+ *              Feature unique/original ids are normally GQuarks which
+ *              are never freed and are created under a global lock. For
+ *              high volume sets (e.g. short reads) this means every load
+ *              permanently grows the quark table and parser threads
+ *              queue on the quark lock. Instead these sets can give their
+ *              features ids from an "id space" that belongs to the
+ *              featureset: a string table private to the set that is
+ *              freed along with it.
+ *
+ *              A local id is still a GQuark sized integer so it can be
+ *              used as a hash key etc. exactly as before, the top bit
+ *              marks it as local and the remaining bits give the id
+ *              space's slot and generation and the string's index within
+ *              that space. Real quarks will never get anywhere near the
+ *              top bit. The generation changes each time a slot is reused
+ *              so an id left over from a destroyed set gives NULL rather
+ *              than some other set's string.
+ *
+ *              Copies of a featureset share its id spaces, they are
+ *              reference counted and freed with the last set using them.
+ *
+ *              Strings are only added to a space by the thread that owns
+ *              its featureset. Once a space is shared, by a copy or by
+ *              its features being merged into another set, it is frozen
+ *              and new ids go in a new space, so looking up an id never
+ *              needs a lock.
+ *
+ *              Use zMapFeatureIDToString() rather than g_quark_to_string()
+ *              to get the string for any feature id.
+ *
+ * Exported functions: See ZMap/zmapFeature.hpp
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <string.h>
+
+#include <ZMap/zmapUtils.hpp>
+#include <zmapFeature_P.hpp>
+
+
+
+#define ID_LOCAL_FLAG   0x80000000
+#define ID_GEN_BITS     3
+#define ID_SPACE_BITS   9
+#define ID_ENTRY_BITS   19
+#define ID_MAX_GENS     (1 << ID_GEN_BITS)
+#define ID_MAX_SPACES   (1 << ID_SPACE_BITS)
+#define ID_MAX_ENTRIES  (1 << ID_ENTRY_BITS)
+
+#define ID_GEN(ID)      (((ID) >> (ID_SPACE_BITS + ID_ENTRY_BITS)) & (ID_MAX_GENS - 1))
+#define ID_SPACE(ID)    (((ID) >> ID_ENTRY_BITS) & (ID_MAX_SPACES - 1))
+#define ID_ENTRY(ID)    ((ID) & (ID_MAX_ENTRIES - 1))
+
+#define ID_MAKE(ID_SPACE_PTR, ENTRY)                                                    \
+  (ID_LOCAL_FLAG | ((ID_SPACE_PTR)->generation << (ID_SPACE_BITS + ID_ENTRY_BITS))      \
+   | ((ID_SPACE_PTR)->index << ID_ENTRY_BITS) | (ENTRY))
+
+
+/* A string table for the ids of one featureset, a set with more than ID_MAX_ENTRIES ids has
+ * more than one of these. */
+typedef struct IDSpaceStructType
+{
+  guint index ;                                             /* Our slot in id_spaces_G... */
+  guint generation ;                                        /* ...and its generation. */
+
+  gint ref_count ;                                          /* Featuresets using this space. */
+
+  gboolean frozen ;                                         /* No more strings to be added. */
+
+  GStringChunk *strings ;                                   /* The id strings... */
+  GPtrArray *names ;                                        /* ...indexed by entry... */
+  GHashTable *entries ;                                     /* ...and entry + 1 by string. */
+
+  gsize n_bytes ;                                           /* Total length of the strings. */
+} IDSpaceStruct, *IDSpace ;
+
+
+
+static IDSpace idSpaceCreate(void) ;
+static void idSpaceUnref(IDSpace id_space) ;
+static GQuark idSpaceFind(IDSpace id_space, const char *id_str) ;
+static GQuark idSpaceAdd(IDSpace id_space, const char *id_str) ;
+static GQuark setFindLocalID(ZMapFeatureSet feature_set, const char *id_str) ;
+static void markIDSpaceUsed(guint8 *used, GQuark id) ;
+
+
+
+/* All the id spaces currently in use, the lock is needed to allocate or free a slot but not to
+ * look one up, slots are set and read atomically. Slots are handed out in turn and each has a
+ * generation that changes when it's freed, so a stale id would only match a new space after
+ * ID_MAX_GENS rounds of all the slots. */
+G_LOCK_DEFINE_STATIC(id_spaces_G) ;
+static IDSpace id_spaces_G[ID_MAX_SPACES] = {NULL} ;
+static guint id_generations_G[ID_MAX_SPACES] = {0} ;
+static int n_id_spaces_G = 0 ;
+static int next_id_space_G = 0 ;
+
+
+
+/*
+ *                   External interface.
+ */
+
+
+/* Returns a local id for id_str in feature_set, the same string always gives the same id
+ * within a set. If all the id spaces are in use then falls back to returning a quark. */
+GQuark zMapFeatureSetCreateLocalID(ZMapFeatureSet feature_set, const char *id_str)
+{
+  GQuark id = 0 ;
+  IDSpace id_space = NULL ;
+
+  zMapReturnValIfFail((feature_set && id_str), id) ;
+
+  if (!(id = setFindLocalID(feature_set, id_str)))
+    {
+      /* Newest space is always at the head of the list. */
+      if (feature_set->id_spaces)
+        id_space = (IDSpace)(feature_set->id_spaces->data) ;
+
+      if (!id_space || id_space->frozen || id_space->names->len >= ID_MAX_ENTRIES)
+        {
+          if ((id_space = idSpaceCreate()))
+            feature_set->id_spaces = g_list_prepend(feature_set->id_spaces, id_space) ;
+        }
+
+      if (id_space)
+        id = idSpaceAdd(id_space, id_str) ;
+      else
+        id = g_quark_from_string(id_str) ;
+    }
+
+  return id ;
+}
+
+
+gboolean zMapFeatureIDIsLocal(GQuark id)
+{
+  gboolean result = FALSE ;
+
+  if ((id & ID_LOCAL_FLAG))
+    result = TRUE ;
+
+  return result ;
+}
+
+
+/* Returns the string for any feature id, local or quark, or NULL if there isn't one. A local
+ * id must only be looked up while some featureset using its space exists. */
+const char *zMapFeatureIDToString(GQuark id)
+{
+  const char *id_str = NULL ;
+
+  if (!(id & ID_LOCAL_FLAG))
+    {
+      id_str = g_quark_to_string(id) ;
+    }
+  else
+    {
+      IDSpace id_space ;
+      guint entry = ID_ENTRY(id) ;
+
+      if ((id_space = (IDSpace)g_atomic_pointer_get(&id_spaces_G[ID_SPACE(id)]))
+          && id_space->generation == ID_GEN(id) && entry < id_space->names->len)
+        id_str = (const char *)g_ptr_array_index(id_space->names, entry) ;
+    }
+
+  return id_str ;
+}
+
+
+/* Reports the local ids currently held by all featuresets, used to log memory use across
+ * loads, any of the args may be NULL. */
+void zMapFeatureIDGetStats(int *n_spaces_out, int *n_ids_out, gsize *n_bytes_out)
+{
+  int i, n_spaces = 0, n_ids = 0 ;
+  gsize n_bytes = 0 ;
+
+  G_LOCK(id_spaces_G) ;
+
+  for (i = 0 ; i < ID_MAX_SPACES && n_spaces < n_id_spaces_G ; i++)
+    {
+      IDSpace id_space ;
+
+      if ((id_space = id_spaces_G[i]))
+        {
+          n_spaces++ ;
+          n_ids += id_space->names->len ;
+          n_bytes += id_space->n_bytes ;
+        }
+    }
+
+  G_UNLOCK(id_spaces_G) ;
+
+  if (n_spaces_out)
+    *n_spaces_out = n_spaces ;
+  if (n_ids_out)
+    *n_ids_out = n_ids ;
+  if (n_bytes_out)
+    *n_bytes_out = n_bytes ;
+
+  return ;
+}
+
+
+
+/*
+ *                   Package routines.
+ */
+
+
+/* Returns the id already given to id_str in feature_set, either local or a quark, or 0 if
+ * there isn't one. Used when merging to spot features we already have under another id. */
+GQuark zmapFeatureSetFindID(ZMapFeatureSet feature_set, const char *id_str)
+{
+  GQuark id = 0 ;
+
+  if (id_str && !(id = setFindLocalID(feature_set, id_str)))
+    id = g_quark_try_string(id_str) ;
+
+  return id ;
+}
+
+
+/* Features moved from src_set to another set during a merge keep their ids so the id spaces
+ * they use must move with them. Returns the spaces of src_set used by the unique or original
+ * ids of features (a table of ZMapFeature), they are removed from src_set's list. Spaces only
+ * used by features left behind go when src_set is destroyed. */
+GList *zmapFeatureSetTakeIDSpaces(ZMapFeatureSet src_set, GHashTable *features)
+{
+  GList *id_spaces = NULL, *l, *next ;
+  guint8 used[ID_MAX_SPACES] = {0} ;
+  GHashTableIter iter ;
+  gpointer value ;
+
+  if (!src_set->id_spaces)
+    return id_spaces ;
+
+  g_hash_table_iter_init(&iter, features) ;
+
+  while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+      ZMapFeatureAny feature_any = (ZMapFeatureAny)value ;
+
+      markIDSpaceUsed(used, feature_any->unique_id) ;
+      markIDSpaceUsed(used, feature_any->original_id) ;
+    }
+
+  for (l = src_set->id_spaces ; l ; l = next)
+    {
+      IDSpace id_space = (IDSpace)(l->data) ;
+
+      next = l->next ;
+
+      if (used[id_space->index])
+        {
+          src_set->id_spaces = g_list_remove_link(src_set->id_spaces, l) ;
+          id_spaces = g_list_concat(id_spaces, l) ;
+        }
+    }
+
+  return id_spaces ;
+}
+
+
+/* Adds spaces from zmapFeatureSetTakeIDSpaces() to dest_set. From now on other threads may
+ * look up ids in any of dest_set's spaces so they are all frozen. */
+void zmapFeatureSetAddIDSpaces(ZMapFeatureSet dest_set, GList *id_spaces)
+{
+  GList *l ;
+
+  dest_set->id_spaces = g_list_concat(dest_set->id_spaces, id_spaces) ;
+
+  for (l = dest_set->id_spaces ; l ; l = l->next)
+    ((IDSpace)(l->data))->frozen = TRUE ;
+
+  return ;
+}
+
+
+/* Returns a copy of a set's list of id spaces for a copy of the set, the features in the
+ * copy have the same ids. The spaces are frozen as they are now shared. */
+GList *zmapFeatureSetCopyIDSpaces(GList *id_spaces)
+{
+  GList *l ;
+
+  for (l = id_spaces ; l ; l = l->next)
+    {
+      IDSpace id_space = (IDSpace)(l->data) ;
+
+      id_space->frozen = TRUE ;
+      g_atomic_int_inc(&(id_space->ref_count)) ;
+    }
+
+  return g_list_copy(id_spaces) ;
+}
+
+
+/* Called once the set's features have been destroyed. */
+void zmapFeatureSetDestroyIDSpaces(GList *id_spaces)
+{
+  GList *l ;
+
+  for (l = id_spaces ; l ; l = l->next)
+    idSpaceUnref((IDSpace)(l->data)) ;
+
+  g_list_free(id_spaces) ;
+
+  return ;
+}
+
+
+
+/*
+ *                   Internal routines.
+ */
+
+
+/* Returns NULL if all the slots are taken. */
+static IDSpace idSpaceCreate(void)
+{
+  IDSpace id_space = NULL ;
+  int i, j ;
+
+  G_LOCK(id_spaces_G) ;
+
+  if (n_id_spaces_G < ID_MAX_SPACES)
+    {
+      for (j = 0 ; j < ID_MAX_SPACES ; j++)
+        {
+          i = (next_id_space_G + j) % ID_MAX_SPACES ;
+
+          if (!id_spaces_G[i])
+            {
+              id_space = g_new0(IDSpaceStruct, 1) ;
+
+              id_space->index = i ;
+              id_space->generation = id_generations_G[i] ;
+              id_space->ref_count = 1 ;
+              id_space->strings = g_string_chunk_new(4096) ;
+              id_space->names = g_ptr_array_new() ;
+              id_space->entries = g_hash_table_new(g_str_hash, g_str_equal) ;
+
+              g_atomic_pointer_set(&id_spaces_G[i], id_space) ;
+              n_id_spaces_G++ ;
+              next_id_space_G = (i + 1) % ID_MAX_SPACES ;
+
+              break ;
+            }
+        }
+    }
+
+  G_UNLOCK(id_spaces_G) ;
+
+  if (!id_space)
+    zMapLogWarning("All %d feature id spaces are in use, falling back to quarks.", ID_MAX_SPACES) ;
+
+  return id_space ;
+}
+
+
+/* Frees the space when the last featureset using it lets go. */
+static void idSpaceUnref(IDSpace id_space)
+{
+  if (!g_atomic_int_dec_and_test(&(id_space->ref_count)))
+    return ;
+
+  G_LOCK(id_spaces_G) ;
+
+  g_atomic_pointer_set(&id_spaces_G[id_space->index], NULL) ;
+  id_generations_G[id_space->index] = (id_space->generation + 1) % ID_MAX_GENS ;
+  n_id_spaces_G-- ;
+
+  G_UNLOCK(id_spaces_G) ;
+
+  g_hash_table_destroy(id_space->entries) ;
+  g_ptr_array_free(id_space->names, TRUE) ;
+  g_string_chunk_free(id_space->strings) ;
+
+  g_free(id_space) ;
+
+  return ;
+}
+
+
+static GQuark idSpaceFind(IDSpace id_space, const char *id_str)
+{
+  GQuark id = 0 ;
+  guint entry ;
+
+  if ((entry = GPOINTER_TO_UINT(g_hash_table_lookup(id_space->entries, id_str))))
+    id = ID_MAKE(id_space, (entry - 1)) ;
+
+  return id ;
+}
+
+
+static GQuark idSpaceAdd(IDSpace id_space, const char *id_str)
+{
+  GQuark id ;
+  char *str ;
+  guint entry ;
+
+  str = g_string_chunk_insert(id_space->strings, id_str) ;
+  entry = id_space->names->len ;
+
+  g_ptr_array_add(id_space->names, str) ;
+  g_hash_table_insert(id_space->entries, str, GUINT_TO_POINTER(entry + 1)) ;
+  id_space->n_bytes += strlen(str) + 1 ;
+
+  id = ID_MAKE(id_space, entry) ;
+
+  return id ;
+}
+
+
+static GQuark setFindLocalID(ZMapFeatureSet feature_set, const char *id_str)
+{
+  GQuark id = 0 ;
+  GList *l ;
+
+  for (l = feature_set->id_spaces ; l && !id ; l = l->next)
+    id = idSpaceFind((IDSpace)(l->data), id_str) ;
+
+  return id ;
+}
+
+
+static void markIDSpaceUsed(guint8 *used, GQuark id)
+{
+  if ((id & ID_LOCAL_FLAG))
+    used[ID_SPACE(id)] = TRUE ;
+
+  return ;
+}
@@ -727,8 +727,8 @@ GString *feature2Text(GString *feature_str, ZMapFeature feature)
   g_string_append_printf(result, "%sFeature %p, \"%s\" (unique id = \"%s\")\n",
                          indent,
                          feature,
-                         (char *)g_quark_to_string(feature->original_id),
-                         (char *)g_quark_to_string(feature->unique_id)) ;
+                         (char *)zMapFeatureIDToString(feature->original_id),
+                         (char *)zMapFeatureIDToString(feature->unique_id)) ;
 
   /* Common feature parts */
   indent = "          " ;
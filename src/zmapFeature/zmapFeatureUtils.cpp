@@ -232,8 +232,8 @@ gboolean zMapFeatureIsSane(ZMapFeature feature, char **insanity_explained)
   feature->mode >  ZMAPSTYLE_MODE_META) /* Keep in step with zmapStyle.h */
         {
           insanity = g_strdup_printf("Feature '%s' [%s] has invalid type.", /* keep in step with zmapStyle.h */
-                                     (char *)g_quark_to_string(feature->original_id),
-                                     (char *)g_quark_to_string(feature->unique_id));
+                                     (char *)zMapFeatureIDToString(feature->original_id),
+                                     (char *)zMapFeatureIDToString(feature->unique_id));
           sane = FALSE;
         }
     }
@@ -243,8 +243,8 @@ gboolean zMapFeatureIsSane(ZMapFeature feature, char **insanity_explained)
       if (feature->x1 > feature->x2)
         {
           insanity = g_strdup_printf("Feature '%s' [%s] has start > end.",
-                                     (char *)g_quark_to_string(feature->original_id),
-                                     (char *)g_quark_to_string(feature->unique_id));
+                                     (char *)zMapFeatureIDToString(feature->original_id),
+                                     (char *)zMapFeatureIDToString(feature->unique_id));
           sane = FALSE;
         }
     }
@@ -268,7 +268,7 @@ gboolean zMapFeatureIsSane(ZMapFeature feature, char **insanity_explained)
                       {
                         insanity = g_strdup_printf("Exon %d in feature '%s' has start > end.",
                                                    i + 1,
-                                                   (char *)g_quark_to_string(feature->original_id));
+                                                   (char *)zMapFeatureIDToString(feature->original_id));
                         sane = FALSE;
                       }
                   }
@@ -283,7 +283,7 @@ gboolean zMapFeatureIsSane(ZMapFeature feature, char **insanity_explained)
                       {
                         insanity = g_strdup_printf("Intron %d in feature '%s' has start > end.",
                                                    i + 1,
-                                                   (char *)g_quark_to_string(feature->original_id));
+                                                   (char *)zMapFeatureIDToString(feature->original_id));
                         sane = FALSE;
                       }
                   }
@@ -293,7 +293,7 @@ gboolean zMapFeatureIsSane(ZMapFeature feature, char **insanity_explained)
                 if(feature->feature.transcript.cds_start > feature->feature.transcript.cds_end)
                   {
                     insanity = g_strdup_printf("CDS for feature '%s' has start > end.",
-                                               (char *)g_quark_to_string(feature->original_id));
+                                               (char *)zMapFeatureIDToString(feature->original_id));
                     sane = FALSE;
                   }
               }
@@ -339,8 +339,8 @@ gboolean zMapFeatureAnyIsSane(ZMapFeatureAny feature, char **insanity_explained)
         insanity = g_strdup("Feature has bad identifier.") ;
       else
         insanity = g_strdup_printf("Feature '%s' [%s] has bad type.",
-                                   (char *)g_quark_to_string(feature->original_id),
-                                   (char *)g_quark_to_string(feature->unique_id));
+                                   (char *)zMapFeatureIDToString(feature->original_id),
+                                   (char *)zMapFeatureIDToString(feature->unique_id));
 
       sane = FALSE ;
     }
@@ -368,8 +368,8 @@ gboolean zMapFeatureAnyIsSane(ZMapFeatureAny feature, char **insanity_explained)
         default:
           sane = FALSE ;
           insanity = g_strdup_printf("Feature '%s' [%s] has bad type.",
-                                     (char *)g_quark_to_string(feature->original_id),
-                                     (char *)g_quark_to_string(feature->unique_id));
+                                     (char *)zMapFeatureIDToString(feature->original_id),
+                                     (char *)zMapFeatureIDToString(feature->unique_id));
 
           zMapWarnIfReached();
           break;
@@ -410,7 +410,7 @@ char *zMapFeatureName(ZMapFeatureAny any_feature)
 
   zMapReturnValIfFail(zMapFeatureIsValid(any_feature), NULL) ;
 
-  feature_name = (char *)g_quark_to_string(any_feature->original_id) ;
+  feature_name = (char *)zMapFeatureIDToString(any_feature->original_id) ;
 
   return feature_name ;
 }
@@ -425,7 +425,7 @@ char *zMapFeatureUniqueName(ZMapFeatureAny any_feature)
 
   zMapReturnValIfFail(zMapFeatureIsValid(any_feature), NULL) ;
 
-  feature_name = (char *)g_quark_to_string(any_feature->unique_id) ;
+  feature_name = (char *)zMapFeatureIDToString(any_feature->unique_id) ;
 
   return feature_name ;
 }
@@ -446,7 +446,7 @@ gboolean zMapFeatureNameCompare(ZMapFeatureAny any_feature, char *name)
   if (!zMapFeatureIsValid(any_feature) || !name || !*name)
     return result ;
 
-  if (g_ascii_strcasecmp(g_quark_to_string(any_feature->original_id), name) == 0)
+  if (g_ascii_strcasecmp(zMapFeatureIDToString(any_feature->original_id), name) == 0)
     result = TRUE ;
 
   return result ;
@@ -1463,7 +1463,7 @@ ZMapFrame zMapFeatureTranscriptFrame(ZMapFeature feature)
     }
   else
     {
-      zMapLogWarning("Feature %s is not a Transcript.", g_quark_to_string(feature->unique_id));
+      zMapLogWarning("Feature %s is not a Transcript.", zMapFeatureIDToString(feature->unique_id));
     }
 
   return frame;
@@ -1493,7 +1493,7 @@ char *zMapFeatureTranscriptTranslation(ZMapFeature feature, int *length, gboolea
   if ((dna_str = zMapFeatureGetTranscriptDNA(feature, TRUE, feature->feature.transcript.flags.cds)))
     {
       free_me = dna_str;    /* as we potentially move ptr. */
-      name    = (char *)g_quark_to_string(feature->original_id);
+      name    = (char *)zMapFeatureIDToString(feature->original_id);
 
       if (feature->feature.transcript.flags.start_not_found)
         dna_str += (feature->feature.transcript.start_not_found - 1) ;
@@ -2009,7 +2009,7 @@ static void printChildCB(gpointer key, gpointer value, gpointer user_data_unused
   zMapDebugPrint(debug, "Feature %s - %s (%s)",
                  zMapFeatureLevelType2Str(feature_any->struct_type),
                  zMapFeatureName(feature_any),
-                 g_quark_to_string(feature_any->unique_id)) ;
+                 zMapFeatureIDToString(feature_any->unique_id)) ;
 
   return ;
 }
@@ -70,6 +70,12 @@ void zmapPrintFeatureContext(ZMapFeatureContext context) ;
 
 void zmapFeatureBlockAddEmptySets(ZMapFeatureBlock ref, ZMapFeatureBlock block, GList *feature_set_names) ;
 
+GQuark zmapFeatureSetFindID(ZMapFeatureSet feature_set, const char *id_str) ;
+GList *zmapFeatureSetTakeIDSpaces(ZMapFeatureSet src_set, GHashTable *features) ;
+void zmapFeatureSetAddIDSpaces(ZMapFeatureSet dest_set, GList *id_spaces) ;
+GList *zmapFeatureSetCopyIDSpaces(GList *id_spaces) ;
+void zmapFeatureSetDestroyIDSpaces(GList *id_spaces) ;
+
 
 
 void zmapFeature3FrameTranslationSetRevComp(ZMapFeatureSet feature_set, int block_start, int block_end) ;
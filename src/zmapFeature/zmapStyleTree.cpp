@@ -58,6 +58,9 @@ ZMapStyleTree::~ZMapStyleTree()
     {
       delete *iter ;
     }
+
+  if (m_index)
+    g_hash_table_destroy(m_index) ;
 }
 
 
@@ -93,6 +96,11 @@ const ZMapStyleTree* ZMapStyleTree::find(ZMapFeatureTypeStyle style) const
     {
       result = this ;
     }
+  else if (m_index)
+    {
+      if (style)
+        result = (const ZMapStyleTree *)g_hash_table_lookup(m_index, GUINT_TO_POINTER(style->unique_id)) ;
+    }
   else
     {
       for (std::vector<ZMapStyleTree*>::const_iterator iter = m_children.begin(); !result && iter != m_children.end(); ++iter)
@@ -115,6 +123,11 @@ ZMapStyleTree* ZMapStyleTree::find(ZMapFeatureTypeStyle style)
     {
       result = this ;
     }
+  else if (m_index)
+    {
+      if (style)
+        result = (ZMapStyleTree *)g_hash_table_lookup(m_index, GUINT_TO_POINTER(style->unique_id)) ;
+    }
   else
     {
       for (std::vector<ZMapStyleTree*>::iterator iter = m_children.begin(); !result && iter != m_children.end(); ++iter)
@@ -134,16 +147,26 @@ ZMapStyleTree* ZMapStyleTree::find(const GQuark style_id)
   ZMapStyleTree *result = NULL ;
 
   if (is_style(style_id))
-    {
-      result = this ;
-    }
+    result = this ;
+  else if (m_index)
+    result = (ZMapStyleTree *)g_hash_table_lookup(m_index, GUINT_TO_POINTER(style_id)) ;
   else
+    result = search(style_id) ;
+
+  return result ;
+}
+
+
+/* Search the tree below this node for the given style id, used for nodes that do not have
+ * an index. Return the tree node or null if not found. */
+ZMapStyleTree* ZMapStyleTree::search(const GQuark style_id)
+{
+  ZMapStyleTree *result = NULL ;
+
+  for (std::vector<ZMapStyleTree*>::iterator iter = m_children.begin(); !result && iter != m_children.end(); ++iter)
     {
-      for (std::vector<ZMapStyleTree*>::iterator iter = m_children.begin(); !result && iter != m_children.end(); ++iter)
-        {
-          ZMapStyleTree *child = *iter ;
-          result = child->find(style_id) ;
-        }
+      ZMapStyleTree *child = *iter ;
+      result = child->find(style_id) ;
     }
 
   return result ;
@@ -190,12 +213,29 @@ ZMapStyleTree* ZMapStyleTree::find_parent(ZMapFeatureTypeStyle style)
 
 
 
-/* Add a new child tree node with this style to our list of children */
-void ZMapStyleTree::add_child_style(ZMapFeatureTypeStyle style)
+/* Add a new child tree node with this style to our list of children, returns the new node. */
+ZMapStyleTree* ZMapStyleTree::add_child_style(ZMapFeatureTypeStyle style)
 {
   ZMapStyleTree *node = new ZMapStyleTree(style) ;
 
   m_children.push_back(node) ;
+
+  return node ;
+}
+
+
+/* Record a node that has been added somewhere below this one in our index. */
+void ZMapStyleTree::index_node(ZMapStyleTree *node)
+{
+  ZMapFeatureTypeStyle style ;
+
+  if (node && (style = node->get_style()))
+    {
+      if (!m_index)
+        m_index = g_hash_table_new(NULL, NULL) ;
+
+      g_hash_table_insert(m_index, GUINT_TO_POINTER(style->unique_id), node) ;
+    }
 }
 
 
@@ -233,7 +273,7 @@ void ZMapStyleTree::add_style(ZMapFeatureTypeStyle style)
 
           if (parent_node)
             {
-              parent_node->add_child_style(style) ;
+              index_node(parent_node->add_child_style(style)) ;
             }
           else
             {
@@ -244,7 +284,7 @@ void ZMapStyleTree::add_style(ZMapFeatureTypeStyle style)
       else
         {
           /* This style has no parent, so add it to the root style in the tree */
-          add_child_style(style) ;
+          index_node(add_child_style(style)) ;
         }
       
     }
@@ -298,7 +338,7 @@ void ZMapStyleTree::do_add_style(ZMapFeatureTypeStyle style, GHashTable *styles,
   if (!style->parent_id)
     {
       /* This style has no parent, so add it to the root style in the tree */
-      add_child_style(style) ;
+      index_node(add_child_style(style)) ;
     }
   else if (styleDependsOnParent(style, style->unique_id, styles))
     {
@@ -332,7 +372,7 @@ void ZMapStyleTree::do_add_style(ZMapFeatureTypeStyle style, GHashTable *styles,
           /* Add the child to the parent node */
           if (parent_node)
             {
-              parent_node->add_child_style(style) ;
+              index_node(parent_node->add_child_style(style)) ;
             }
           else
             {
@@ -460,6 +500,9 @@ void ZMapStyleTree::remove_style(ZMapFeatureTypeStyle style)
 
       /* Remove the node from the parent's child list */
       parent->remove_child(node) ;
+
+      if (m_index)
+        g_hash_table_remove(m_index, GUINT_TO_POINTER(style->unique_id)) ;
     }
 }
 
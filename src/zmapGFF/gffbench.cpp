@@ -0,0 +1,335 @@
+/*  File: gffbench.cpp
+ *  Author: Ed Griffiths (edgrif@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Program to time GFF export of a large synthetic context,
+ *              writing each feature as it is formatted against the
+ *              chunked dumper used by zMapGFFDumpRegion(), and to check
+ *              that both give the same feature lines.
+ *
+ *              Usage: gffbench [number of features]
+ *
+ * Exported functions: none
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include <ZMap/zmapFeature.hpp>
+#include <ZMap/zmapGFF.hpp>
+
+
+
+#define GFFBENCH_DEFAULT_FEATURES 500000
+#define GFFBENCH_FEATURESETS 8
+
+
+
+/* For writing each feature as it is formatted. */
+typedef struct
+{
+  GIOChannel *file ;
+  GString *line ;
+  ZMapGFFAttributeFlagsStruct attribute_flags ;
+  gboolean status ;
+  char *err_msg ;
+} WriteFeatureStruct, *WriteFeature ;
+
+
+
+static ZMapFeatureContext makeContext(int n_features, int n_featuresets, int *n_made_out) ;
+static gboolean dumpPerFeature(ZMapFeatureContext context, GIOChannel *file, GError **error_out) ;
+static ZMapFeatureContextExecuteStatus writeFeatureCB(GQuark key, gpointer data,
+                                                      gpointer user_data, char **err_out) ;
+static char *featureLines(char *contents) ;
+
+
+
+int main(int argc, char *argv[])
+{
+  static const char *methods[2] = {"one write per feature", "parallel chunks"} ;
+  gboolean result = TRUE ;
+  int n_features = GFFBENCH_DEFAULT_FEATURES ;
+  ZMapFeatureContext context ;
+  ZMapStyleTree styles ;
+  char *file_names[2] = {NULL, NULL} ;
+  char *contents[2] = {NULL, NULL} ;
+  gsize sizes[2] = {0, 0} ;
+  double times[2] = {0.0, 0.0} ;
+  GError *error = NULL ;
+  int i ;
+
+  if (argc > 1 && (n_features = atoi(argv[1])) <= 0)
+    {
+      fprintf(stderr, "usage: %s [number of features]\n", argv[0]) ;
+
+      exit(EXIT_FAILURE) ;
+    }
+
+  /* There's a limit on the number of features so we may not get all we asked for. */
+  context = makeContext(n_features, GFFBENCH_FEATURESETS, &n_features) ;
+
+  for (i = 0 ; result && i < 2 ; i++)
+    {
+      GIOChannel *file = NULL ;
+      GTimer *timer = NULL ;
+      int fd ;
+
+      if ((fd = g_file_open_tmp("zmap_gffbench_XXXXXX", &file_names[i], &error)) == -1)
+        {
+          result = FALSE ;
+          break ;
+        }
+
+      close(fd) ;
+
+      /* Open it the same way as an export does. */
+      if (!(file = g_io_channel_new_file(file_names[i], "w", &error)))
+        {
+          result = FALSE ;
+          break ;
+        }
+
+      timer = g_timer_new() ;
+
+      if (i == 0)
+        result = dumpPerFeature(context, file, &error) ;
+      else
+        result = zMapGFFDumpRegion((ZMapFeatureAny)context, styles, NULL, file, &error) ;
+
+      g_io_channel_shutdown(file, TRUE, NULL) ;
+      g_io_channel_unref(file) ;
+
+      times[i] = g_timer_elapsed(timer, NULL) ;
+      g_timer_destroy(timer) ;
+    }
+
+  if (result)
+    result = (g_file_get_contents(file_names[0], &contents[0], &sizes[0], &error)
+              && g_file_get_contents(file_names[1], &contents[1], &sizes[1], &error)) ;
+
+  if (result)
+    {
+      /* Only the exporter writes a header. */
+      const char *lines = featureLines(contents[1]) ;
+
+      printf("GFF export of %d features (%" G_GSIZE_FORMAT " bytes):\n", n_features, sizes[1]) ;
+
+      for (i = 0 ; i < 2 ; i++)
+        printf("  %-24s%8.2fs %12.0f features/s\n",
+               methods[i], times[i], (times[i] > 0.0 ? n_features / times[i] : 0.0)) ;
+
+      result = !strcmp(contents[0], lines) ;
+
+      printf("  (%d processors), feature lines are %s.\n",
+             (int)g_get_num_processors(), (result ? "identical" : "DIFFERENT")) ;
+    }
+  else
+    {
+      fprintf(stderr, "%s: %s\n", argv[0], (error ? error->message : "export failed")) ;
+    }
+
+  for (i = 0 ; i < 2 ; i++)
+    {
+      if (file_names[i])
+        {
+          g_unlink(file_names[i]) ;
+          g_free(file_names[i]) ;
+        }
+
+      g_free(contents[i]) ;
+    }
+
+  if (error)
+    g_error_free(error) ;
+
+  zMapFeatureContextDestroy(context, TRUE) ;
+
+  exit(result ? EXIT_SUCCESS : EXIT_FAILURE) ;
+}
+
+
+
+/* A context of up to n_features gapped alignments spread along a block over n_featuresets. */
+static ZMapFeatureContext makeContext(int n_features, int n_featuresets, int *n_made_out)
+{
+  static const int region_length = 10000000, read_length = 100, intron_length = 20, n_targets = 1024 ;
+  char *sequence = (char *)"gff_benchmark" ;
+  ZMapFeatureContext context ;
+  ZMapFeatureAlignment align ;
+  ZMapFeatureBlock block ;
+  ZMapFeatureSet *featuresets ;
+  int i ;
+
+  context = zMapFeatureContextCreate(sequence, 1, region_length, NULL) ;
+
+  align = zMapFeatureAlignmentCreate(sequence, TRUE) ;
+  zMapFeatureContextAddAlignment(context, align, TRUE) ;
+
+  block = zMapFeatureBlockCreate(sequence,
+                                 1, region_length, ZMAPSTRAND_FORWARD,
+                                 1, region_length, ZMAPSTRAND_FORWARD) ;
+  zMapFeatureAlignmentAddBlock(align, block) ;
+
+  featuresets = g_new0(ZMapFeatureSet, n_featuresets) ;
+
+  for (i = 0 ; i < n_featuresets ; i++)
+    {
+      char *name = g_strdup_printf("gff_benchmark_%d", i) ;
+
+      featuresets[i] = zMapFeatureSetCreate(name, NULL) ;
+      zMapFeatureBlockAddFeatureSet(block, featuresets[i]) ;
+
+      g_free(name) ;
+    }
+
+  for (i = 0 ; i < n_features ; i++)
+    {
+      ZMapFeatureSet featureset = featuresets[i % n_featuresets] ;
+      ZMapFeature feature ;
+      ZMapStrand strand = ((i & 1) ? ZMAPSTRAND_REVERSE : ZMAPSTRAND_FORWARD) ;
+      ZMapAlignBlockStruct align_block = {0} ;
+      GArray *gaps ;
+      char *name, *name_id, *target ;
+      int start, end ;
+
+      start = 1 + (int)(((gint64)i * (region_length - 2 * read_length)) / n_features) ;
+      end = start + read_length + intron_length - 1 ;
+
+      if (!(feature = zMapFeatureCreateEmpty()))
+        break ;
+
+      /* Two halves of the read either side of an intron. */
+      gaps = g_array_sized_new(FALSE, FALSE, sizeof(ZMapAlignBlockStruct), 2) ;
+      align_block.q_strand = ZMAPSTRAND_FORWARD ;
+      align_block.t_strand = strand ;
+      align_block.q1 = 1 ;
+      align_block.q2 = read_length / 2 ;
+      align_block.t1 = start ;
+      align_block.t2 = start + (read_length / 2) - 1 ;
+      g_array_append_val(gaps, align_block) ;
+      align_block.q1 = (read_length / 2) + 1 ;
+      align_block.q2 = read_length ;
+      align_block.t1 = end - (read_length / 2) + 1 ;
+      align_block.t2 = end ;
+      g_array_append_val(gaps, align_block) ;
+
+      name = g_strdup_printf("read_%d", i) ;
+      name_id = zMapFeatureCreateName(ZMAPSTYLE_MODE_ALIGNMENT, name, strand, start, end, 1, read_length) ;
+      target = g_strdup_printf("target_%d", i % n_targets) ;
+
+      /* Local ids so as not to fill the quark table with throw away names. */
+      zMapFeatureAddStandardDataLocalIDs(featureset, feature, name_id, name, sequence, "read",
+                                         ZMAPSTYLE_MODE_ALIGNMENT, &featureset->style,
+                                         start, end, TRUE, 100.0, strand) ;
+      zMapFeatureAddAlignmentData(feature, g_quark_from_string(target), 100.0,
+                                  1, read_length, ZMAPHOMOL_N_HOMOL, read_length, ZMAPSTRAND_FORWARD,
+                                  ZMAPPHASE_0, gaps, 0, FALSE, NULL) ;
+      zMapFeatureSetAddFeature(featureset, feature) ;
+
+      g_free(target) ;
+      g_free(name_id) ;
+      g_free(name) ;
+    }
+
+  g_free(featuresets) ;
+
+  *n_made_out = i ;
+
+  return context ;
+}
+
+
+/* Formats and writes each feature in turn, as the exporter used to. */
+static gboolean dumpPerFeature(ZMapFeatureContext context, GIOChannel *file, GError **error_out)
+{
+  WriteFeatureStruct write_data ;
+
+  memset(&write_data, 0, sizeof(write_data)) ;
+  write_data.file = file ;
+  write_data.line = g_string_sized_new(1000) ;
+  write_data.status = TRUE ;
+
+  zMapFeatureContextExecuteSubset((ZMapFeatureAny)context, ZMAPFEATURE_STRUCT_FEATURE,
+                                  writeFeatureCB, &write_data) ;
+
+  if (write_data.status && g_io_channel_flush(file, error_out) != G_IO_STATUS_NORMAL)
+    write_data.status = FALSE ;
+
+  if (write_data.err_msg)
+    {
+      g_set_error(error_out, g_quark_from_string("gffbench"), 0, "%s", write_data.err_msg) ;
+      g_free(write_data.err_msg) ;
+    }
+
+  g_string_free(write_data.line, TRUE) ;
+
+  return write_data.status ;
+}
+
+
+static ZMapFeatureContextExecuteStatus writeFeatureCB(GQuark key, gpointer data,
+                                                      gpointer user_data, char **err_out)
+{
+  ZMapFeatureAny feature_any = (ZMapFeatureAny)data ;
+  WriteFeature write_data = (WriteFeature)user_data ;
+
+  if (write_data->status && feature_any->struct_type == ZMAPFEATURE_STRUCT_FEATURE)
+    {
+      ZMapFeature feature = (ZMapFeature)feature_any ;
+
+      write_data->status = (zMapGFFFormatAttributeSetAlignment(&(write_data->attribute_flags))
+                            && zMapGFFWriteFeatureAlignment(feature, &(write_data->attribute_flags),
+                                                            write_data->line, TRUE, NULL)
+                            && zMapGFFOutputWriteLineToGIO(write_data->file, &(write_data->err_msg),
+                                                           write_data->line, TRUE)) ;
+    }
+
+  return ZMAP_CONTEXT_EXEC_STATUS_OK ;
+}
+
+
+/* Returns the start of the first line that isn't a comment or directive. */
+static char *featureLines(char *contents)
+{
+  char *lines = contents ;
+
+  while (*lines == '#')
+    {
+      char *next ;
+
+      if ((next = strchr(lines, '\n')))
+        lines = next + 1 ;
+      else
+        lines += strlen(lines) ;
+    }
+
+  return lines ;
+}
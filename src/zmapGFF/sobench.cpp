@@ -0,0 +1,241 @@
+/*  File: sobench.cpp
+ *  Author: Steve Miller (sm23@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Program to time the SO term lookups the GFF3 parser makes
+ *              for each line's type (name to ID, name to mode and ID to
+ *              homol) using the library's sorted indexes against plain
+ *              linear scans of the generated tables, and to check that
+ *              both give the same results for every term.
+ *
+ *              Usage: sobench [number of lines]
+ *
+ * Exported functions: none
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zmapSOParser_P.hpp>
+
+
+
+#define SOBENCH_DEFAULT_LINES 1000000
+
+
+
+/* One of the generated tables, as the library sees them. */
+typedef struct
+{
+  const ZMapSOIDDataStruct *pData ;
+  unsigned int iNumItems ;
+} SOBenchTableStruct ;
+
+/* Indexed by ZMapSOSetInUse. */
+static const SOBenchTableStruct sobench_tables_G[ZMAPSO_USE_NONE] =
+  {
+    {ZMAP_SO_DATA_TABLE01, ZMAP_SO_DATA_TABLE01_NUM_ITEMS},
+    {ZMAP_SO_DATA_TABLE02, ZMAP_SO_DATA_TABLE02_NUM_ITEMS},
+    {ZMAP_SO_DATA_TABLE03, ZMAP_SO_DATA_TABLE03_NUM_ITEMS}
+  } ;
+
+#ifdef USE_SO_TERM_HACK
+static const SOBenchTableStruct sobench_hack_table_G =
+  {ZMAP_SO_DATA_TABLE04_HACK, ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS} ;
+#endif
+
+
+
+static const ZMapSOIDDataStruct *linearFindName(ZMapSOSetInUse cSOSetInUse, const char * const sName) ;
+static const ZMapSOIDDataStruct *linearFindID(ZMapSOSetInUse cSOSetInUse, unsigned int iID) ;
+
+
+
+int main(int argc, char *argv[])
+{
+  /* Roughly in proportion to how often they turn up, most lines are exons/CDS of
+   * transcripts or parts of alignments. */
+  static const char * const sTypes[] =
+    {
+      "exon", "exon", "exon", "exon", "exon", "exon", "CDS", "CDS", "CDS", "CDS",
+      "match_part", "match_part", "match_part", "match_part", "match_part",
+      "nucleotide_match", "nucleotide_match", "protein_match", "protein_match",
+      "EST_match", "cDNA_match", "expressed_sequence_match", "translated_nucleotide_match",
+      "mRNA", "transcript", "gene", "five_prime_UTR", "three_prime_UTR",
+      "start_codon", "stop_codon", "polyA_site", "polyA_signal_sequence",
+      "repeat_region", "sequence_variant", "SNP", "region", "contig",
+      "TSS", "Locus", "solexa_coverage", "not_an_SO_term"
+    } ;
+  static const char * const sMethods[2] = {"linear scan", "sorted index"} ;
+  static const int iNumTypes = (int)(sizeof(sTypes) / sizeof(sTypes[0])) ;
+  /* gffv3 parsing uses so-xp by default. */
+  static const ZMapSOSetInUse cSOSetInUse = ZMAPSO_USE_SOXP ;
+  gboolean bResult = TRUE ;
+  int iNumLines = SOBENCH_DEFAULT_LINES ;
+  double dTimes[2] = {0.0, 0.0} ;
+  unsigned long iSums[2] = {0, 0} ;
+  int i, j ;
+
+  if (argc > 1 && (iNumLines = atoi(argv[1])) <= 0)
+    {
+      fprintf(stderr, "usage: %s [number of lines]\n", argv[0]) ;
+
+      exit(EXIT_FAILURE) ;
+    }
+
+  for (i = 0 ; i < 2 ; i++)
+    {
+      GTimer *pTimer = g_timer_new() ;
+
+      for (j = 0 ; j < iNumLines ; j++)
+        {
+          const char *sType = sTypes[j % iNumTypes] ;
+          unsigned int iID ;
+
+          /* The same three calls gffv3 makes for a type given as a name. */
+          if (i == 0)
+            {
+              const ZMapSOIDDataStruct *pFound ;
+
+              if ((pFound = linearFindName(cSOSetInUse, sType)))
+                {
+                  iID = pFound->iID ;
+                  iSums[i] += iID ;
+                  iSums[i] += linearFindName(cSOSetInUse, sType)->cStyleMode ;
+                  iSums[i] += linearFindID(cSOSetInUse, iID)->cHomol ;
+                }
+            }
+          else
+            {
+              if ((iID = zMapSOSetIsNamePresent(cSOSetInUse, sType)) != ZMAPSO_ID_UNK)
+                {
+                  iSums[i] += iID ;
+                  iSums[i] += zMapSOSetGetStyleModeFromName(cSOSetInUse, sType) ;
+                  iSums[i] += zMapSOSetGetHomolFromID(cSOSetInUse, iID) ;
+                }
+            }
+        }
+
+      dTimes[i] = g_timer_elapsed(pTimer, NULL) ;
+      g_timer_destroy(pTimer) ;
+    }
+
+  /* Check every term in every table is found by both methods. */
+  for (i = ZMAPSO_USE_SOFA ; bResult && i <= ZMAPSO_USE_SOXPSIMPLE ; i++)
+    {
+      const SOBenchTableStruct *pTable = &sobench_tables_G[i] ;
+
+      for (j = 0 ; bResult && j < (int)pTable->iNumItems ; j++)
+        {
+          const ZMapSOIDDataStruct *pData = &pTable->pData[j] ;
+          const ZMapSOIDDataStruct *pByName = linearFindName((ZMapSOSetInUse)i, pData->sName) ;
+          const ZMapSOIDDataStruct *pByID = linearFindID((ZMapSOSetInUse)i, pData->iID) ;
+          const char *sName = zMapSOSetIsIDPresent((ZMapSOSetInUse)i, pData->iID) ;
+
+          if (pByName->iID != zMapSOSetIsNamePresent((ZMapSOSetInUse)i, pData->sName)
+              || pByName->cStyleMode != zMapSOSetGetStyleModeFromName((ZMapSOSetInUse)i, pData->sName)
+              || !sName || strcmp(pByID->sName, sName)
+              || pByID->cStyleMode != zMapSOSetGetStyleModeFromID((ZMapSOSetInUse)i, pData->iID)
+              || pByID->cHomol != zMapSOSetGetHomolFromID((ZMapSOSetInUse)i, pData->iID))
+            bResult = FALSE ;
+        }
+    }
+
+  if (iSums[0] != iSums[1])
+    bResult = FALSE ;
+
+  printf("SO term lookups for %d GFF lines (%d different types):\n", iNumLines, iNumTypes) ;
+
+  for (i = 0 ; i < 2 ; i++)
+    printf("  %-16s%8.3fs %10.1f ns/line\n", sMethods[i], dTimes[i], (dTimes[i] * 1.0e9) / iNumLines) ;
+
+  printf("  results are %s.\n", (bResult ? "identical" : "DIFFERENT")) ;
+
+  exit(bResult ? EXIT_SUCCESS : EXIT_FAILURE) ;
+}
+
+
+
+/*
+ * The linear searches the library used to make for every GFF line.
+ */
+static const ZMapSOIDDataStruct *linearFindName(ZMapSOSetInUse cSOSetInUse, const char * const sName)
+{
+  const ZMapSOIDDataStruct *pResult = NULL ;
+  const SOBenchTableStruct *pTable = NULL ;
+  unsigned int i ;
+
+  if (cSOSetInUse < ZMAPSO_USE_NONE)
+    {
+      pTable = &sobench_tables_G[cSOSetInUse] ;
+
+      for (i=0; !pResult && i<pTable->iNumItems; ++i)
+        {
+          if (!strcmp(sName, pTable->pData[i].sName))
+            pResult = &pTable->pData[i] ;
+        }
+    }
+
+#ifdef USE_SO_TERM_HACK
+  for (i=0; !pResult && i<sobench_hack_table_G.iNumItems; ++i)
+    {
+      if (!strcmp(sName, sobench_hack_table_G.pData[i].sName))
+        pResult = &sobench_hack_table_G.pData[i] ;
+    }
+#endif
+
+  return pResult ;
+}
+
+static const ZMapSOIDDataStruct *linearFindID(ZMapSOSetInUse cSOSetInUse, unsigned int iID)
+{
+  const ZMapSOIDDataStruct *pResult = NULL ;
+  const SOBenchTableStruct *pTable = NULL ;
+  unsigned int i ;
+
+  if (cSOSetInUse < ZMAPSO_USE_NONE)
+    {
+      pTable = &sobench_tables_G[cSOSetInUse] ;
+
+      for (i=0; !pResult && i<pTable->iNumItems; ++i)
+        {
+          if (iID == pTable->pData[i].iID)
+            pResult = &pTable->pData[i] ;
+        }
+    }
+
+#ifdef USE_SO_TERM_HACK
+  for (i=0; !pResult && i<sobench_hack_table_G.iNumItems; ++i)
+    {
+      if (iID == sobench_hack_table_G.pData[i].iID)
+        pResult = &sobench_hack_table_G.pData[i] ;
+    }
+#endif
+
+  return pResult ;
+}
@@ -33,8 +33,18 @@
 #include <ZMap/zmap.hpp>
 
 #include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include <config.h>
+#ifdef USE_HTSLIB
+#include <htslib/bgzf.h>
+#include <htslib/tbx.h>
+#endif
 
 #include <ZMap/zmapUtils.hpp>
+#include <ZMap/zmapGLibUtils.hpp>
 #include <ZMap/zmapFeature.hpp>
 #include <ZMap/zmapSO.hpp>
 #include <ZMap/zmapGFF.hpp>
@@ -72,6 +82,74 @@ typedef struct ZMapGFFFormatDataStruct_
 static ZMapGFFFormatData createGFFFormatData() ;
 static void deleteGFFFormatData(ZMapGFFFormatData *) ;
 
+/*
+ * Large dumps are formatted on worker threads a chunk of features at a time, each chunk
+ * into its own buffer, and the buffers are then written out in order so the output is
+ * exactly as if the features had been written one by one. The buffers are reused for
+ * each round of chunks.
+ */
+#define DUMP_CHUNK_FEATURES 4096
+#define DUMP_CHUNK_BUFFER_SIZE (DUMP_CHUNK_FEATURES * 160)
+#define DUMP_CHANNEL_BUFFER_SIZE (1 << 20)
+
+typedef struct DumpChunkStruct_
+{
+  ZMapStyleTree *styles ;
+  ZMapFeatureAny *features ;                               /* This chunk's slice of the features. */
+  guint n_features ;
+  GString *buffer ;
+  ZMapGFFFormatData format_data ;                          /* Each chunk has its own as
+                                                              dump_gff_cb() sets the attribute flags. */
+  gboolean status ;
+  GError *error ;
+} DumpChunkStruct, *DumpChunk ;
+
+typedef struct DumpCollectStruct_
+{
+  ZMapSpan region_span ;
+  GPtrArray *features ;
+} DumpCollectStruct, *DumpCollect ;
+
+static gboolean dumpFeaturesParallel(ZMapFeatureAny dump_set, ZMapStyleTree *styles, ZMapSpan region_span,
+                                     GIOChannel *file, GString *text_out, GError **error_out) ;
+static ZMapFeatureContextExecuteStatus collect_features_cb(GQuark key, gpointer data,
+                                                           gpointer user_data, char **err_out) ;
+static void formatChunkCB(gpointer data, gpointer user_data) ;
+static gboolean writeChunks(GIOChannel *file, GString *text_out, DumpChunk chunks, int n_chunks,
+                            GError **error_out) ;
+
+/*
+ * Compressed output is written as BGZF (blocked gzip) with the feature lines sorted by
+ * sequence and start so it can be tabix indexed, the header lines go first unsorted.
+ *
+ * The GFF is either already in memory or is read from a file a line at a time, only the
+ * position of each line and its sort key are kept and the lines are read back in sorted
+ * order as they are written.
+ */
+typedef struct BGZFInputStruct_
+{
+  GString *text ;                                            /* The GFF is either in memory... */
+  GIOChannel *file ;                                         /* ...or in a file. */
+  GString *buffer ;                                          /* Holds lines read from file. */
+  gint64 offset ;                                            /* Of the next line. */
+} BGZFInputStruct, *BGZFInput ;
+
+typedef struct BGZFLineStruct_
+{
+  gint64 offset ;                                            /* Start of the line in the input... */
+  gsize len ;                                                /* ...and its length including '\n'. */
+  int seq ;                                                  /* Order in which its sequence was first seen. */
+  long start ;
+  guint order ;                                              /* Keeps the sort stable. */
+} BGZFLineStruct, *BGZFLine ;
+
+static gboolean writeBGZF(BGZFInput input, const char *filename, GError **error_out) ;
+#ifdef USE_HTSLIB
+static gboolean bgzfInputNextLine(BGZFInput input, const char **line_out, gsize *len_out, GError **error_out) ;
+static gboolean bgzfWriteLine(BGZF *bgzf, BGZFInput input, BGZFLine line, GError **error_out) ;
+static int bgzfLineCompare(const void *a, const void *b) ;
+#endif
+
 /*
  * A hack for sources that are input as '.',
  * and also a list of characters that are to be
@@ -197,18 +275,61 @@ gboolean zMapGFFDumpRegion(ZMapFeatureAny dump_set, ZMapStyleTree &styles,
     }
 
   if (result)
+    result = dumpFeaturesParallel(dump_set, &styles, region_span, file, NULL, error_out) ;
+
+  if (format_data)
+    deleteGFFFormatData(&format_data) ;
+
+  return result ;
+}
+
+
+/*
+ * As zMapGFFDumpRegion() but writes filename as BGZF compressed GFF, sorted by sequence
+ * and start, and builds a tabix index for it in filename.tbi. Fails if zmap was built
+ * without htslib.
+ */
+gboolean zMapGFFDumpRegionBGZF(ZMapFeatureAny dump_set, ZMapStyleTree &styles,
+                               ZMapSpan region_span, const char *filename, GError **error_out)
+{
+  gboolean result = FALSE ;
+  ZMapGFFFormatData format_data = NULL ;
+  GString *text = NULL ;
+
+  zMapReturnValIfFail(   filename && dump_set
+                      && (dump_set->struct_type != ZMAPFEATURE_STRUCT_INVALID)
+                      && error_out,
+                                  result) ;
+
+  if ((format_data = createGFFFormatData()))
     {
+      /* The whole file has to be sorted so it's formatted into memory first. */
+      text = g_string_sized_new(DUMP_CHANNEL_BUFFER_SIZE) ;
 
-      /* This might get overwritten later, but as DumpToFile uses
-       * Subset, there's a chance it wouldn't get set at all */
-      if(region_span)
-        result = zMapFeatureContextRangeDumpToFile((ZMapFeatureAny)dump_set, &styles, region_span,
-                   dump_gff_cb, format_data, file, error_out) ;
-      else
-        result = zMapFeatureContextDumpToFile((ZMapFeatureAny)dump_set, &styles,
-                   dump_gff_cb, format_data, file, error_out) ;
+      format_data->sequence = NULL ;
+      format_data->buffer = text ;
+      format_data->flags.cont       = TRUE;
+      format_data->flags.status     = TRUE;
+      format_data->flags.over_write = FALSE ;
+
+      result = dump_full_header(dump_set, NULL, format_data, error_out) ;
+    }
+
+  if (result)
+    result = dumpFeaturesParallel(dump_set, &styles, region_span, NULL, text, error_out) ;
+
+  if (result)
+    {
+      BGZFInputStruct input = {NULL} ;
+
+      input.text = text ;
+
+      result = writeBGZF(&input, filename, error_out) ;
     }
 
+  if (text)
+    g_string_free(text, TRUE) ;
+
   if (format_data)
     deleteGFFFormatData(&format_data) ;
 
@@ -216,6 +337,51 @@ gboolean zMapGFFDumpRegion(ZMapFeatureAny dump_set, ZMapStyleTree &styles,
 }
 
 
+/*
+ * Writes the plain GFF file gff_filename out again as BGZF compressed, sorted GFF in
+ * bgzf_filename and builds its tabix index, gff_filename is left as it was. The file is
+ * not read into memory, only the position and sort key of each line are kept. Fails for
+ * a file with a ##FASTA section as tabix cannot index sequence.
+ */
+gboolean zMapGFFFileToBGZF(const char *gff_filename, const char *bgzf_filename, GError **error_out)
+{
+  gboolean result = FALSE ;
+  BGZFInputStruct input = {NULL} ;
+
+  zMapReturnValIfFail((gff_filename && bgzf_filename && error_out), result) ;
+
+  if ((input.file = g_io_channel_new_file(gff_filename, "r", error_out)))
+    {
+      /* Read bytes, not utf8, so the lines can be sought back to by offset. */
+      if (g_io_channel_set_encoding(input.file, NULL, error_out) == G_IO_STATUS_NORMAL)
+        {
+          input.buffer = g_string_sized_new(1000) ;
+
+          result = writeBGZF(&input, bgzf_filename, error_out) ;
+
+          g_string_free(input.buffer, TRUE) ;
+        }
+
+      g_io_channel_shutdown(input.file, FALSE, NULL) ;
+      g_io_channel_unref(input.file) ;
+    }
+
+  return result ;
+}
+
+
+/* Returns TRUE if filename has one of the usual suffixes for bgzip'd files. */
+gboolean zMapGFFIsBGZFFilename(const char *filename)
+{
+  gboolean result = FALSE ;
+
+  if (filename && (g_str_has_suffix(filename, ".gz") || g_str_has_suffix(filename, ".bgz")))
+    result = TRUE ;
+
+  return result ;
+}
+
+
 
 /*
  * Dumps a list of featuresets in a given region.
@@ -363,6 +529,447 @@ gboolean zMapGFFDumpList(GList *dump_list,
 
 /* INTERNALS */
 
+/*
+ * Dumps the features in dump_set (optionally only those overlapping region_span) in the
+ * same order as zMapFeatureContextDumpToFile() would but formats them a chunk at a time
+ * on the shared thread pool, each round of chunks is then written out in order. If file is NULL
+ * the output is appended to text_out instead.
+ */
+static gboolean dumpFeaturesParallel(ZMapFeatureAny dump_set, ZMapStyleTree *styles, ZMapSpan region_span,
+                                     GIOChannel *file, GString *text_out, GError **error_out)
+{
+  gboolean result = TRUE ;
+  DumpCollectStruct collect = {NULL} ;
+  DumpChunk chunks = NULL ;
+  GList *round_list ;
+  guint n_dumped = 0 ;
+  gsize channel_buffer_size = 0 ;
+  int n_chunks, i ;
+
+  /* Walk the context exactly as the serial dumper does to get the features in the same order. */
+  collect.region_span = region_span ;
+  collect.features = g_ptr_array_new() ;
+
+  zMapFeatureContextExecuteSubset(dump_set, ZMAPFEATURE_STRUCT_FEATURE, collect_features_cb, &collect) ;
+
+  /* Two chunks per processor so the pool stays busy when chunks take different times. */
+  n_chunks = 2 * (int)g_get_num_processors() ;
+  if ((guint)n_chunks > (collect.features->len + DUMP_CHUNK_FEATURES - 1) / DUMP_CHUNK_FEATURES)
+    n_chunks = (collect.features->len + DUMP_CHUNK_FEATURES - 1) / DUMP_CHUNK_FEATURES ;
+
+  chunks = g_new0(DumpChunkStruct, n_chunks) ;
+
+  for (i = 0 ; i < n_chunks ; i++)
+    {
+      chunks[i].styles = styles ;
+      chunks[i].buffer = g_string_sized_new(DUMP_CHUNK_BUFFER_SIZE) ;
+      chunks[i].format_data = createGFFFormatData() ;
+
+      /* Lines are appended to the chunk's buffer, not written one at a time. */
+      chunks[i].format_data->flags.over_write = FALSE ;
+    }
+
+  /* Let the channel take large writes without splitting them up. */
+  if (file)
+    {
+      channel_buffer_size = g_io_channel_get_buffer_size(file) ;
+      g_io_channel_set_buffer_size(file, DUMP_CHANNEL_BUFFER_SIZE) ;
+    }
+
+  while (result && n_dumped < collect.features->len)
+    {
+      int n_round = 0 ;
+
+      for (i = 0 ; i < n_chunks && n_dumped < collect.features->len ; i++, n_round++)
+        {
+          DumpChunk chunk = &chunks[i] ;
+
+          chunk->features = (ZMapFeatureAny *)&(collect.features->pdata[n_dumped]) ;
+          chunk->n_features = MIN((guint)DUMP_CHUNK_FEATURES, collect.features->len - n_dumped) ;
+          chunk->status = TRUE ;
+          g_string_truncate(chunk->buffer, 0) ;
+
+          n_dumped += chunk->n_features ;
+        }
+
+      /* Format the chunks on the shared thread pool. */
+      round_list = NULL ;
+
+      for (i = n_round - 1 ; i >= 0 ; i--)
+        round_list = g_list_prepend(round_list, &chunks[i]) ;
+
+      zMap_g_thread_pool_run(round_list, formatChunkCB, "format GFF") ;
+
+      g_list_free(round_list) ;
+
+      result = writeChunks(file, text_out, chunks, n_round, error_out) ;
+    }
+
+  if (file)
+    {
+      if (result && g_io_channel_flush(file, error_out) != G_IO_STATUS_NORMAL)
+        result = FALSE ;
+
+      g_io_channel_set_buffer_size(file, channel_buffer_size) ;
+    }
+
+  for (i = 0 ; i < n_chunks ; i++)
+    {
+      g_string_free(chunks[i].buffer, TRUE) ;
+      deleteGFFFormatData(&(chunks[i].format_data)) ;
+
+      if (chunks[i].error)
+        g_error_free(chunks[i].error) ;
+    }
+
+  g_free(chunks) ;
+  g_ptr_array_free(collect.features, TRUE) ;
+
+  return result ;
+}
+
+
+/* Collects the features to be dumped, in the order they are visited. */
+static ZMapFeatureContextExecuteStatus collect_features_cb(GQuark key, gpointer data,
+                                                           gpointer user_data, char **err_out)
+{
+  ZMapFeatureAny feature_any = (ZMapFeatureAny)data ;
+  DumpCollect collect = (DumpCollect)user_data ;
+
+  if (feature_any->struct_type == ZMAPFEATURE_STRUCT_FEATURE)
+    {
+      ZMapFeature feature = (ZMapFeature)feature_any ;
+
+      /* Same test as zMapFeatureContextRangeDumpToFile(). */
+      if (!collect->region_span
+          || !(feature->x1 > collect->region_span->x2 || feature->x2 < collect->region_span->x1))
+        g_ptr_array_add(collect->features, feature) ;
+    }
+
+  return ZMAP_CONTEXT_EXEC_STATUS_OK ;
+}
+
+
+/* Runs in a worker thread, dump_gff_cb() only reads the features. */
+static void formatChunkCB(gpointer data, gpointer user_data)
+{
+  DumpChunk chunk = (DumpChunk)data ;
+  guint i ;
+
+  for (i = 0 ; chunk->status && i < chunk->n_features ; i++)
+    {
+      gsize len = chunk->buffer->len ;
+
+      if (!(chunk->status = dump_gff_cb(chunk->features[i], chunk->styles, chunk->buffer,
+                                        &(chunk->error), chunk->format_data)))
+        {
+          /* The serial dumper never writes out any of a feature that fails. */
+          g_string_truncate(chunk->buffer, len) ;
+        }
+    }
+
+  return ;
+}
+
+
+/* Writes the chunks' buffers in order to file or if that's NULL to text_out, stops after the
+ * first chunk that failed to format. */
+static gboolean writeChunks(GIOChannel *file, GString *text_out, DumpChunk chunks, int n_chunks,
+                            GError **error_out)
+{
+  gboolean result = TRUE ;
+  int i ;
+
+  for (i = 0 ; result && i < n_chunks ; i++)
+    {
+      DumpChunk chunk = &chunks[i] ;
+      gsize bytes_written = 0 ;
+
+      if (!file)
+        {
+          g_string_append_len(text_out, chunk->buffer->str, chunk->buffer->len) ;
+        }
+      else if (chunk->buffer->len
+               && g_io_channel_write_chars(file, chunk->buffer->str, chunk->buffer->len,
+                                           &bytes_written, error_out) != G_IO_STATUS_NORMAL)
+        {
+          result = FALSE ;
+        }
+
+      if (result && !chunk->status)
+        {
+          if (chunk->error)
+            {
+              g_propagate_error(error_out, chunk->error) ;
+              chunk->error = NULL ;
+            }
+
+          result = FALSE ;
+        }
+    }
+
+  return result ;
+}
+
+
+/*
+ * Writes the GFF from input to filename as BGZF and indexes it with tabix. Tabix needs all
+ * the lines for a sequence together and in start order so the feature lines are sorted,
+ * keeping their original order where they start at the same place so multi-line features
+ * (e.g. transcripts) stay as they were written.
+ *
+ * The "#" lines before the first feature are written first as they are, any later ones
+ * are kept in front of the feature line that follows them and any after the last feature
+ * are written at the end. Tabix cannot index sequence so input is rejected when it gets
+ * to a ##FASTA section, nothing after it is read.
+ */
+static gboolean writeBGZF(BGZFInput input, const char *filename, GError **error_out)
+{
+  gboolean result = FALSE ;
+#ifdef USE_HTSLIB
+  GQuark domain = g_quark_from_string("ERROR in writeBGZF()") ;
+  GArray *headers, *lines, *comments ;
+  GHashTable *seqs ;
+  BGZF *bgzf = NULL ;
+  const char *line_str = NULL ;
+  gsize line_len = 0 ;
+  guint i ;
+
+  headers = g_array_new(FALSE, FALSE, sizeof(BGZFLineStruct)) ;
+  lines = g_array_sized_new(FALSE, FALSE, sizeof(BGZFLineStruct),
+                            (input->text ? input->text->len / 100 : 1000)) ;
+  comments = g_array_new(FALSE, FALSE, sizeof(BGZFLineStruct)) ;
+  seqs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL) ;
+
+  result = TRUE ;
+
+  while (result && bgzfInputNextLine(input, &line_str, &line_len, error_out))
+    {
+      BGZFLineStruct line = {0} ;
+
+      line.offset = input->offset - line_len ;
+      line.len = line_len ;
+
+      if (*line_str == '#')
+        {
+          if (g_str_has_prefix(line_str, "##FASTA"))
+            {
+              g_set_error(error_out, domain, 0, "GFF with a ##FASTA section cannot be tabix indexed.") ;
+              result = FALSE ;
+            }
+          else if (!lines->len)
+            {
+              g_array_append_val(headers, line) ;
+            }
+          else
+            {
+              g_array_append_val(comments, line) ;
+            }
+        }
+      else if (line_len > 1)
+        {
+          const char *line_end = line_str + line_len ;
+          const char *tab ;
+          char *seq_name ;
+          gpointer seq_index ;
+          int n_tabs ;
+
+          if (!(tab = (const char *)memchr(line_str, '\t', line_len)))
+            {
+              g_set_error(error_out, domain, 0, "Bad GFF line, no columns: \"%.*s\"",
+                          (int)(line_len - 1), line_str) ;
+              result = FALSE ;
+              break ;
+            }
+
+          /* Sequences are given an index in the order they are first seen. */
+          seq_name = g_strndup(line_str, tab - line_str) ;
+
+          if (g_hash_table_lookup_extended(seqs, seq_name, NULL, &seq_index))
+            {
+              g_free(seq_name) ;
+            }
+          else
+            {
+              seq_index = GINT_TO_POINTER(g_hash_table_size(seqs)) ;
+              g_hash_table_insert(seqs, seq_name, seq_index) ;
+            }
+
+          line.seq = GPOINTER_TO_INT(seq_index) ;
+
+          /* Start is the 4th column. */
+          for (n_tabs = 1 ; tab && n_tabs < 3 ; n_tabs++)
+            tab = (const char *)memchr(tab + 1, '\t', line_end - (tab + 1)) ;
+
+          if (tab)
+            line.start = strtol(tab + 1, NULL, 10) ;
+
+          /* Comments since the last feature line sort with this one and go in front of it. */
+          for (i = 0 ; i < comments->len ; i++)
+            {
+              BGZFLine comment = &g_array_index(comments, BGZFLineStruct, i) ;
+
+              comment->seq = line.seq ;
+              comment->start = line.start ;
+              comment->order = lines->len ;
+
+              g_array_append_val(lines, *comment) ;
+            }
+
+          g_array_set_size(comments, 0) ;
+
+          line.order = lines->len ;
+
+          g_array_append_val(lines, line) ;
+        }
+    }
+
+  if (result && *error_out)
+    result = FALSE ;
+
+  if (result)
+    {
+      qsort(lines->data, lines->len, sizeof(BGZFLineStruct), bgzfLineCompare) ;
+
+      if (!(bgzf = bgzf_open(filename, "w")))
+        {
+          g_set_error(error_out, domain, 0, "Could not open \"%s\" for compressed output.", filename) ;
+          result = FALSE ;
+        }
+    }
+
+  for (i = 0 ; result && i < headers->len ; i++)
+    result = bgzfWriteLine(bgzf, input, &g_array_index(headers, BGZFLineStruct, i), error_out) ;
+
+  for (i = 0 ; result && i < lines->len ; i++)
+    result = bgzfWriteLine(bgzf, input, &g_array_index(lines, BGZFLineStruct, i), error_out) ;
+
+  for (i = 0 ; result && i < comments->len ; i++)
+    result = bgzfWriteLine(bgzf, input, &g_array_index(comments, BGZFLineStruct, i), error_out) ;
+
+  if (bgzf)
+    {
+      if (bgzf_close(bgzf) < 0)
+        result = FALSE ;
+
+      if (!result && !*error_out)
+        g_set_error(error_out, domain, 0, "Could not write compressed output to \"%s\".", filename) ;
+    }
+
+  if (result && tbx_index_build(filename, 0, &tbx_conf_gff) != 0)
+    {
+      g_set_error(error_out, domain, 0, "Could not build tabix index for \"%s\".", filename) ;
+      result = FALSE ;
+    }
+
+  g_hash_table_destroy(seqs) ;
+  g_array_free(comments, TRUE) ;
+  g_array_free(lines, TRUE) ;
+  g_array_free(headers, TRUE) ;
+
+#else
+
+  g_set_error(error_out, g_quark_from_string("ERROR in writeBGZF()"), 0,
+              "Cannot write \"%s\", compressed GFF output needs ZMap to be built with htslib.",
+              filename) ;
+
+#endif /* USE_HTSLIB */
+
+  return result ;
+}
+
+
+#ifdef USE_HTSLIB
+/* Returns the next line of input, including its '\n', and moves on past it. Returns FALSE at
+ * the end of the input and on error when error_out is set. */
+static gboolean bgzfInputNextLine(BGZFInput input, const char **line_out, gsize *len_out, GError **error_out)
+{
+  gboolean result = FALSE ;
+
+  if (input->text)
+    {
+      const char *line_start = input->text->str + input->offset ;
+      const char *text_end = input->text->str + input->text->len ;
+      const char *line_end ;
+
+      if (line_start < text_end)
+        {
+          if ((line_end = (const char *)memchr(line_start, '\n', text_end - line_start)))
+            line_end++ ;
+          else
+            line_end = text_end ;
+
+          *line_out = line_start ;
+          *len_out = line_end - line_start ;
+
+          result = TRUE ;
+        }
+    }
+  else
+    {
+      if (g_io_channel_read_line_string(input->file, input->buffer, NULL, error_out) == G_IO_STATUS_NORMAL)
+        {
+          *line_out = input->buffer->str ;
+          *len_out = input->buffer->len ;
+
+          result = TRUE ;
+        }
+    }
+
+  if (result)
+    input->offset += *len_out ;
+
+  return result ;
+}
+
+
+/* Writes line, reading it back from the input file if that's where it is. */
+static gboolean bgzfWriteLine(BGZF *bgzf, BGZFInput input, BGZFLine line, GError **error_out)
+{
+  gboolean result = FALSE ;
+  const char *line_str = NULL ;
+
+  if (input->text)
+    {
+      line_str = input->text->str + line->offset ;
+    }
+  else
+    {
+      gsize bytes_read = 0 ;
+
+      g_string_set_size(input->buffer, line->len) ;
+
+      if (g_io_channel_seek_position(input->file, line->offset, G_SEEK_SET, error_out) == G_IO_STATUS_NORMAL
+          && g_io_channel_read_chars(input->file, input->buffer->str, line->len,
+                                     &bytes_read, error_out) == G_IO_STATUS_NORMAL
+          && bytes_read == line->len)
+        line_str = input->buffer->str ;
+    }
+
+  if (line_str && bgzf_write(bgzf, line_str, line->len) >= 0)
+    result = TRUE ;
+
+  return result ;
+}
+
+
+static int bgzfLineCompare(const void *a, const void *b)
+{
+  BGZFLine line_a = (BGZFLine)a, line_b = (BGZFLine)b ;
+  int result ;
+
+  if (line_a->seq != line_b->seq)
+    result = (line_a->seq < line_b->seq ? -1 : 1) ;
+  else if (line_a->start != line_b->start)
+    result = (line_a->start < line_b->start ? -1 : 1) ;
+  else
+    result = (line_a->order < line_b->order ? -1 : (line_a->order > line_b->order ? 1 : 0)) ;
+
+  return result ;
+}
+#endif /* USE_HTSLIB */
+
+
 static gboolean dump_full_header(ZMapFeatureAny feature_any,
                                  GIOChannel *file,
                                  ZMapGFFFormatData format_data,
@@ -540,7 +1147,7 @@ static ZMapFeatureContextExecuteStatus get_type_seq_header_cb(GQuark  key, gpoin
           {
             ZMapFeatureBlock feature_block = (ZMapFeatureBlock)feature_any;
 
-            format_data->sequence = g_quark_to_string(feature_any->original_id) ;
+            format_data->sequence = zMapFeatureIDToString(feature_any->original_id) ;
             format_data->start = feature_block->block_to_sequence.block.x1 ;
             format_data->end = feature_block->block_to_sequence.block.x2 ;
 
@@ -1720,7 +2327,7 @@ gboolean zMapWriteAttributeName(ZMapFeature feature, GString *attribute)
   if (!feature || !attribute)
     return result ;
 
-  string_escaped = g_uri_escape_string(g_quark_to_string(feature->original_id),
+  string_escaped = g_uri_escape_string(zMapFeatureIDToString(feature->original_id),
                                        reserved_allowed, FALSE) ;
   if (string_escaped)
     {
@@ -1745,7 +2352,7 @@ gboolean zMapWriteAttributeID(ZMapFeature feature, GString *attribute)
   if (!feature || !attribute)
     return result ;
 
-  string_escaped = g_uri_escape_string(g_quark_to_string(feature->original_id),
+  string_escaped = g_uri_escape_string(zMapFeatureIDToString(feature->original_id),
                                        reserved_allowed, FALSE) ;
   if (string_escaped)
     {
@@ -1770,7 +2377,7 @@ gboolean zMapWriteAttributeParent(ZMapFeature feature, GString *attribute)
   if (!feature || !attribute)
     return result ;
 
-  string_escaped = g_uri_escape_string(g_quark_to_string(feature->original_id),
+  string_escaped = g_uri_escape_string(zMapFeatureIDToString(feature->original_id),
                                        reserved_allowed, FALSE) ;
   if (string_escaped)
     {
@@ -1937,7 +2544,7 @@ gboolean zMapWriteAttributeTarget(ZMapFeature feature, GString *attribute)
   s_strand = feature->feature.homol.strand ;
   sstart = feature->feature.homol.y1 ;
   send = feature->feature.homol.y2 ;
-  escaped_string = g_uri_escape_string(g_quark_to_string(feature->original_id), reserved_allowed, FALSE) ;
+  escaped_string = g_uri_escape_string(zMapFeatureIDToString(feature->original_id), reserved_allowed, FALSE) ;
   if (escaped_string)
     {
       g_string_truncate(attribute, (gsize)0) ;
@@ -107,6 +107,17 @@ static GQuark compositeFeaturesCreateID(ZMapGFFAttribute *pAttributes, unsigned
 static GQuark compositeFeaturesFind(ZMapGFF3Parser const pParser, GQuark feature_id ) ;
 static gboolean compositeFeaturesInsert(ZMapGFF3Parser const pParser, GQuark feature_id, GQuark feature_unique_id );
 
+/*
+ * These functions are to deal with duplicate short reads.
+ */
+static gboolean isShortReadSet(ZMapFeatureSet pFeatureSet) ;
+static ZMapFeature distinctReadsFind(ZMapGFFParserFeatureSet pParserFeatureSet, ZMapStrand cStrand,
+                                     int iStart, int iEnd, int iTargetStart, int iTargetEnd, GArray *pGaps,
+                                     char *sReadSequence) ;
+static void distinctReadsInsert(ZMapGFFParserFeatureSet pParserFeatureSet, ZMapFeature pFeature) ;
+static guint distinctReadHashCB(gconstpointer key) ;
+static gboolean distinctReadEqualCB(gconstpointer a, gconstpointer b) ;
+
 
 /*
  * See comments with function.
@@ -3313,7 +3324,8 @@ static ZMapFeature makeFeatureAlignment(ZMapGFF3Parser const pParser,
     *sSource = NULL,
     *sSOType = NULL ;
   char *sFeatureName = NULL,
-    *sFeatureNameID = NULL ;
+    *sFeatureNameID = NULL,
+    *sReadSequence = NULL ;
   const char * sIdentifier = NULL ;
   double dScore = 0.0,
     dPercentID = 0.0 ;
@@ -3327,6 +3339,7 @@ static ZMapFeature makeFeatureAlignment(ZMapGFF3Parser const pParser,
   GQuark gqTargetID = 0 ;
   ZMapSOIDData pSOIDData = NULL ;
   ZMapFeature pFeature = NULL ;
+  ZMapGFFParserFeatureSet pParserFeatureSet = NULL ;
   ZMapGFFAttribute *pAttributes = NULL,
     pAttribute = NULL,
     pAttributeTarget = NULL ;
@@ -3445,41 +3458,6 @@ static ZMapFeature makeFeatureAlignment(ZMapGFF3Parser const pParser,
      )
     {
 
-      /*
-       * Create a new feature.
-       */
-      GError *g_error = NULL ;
-      pFeature = zMapFeatureCreateEmpty(&g_error) ;
-      if (pFeature)
-        {
-          bNewFeatureCreated = TRUE ;
-        }
-      else if (!pFeature)
-        {
-          if (g_error)
-            {
-              if (zMapFeatureErrorIsFatal(&g_error))
-                pParser->state = ZMAPGFF_PARSER_ERR ;
-
-              *psError = g_strdup_printf("makeFeatureAlignment(); could not create new feature object: %s ",
-                                         g_error->message);
-              g_error_free(g_error) ;
-            }
-
-          return pFeature ;
-        }
-
-      sFeatureName = g_strdup(sIdentifier) ;
-      sFeatureNameID = zMapFeatureCreateName(cFeatureStyleMode, sFeatureName, cStrand, iStart, iEnd, iTargetStart, iTargetEnd) ;
-
-      bDataAdded = zMapFeatureAddStandardData(pFeature,
-                                              (char*)sFeatureNameID,
-                                              (char*)sFeatureName,
-                                              (char*)sSequence,
-                                              (char*)sSOType,
-                                              cFeatureStyleMode, &pFeatureSet->style,
-                                              iStart, iEnd, bHasScore, dScore, cStrand) ;
-
       /*
        * "percentID" attribute
        */
@@ -3521,13 +3499,111 @@ static ZMapFeature makeFeatureAlignment(ZMapGFF3Parser const pParser,
           pGaps = NULL ;
         }
 
+      /*
+       * "sequence" attribute, the bases of the read (e.g. from BAM). Lower case as for GFF2
+       * otherwise reverse complementing gives zeroes.
+       */
+      if ((pAttribute = zMapGFFAttributeListContains(pAttributes, nAttributes, sAttributeName_sequence)))
+        {
+          if (zMapAttParseSequence(pAttribute, &sReadSequence) && sReadSequence)
+            {
+              char *pBase ;
+
+              for (pBase = sReadSequence ; *pBase ; pBase++)
+                *pBase = g_ascii_tolower(*pBase) ;
+            }
+        }
+
+      /*
+       * Short reads often arrive many times over at exactly the same position, rather than
+       * making a feature for every copy we count it in the population of the first one so
+       * we only hold the distinct reads. Reads must have the same bases as well as the same
+       * alignment to count as copies, otherwise the consensus and blixem would lose the
+       * mismatches. Reads that are not identical are still collapsed or squashed after merging.
+       */
+      if (isShortReadSet(pFeatureSet))
+        {
+          if (pGaps)
+            zMapFeatureSortGaps(pGaps) ;
+
+          pParserFeatureSet = getParserFeatureSet((ZMapGFFParser)pParser, (char*)sSource) ;
+
+          if (pParserFeatureSet
+              && (pFeature = distinctReadsFind(pParserFeatureSet, cStrand, iStart, iEnd,
+                                               iTargetStart, iTargetEnd, pGaps, sReadSequence)))
+            {
+              pFeature->population++ ;
+
+              if (pGaps)
+                g_array_free(pGaps, TRUE) ;
+              if (sReadSequence)
+                g_free(sReadSequence) ;
+
+              return pFeature ;
+            }
+        }
+
+      /*
+       * Create a new feature.
+       */
+      GError *g_error = NULL ;
+      pFeature = zMapFeatureCreateEmpty(&g_error) ;
+      if (pFeature)
+        {
+          bNewFeatureCreated = TRUE ;
+        }
+      else if (!pFeature)
+        {
+          if (g_error)
+            {
+              if (zMapFeatureErrorIsFatal(&g_error))
+                pParser->state = ZMAPGFF_PARSER_ERR ;
+
+              *psError = g_strdup_printf("makeFeatureAlignment(); could not create new feature object: %s ",
+                                         g_error->message);
+              g_error_free(g_error) ;
+            }
+
+          if (pGaps)
+            g_array_free(pGaps, TRUE) ;
+          if (sReadSequence)
+            g_free(sReadSequence) ;
+
+          return pFeature ;
+        }
+
+      sFeatureName = g_strdup(sIdentifier) ;
+      sFeatureNameID = zMapFeatureCreateName(cFeatureStyleMode, sFeatureName, cStrand, iStart, iEnd, iTargetStart, iTargetEnd) ;
+
+      /*
+       * Short reads come in huge numbers and are only looked up within their own set so
+       * give them ids local to the set rather than adding every one to the quark table.
+       * The Target name stays a quark as it identifies the sequence outside the set.
+       */
+      if (isShortReadSet(pFeatureSet))
+        bDataAdded = zMapFeatureAddStandardDataLocalIDs(pFeatureSet, pFeature,
+                                                        (char*)sFeatureNameID,
+                                                        (char*)sFeatureName,
+                                                        (char*)sSequence,
+                                                        (char*)sSOType,
+                                                        cFeatureStyleMode, &pFeatureSet->style,
+                                                        iStart, iEnd, bHasScore, dScore, cStrand) ;
+      else
+        bDataAdded = zMapFeatureAddStandardData(pFeature,
+                                                (char*)sFeatureNameID,
+                                                (char*)sFeatureName,
+                                                (char*)sSequence,
+                                                (char*)sSOType,
+                                                cFeatureStyleMode, &pFeatureSet->style,
+                                                iStart, iEnd, bHasScore, dScore, cStrand) ;
+
       /*
        * Add data to the feature.
        */
       bDataAdded = zMapFeatureAddAlignmentData(pFeature, gqTargetID, dPercentID,
                                                iTargetStart, iTargetEnd, cHomolType,
                                                iLength, cTargetStrand, ZMAPPHASE_0, pGaps,
-                                               zMapStyleGetWithinAlignError(pFeatureSet->style), FALSE, NULL )  ;
+                                               zMapStyleGetWithinAlignError(pFeatureSet->style), FALSE, sReadSequence)  ;
       if (bDataAdded)
         {
           bFeatureAdded = zMapFeatureSetAddFeature(pFeatureSet, pFeature) ;
@@ -3537,6 +3613,10 @@ static ZMapFeature makeFeatureAlignment(ZMapGFF3Parser const pParser,
           *psError = g_strdup_printf("makeFeatureAlignment(); feature with ID = %i and name = '%s' could not be added",
                                      (int)pFeature->unique_id, sFeatureName) ;
         }
+      else if (pParserFeatureSet)
+        {
+          distinctReadsInsert(pParserFeatureSet, pFeature) ;
+        }
 
       zMapFeatureAddText(pFeature, g_quark_from_string(sSource), (char*)sSource, NULL) ;
     }
@@ -4436,6 +4516,9 @@ static void destroyFeatureArray(gpointer data)
 
   g_hash_table_destroy(parser_feature_set->feature_styles);
 
+  if (parser_feature_set->distinct_reads)
+    g_hash_table_destroy(parser_feature_set->distinct_reads) ;
+
   g_free(parser_feature_set) ;
 
   return ;
@@ -4787,46 +4870,134 @@ static gboolean compositeFeaturesInsert(ZMapGFF3Parser const pParser, GQuark fea
 
 
 
+/*
+ * Short read sets are the ones that will be collapsed or squashed for display.
+ */
+static gboolean isShortReadSet(ZMapFeatureSet pFeatureSet)
+{
+  gboolean bResult = FALSE ;
 
+  if (pFeatureSet->style && (zMapStyleIsCollapse(pFeatureSet->style) || zMapStyleIsSquash(pFeatureSet->style)))
+    bResult = TRUE ;
 
+  return bResult ;
+}
 
 
+/*
+ * Look for a read already in the set that is identical to the one described, i.e. same
+ * position, strand, match coords, gaps and bases. pGaps must already be sorted.
+ */
+static ZMapFeature distinctReadsFind(ZMapGFFParserFeatureSet pParserFeatureSet, ZMapStrand cStrand,
+                                     int iStart, int iEnd, int iTargetStart, int iTargetEnd, GArray *pGaps,
+                                     char *sReadSequence)
+{
+  ZMapFeature pFeature = NULL ;
+  ZMapFeatureStruct probe ;
 
+  if (pParserFeatureSet->distinct_reads)
+    {
+      memset(&probe, 0, sizeof(ZMapFeatureStruct)) ;
 
+      /* Same as zMapFeatureAddAlignmentData() does with the match coords. */
+      if (iTargetStart > iTargetEnd)
+        {
+          int iTmp = iTargetStart ;
 
+          iTargetStart = iTargetEnd ;
+          iTargetEnd = iTmp ;
+        }
 
+      probe.strand = cStrand ;
+      probe.x1 = iStart ;
+      probe.x2 = iEnd ;
+      probe.feature.homol.y1 = iTargetStart ;
+      probe.feature.homol.y2 = iTargetEnd ;
+      probe.feature.homol.align = pGaps ;
+      probe.feature.homol.sequence = sReadSequence ;
 
+      pFeature = (ZMapFeature)g_hash_table_lookup(pParserFeatureSet->distinct_reads, &probe) ;
+    }
 
+  return pFeature ;
+}
 
 
+/*
+ * Record a new distinct read, it starts with a population of one.
+ */
+static void distinctReadsInsert(ZMapGFFParserFeatureSet pParserFeatureSet, ZMapFeature pFeature)
+{
+  if (!pParserFeatureSet->distinct_reads)
+    pParserFeatureSet->distinct_reads = g_hash_table_new(distinctReadHashCB, distinctReadEqualCB) ;
 
+  pFeature->population = 1 ;
 
+  g_hash_table_insert(pParserFeatureSet->distinct_reads, pFeature, pFeature) ;
 
+  return ;
+}
 
 
+static guint distinctReadHashCB(gconstpointer key)
+{
+  ZMapFeature pFeature = (ZMapFeature)key ;
+  GArray *pGaps = pFeature->feature.homol.align ;
+  guint iHash ;
 
+  iHash = (guint)pFeature->x1 ;
+  iHash = (iHash * 31) + (guint)pFeature->x2 ;
+  iHash = (iHash * 31) + (guint)pFeature->strand ;
+  iHash = (iHash * 31) + (guint)pFeature->feature.homol.y1 ;
 
+  if (pGaps)
+    iHash = (iHash * 31) + pGaps->len ;
 
+  if (pFeature->feature.homol.sequence)
+    iHash = (iHash * 31) + g_str_hash(pFeature->feature.homol.sequence) ;
 
+  return iHash ;
+}
 
 
+static gboolean distinctReadEqualCB(gconstpointer a, gconstpointer b)
+{
+  ZMapFeature pFeatureA = (ZMapFeature)a,
+    pFeatureB = (ZMapFeature)b ;
+  GArray *pGapsA = pFeatureA->feature.homol.align,
+    *pGapsB = pFeatureB->feature.homol.align ;
+  gboolean bResult = FALSE ;
 
+  if (pFeatureA->x1 == pFeatureB->x1 && pFeatureA->x2 == pFeatureB->x2
+      && pFeatureA->strand == pFeatureB->strand
+      && pFeatureA->feature.homol.y1 == pFeatureB->feature.homol.y1
+      && pFeatureA->feature.homol.y2 == pFeatureB->feature.homol.y2)
+    {
+      guint i ;
 
+      if (!pGapsA || !pGapsB)
+        {
+          bResult = (!pGapsA && !pGapsB) ;
+        }
+      else if (pGapsA->len == pGapsB->len)
+        {
+          bResult = TRUE ;
 
+          for (i = 0 ; bResult && i < pGapsA->len ; i++)
+            {
+              ZMapAlignBlock pBlockA = &g_array_index(pGapsA, ZMapAlignBlockStruct, i),
+                pBlockB = &g_array_index(pGapsB, ZMapAlignBlockStruct, i) ;
 
+              if (pBlockA->t1 != pBlockB->t1 || pBlockA->t2 != pBlockB->t2
+                  || pBlockA->q1 != pBlockB->q1 || pBlockA->q2 != pBlockB->q2)
+                bResult = FALSE ;
+            }
+        }
 
+      if (bResult && (pFeatureA->feature.homol.sequence || pFeatureB->feature.homol.sequence))
+        bResult = (pFeatureA->feature.homol.sequence && pFeatureB->feature.homol.sequence
+                   && !strcmp(pFeatureA->feature.homol.sequence, pFeatureB->feature.homol.sequence)) ;
+    }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+  return bResult ;
+}
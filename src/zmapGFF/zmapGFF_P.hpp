@@ -174,6 +174,9 @@ typedef struct ZMapGFFParserFeatureSetStruct_
                                                               user_data parameter. */
   GHashTable *feature_styles;                              /* copies of styles needed by features
                                                             * that can get pointed at by them */
+  GHashTable *distinct_reads ;                             /* For collapse/squash styles, the reads
+                                                            * seen so far, duplicates are counted
+                                                            * in the first one's population. */
 
 } ZMapGFFParserFeatureSetStruct, *ZMapGFFParserFeatureSet ;
 
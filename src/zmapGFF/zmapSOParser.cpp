@@ -32,6 +32,41 @@
 #include <zmapSOParser_P.hpp>
 
 
+/*
+ * One of the tables generated by zmap_SO_header.pl along with its indexes
+ * sorted by name and by ID, these give binary search lookups rather than
+ * scanning the whole table for every GFF line.
+ */
+typedef struct SOTableStructType
+  {
+    const ZMapSOIDDataStruct *pData ;
+    unsigned int iNumItems ;
+    const unsigned short *pByName ;
+    const unsigned short *pByID ;
+  } SOTableStruct ;
+
+/*
+ * Indexed by ZMapSOSetInUse.
+ */
+static const SOTableStruct so_tables_G[ZMAPSO_USE_NONE] =
+  {
+    {ZMAP_SO_DATA_TABLE01, ZMAP_SO_DATA_TABLE01_NUM_ITEMS, ZMAP_SO_DATA_TABLE01_BY_NAME, ZMAP_SO_DATA_TABLE01_BY_ID},
+    {ZMAP_SO_DATA_TABLE02, ZMAP_SO_DATA_TABLE02_NUM_ITEMS, ZMAP_SO_DATA_TABLE02_BY_NAME, ZMAP_SO_DATA_TABLE02_BY_ID},
+    {ZMAP_SO_DATA_TABLE03, ZMAP_SO_DATA_TABLE03_NUM_ITEMS, ZMAP_SO_DATA_TABLE03_BY_NAME, ZMAP_SO_DATA_TABLE03_BY_ID}
+  } ;
+
+#ifdef USE_SO_TERM_HACK
+static const SOTableStruct so_hack_table_G =
+  {ZMAP_SO_DATA_TABLE04_HACK, ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS,
+   ZMAP_SO_DATA_TABLE04_HACK_BY_NAME, ZMAP_SO_DATA_TABLE04_HACK_BY_ID} ;
+#endif
+
+static const ZMapSOIDDataStruct *tableFindName(const SOTableStruct *pTable, const char * const sName) ;
+static const ZMapSOIDDataStruct *tableFindID(const SOTableStruct *pTable, unsigned int iID) ;
+static const ZMapSOIDDataStruct *setFindName(ZMapSOSetInUse cSOSetInUse, const char * const sName) ;
+static const ZMapSOIDDataStruct *setFindID(ZMapSOSetInUse cSOSetInUse, unsigned int iID) ;
+
+
 /*
  * Create a single SO ID Data object with null data.
  */
@@ -152,50 +187,16 @@ gboolean zMapSOIDDataDestroy(ZMapSOIDData pID)
 char *       zMapSOIDDataName2SOAcc(const char * const pData)
 {
   char * sResult = NULL ;
-  unsigned int iID = 0 ;
-  gboolean bFound = FALSE ;
+  const ZMapSOIDDataStruct *pFound = NULL ;
   int i = 0 ;
   zMapReturnValIfFailSafe(pData, sResult ) ;
 
-  for (i=0; i<ZMAP_SO_DATA_TABLE01_NUM_ITEMS; ++i)
-    {
-      if (!strcmp(pData, ZMAP_SO_DATA_TABLE01[i].sName))
-        {
-          iID = ZMAP_SO_DATA_TABLE01[i].iID ;
-          bFound = TRUE ;
-          break ;
-        }
-    }
-
-  if (!bFound)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE02_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(pData, ZMAP_SO_DATA_TABLE02[i].sName))
-            {
-              iID = ZMAP_SO_DATA_TABLE02[i].iID ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-
-  if (!bFound)
-  {
-    for (i=0; i<ZMAP_SO_DATA_TABLE03_NUM_ITEMS; ++i)
-      {
-        if (!strcmp(pData, ZMAP_SO_DATA_TABLE03[i].sName))
-          {
-            iID = ZMAP_SO_DATA_TABLE03[i].iID ;
-            bFound = TRUE ;
-            break ;
-          }
-      }
-  }
+  for (i=ZMAPSO_USE_SOFA; !pFound && i<=ZMAPSO_USE_SOXPSIMPLE; ++i)
+    pFound = tableFindName(&so_tables_G[i], pData) ;
 
-  if (bFound)
+  if (pFound)
     {
-      sResult = g_strdup_printf("SO:%07d", iID) ;
+      sResult = g_strdup_printf("SO:%07d", pFound->iID) ;
     }
 
 
@@ -209,62 +210,11 @@ char *       zMapSOIDDataName2SOAcc(const char * const pData)
 ZMapStyleMode zMapSOSetGetStyleModeFromID(ZMapSOSetInUse cSOSetInUse, unsigned int iID)
 {
   ZMapStyleMode cTheMode = ZMAPSTYLE_MODE_INVALID ;
-  gboolean bFound = FALSE ;
-  unsigned int i ;
+  const ZMapSOIDDataStruct *pFound = NULL ;
   zMapReturnValIfFail(iID, cTheMode) ;
 
-  if (cSOSetInUse == ZMAPSO_USE_SOFA)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE01_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE01[i].iID )
-            {
-              cTheMode =  ZMAP_SO_DATA_TABLE01[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXP)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE02_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE02[i].iID )
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE02[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXPSIMPLE)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE03_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE03[i].iID )
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE03[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-
-#ifdef USE_SO_TERM_HACK
-  if (!bFound)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE04_HACK[i].iID )
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE04_HACK[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-#endif
-
+  if ((pFound = setFindID(cSOSetInUse, iID)))
+    cTheMode = pFound->cStyleMode ;
 
   return cTheMode ;
 }
@@ -275,62 +225,11 @@ ZMapStyleMode zMapSOSetGetStyleModeFromID(ZMapSOSetInUse cSOSetInUse, unsigned i
 ZMapHomolType zMapSOSetGetHomolFromID(ZMapSOSetInUse cSOSetInUse, unsigned int iID)
 {
   ZMapHomolType cHomol = ZMAPHOMOL_NONE;
-  gboolean bFound = FALSE ;
-  unsigned int i ;
+  const ZMapSOIDDataStruct *pFound = NULL ;
   zMapReturnValIfFail(iID, cHomol ) ;
 
-  if (cSOSetInUse == ZMAPSO_USE_SOFA)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE01_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE01[i].iID )
-            {
-              cHomol =  ZMAP_SO_DATA_TABLE01[i].cHomol ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXP)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE02_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE02[i].iID )
-            {
-              cHomol = ZMAP_SO_DATA_TABLE02[i].cHomol ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXPSIMPLE)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE03_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE03[i].iID )
-            {
-              cHomol = ZMAP_SO_DATA_TABLE03[i].cHomol ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-
-#ifdef USE_SO_TERM_HACK
-  if (!bFound)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE04_HACK[i].iID )
-            {
-              cHomol = ZMAP_SO_DATA_TABLE04_HACK[i].cHomol ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-#endif
-
+  if ((pFound = setFindID(cSOSetInUse, iID)))
+    cHomol = pFound->cHomol ;
 
   return cHomol ;
 }
@@ -341,61 +240,11 @@ ZMapHomolType zMapSOSetGetHomolFromID(ZMapSOSetInUse cSOSetInUse, unsigned int i
 ZMapStyleMode zMapSOSetGetStyleModeFromName(ZMapSOSetInUse cSOSetInUse, const char * const sName )
 {
   ZMapStyleMode cTheMode = ZMAPSTYLE_MODE_INVALID ;
-  gboolean bFound = FALSE ;
-  unsigned int i ;
+  const ZMapSOIDDataStruct *pFound = NULL ;
   zMapReturnValIfFail(sName && *sName, cTheMode ) ;
 
-  if (cSOSetInUse == ZMAPSO_USE_SOFA)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE01_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sName, ZMAP_SO_DATA_TABLE01[i].sName))
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE01[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXP)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE02_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sName, ZMAP_SO_DATA_TABLE02[i].sName))
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE02[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXPSIMPLE)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE03_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sName, ZMAP_SO_DATA_TABLE03[i].sName))
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE03[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-
-#ifdef USE_SO_TERM_HACK
-  if (!bFound)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sName, ZMAP_SO_DATA_TABLE04_HACK[i].sName))
-            {
-              cTheMode = ZMAP_SO_DATA_TABLE04_HACK[i].cStyleMode ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-#endif
+  if ((pFound = setFindName(cSOSetInUse, sName)))
+    cTheMode = pFound->cStyleMode ;
 
   return cTheMode ;
 }
@@ -406,61 +255,12 @@ ZMapStyleMode zMapSOSetGetStyleModeFromName(ZMapSOSetInUse cSOSetInUse, const ch
  */
 unsigned int zMapSOSetIsNamePresent(ZMapSOSetInUse cSOSetInUse, const char * const sType)
 {
-  unsigned int iResult = ZMAPSO_ID_UNK, i ;
-  gboolean bFound = FALSE ;
+  unsigned int iResult = ZMAPSO_ID_UNK ;
+  const ZMapSOIDDataStruct *pFound = NULL ;
   zMapReturnValIfFail(sType && *sType, iResult ) ;
 
-  if (cSOSetInUse == ZMAPSO_USE_SOFA)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE01_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sType, ZMAP_SO_DATA_TABLE01[i].sName))
-            {
-              iResult = ZMAP_SO_DATA_TABLE01[i].iID ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXP)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE02_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sType, ZMAP_SO_DATA_TABLE02[i].sName))
-            {
-              iResult = ZMAP_SO_DATA_TABLE02[i].iID ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXPSIMPLE)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE03_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sType, ZMAP_SO_DATA_TABLE03[i].sName))
-            {
-              iResult = ZMAP_SO_DATA_TABLE03[i].iID ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-
-#ifdef USE_SO_TERM_HACK
-  if (!bFound)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS; ++i)
-        {
-          if (!strcmp(sType, ZMAP_SO_DATA_TABLE04_HACK[i].sName))
-            {
-              iResult = ZMAP_SO_DATA_TABLE04_HACK[i].iID ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-#endif
+  if ((pFound = setFindName(cSOSetInUse, sType)))
+    iResult = pFound->iID ;
 
   return iResult ;
 }
@@ -472,65 +272,97 @@ unsigned int zMapSOSetIsNamePresent(ZMapSOSetInUse cSOSetInUse, const char * con
 const char * zMapSOSetIsIDPresent(ZMapSOSetInUse cSOSetInUse, unsigned int iID )
 {
   const char* sResult = NULL ;
-  gboolean bFound = FALSE ;
-  unsigned int i ;
+  const ZMapSOIDDataStruct *pFound = NULL ;
   zMapReturnValIfFail(iID, sResult ) ;
 
-  if (cSOSetInUse == ZMAPSO_USE_SOFA)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE01_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE01[i].iID )
-            {
-              sResult =  ZMAP_SO_DATA_TABLE01[i].sName ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXP)
+  if ((pFound = setFindID(cSOSetInUse, iID)))
+    sResult = pFound->sName ;
+
+  return sResult ;
+}
+
+
+/*
+ * Binary search of one of the generated tables using its name index. Where a
+ * name appears more than once this gives the first, as the linear search did.
+ */
+static const ZMapSOIDDataStruct *tableFindName(const SOTableStruct *pTable, const char * const sName)
+{
+  const ZMapSOIDDataStruct *pResult = NULL ;
+  unsigned int iLow = 0, iHigh = pTable->iNumItems, iMid ;
+
+  while (iLow < iHigh)
     {
-      for (i=0; i<ZMAP_SO_DATA_TABLE02_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE02[i].iID )
-            {
-              sResult = ZMAP_SO_DATA_TABLE02[i].sName ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
+      iMid = (iLow + iHigh) / 2 ;
+
+      if (strcmp(pTable->pData[pTable->pByName[iMid]].sName, sName) < 0)
+        iLow = iMid + 1 ;
+      else
+        iHigh = iMid ;
     }
-  else if (cSOSetInUse == ZMAPSO_USE_SOXPSIMPLE)
+
+  if (iLow < pTable->iNumItems && !strcmp(pTable->pData[pTable->pByName[iLow]].sName, sName))
+    pResult = &pTable->pData[pTable->pByName[iLow]] ;
+
+  return pResult ;
+}
+
+/*
+ * As tableFindName() but using the ID index.
+ */
+static const ZMapSOIDDataStruct *tableFindID(const SOTableStruct *pTable, unsigned int iID)
+{
+  const ZMapSOIDDataStruct *pResult = NULL ;
+  unsigned int iLow = 0, iHigh = pTable->iNumItems, iMid ;
+
+  while (iLow < iHigh)
     {
-      for (i=0; i<ZMAP_SO_DATA_TABLE03_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE03[i].iID )
-            {
-              sResult = ZMAP_SO_DATA_TABLE03[i].sName;
-              bFound = TRUE ;
-              break ;
-            }
-        }
+      iMid = (iLow + iHigh) / 2 ;
+
+      if (pTable->pData[pTable->pByID[iMid]].iID < iID)
+        iLow = iMid + 1 ;
+      else
+        iHigh = iMid ;
     }
 
+  if (iLow < pTable->iNumItems && pTable->pData[pTable->pByID[iLow]].iID == iID)
+    pResult = &pTable->pData[pTable->pByID[iLow]] ;
+
+  return pResult ;
+}
+
+/*
+ * Look in the table for the set in use and then in the hack table.
+ */
+static const ZMapSOIDDataStruct *setFindName(ZMapSOSetInUse cSOSetInUse, const char * const sName)
+{
+  const ZMapSOIDDataStruct *pResult = NULL ;
+
+  if (cSOSetInUse < ZMAPSO_USE_NONE)
+    pResult = tableFindName(&so_tables_G[cSOSetInUse], sName) ;
+
 #ifdef USE_SO_TERM_HACK
-  if (!bFound)
-    {
-      for (i=0; i<ZMAP_SO_DATA_TABLE04_HACK_NUM_ITEMS; ++i)
-        {
-          if (iID == ZMAP_SO_DATA_TABLE04_HACK[i].iID )
-            {
-              sResult = ZMAP_SO_DATA_TABLE04_HACK[i].sName ;
-              bFound = TRUE ;
-              break ;
-            }
-        }
-    }
+  if (!pResult)
+    pResult = tableFindName(&so_hack_table_G, sName) ;
 #endif
 
-  return sResult ;
+  return pResult ;
 }
 
+static const ZMapSOIDDataStruct *setFindID(ZMapSOSetInUse cSOSetInUse, unsigned int iID)
+{
+  const ZMapSOIDDataStruct *pResult = NULL ;
+
+  if (cSOSetInUse < ZMAPSO_USE_NONE)
+    pResult = tableFindID(&so_tables_G[cSOSetInUse], iID) ;
+
+#ifdef USE_SO_TERM_HACK
+  if (!pResult)
+    pResult = tableFindID(&so_hack_table_G, iID) ;
+#endif
+
+  return pResult ;
+}
 
 /*
  * Need functions to lookup ZMapStyleMode from either the ID
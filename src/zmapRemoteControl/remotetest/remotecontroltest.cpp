@@ -88,6 +88,9 @@
 #define XREMOTEARG_CMD_DEBUG "command-debug"
 #define XREMOTEARG_CMD_DEBUG_DESC "Display command debugging output (default true)."
 
+#define XREMOTEARG_PING_COUNT "ping-count"
+#define XREMOTEARG_PING_COUNT_DESC "Number of pings sent by the ping latency test (default 1000)."
+
 
 /* command line args passed to zmap. */
 #define XREMOTEARG_SLEEP "zmap-sleep"
@@ -116,6 +119,10 @@
 
 
 
+/* Default number of pings for the ping latency test. */
+#define XREMOTE_PING_TEST_COUNT 1000
+
+
 /* config file defines */
 #define XREMOTE_PROG_CONFIG "programs"
 
@@ -137,6 +144,7 @@ enum
 
     XREMOTE_CREATE,
     XREMOTE_CREATE_SIMPLE,
+    XREMOTE_CREATE_FEATURES,
     XREMOTE_REPLACE,
     XREMOTE_DELETE,
     XREMOTE_FIND,
@@ -172,6 +180,7 @@ typedef struct XRemoteCmdLineArgsStructType
   gboolean debugger ;
   gboolean xremote_debug ;
   gboolean cmd_debug ;
+  int ping_count ;
 
   /* and those to be passed to zmap */
   const char *sleep_seconds ;
@@ -254,6 +263,13 @@ typedef struct AppDataStructType
   GetPeer peer_cbdata ;
 
 
+  /* Ping latency test, pings are sent back to back and each round trip is timed. */
+  int ping_test_count ;                                     /* Number of pings to send. */
+  int ping_test_done ;                                      /* Number of replies received so far. */
+  GTimer *ping_test_timer ;                                 /* Times a single round trip. */
+  GTimer *ping_test_total_timer ;                           /* Times the whole test. */
+  double ping_test_min, ping_test_max, ping_test_sum ;      /* Round trip stats in seconds. */
+
 
 } AppDataStruct, *AppData ;
 
@@ -298,6 +314,9 @@ static GtkWidget *makeStateBox(AppData app_data) ;
 
 static void requestZMapStop(AppData app_data) ;
 static gboolean stopZMapCB(gpointer user_data) ;
+static gboolean pingTestSend(AppData app_data) ;
+static void pingTestReply(AppData app_data) ;
+static void pingTestStop(AppData app_data, const char *err_msg) ;
 static void resetGUI(AppData app_data) ;
 static void resetTextAreas(AppData app_data) ;
 
@@ -348,6 +367,7 @@ static GtkWidget *button_bar(AppData app_data);
 
 
 static void cmdCB( gpointer data, guint callback_action, GtkWidget *w );
+static void pingTestCB(gpointer data, guint callback_action, GtkWidget *w) ;
 static void runZMapCB( gpointer data, guint callback_action, GtkWidget *w );
 static void killZMapCB( gpointer data, guint callback_action, GtkWidget *w );
 static void menuQuitCB(gpointer data, guint callback_action, GtkWidget *w);
@@ -392,6 +412,7 @@ static GtkItemFactoryEntry menu_items_G[] =
     {(gchar *)"/_ZMap Control/Kill ZMap",  NULL,        (GtkItemFactoryCallback)killZMapCB,  0,             NULL, NULL},
     {(gchar *)"/_Commands",               NULL,         NULL,       0,                  (gchar *)"<Branch>", NULL},
     {(gchar *)"/Commands/ping",           NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_PING,       NULL,       NULL},
+    {(gchar *)"/Commands/ping latency test", NULL,      (GtkItemFactoryCallback)pingTestCB, 0,                  NULL,       NULL},
 
     {(gchar *)"/Commands/new_view",       NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_NEW_VIEW,   NULL,       NULL},
     {(gchar *)"/Commands/add_to_view",    NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_ADD_VIEW,   NULL,       NULL},
@@ -404,6 +425,7 @@ static GtkItemFactoryEntry menu_items_G[] =
 
     {(gchar *)"/Commands/Feature Create (simple)", NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_CREATE_SIMPLE,   NULL,       NULL},
     {(gchar *)"/Commands/Feature Create", NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_CREATE,   NULL,       NULL},
+    {(gchar *)"/Commands/Features Create (one duplicated)", NULL, (GtkItemFactoryCallback)cmdCB, XREMOTE_CREATE_FEATURES, NULL, NULL},
     {(gchar *)"/Commands/Feature Replace",NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_REPLACE,     NULL,       NULL},
     {(gchar *)"/Commands/Feature Delete", NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_DELETE,   NULL,       NULL},
     {(gchar *)"/Commands/Feature Find",   NULL,         (GtkItemFactoryCallback)cmdCB,      XREMOTE_FIND,     NULL,       NULL},
@@ -519,6 +541,11 @@ static void destroyAppData(AppData app_data)
   if (app_data->config_context)
     zMapConfigIniContextDestroy(app_data->config_context) ;
 
+  if (app_data->ping_test_timer)
+    g_timer_destroy(app_data->ping_test_timer) ;
+  if (app_data->ping_test_total_timer)
+    g_timer_destroy(app_data->ping_test_total_timer) ;
+
   /* May need more than this..... */
   g_option_context_free(app_data->cmd_line_args->opt_context) ;
   g_free(app_data->cmd_line_args->zmap_config_file) ;
@@ -1326,6 +1353,9 @@ static void replyHandlerCB(ZMapRemoteControl remote_control, char *reply, void *
       err_msg = g_strdup_printf("Bad format reply: \"%s\".", reply) ;
       gtk_text_buffer_set_text(app_data->our_req.response_text_buffer, err_msg, -1) ;
       g_free(err_msg) ;
+
+      if (app_data->ping_test_count)
+        pingTestStop(app_data, "bad reply format") ;
     }
   else if (command_rc != REMOTE_COMMAND_RC_OK)
     {
@@ -1333,6 +1363,14 @@ static void replyHandlerCB(ZMapRemoteControl remote_control, char *reply, void *
 
       zMapWarning("Command \"%s\" failed with return code \"%s\" and reason \"%s\".",
 		  command, zMapRemoteCommandRC2Str(command_rc), reason) ;
+
+      if (app_data->ping_test_count)
+        pingTestStop(app_data, "ping failed") ;
+    }
+  else if (app_data->ping_test_count && strcmp(command, ZACP_PING) == 0)
+    {
+      /* Ping latency test, don't display every reply, it would swamp the timings. */
+      pingTestReply(app_data) ;
     }
   else
     {
@@ -1409,6 +1447,10 @@ static void replyHandlerCB(ZMapRemoteControl remote_control, char *reply, void *
   gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(app_data->waiting), TRUE) ;
 
 
+  /* Send the next ping as soon as the last one is replied to. */
+  if (app_data->ping_test_count)
+    pingTestSend(app_data) ;
+
 
   zMapDebugPrint(debug_G, "%s", "Exit...") ;
 
@@ -1424,6 +1466,9 @@ static void errorCB(ZMapRemoteControl remote_control,
 
   zMapDebugPrint(debug_G, "%s", "Enter...") ;
 
+  if (app_data->ping_test_count)
+    pingTestStop(app_data, err_msg) ;
+
   gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(app_data->waiting), TRUE) ;
 
   zMapDebugPrint(debug_G, "%s", "Exit...") ;
@@ -1881,6 +1926,7 @@ static void cmdCB(gpointer data, guint callback_action, GtkWidget *w)
   GQuark *action ;
   gboolean do_feature_xml = FALSE ;
   gboolean do_replace_xml = FALSE ;
+  gboolean do_duplicate_xml = FALSE ;
 
   /* New stuff.... */
   const char *command = NULL ;
@@ -2028,6 +2074,18 @@ static void cmdCB(gpointer data, guint callback_action, GtkWidget *w)
       do_feature_xml = TRUE ;
       break;
 
+    case XREMOTE_CREATE_FEATURES:
+      /* The feature is sent twice, zmap should create it once and reply "ok" with a
+       * message saying the second one could not be created. */
+      *action  = g_quark_from_string(ZACP_CREATE_FEATURES) ;
+      command = ZACP_CREATE_FEATURES ;
+
+      data_ptr = &feature_simple[0];
+
+      do_feature_xml = TRUE ;
+      do_duplicate_xml = TRUE ;
+      break;
+
     case XREMOTE_REPLACE:
       *action  = g_quark_from_string(ZACP_REPLACE_FEATURE) ;
       command = ZACP_REPLACE_FEATURE ;
@@ -2093,7 +2151,7 @@ static void cmdCB(gpointer data, guint callback_action, GtkWidget *w)
       featureset[1].value.q = g_quark_from_string(default_feature_set) ;
 
 
-      if (callback_action == XREMOTE_CREATE_SIMPLE)
+      if (callback_action == XREMOTE_CREATE_SIMPLE || callback_action == XREMOTE_CREATE_FEATURES)
 	xml = &feature_simple[0] ;
       else
 	xml = &feature[0] ;
@@ -2122,6 +2180,12 @@ static void cmdCB(gpointer data, guint callback_action, GtkWidget *w)
 							       NULL, NULL,
 							       data_ptr) ;
 
+  if (do_duplicate_xml)
+    request_stack = zMapXMLUtilsAddStackToEventsArrayToElement(request_stack,
+							       next_element, 0,
+							       NULL, NULL,
+							       data_ptr) ;
+
 
   if (do_replace_xml)
     {
@@ -2163,6 +2227,150 @@ static void cmdCB(gpointer data, guint callback_action, GtkWidget *w)
   return ;
 }
 
+/* Start the ping latency test: sends --ping-count pings to zmap one after the other, each
+ * one as soon as the reply to the previous one arrives, and reports the round trip times
+ * and overall throughput. */
+static void pingTestCB(gpointer data, guint callback_action, GtkWidget *w)
+{
+  AppData app_data = (AppData)data ;
+
+  if (!(app_data->send_interface_init))
+    {
+      zMapGUIShowMsg(ZMAP_MSG_WARNING, "Cannot run ping test, zmap is not running.") ;
+    }
+  else if (app_data->ping_test_count || app_data->curr_request)
+    {
+      zMapGUIShowMsg(ZMAP_MSG_WARNING, "Cannot run ping test, a request is already in progress.") ;
+    }
+  else
+    {
+      app_data->ping_test_count = app_data->cmd_line_args->ping_count ;
+      app_data->ping_test_done = 0 ;
+      app_data->ping_test_min = G_MAXDOUBLE ;
+      app_data->ping_test_max = app_data->ping_test_sum = 0.0 ;
+
+      if (!(app_data->ping_test_timer))
+        app_data->ping_test_timer = g_timer_new() ;
+      if (!(app_data->ping_test_total_timer))
+        app_data->ping_test_total_timer = g_timer_new() ;
+
+      g_timer_start(app_data->ping_test_total_timer) ;
+
+      gtk_text_buffer_set_text(app_data->our_req.response_text_buffer, "", -1) ;
+
+      pingTestSend(app_data) ;
+    }
+
+  return ;
+}
+
+
+/* Send the next ping of the latency test. */
+static gboolean pingTestSend(AppData app_data)
+{
+  gboolean result = FALSE ;
+  GArray *request_stack ;
+  char *request ;
+  char *err_msg = NULL ;
+
+  request_stack = zMapRemoteCommandCreateRequest(app_data->remote_cntl, ZACP_PING, -1, (char *)NULL) ;
+
+  if (!(request = zMapXMLUtilsStack2XML(request_stack, &err_msg, FALSE)))
+    {
+      pingTestStop(app_data, err_msg) ;
+
+      g_free(err_msg) ;
+    }
+  else
+    {
+      g_timer_start(app_data->ping_test_timer) ;
+
+      if (!zMapRemoteControlSendRequest(app_data->remote_cntl, request))
+        {
+          pingTestStop(app_data, "could not send request") ;
+
+          g_free(request) ;
+        }
+      else
+        {
+          /* request now belongs to the outgoing message so keep our own copy. */
+          if (app_data->curr_request)
+            g_free(app_data->curr_request) ;
+
+          app_data->curr_request = g_strdup(request) ;
+
+          gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(app_data->sending), TRUE) ;
+
+          result = TRUE ;
+        }
+    }
+
+  g_array_free(request_stack, TRUE) ;
+
+  return result ;
+}
+
+
+/* Record the round trip time of a ping and report the results once all pings are done. */
+static void pingTestReply(AppData app_data)
+{
+  double round_trip ;
+
+  round_trip = g_timer_elapsed(app_data->ping_test_timer, NULL) ;
+
+  app_data->ping_test_done++ ;
+  app_data->ping_test_sum += round_trip ;
+
+  if (round_trip < app_data->ping_test_min)
+    app_data->ping_test_min = round_trip ;
+  if (round_trip > app_data->ping_test_max)
+    app_data->ping_test_max = round_trip ;
+
+  if (app_data->ping_test_done == app_data->ping_test_count)
+    pingTestStop(app_data, NULL) ;
+
+  return ;
+}
+
+
+/* End the ping latency test, reporting the timings for the pings that completed and
+ * err_msg if the test failed. */
+static void pingTestStop(AppData app_data, const char *err_msg)
+{
+  GString *report ;
+  double total ;
+
+  total = g_timer_elapsed(app_data->ping_test_total_timer, NULL) ;
+
+  report = g_string_new(NULL) ;
+
+  if (err_msg)
+    g_string_append_printf(report, "Ping test stopped after %d of %d pings: %s\n",
+                           app_data->ping_test_done, app_data->ping_test_count, err_msg) ;
+  else
+    g_string_append_printf(report, "Ping test completed %d pings.\n", app_data->ping_test_done) ;
+
+  if (app_data->ping_test_done)
+    g_string_append_printf(report,
+                           "Round trip (ms): min %.3f, mean %.3f, max %.3f\n"
+                           "Throughput: %.1f requests/s over %.3fs\n",
+                           app_data->ping_test_min * 1000.0,
+                           (app_data->ping_test_sum / app_data->ping_test_done) * 1000.0,
+                           app_data->ping_test_max * 1000.0,
+                           (total > 0.0 ? app_data->ping_test_done / total : 0.0), total) ;
+
+  gtk_text_buffer_set_text(app_data->our_req.response_text_buffer, report->str, -1) ;
+
+  zMapDebugPrint(debug_G, "%s", report->str) ;
+
+  g_string_free(report, TRUE) ;
+
+  app_data->ping_test_count = 0 ;
+
+  return ;
+}
+
+
 /* quit from the menu */
 static void menuQuitCB(gpointer data, guint callback_action, GtkWidget *w)
 {
@@ -2378,6 +2586,9 @@ static XRemoteCmdLineArgs getCommandLineArgs(int argc, char *argv[])
 
       if (!(arg_context->zmap_path))
         arg_context->zmap_path = "./zmap" ;
+
+      if (arg_context->ping_count <= 0)
+        arg_context->ping_count = XREMOTE_PING_TEST_COUNT ;
     }
 
   return arg_context ;
@@ -2455,6 +2666,8 @@ static GOptionEntry *get_main_entries(XRemoteCmdLineArgs arg_context)
       XREMOTEARG_SLEEP_DESC, "sleep" },
     { XREMOTEARG_NO_TIMEOUT, 0, 0, G_OPTION_ARG_NONE, NULL,
       XREMOTEARG_NO_TIMEOUT_DESC, XREMOTEARG_NO_ARG },
+    { XREMOTEARG_PING_COUNT, 0, 0, G_OPTION_ARG_INT, NULL,
+      XREMOTEARG_PING_COUNT_DESC, "count" },
     { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING, NULL,
       NULL, "<zmap executable>" },
     { NULL }
@@ -2476,7 +2689,8 @@ static GOptionEntry *get_main_entries(XRemoteCmdLineArgs arg_context)
       entries[10].arg_data = &(arg_context->remote_debug) ;
       entries[11].arg_data = &(arg_context->sleep_seconds) ;
       entries[12].arg_data = &(arg_context->timeout) ;
-      entries[13].arg_data = &(arg_context->zmap_path) ;
+      entries[13].arg_data = &(arg_context->ping_count) ;
+      entries[14].arg_data = &(arg_context->zmap_path) ;
     }
 
   return entries;
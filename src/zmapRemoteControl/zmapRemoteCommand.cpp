@@ -177,6 +177,7 @@ CommandAttributeStruct cmd_attrs_G[] =
     {ZACP_SELECT_FEATURE, COMMAND_PRIORITY_HIGH},
     {ZACP_EDIT_FEATURE, COMMAND_PRIORITY_HIGH},
     {ZACP_CREATE_FEATURE, COMMAND_PRIORITY_HIGH},
+    {ZACP_CREATE_FEATURES, COMMAND_PRIORITY_HIGH},
     {ZACP_REPLACE_FEATURE, COMMAND_PRIORITY_HIGH},
     {ZACP_DELETE_FEATURE, COMMAND_PRIORITY_HIGH},
     {ZACP_SELECT_MULTI_FEATURE, COMMAND_PRIORITY_HIGH},
@@ -63,18 +63,6 @@
 
 
 
-/* Have no idea what's sensible but a guess is to think that we need socket checking to be faster
- * than queue checking since the queue checker can't have anything to check unless there is something
- * from the socket. */
-enum
-  {
-    SOCKET_WATCH_INTERVAL = 10,                             /* Interval in ms between checking zmq socket. */
-
-    QUEUE_WATCH_INTERVAL = 20                               /* Interval in ms between checking request/repy queues. */
-  } ;
-
-
-
 /*
  * Use these macros for _ALL_ logging calls/error handling in this code
  * to ensure that messages go to the right place.
@@ -160,6 +148,9 @@ static RemoteZeroMQMessage zeroMQMessageCreate(char *header, char *body) ;
 static void zeroMQMessageDestroy(RemoteZeroMQMessage zeromq_msg) ;
 
 static gboolean queueMonitorCB(gpointer user_data) ;
+static void queueMonitorKick(ZMapRemoteControl remote_control) ;
+static void queueMonitorReschedule(ZMapRemoteControl remote_control) ;
+static gboolean queueProcess(ZMapRemoteControl remote_control) ;
 static GQueue *queueCreate(void) ;
 static void queueAdd(GQueue *gqueue, RemoteZeroMQMessage req_rep) ;
 static void queueAddFront(GQueue *gqueue, RemoteZeroMQMessage req_rep) ;
@@ -197,8 +188,12 @@ static gboolean zeroMQSocketRequestorCreate(void *zmq_context, const char *end_p
 static gboolean zeroMQSocketReplierCreate(void *zmq_context,
                                           void **socket_out, char **end_point_out, char **err_msg_out) ;
 static char *zeroMQSocketGetAddress(void *zmq_socket, char **err_msg_out) ;
-static TimerData zeroMQSocketSetWatch(GSourceFunc wait_func_cb, ZMapRemoteControl remote_control) ;
+static TimerData zeroMQSocketSetWatch(void *zmq_socket, GSourceFunc wait_func_cb, ZMapRemoteControl remote_control) ;
 static gboolean zeroMQSocketUnSetWatch(TimerData timer_data) ;
+static gboolean zeroMQSocketHasMessage(void *zmq_socket) ;
+static gboolean zeroMQSourcePrepare(GSource *source, gint *timeout_out) ;
+static gboolean zeroMQSourceCheck(GSource *source) ;
+static gboolean zeroMQSourceDispatch(GSource *source, GSourceFunc callback, gpointer user_data) ;
 static gboolean zeroMQSocketSendMessage(void *zmq_socket, char *header, char *body, char **err_msg_out) ;
 static gboolean zeroMQSocketSendFrame(void *zmq_socket, void *msg, int msg_len, gboolean send_more,
                                       char **err_msg_out) ;
@@ -210,6 +205,7 @@ static void timeoutStartTimer(ZMapRemoteControl remote_control) ;
 static TimeoutType timeoutHasTimedOut(ZMapRemoteControl remote_control) ;
 static void timeoutResetTimeouts(ZMapRemoteControl remote_control) ;
 static void timeoutGetCurrTimeout(ZMapRemoteControl remote_control, int *timeout_num_out, double *timeout_s_out) ;
+static guint timeoutGetRemaining(ZMapRemoteControl remote_control) ;
 
 static void errorHandler(ZMapRemoteControl remote_control,
 			 const char *file_name, const char *func_name,
@@ -341,19 +337,13 @@ gboolean zMapRemoteControlReceiveInit(ZMapRemoteControl remote_control,
     {
       REMOTELOGMSG(remote_control, "%s", err_msg) ;
     }
-  else if (!(timer_data = zeroMQSocketSetWatch(waitForRequestCB, remote_control)))
+  else if (!(timer_data = zeroMQSocketSetWatch(receive_socket, waitForRequestCB, remote_control)))
     {
       REMOTELOGMSG(remote_control,
                    "Cannot set a watch on zeroMQ socket \"%s\" so cannot wait for requests.", socket_address) ;
     }
   else
     {
-      /* Lazy set up of timer routine to monitor our incoming/outgoing queues,
-       * not needed until send or receive is set up. */
-      if (!(remote_control->queue_monitor_cb_id))
-        remote_control->queue_monitor_cb_id = g_timeout_add(QUEUE_WATCH_INTERVAL, queueMonitorCB, remote_control) ;
-
-
       remote_control->receive = createReceive(remote_control->app_id,
                                               process_request_func, process_request_func_data,
                                               reply_sent_func, reply_sent_func_data) ;
@@ -417,11 +407,6 @@ gboolean zMapRemoteControlSendInit(ZMapRemoteControl remote_control,
                       process_reply_func, process_reply_func_data,
                       &err_msg))
     {
-      /* Lazy set up of timer routine to monitor our incoming/outgoing queues,
-       * not needed until send or receive is set up. */
-      if (!(remote_control->queue_monitor_cb_id))
-        remote_control->queue_monitor_cb_id = g_timeout_add(QUEUE_WATCH_INTERVAL, queueMonitorCB, remote_control) ;
-
       remote_control->state = REMOTE_STATE_IDLE ;
 
       REMOTELOGMSG(remote_control,
@@ -486,6 +471,8 @@ gboolean zMapRemoteControlSendRequest(ZMapRemoteControl remote_control, char *re
 
           queueAddInRequestPriority(remote_control->outgoing_requests, outgoing_request, NULL) ;
 
+          queueMonitorKick(remote_control) ;
+
           DEBUGLOGMSG(remote_control, ZMAP_REMOTECONTROL_DEBUG_VERBOSE,
                       "Received request from zmap, added to outgoing request queue: %s",
                       outgoing_request->body) ;
@@ -750,14 +737,13 @@ ZMAP_ENUM_AS_EXACT_STRING_FUNC(remoteState2ExactStr, RemoteControlState, REMOTE_
 
 
 /*
- * Callbacks to handle receiving requests/replies from our peer. These are g_timer
- * callbacks and can be removed by returning FALSE.
+ * Callbacks to handle receiving requests/replies from our peer. These are called
+ * from a zeromq socket GSource and can be removed by returning FALSE.
  */
 
 
-/* A GSourceFunc() called every SOCKET_WATCH_INTERVAL ms to check our
- * request receive socket to see if there have been any requests from our peer.
- * If there is a request it is queued for processing.
+/* A GSourceFunc() called when our request receive socket has a message from our
+ * peer, the request is queued and the queue monitor kicked to process it.
  */
 static gboolean waitForRequestCB(gpointer user_data)
 {
@@ -792,6 +778,8 @@ static gboolean waitForRequestCB(gpointer user_data)
 
       queueAdd(remote_control->incoming_requests, incoming_request) ;
 
+      queueMonitorKick(remote_control) ;
+
       DEBUGLOGMSG(remote_control, ZMAP_REMOTECONTROL_DEBUG_VERBOSE,
                   "Received request from peer, adding to incoming request queue: %s",
                   incoming_request->body) ;
@@ -801,9 +789,8 @@ static gboolean waitForRequestCB(gpointer user_data)
 }
 
 
-/* A GSourceFunc() called every SOCKET_WATCH_INTERVAL ms to check our
- * reply receive socket to see if there has been a reply from our peer to our request.
- * If there is a reply it is queued for processing.
+/* A GSourceFunc() called when our reply receive socket has a reply from our peer
+ * to our request, the reply is queued and the queue monitor kicked to process it.
  */
 static gboolean waitForReplyCB(gpointer user_data)
 {
@@ -838,6 +825,8 @@ static gboolean waitForReplyCB(gpointer user_data)
 
       queueAdd(remote_control->incoming_replies, incoming_reply) ;
 
+      queueMonitorKick(remote_control) ;
+
       DEBUGLOGMSG(remote_control, ZMAP_REMOTECONTROL_DEBUG_VERBOSE,
                   "Received reply from peer, adding to incoming reply queue: %s",
                   incoming_reply->body) ;
@@ -891,6 +880,8 @@ static void receiveReplyFromAppCB(void *remote_data, gboolean abort, char *reply
                       outgoing_reply->body) ;
 
           queueAdd(remote_control->outgoing_replies, outgoing_reply) ;
+
+          queueMonitorKick(remote_control) ;
         }
     }
 
@@ -931,6 +922,7 @@ static gboolean setToInactive(ZMapRemoteControl remote_control)
       result = FALSE ;
     }
   remote_control->queue_monitor_cb_id = 0 ;
+  remote_control->queue_monitor_is_timeout = FALSE ;
 
   /* Empty the queues. */
   queueEmpty(remote_control->incoming_requests) ;
@@ -989,10 +981,119 @@ static gboolean setToInactive(ZMapRemoteControl remote_control)
 
 
 
+/* A one-shot GSourceFunc() that processes the request/reply queues. It is added as an idle
+ * callback by queueMonitorKick() whenever something is added to a queue, or as a timeout
+ * callback by queueMonitorReschedule() when we are waiting for the peer's reply and need to
+ * check for a timeout, so nothing runs while there is nothing to do. */
+static gboolean queueMonitorCB(gpointer user_data)
+{
+  ZMapRemoteControl remote_control = (ZMapRemoteControl)user_data ;
+
+  /* Clear the id first so that any kick made while we are processing adds a new callback. */
+  remote_control->queue_monitor_cb_id = 0 ;
+  remote_control->queue_monitor_is_timeout = FALSE ;
+
+  if (queueProcess(remote_control))
+    queueMonitorReschedule(remote_control) ;
+
+  return FALSE ;
+}
+
+
+/* Make sure the queue monitor runs as soon as the main loop is free, replacing any pending
+ * timeout callback. */
+static void queueMonitorKick(ZMapRemoteControl remote_control)
+{
+  /* Queue processing is only possible once send or receive has been set up. */
+  if (remote_control->state == REMOTE_STATE_INACTIVE
+      || remote_control->state == REMOTE_STATE_FAILED || remote_control->state == REMOTE_STATE_DYING)
+    return ;
+
+  if (remote_control->queue_monitor_cb_id && remote_control->queue_monitor_is_timeout)
+    {
+      g_source_remove(remote_control->queue_monitor_cb_id) ;
+      remote_control->queue_monitor_cb_id = 0 ;
+    }
+
+  if (!(remote_control->queue_monitor_cb_id))
+    {
+      remote_control->queue_monitor_cb_id = g_idle_add_full(G_PRIORITY_DEFAULT, queueMonitorCB, remote_control, NULL) ;
+      remote_control->queue_monitor_is_timeout = FALSE ;
+    }
+
+  return ;
+}
+
+
+/* Called after the queues have been processed to decide whether the monitor needs to run
+ * again: straight away if there is more it can do now, after the current timeout if we are
+ * waiting for the peer's reply, otherwise not until the next message is queued. */
+static void queueMonitorReschedule(ZMapRemoteControl remote_control)
+{
+  gboolean run_now = FALSE ;
+
+  /* Already kicked while we were processing. */
+  if (remote_control->queue_monitor_cb_id)
+    return ;
+
+  switch (remote_control->state)
+    {
+    case REMOTE_STATE_IDLE:
+      {
+        run_now = (remote_control->stalled_req
+                   || !queueIsEmpty(remote_control->incoming_requests)
+                   || !queueIsEmpty(remote_control->outgoing_requests)) ;
+        break ;
+      }
+
+    case REMOTE_STATE_OUTGOING_REQUEST_TO_BE_SENT:
+    case REMOTE_STATE_INCOMING_REQUEST_TO_BE_RECEIVED:
+      {
+        run_now = TRUE ;
+        break ;
+      }
+
+    case REMOTE_STATE_OUTGOING_REQUEST_WAITING_FOR_THEIR_REPLY:
+      {
+        /* Note that a queued incoming request is not a reason to run again here, the collision
+         * has already been resolved in our favour and will be again until our reply arrives. */
+        if (!queueIsEmpty(remote_control->incoming_replies))
+          {
+            run_now = TRUE ;
+          }
+        else
+          {
+            remote_control->queue_monitor_cb_id = g_timeout_add(timeoutGetRemaining(remote_control),
+                                                                queueMonitorCB, remote_control) ;
+            remote_control->queue_monitor_is_timeout = TRUE ;
+          }
+        break ;
+      }
+
+    case REMOTE_STATE_INCOMING_REQUEST_WAITING_FOR_OUR_REPLY:
+      {
+        run_now = !queueIsEmpty(remote_control->outgoing_replies) ;
+        break ;
+      }
+
+    default:
+      {
+        /* Inactive/failed etc, nothing to monitor. */
+        break ;
+      }
+    }
+
+  if (run_now)
+    queueMonitorKick(remote_control) ;
+
+  return ;
+}
+
+
 /* THIS FUNCTION HAS GOT TOO LONG, IT'S HARD TO SEE WHAT'S GOING ON, THE SWITCH CLAUSES
  * NEED TO BE TURNED INTO FUNCTIONS SO THE OVERALL STRUCTURE OF THE SWITCH CAN BE SEEN.... */
-/* A GSourceFunc() called back by glib every QUEUE_WATCH_INTERVAL ms to monitor and process
- * incoming and outgoing requests.
+/* Called from queueMonitorCB() to monitor and process incoming and outgoing requests.
+ * Returns FALSE if queue monitoring should stop.
  *
  * This function won't be called until either/both of the receive or send interfaces have
  * been initialised.
@@ -1007,14 +1108,13 @@ static gboolean setToInactive(ZMapRemoteControl remote_control)
  * then we leave "done" as FALSE so that we loop and process the new state.
  *
  * If the result of the action is that we will need to wait (e.g. for a reply from the peer)
- * then we set "done" to TRUE and exit this routine to be called back again in
- * QUEUE_WATCH_INTERVAL ms by which time the reply or whatever may have happened.
+ * then we set "done" to TRUE and exit this routine, queueMonitorCB() then arranges for us
+ * to be called again when the reply arrives or the request times out.
  * 
  *  */
-static gboolean queueMonitorCB(gpointer user_data)
+static gboolean queueProcess(ZMapRemoteControl remote_control)
 {
   gboolean result = TRUE ;                                  /* Usually want to be called back. */
-  ZMapRemoteControl remote_control = (ZMapRemoteControl)user_data ;
   gboolean done = FALSE ;
 
   zMapReturnValIfFail((remote_control->state != REMOTE_STATE_FAILED && remote_control->state != REMOTE_STATE_DYING),
@@ -2071,20 +2171,47 @@ static char *zeroMQSocketGetAddress(void *zmq_socket, char **err_msg_out)
 
 
 
-static TimerData zeroMQSocketSetWatch(GSourceFunc timer_func_cb, ZMapRemoteControl remote_control)
+/* Add a glib event source for zmq_socket so that timer_func_cb is called as soon as there is
+ * a message to read on the socket rather than polling the socket on a timer.
+ *
+ * Returns NULL if the socket's file descriptor cannot be obtained. */
+static TimerData zeroMQSocketSetWatch(void *zmq_socket, GSourceFunc timer_func_cb, ZMapRemoteControl remote_control)
 {
+  static GSourceFuncs zmq_source_funcs = {zeroMQSourcePrepare, zeroMQSourceCheck, zeroMQSourceDispatch,
+                                          NULL, NULL, NULL} ;
   TimerData timer_data = NULL ;
+  int zmq_fd = -1 ;
+  size_t sizeof_fd = sizeof(zmq_fd) ;
+
+  if (zmq_getsockopt(zmq_socket, ZMQ_FD, &zmq_fd, &sizeof_fd) == 0)
+    {
+      GSource *source ;
+      ZeroMQSource zmq_source ;
+
+      source = g_source_new(&zmq_source_funcs, sizeof(ZeroMQSourceStruct)) ;
+
+      zmq_source = (ZeroMQSource)source ;
+      zmq_source->zmq_socket = zmq_socket ;
+      zmq_source->poll_fd.fd = zmq_fd ;
+      zmq_source->poll_fd.events = G_IO_IN | G_IO_ERR ;
+      g_source_add_poll(source, &(zmq_source->poll_fd)) ;
+
+      timer_data = g_new0(TimerDataStruct, 1) ;
+      timer_data->remote_control = remote_control ;
+      timer_data->timer_func_cb = timer_func_cb ;
+
+      g_source_set_callback(source, timer_data->timer_func_cb, timer_data, NULL) ;
 
-  timer_data = g_new0(TimerDataStruct, 1) ;
-  timer_data->remote_control = remote_control ;
-  timer_data->timer_func_cb = timer_func_cb ;
-  timer_data->timer_id = g_timeout_add(SOCKET_WATCH_INTERVAL, timer_data->timer_func_cb, timer_data) ;
+      /* The main context holds the only reference so g_source_remove() frees the source. */
+      timer_data->timer_id = g_source_attach(source, NULL) ;
+      g_source_unref(source) ;
+    }
 
   return timer_data ;
 }
 
 
-/* Remove the timer routine that is called to check a zmq socket.
+/* Remove the event source that is called to read a zmq socket.
  *
  *  */
 static gboolean zeroMQSocketUnSetWatch(TimerData timer_data)
@@ -2101,6 +2228,52 @@ static gboolean zeroMQSocketUnSetWatch(TimerData timer_data)
 
 
 
+/* Returns TRUE if there is a message waiting to be read on zmq_socket. If the socket
+ * cannot be queried we also return TRUE so the socket callback gets to report the error. */
+static gboolean zeroMQSocketHasMessage(void *zmq_socket)
+{
+  gboolean result = TRUE ;
+  uint32_t status ;
+  size_t sizeof_status = sizeof(status) ;
+
+  if (zmq_getsockopt(zmq_socket, ZMQ_EVENTS, &status, &sizeof_status) == 0)
+    result = ((status & ZMQ_POLLIN) ? TRUE : FALSE) ;
+
+  return result ;
+}
+
+
+/* GSourceFuncs for the zeromq socket event source. The ZMQ_FD only signals edges so we must
+ * check ZMQ_EVENTS before sleeping in case a message arrived since the last dispatch, and
+ * again after being woken because the fd signalling does not mean a message is waiting. */
+static gboolean zeroMQSourcePrepare(GSource *source, gint *timeout_out)
+{
+  ZeroMQSource zmq_source = (ZeroMQSource)source ;
+
+  *timeout_out = -1 ;
+
+  return zeroMQSocketHasMessage(zmq_source->zmq_socket) ;
+}
+
+static gboolean zeroMQSourceCheck(GSource *source)
+{
+  ZeroMQSource zmq_source = (ZeroMQSource)source ;
+
+  return zeroMQSocketHasMessage(zmq_source->zmq_socket) ;
+}
+
+static gboolean zeroMQSourceDispatch(GSource *source, GSourceFunc callback, gpointer user_data)
+{
+  gboolean result = FALSE ;
+
+  if (callback)
+    result = callback(user_data) ;
+
+  return result ;
+}
+
+
+
 static gboolean zeroMQSocketSendMessage(void *zmq_socket, char *header, char *body, char **err_msg_out)
 {
   gboolean result = FALSE ;
@@ -2601,7 +2774,7 @@ static gboolean createSend(ZMapRemoteControl remote_control, const char *socket_
 
       g_free(err_msg) ;
     }
-  else if (!(timer_data = zeroMQSocketSetWatch(waitForReplyCB, remote_control)))
+  else if (!(timer_data = zeroMQSocketSetWatch(send_socket, waitForReplyCB, remote_control)))
     {
       *err_msg_out = g_strdup_printf("Could not set up waiting for reply on socket \"%s\".", socket_string) ;
     }
@@ -2763,6 +2936,23 @@ static void timeoutGetCurrTimeout(ZMapRemoteControl remote_control, int *timeout
 }
 
 
+/* Returns the number of ms left before the current timeout expires. */
+static guint timeoutGetRemaining(ZMapRemoteControl remote_control)
+{
+  guint remaining_ms = 0 ;
+  double remaining_s ;
+
+  remaining_s = g_array_index(remote_control->timeout_list, double, remote_control->timeout_list_pos)
+    - g_timer_elapsed(remote_control->timeout_timer, NULL) ;
+
+  /* + 1 because timeoutHasTimedOut() requires the elapsed time to exceed the timeout. */
+  if (remaining_s > 0.0)
+    remaining_ms = (guint)(remaining_s * 1000.0) + 1 ;
+
+  return remaining_ms ;
+}
+
+
 /* Creates the header for zeromq messages as a string in the form:
  *
  * "<REQUEST | REPLY> <ID>/<RETRY_NUM> <TIME>"
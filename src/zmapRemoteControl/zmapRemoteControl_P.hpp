@@ -137,18 +137,32 @@ ZMAP_DEFINE_ENUM(RemoteControlRequestType, REQUEST_TYPE_LIST) ;
 
 
 
-/* Data needed by timer functions monitoring request/reply zeromq sockets. */
+/* Data needed by the watch functions monitoring request/reply zeromq sockets. */
 typedef struct TimerDataStructType
 {
   ZMapRemoteControl remote_control ;                        /* Needed for debug messages etc. */
 
-  GSourceFunc timer_func_cb ;                               /* timer callback func. */
-  guint timer_id ;                                          /* timer callback id. */
+  GSourceFunc timer_func_cb ;                               /* socket watch callback func. */
+  guint timer_id ;                                          /* socket watch source id. */
   gboolean remove_timer ;                                   /* If true then timer callback removes itself. */
 
 } TimerDataStruct, *TimerData ;
 
 
+/* A glib event source for a zeromq socket. zeromq gives us a file descriptor (ZMQ_FD) for each
+ * socket that glib can poll but it is edge-triggered and only says the socket state _may_ have
+ * changed so ZMQ_EVENTS has to be checked both before glib sleeps and after it wakes. */
+typedef struct ZeroMQSourceStructType
+{
+  GSource source ;                                          /* Must be first. */
+
+  GPollFD poll_fd ;                                         /* The socket's ZMQ_FD. */
+
+  void *zmq_socket ;
+
+} ZeroMQSourceStruct, *ZeroMQSource ;
+
+
 
 /* This is the message struct that gets queued and dequeued.... */
 typedef struct RemoteZeroMQMessageStructType
@@ -300,6 +314,9 @@ typedef struct ZMapRemoteControlStructType
   GQueue *incoming_replies ;
 
   guint queue_monitor_cb_id ;                               /* queue monitor glib callback id. */
+  gboolean queue_monitor_is_timeout ;                       /* TRUE => queue monitor is waiting
+                                                               for a request timeout, FALSE => it
+                                                               is an idle callback. */
 
 
 
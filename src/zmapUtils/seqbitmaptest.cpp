@@ -0,0 +1,234 @@
+/*  File: seqbitmaptest.cpp
+ *  Author: Roy Storey (rds@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Checks marking regions in a ZMapSeqBitmap and getting
+ *              back the unmarked ones: adjacent and overlapping marks
+ *              must merge, marks are clipped to the bitmap and unmarked
+ *              regions are widened to whole bins. Run by "make check",
+ *              exits with EXIT_FAILURE if any check fails.
+ *
+ * Exported functions: none
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ZMap/zmapSeqBitmap.hpp>
+
+
+
+/* Unmarked regions we expect back. */
+typedef struct
+{
+  int start, end ;
+} ExpectRegionStruct ;
+
+#define EXPECT_NUM(EXPECT) ((int)(sizeof(EXPECT) / sizeof(EXPECT[0])))
+
+
+
+static gboolean checkUnmarked(const char *sTest, ZMapSeqBitmap pBitmap, int iStart, int iEnd,
+                              const ExpectRegionStruct *pExpect, int iNumExpect) ;
+static gboolean checkMarked(const char *sTest, ZMapSeqBitmap pBitmap, int iStart, int iEnd, gboolean bExpect) ;
+
+
+
+int main(int argc, char *argv[])
+{
+  gboolean bResult = TRUE ;
+  ZMapSeqBitmap pBitmap ;
+
+  /* Bins of a single base so regions come back exactly as marked. */
+  pBitmap = zmapSeqBitmapCreate(1, 1000, 1) ;
+
+  {
+    static const ExpectRegionStruct pExpect[] = {{1, 1000}} ;
+
+    bResult &= checkUnmarked("empty", pBitmap, 1, 1000, pExpect, EXPECT_NUM(pExpect)) ;
+    bResult &= checkMarked("empty", pBitmap, 1, 1, FALSE) ;
+  }
+
+  /* Adjacent regions merge into one. */
+  zmapSeqBitmapMarkRegion(pBitmap, 100, 199) ;
+  zmapSeqBitmapMarkRegion(pBitmap, 200, 299) ;
+  {
+    static const ExpectRegionStruct pExpect[] = {{1, 99}, {300, 1000}} ;
+
+    bResult &= checkUnmarked("adjacent", pBitmap, 1, 1000, pExpect, EXPECT_NUM(pExpect)) ;
+    bResult &= checkMarked("adjacent", pBitmap, 100, 299, TRUE) ;
+  }
+
+  /* Overlapping the end, coords given backwards. */
+  zmapSeqBitmapMarkRegion(pBitmap, 400, 250) ;
+  {
+    static const ExpectRegionStruct pExpect[] = {{50, 99}, {401, 450}} ;
+
+    bResult &= checkUnmarked("overlap", pBitmap, 50, 450, pExpect, EXPECT_NUM(pExpect)) ;
+    bResult &= checkMarked("overlap", pBitmap, 100, 400, TRUE) ;
+    bResult &= checkMarked("overlap", pBitmap, 100, 401, FALSE) ;
+  }
+
+  /* A region spanning several others swallows them all. */
+  zmapSeqBitmapMarkRegion(pBitmap, 500, 600) ;
+  zmapSeqBitmapMarkRegion(pBitmap, 700, 800) ;
+  zmapSeqBitmapMarkRegion(pBitmap, 550, 750) ;
+  {
+    static const ExpectRegionStruct pExpect[] = {{401, 499}, {801, 900}} ;
+
+    bResult &= checkUnmarked("spanning", pBitmap, 300, 900, pExpect, EXPECT_NUM(pExpect)) ;
+    bResult &= checkMarked("spanning", pBitmap, 500, 800, TRUE) ;
+  }
+
+  /* Marks are clipped to the bitmap but anything outside it is unmarked. */
+  zmapSeqBitmapMarkRegion(pBitmap, -10, 5) ;
+  zmapSeqBitmapMarkRegion(pBitmap, 990, 2000) ;
+  {
+    static const ExpectRegionStruct pExpect[] = {{-5, 0}, {6, 99}, {401, 499}, {801, 989}, {1001, 1010}} ;
+
+    bResult &= checkUnmarked("clipped", pBitmap, -5, 1010, pExpect, EXPECT_NUM(pExpect)) ;
+    bResult &= checkMarked("clipped", pBitmap, 1, 5, TRUE) ;
+    bResult &= checkMarked("clipped", pBitmap, 990, 1000, TRUE) ;
+  }
+
+  bResult &= checkUnmarked("all marked", pBitmap, 120, 280, NULL, 0) ;
+
+  pBitmap = zmapSeqBitmapDestroy(pBitmap) ;
+
+
+  /* Bins of 100, i.e. 1-100, 101-200 and so on. */
+  pBitmap = zmapSeqBitmapCreate(1, 1000, 100) ;
+
+  /* Unmarked regions are widened to whole bins so a mark that covers part of a bin doesn't
+   * stop that bin coming back. */
+  zmapSeqBitmapMarkRegion(pBitmap, 150, 250) ;
+  {
+    static const ExpectRegionStruct pExpect[] = {{1, 1000}} ;
+
+    bResult &= checkUnmarked("part bins", pBitmap, 1, 1000, pExpect, EXPECT_NUM(pExpect)) ;
+  }
+
+  pBitmap = zmapSeqBitmapDestroy(pBitmap) ;
+
+  pBitmap = zmapSeqBitmapCreate(1, 1000, 100) ;
+
+  zmapSeqBitmapMarkRegion(pBitmap, 101, 350) ;
+  {
+    static const ExpectRegionStruct pExpect[] = {{1, 100}, {301, 1000}} ;
+
+    bResult &= checkUnmarked("whole bins", pBitmap, 1, 1000, pExpect, EXPECT_NUM(pExpect)) ;
+  }
+
+  /* Widening never goes outside the range asked for. */
+  {
+    static const ExpectRegionStruct pExpect[] = {{301, 380}} ;
+
+    bResult &= checkUnmarked("widened clipped", pBitmap, 120, 380, pExpect, EXPECT_NUM(pExpect)) ;
+  }
+
+  bResult &= checkUnmarked("bins marked", pBitmap, 101, 300, NULL, 0) ;
+
+  pBitmap = zmapSeqBitmapDestroy(pBitmap) ;
+
+
+  printf("seqbitmaptest: %s\n", (bResult ? "all checks passed" : "FAILED")) ;
+
+  exit(bResult ? EXIT_SUCCESS : EXIT_FAILURE) ;
+}
+
+
+
+/*
+ *                   Internal routines.
+ */
+
+
+static gboolean checkUnmarked(const char *sTest, ZMapSeqBitmap pBitmap, int iStart, int iEnd,
+                              const ExpectRegionStruct *pExpect, int iNumExpect)
+{
+  gboolean bResult = TRUE ;
+  GList *pRegions, *pList ;
+  int i ;
+
+  pRegions = zmapSeqBitmapGetUnmarkedRegions(pBitmap, iStart, iEnd) ;
+
+  for (pList = pRegions, i = 0 ; bResult && i < iNumExpect ; pList = pList->next, i++)
+    {
+      ZMapSeqBitmapRegion pRegion ;
+
+      if (!pList)
+        {
+          printf("%s: unmarked region %d in %d -> %d should be %d -> %d but is missing\n",
+                 sTest, i, iStart, iEnd, pExpect[i].start, pExpect[i].end) ;
+
+          bResult = FALSE ;
+          break ;
+        }
+
+      pRegion = (ZMapSeqBitmapRegion)(pList->data) ;
+
+      if (pRegion->start != pExpect[i].start || pRegion->end != pExpect[i].end)
+        {
+          printf("%s: unmarked region %d in %d -> %d should be %d -> %d but is %d -> %d\n",
+                 sTest, i, iStart, iEnd, pExpect[i].start, pExpect[i].end, pRegion->start, pRegion->end) ;
+
+          bResult = FALSE ;
+        }
+    }
+
+  if (bResult && pList)
+    {
+      printf("%s: %u unmarked regions in %d -> %d, expected %d\n",
+             sTest, g_list_length(pRegions), iStart, iEnd, iNumExpect) ;
+
+      bResult = FALSE ;
+    }
+
+  if (!bResult)
+    zmapSeqBitmapPrint(pBitmap) ;
+
+  g_list_free_full(pRegions, g_free) ;
+
+  return bResult ;
+}
+
+
+static gboolean checkMarked(const char *sTest, ZMapSeqBitmap pBitmap, int iStart, int iEnd, gboolean bExpect)
+{
+  gboolean bResult = TRUE ;
+
+  if (zmapSeqBitmapIsRegionFullyMarked(pBitmap, iStart, iEnd) != bExpect)
+    {
+      printf("%s: %d -> %d should %sbe fully marked\n", sTest, iStart, iEnd, (bExpect ? "" : "not ")) ;
+
+      zmapSeqBitmapPrint(pBitmap) ;
+
+      bResult = FALSE ;
+    }
+
+  return bResult ;
+}
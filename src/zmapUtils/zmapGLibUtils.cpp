@@ -58,6 +58,32 @@ typedef struct
 }DatalistFirstIDStruct, *DatalistFirstID;
 
 
+/* All the jobs from one call to zMap_g_thread_pool_run(). */
+typedef struct PoolBatchStructType
+{
+  GMutex mutex ;
+  GCond cond ;
+  int n_left ;
+} PoolBatchStruct, *PoolBatch ;
+
+typedef struct PoolJobStructType
+{
+  GFunc func ;
+  gpointer data ;
+  PoolBatch batch ;
+} PoolJobStruct, *PoolJob ;
+
+
+
+/* One pool of worker threads shared by everything that wants to run jobs in parallel, made
+ * the first time it is needed. */
+G_LOCK_DEFINE_STATIC(shared_pool_G) ;
+static GThreadPool *shared_pool_G = NULL ;
+
+/* Set in pool threads so that jobs which themselves run jobs don't wait on the pool. */
+static GPrivate in_pool_thread_G = G_PRIVATE_INIT(NULL) ;
+
+
 
 static inline GQuark g_quark_new(ZMapQuarkSet quark_set, gchar *string_arg) ;
 static void printCB(gpointer data, gpointer user_data) ;
@@ -73,6 +99,9 @@ static void mergehashCB(gpointer key, gpointer value, gpointer user_data) ;
 
 static void insert_after(GList *donor, GList *recipient) ;
 
+static GThreadPool *getSharedPool(const char *what) ;
+static void poolJobCB(gpointer data, gpointer user_data_unused) ;
+
 
 /*
  *                    External routines.
@@ -1104,6 +1133,67 @@ void zMap_g_quark_destroy_set(ZMapQuarkSet quark_set)
 
 
 
+
+/*
+ * Run job_func on the data of each element of jobs using the shared thread pool and wait for
+ * them all to finish, jobs must only touch their own data. If there is only one job, or the
+ * pool can't be made, or we are already in a pool thread, the jobs are run here in turn.
+ * what is used to say what failed in the log.
+ */
+void zMap_g_thread_pool_run(GList *jobs, GFunc job_func, const char *what)
+{
+  GThreadPool *pool = NULL ;
+  int n_jobs ;
+
+  if (!(n_jobs = g_list_length(jobs)))
+    return ;
+
+  if (n_jobs > 1 && !g_private_get(&in_pool_thread_G))
+    pool = getSharedPool(what) ;
+
+  if (!pool)
+    {
+      g_list_foreach(jobs, job_func, NULL) ;
+    }
+  else
+    {
+      PoolBatchStruct batch ;
+      PoolJob pool_jobs ;
+      GList *l ;
+      int i ;
+
+      g_mutex_init(&batch.mutex) ;
+      g_cond_init(&batch.cond) ;
+      batch.n_left = n_jobs ;
+
+      pool_jobs = g_new0(PoolJobStruct, n_jobs) ;
+
+      for (l = jobs, i = 0 ; l ; l = l->next, i++)
+        {
+          pool_jobs[i].func = job_func ;
+          pool_jobs[i].data = l->data ;
+          pool_jobs[i].batch = &batch ;
+
+          g_thread_pool_push(pool, &pool_jobs[i], NULL) ;
+        }
+
+      g_mutex_lock(&batch.mutex) ;
+
+      while (batch.n_left > 0)
+        g_cond_wait(&batch.cond, &batch.mutex) ;
+
+      g_mutex_unlock(&batch.mutex) ;
+
+      g_free(pool_jobs) ;
+
+      g_cond_clear(&batch.cond) ;
+      g_mutex_clear(&batch.mutex) ;
+    }
+
+  return ;
+}
+
+
 /*
  *                 Internal functions.
  */
@@ -1324,7 +1414,47 @@ static void mergehashCB(gpointer key, gpointer value, gpointer user_data)
 
 
 
+/* Returns the shared pool, making it if needed, or NULL if it can't be made. */
+static GThreadPool *getSharedPool(const char *what)
+{
+  GThreadPool *pool ;
+  GError *error = NULL ;
+
+  G_LOCK(shared_pool_G) ;
+
+  if (!shared_pool_G)
+    {
+      if (!(shared_pool_G = g_thread_pool_new(poolJobCB, NULL, (int)g_get_num_processors(), FALSE, &error)))
+        {
+          zMapLogWarning("Could not create thread pool to %s: %s", what, error->message) ;
+          g_error_free(error) ;
+        }
+    }
+
+  pool = shared_pool_G ;
+
+  G_UNLOCK(shared_pool_G) ;
+
+  return pool ;
+}
+
+
+/* Runs in a pool thread. */
+static void poolJobCB(gpointer data, gpointer user_data_unused)
+{
+  PoolJob job = (PoolJob)data ;
+  PoolBatch batch = job->batch ;
+
+  g_private_set(&in_pool_thread_G, GINT_TO_POINTER(TRUE)) ;
 
+  job->func(job->data, NULL) ;
 
+  g_mutex_lock(&batch->mutex) ;
 
+  if (--(batch->n_left) == 0)
+    g_cond_signal(&batch->cond) ;
 
+  g_mutex_unlock(&batch->mutex) ;
+
+  return ;
+}
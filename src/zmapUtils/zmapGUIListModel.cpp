@@ -0,0 +1,976 @@
+/*  File: zmapGUIListModel.cpp
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Lazy list-only GtkTreeModel, see zmapGUIListModel.hpp.
+ *
+ *              Rows are held twice: "rows" is every row in append
+ *              order and owns the row structs, "order" is the rows
+ *              in display order. Each row knows its index in "order"
+ *              so paths and iters are O(1) both ways.
+ *
+ * Exported functions: See ZMap/zmapGUIListModel.hpp
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <string.h>
+#include <ZMap/zmapUtils.hpp>
+#include <ZMap/zmapGUIListModel.hpp>
+
+
+
+typedef struct ListModelRowStructType
+{
+  gpointer data ;
+  int number ;                                              /* 1 based append order. */
+  int position ;                                            /* index in order, -1 if not in it. */
+} ListModelRowStruct, *ListModelRow ;
+
+typedef struct
+{
+  GtkTreeIterCompareFunc func ;
+  gpointer data ;
+  GDestroyNotify destroy ;
+} ListModelSortFuncStruct, *ListModelSortFunc ;
+
+/* Sort keys are fetched once per row per sort, not once per comparison. */
+typedef struct
+{
+  ListModelRow row ;
+  GValue value ;
+  char *collate_key ;
+} ListModelSortKeyStruct, *ListModelSortKey ;
+
+typedef struct
+{
+  ZMapGUIListModel list_model ;
+  ListModelSortFunc sort_func ;
+} ListModelSortDataStruct, *ListModelSortData ;
+
+
+typedef struct _zmapGUIListModelStruct
+{
+  GObject __parent__ ;
+
+  int stamp ;
+
+  int n_columns ;
+  GType *column_types ;
+
+  ZMapGUIListModelValueFunc value_func ;
+  gpointer value_data ;
+  GDestroyNotify row_data_destroy ;
+
+  GPtrArray *rows ;                                         /* all rows, append order, owned. */
+  GPtrArray *order ;                                        /* all rows, display order. */
+  int row_counter ;
+
+  int sort_column_id ;
+  GtkSortType sort_order ;
+  ListModelSortFuncStruct *sort_funcs ;                     /* one per column. */
+  ListModelSortFuncStruct default_sort ;
+} zmapGUIListModelStruct ;
+
+typedef struct _zmapGUIListModelClassStruct
+{
+  GObjectClass __parent__ ;
+} zmapGUIListModelClassStruct, *ZMapGUIListModelClass ;
+
+
+
+static void zmap_guilistmodel_class_init(ZMapGUIListModelClass list_class) ;
+static void zmap_guilistmodel_init(ZMapGUIListModel list_model) ;
+static void zmap_guilistmodel_finalize(GObject *object) ;
+static void zmap_guilistmodel_tree_model_init(GtkTreeModelIface *iface) ;
+static void zmap_guilistmodel_sortable_init(GtkTreeSortableIface *iface) ;
+
+static GtkTreeModelFlags list_get_flags(GtkTreeModel *tree_model) ;
+static gint list_get_n_columns(GtkTreeModel *tree_model) ;
+static GType list_get_column_type(GtkTreeModel *tree_model, gint index) ;
+static gboolean list_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path) ;
+static GtkTreePath *list_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter) ;
+static void list_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter, gint column, GValue *value) ;
+static gboolean list_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter) ;
+static gboolean list_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent) ;
+static gboolean list_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter) ;
+static gint list_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter) ;
+static gboolean list_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                    GtkTreeIter *parent, gint n) ;
+static gboolean list_iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child) ;
+
+static gboolean list_get_sort_column_id(GtkTreeSortable *sortable, gint *sort_column_id, GtkSortType *order) ;
+static void list_set_sort_column_id(GtkTreeSortable *sortable, gint sort_column_id, GtkSortType order) ;
+static void list_set_sort_func(GtkTreeSortable *sortable, gint sort_column_id,
+                               GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy) ;
+static void list_set_default_sort_func(GtkTreeSortable *sortable,
+                                       GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy) ;
+static gboolean list_has_default_sort_func(GtkTreeSortable *sortable) ;
+
+static void setIter(ZMapGUIListModel list_model, GtkTreeIter *iter, ListModelRow row) ;
+static ListModelRow getIterRow(ZMapGUIListModel list_model, GtkTreeIter *iter) ;
+static void fetchValue(ZMapGUIListModel list_model, ListModelRow row, int column, GValue *value) ;
+static gboolean isSorted(ZMapGUIListModel list_model) ;
+static ListModelSortFunc getSortFunc(ZMapGUIListModel list_model) ;
+static int compareValues(GValue *a, GValue *b) ;
+static int compareRows(ZMapGUIListModel list_model, ListModelRow a, ListModelRow b) ;
+static gint compareKeysCB(gconstpointer a, gconstpointer b, gpointer user_data) ;
+static gint compareFuncCB(gconstpointer a, gconstpointer b, gpointer user_data) ;
+static void resort(ZMapGUIListModel list_model) ;
+static ListModelRow createRow(ZMapGUIListModel list_model, gpointer row_data) ;
+static void insertRow(ZMapGUIListModel list_model, ListModelRow row) ;
+static void removeRow(ZMapGUIListModel list_model, ListModelRow row) ;
+static void renumber(ZMapGUIListModel list_model, int from) ;
+static void freeRow(ZMapGUIListModel list_model, ListModelRow row) ;
+
+
+
+/*
+ *                     External routines
+ */
+
+GType zMapGUIListModelGetType(void)
+{
+  static GType type = 0 ;
+
+  if (type == 0)
+    {
+      static const GTypeInfo info =
+        {
+          sizeof(zmapGUIListModelClassStruct),
+          (GBaseInitFunc) NULL,
+          (GBaseFinalizeFunc) NULL,
+          (GClassInitFunc) zmap_guilistmodel_class_init,
+          (GClassFinalizeFunc) NULL,
+          NULL /* class_data */,
+          sizeof(zmapGUIListModelStruct),
+          0 /* n_preallocs */,
+          (GInstanceInitFunc) zmap_guilistmodel_init,
+          NULL
+        } ;
+      static const GInterfaceInfo tree_model_info =
+        {
+          (GInterfaceInitFunc) zmap_guilistmodel_tree_model_init, NULL, NULL
+        } ;
+      static const GInterfaceInfo sortable_info =
+        {
+          (GInterfaceInitFunc) zmap_guilistmodel_sortable_init, NULL, NULL
+        } ;
+
+      type = g_type_register_static(G_TYPE_OBJECT, "ZMapGUIListModel", &info, (GTypeFlags)0) ;
+
+      g_type_add_interface_static(type, GTK_TYPE_TREE_MODEL, &tree_model_info) ;
+      g_type_add_interface_static(type, GTK_TYPE_TREE_SORTABLE, &sortable_info) ;
+    }
+
+  return type ;
+}
+
+
+ZMapGUIListModel zMapGUIListModelCreate(int n_columns, GType *column_types,
+                                        ZMapGUIListModelValueFunc value_func, gpointer value_data,
+                                        GDestroyNotify row_data_destroy)
+{
+  ZMapGUIListModel list_model = NULL ;
+
+  zMapReturnValIfFail(n_columns > 0 && column_types && value_func, list_model) ;
+
+  list_model = (ZMapGUIListModel)g_object_new(zMapGUIListModelGetType(), NULL) ;
+
+  list_model->n_columns = n_columns ;
+  list_model->column_types = (GType *)g_memdup(column_types, n_columns * sizeof(GType)) ;
+  list_model->sort_funcs = g_new0(ListModelSortFuncStruct, n_columns) ;
+
+  list_model->value_func = value_func ;
+  list_model->value_data = value_data ;
+  list_model->row_data_destroy = row_data_destroy ;
+
+  return list_model ;
+}
+
+
+/* Add a row, it goes at the end unless the model is sorted in which case it is inserted in
+ * order. Use zMapGUIListModelAppendRows() for more than a few rows. */
+void zMapGUIListModelAppend(ZMapGUIListModel list_model, gpointer row_data, GtkTreeIter *iter_out)
+{
+  ListModelRow row ;
+
+  zMapReturnIfFail(ZMAP_IS_GUILISTMODEL(list_model)) ;
+
+  row = createRow(list_model, row_data) ;
+
+  insertRow(list_model, row) ;
+
+  if (iter_out)
+    setIter(list_model, iter_out, row) ;
+
+  return ;
+}
+
+
+/* Add a row for each of row_data_list, they go on the end and are renumbered once and then
+ * if the model is sorted the whole lot is sorted once. */
+void zMapGUIListModelAppendRows(ZMapGUIListModel list_model, GList *row_data_list)
+{
+  GPtrArray *order ;
+  int first ;
+  GList *l ;
+  int i ;
+
+  zMapReturnIfFail(ZMAP_IS_GUILISTMODEL(list_model)) ;
+
+  order = list_model->order ;
+  first = (int)order->len ;
+
+  for (l = row_data_list ; l ; l = l->next)
+    g_ptr_array_add(order, createRow(list_model, l->data)) ;
+
+  renumber(list_model, first) ;
+
+  for (i = first ; i < (int)order->len ; i++)
+    {
+      GtkTreePath *path ;
+      GtkTreeIter iter ;
+
+      setIter(list_model, &iter, (ListModelRow)g_ptr_array_index(order, i)) ;
+      path = gtk_tree_path_new_from_indices(i, -1) ;
+      gtk_tree_model_row_inserted(GTK_TREE_MODEL(list_model), path, &iter) ;
+      gtk_tree_path_free(path) ;
+    }
+
+  if ((int)order->len > first)
+    resort(list_model) ;
+
+  return ;
+}
+
+
+/* Replace the data for a row, the old data is passed to the row_data_destroy func. */
+void zMapGUIListModelSetRowData(ZMapGUIListModel list_model, GtkTreeIter *iter, gpointer row_data)
+{
+  ListModelRow row ;
+  GtkTreePath *path ;
+
+  zMapReturnIfFail(ZMAP_IS_GUILISTMODEL(list_model)) ;
+
+  if ((row = getIterRow(list_model, iter)))
+    {
+      if (row->data != row_data && list_model->row_data_destroy && row->data)
+        (list_model->row_data_destroy)(row->data) ;
+
+      row->data = row_data ;
+
+      path = gtk_tree_path_new_from_indices(row->position, -1) ;
+      gtk_tree_model_row_changed(GTK_TREE_MODEL(list_model), path, iter) ;
+      gtk_tree_path_free(path) ;
+    }
+
+  return ;
+}
+
+
+gpointer zMapGUIListModelGetRowData(ZMapGUIListModel list_model, GtkTreeIter *iter)
+{
+  gpointer row_data = NULL ;
+  ListModelRow row ;
+
+  zMapReturnValIfFail(ZMAP_IS_GUILISTMODEL(list_model), row_data) ;
+
+  if ((row = getIterRow(list_model, iter)))
+    row_data = row->data ;
+
+  return row_data ;
+}
+
+
+void zMapGUIListModelRemove(ZMapGUIListModel list_model, GtkTreeIter *iter)
+{
+  ListModelRow row ;
+
+  zMapReturnIfFail(ZMAP_IS_GUILISTMODEL(list_model)) ;
+
+  if ((row = getIterRow(list_model, iter)))
+    {
+      removeRow(list_model, row) ;
+
+      g_ptr_array_remove(list_model->rows, row) ;
+
+      freeRow(list_model, row) ;
+    }
+
+  return ;
+}
+
+
+void zMapGUIListModelClear(ZMapGUIListModel list_model)
+{
+  int i ;
+
+  zMapReturnIfFail(ZMAP_IS_GUILISTMODEL(list_model)) ;
+
+  /* From the end so each row-deleted is a simple truncation for the view. */
+  while (list_model->order->len)
+    removeRow(list_model, (ListModelRow)g_ptr_array_index(list_model->order, list_model->order->len - 1)) ;
+
+  for (i = 0 ; i < (int)list_model->rows->len ; i++)
+    freeRow(list_model, (ListModelRow)g_ptr_array_index(list_model->rows, i)) ;
+
+  g_ptr_array_set_size(list_model->rows, 0) ;
+  list_model->row_counter = 0 ;
+
+  return ;
+}
+
+
+
+/*
+ *                     Internal routines
+ */
+
+static void zmap_guilistmodel_class_init(ZMapGUIListModelClass list_class)
+{
+  GObjectClass *gobject_class = (GObjectClass *)list_class ;
+
+  gobject_class->finalize = zmap_guilistmodel_finalize ;
+
+  return ;
+}
+
+static void zmap_guilistmodel_init(ZMapGUIListModel list_model)
+{
+  list_model->stamp = g_random_int() ;
+  list_model->rows = g_ptr_array_new() ;
+  list_model->order = g_ptr_array_new() ;
+  list_model->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID ;
+  list_model->sort_order = GTK_SORT_ASCENDING ;
+
+  return ;
+}
+
+static void zmap_guilistmodel_finalize(GObject *object)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(object) ;
+  GObjectClass *parent_class ;
+  int i ;
+
+  for (i = 0 ; i < (int)list_model->rows->len ; i++)
+    freeRow(list_model, (ListModelRow)g_ptr_array_index(list_model->rows, i)) ;
+
+  g_ptr_array_free(list_model->rows, TRUE) ;
+  g_ptr_array_free(list_model->order, TRUE) ;
+
+  for (i = 0 ; i < list_model->n_columns ; i++)
+    {
+      if (list_model->sort_funcs[i].destroy)
+        (list_model->sort_funcs[i].destroy)(list_model->sort_funcs[i].data) ;
+    }
+
+  if (list_model->default_sort.destroy)
+    (list_model->default_sort.destroy)(list_model->default_sort.data) ;
+
+  g_free(list_model->sort_funcs) ;
+  g_free(list_model->column_types) ;
+
+  parent_class = G_OBJECT_CLASS(g_type_class_peek_parent(G_OBJECT_GET_CLASS(object))) ;
+
+  if (parent_class->finalize)
+    (parent_class->finalize)(object) ;
+
+  return ;
+}
+
+static void zmap_guilistmodel_tree_model_init(GtkTreeModelIface *iface)
+{
+  iface->get_flags       = list_get_flags ;
+  iface->get_n_columns   = list_get_n_columns ;
+  iface->get_column_type = list_get_column_type ;
+  iface->get_iter        = list_get_iter ;
+  iface->get_path        = list_get_path ;
+  iface->get_value       = list_get_value ;
+  iface->iter_next       = list_iter_next ;
+  iface->iter_children   = list_iter_children ;
+  iface->iter_has_child  = list_iter_has_child ;
+  iface->iter_n_children = list_iter_n_children ;
+  iface->iter_nth_child  = list_iter_nth_child ;
+  iface->iter_parent     = list_iter_parent ;
+
+  return ;
+}
+
+static void zmap_guilistmodel_sortable_init(GtkTreeSortableIface *iface)
+{
+  iface->get_sort_column_id    = list_get_sort_column_id ;
+  iface->set_sort_column_id    = list_set_sort_column_id ;
+  iface->set_sort_func         = list_set_sort_func ;
+  iface->set_default_sort_func = list_set_default_sort_func ;
+  iface->has_default_sort_func = list_has_default_sort_func ;
+
+  return ;
+}
+
+
+/* GtkTreeModel interface. */
+
+static GtkTreeModelFlags list_get_flags(GtkTreeModel *tree_model)
+{
+  return (GtkTreeModelFlags)(GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST) ;
+}
+
+static gint list_get_n_columns(GtkTreeModel *tree_model)
+{
+  return ZMAP_GUILISTMODEL(tree_model)->n_columns ;
+}
+
+static GType list_get_column_type(GtkTreeModel *tree_model, gint index)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  GType type = G_TYPE_INVALID ;
+
+  zMapReturnValIfFail(index >= 0 && index < list_model->n_columns, type) ;
+
+  type = list_model->column_types[index] ;
+
+  return type ;
+}
+
+static gboolean list_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  gboolean result = FALSE ;
+  int index ;
+
+  if (gtk_tree_path_get_depth(path) == 1
+      && (index = gtk_tree_path_get_indices(path)[0]) >= 0
+      && index < (int)list_model->order->len)
+    {
+      setIter(list_model, iter, (ListModelRow)g_ptr_array_index(list_model->order, index)) ;
+      result = TRUE ;
+    }
+
+  return result ;
+}
+
+static GtkTreePath *list_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  GtkTreePath *path = NULL ;
+  ListModelRow row ;
+
+  if ((row = getIterRow(list_model, iter)) && row->position >= 0)
+    path = gtk_tree_path_new_from_indices(row->position, -1) ;
+
+  return path ;
+}
+
+static void list_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter, gint column, GValue *value)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  ListModelRow row ;
+
+  zMapReturnIfFail(column >= 0 && column < list_model->n_columns) ;
+
+  g_value_init(value, list_model->column_types[column]) ;
+
+  if ((row = getIterRow(list_model, iter)))
+    (list_model->value_func)(value, column, row->data, row->number, list_model->value_data) ;
+
+  return ;
+}
+
+static gboolean list_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  gboolean result = FALSE ;
+  ListModelRow row ;
+
+  if ((row = getIterRow(list_model, iter))
+      && row->position >= 0
+      && row->position + 1 < (int)list_model->order->len)
+    {
+      setIter(list_model, iter, (ListModelRow)g_ptr_array_index(list_model->order, row->position + 1)) ;
+      result = TRUE ;
+    }
+  else
+    {
+      iter->stamp = 0 ;
+    }
+
+  return result ;
+}
+
+static gboolean list_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+  return list_iter_nth_child(tree_model, iter, parent, 0) ;
+}
+
+static gboolean list_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+  return FALSE ;
+}
+
+static gint list_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  gint n_children = 0 ;
+
+  if (!iter)
+    n_children = (gint)list_model->order->len ;
+
+  return n_children ;
+}
+
+static gboolean list_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                    GtkTreeIter *parent, gint n)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(tree_model) ;
+  gboolean result = FALSE ;
+
+  if (!parent && n >= 0 && n < (int)list_model->order->len)
+    {
+      setIter(list_model, iter, (ListModelRow)g_ptr_array_index(list_model->order, n)) ;
+      result = TRUE ;
+    }
+
+  return result ;
+}
+
+static gboolean list_iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child)
+{
+  return FALSE ;
+}
+
+
+/* GtkTreeSortable interface. */
+
+static gboolean list_get_sort_column_id(GtkTreeSortable *sortable, gint *sort_column_id, GtkSortType *order)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(sortable) ;
+
+  if (sort_column_id)
+    *sort_column_id = list_model->sort_column_id ;
+  if (order)
+    *order = list_model->sort_order ;
+
+  return (list_model->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID
+          && list_model->sort_column_id != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID) ;
+}
+
+static void list_set_sort_column_id(GtkTreeSortable *sortable, gint sort_column_id, GtkSortType order)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(sortable) ;
+
+  zMapReturnIfFail(sort_column_id == GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID
+                   || sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID
+                   || (sort_column_id >= 0 && sort_column_id < list_model->n_columns)) ;
+
+  if (list_model->sort_column_id == sort_column_id && list_model->sort_order == order)
+    return ;
+
+  list_model->sort_column_id = sort_column_id ;
+  list_model->sort_order = order ;
+
+  gtk_tree_sortable_sort_column_changed(sortable) ;
+
+  resort(list_model) ;
+
+  return ;
+}
+
+static void list_set_sort_func(GtkTreeSortable *sortable, gint sort_column_id,
+                               GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(sortable) ;
+  ListModelSortFunc sort_func ;
+
+  zMapReturnIfFail(sort_column_id >= 0 && sort_column_id < list_model->n_columns) ;
+
+  sort_func = &(list_model->sort_funcs[sort_column_id]) ;
+
+  if (sort_func->destroy)
+    (sort_func->destroy)(sort_func->data) ;
+
+  sort_func->func = func ;
+  sort_func->data = data ;
+  sort_func->destroy = destroy ;
+
+  if (list_model->sort_column_id == sort_column_id)
+    resort(list_model) ;
+
+  return ;
+}
+
+static void list_set_default_sort_func(GtkTreeSortable *sortable,
+                                       GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+  ZMapGUIListModel list_model = ZMAP_GUILISTMODEL(sortable) ;
+
+  if (list_model->default_sort.destroy)
+    (list_model->default_sort.destroy)(list_model->default_sort.data) ;
+
+  list_model->default_sort.func = func ;
+  list_model->default_sort.data = data ;
+  list_model->default_sort.destroy = destroy ;
+
+  if (list_model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    resort(list_model) ;
+
+  return ;
+}
+
+static gboolean list_has_default_sort_func(GtkTreeSortable *sortable)
+{
+  return (ZMAP_GUILISTMODEL(sortable)->default_sort.func != NULL) ;
+}
+
+
+/* Row and sort handling. */
+
+static void setIter(ZMapGUIListModel list_model, GtkTreeIter *iter, ListModelRow row)
+{
+  iter->stamp = list_model->stamp ;
+  iter->user_data = row ;
+  iter->user_data2 = NULL ;
+  iter->user_data3 = NULL ;
+
+  return ;
+}
+
+static ListModelRow getIterRow(ZMapGUIListModel list_model, GtkTreeIter *iter)
+{
+  ListModelRow row = NULL ;
+
+  if (iter && iter->stamp == list_model->stamp)
+    row = (ListModelRow)(iter->user_data) ;
+
+  return row ;
+}
+
+static void fetchValue(ZMapGUIListModel list_model, ListModelRow row, int column, GValue *value)
+{
+  g_value_init(value, list_model->column_types[column]) ;
+
+  (list_model->value_func)(value, column, row->data, row->number, list_model->value_data) ;
+
+  return ;
+}
+
+/* Unsorted, or "default" with no default func, both mean leave the order alone. */
+static gboolean isSorted(ZMapGUIListModel list_model)
+{
+  gboolean sorted = FALSE ;
+
+  if (list_model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    sorted = (list_model->default_sort.func != NULL) ;
+  else if (list_model->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+    sorted = TRUE ;
+
+  return sorted ;
+}
+
+static ListModelSortFunc getSortFunc(ZMapGUIListModel list_model)
+{
+  ListModelSortFunc sort_func = NULL ;
+
+  if (list_model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    sort_func = &(list_model->default_sort) ;
+  else if (list_model->sort_column_id >= 0 && list_model->sort_funcs[list_model->sort_column_id].func)
+    sort_func = &(list_model->sort_funcs[list_model->sort_column_id]) ;
+
+  return sort_func ;
+}
+
+/* Compares the value types the feature lists actually use, anything else compares equal. */
+static int compareValues(GValue *a, GValue *b)
+{
+  int result = 0 ;
+
+  switch (G_TYPE_FUNDAMENTAL(G_VALUE_TYPE(a)))
+    {
+    case G_TYPE_INT:
+      result = (g_value_get_int(a) < g_value_get_int(b) ? -1 : (g_value_get_int(a) > g_value_get_int(b) ? 1 : 0)) ;
+      break ;
+    case G_TYPE_UINT:
+      result = (g_value_get_uint(a) < g_value_get_uint(b) ? -1 : (g_value_get_uint(a) > g_value_get_uint(b) ? 1 : 0)) ;
+      break ;
+    case G_TYPE_BOOLEAN:
+      result = (int)(g_value_get_boolean(a) != FALSE) - (int)(g_value_get_boolean(b) != FALSE) ;
+      break ;
+    case G_TYPE_FLOAT:
+      result = (g_value_get_float(a) < g_value_get_float(b) ? -1 : (g_value_get_float(a) > g_value_get_float(b) ? 1 : 0)) ;
+      break ;
+    case G_TYPE_DOUBLE:
+      result = (g_value_get_double(a) < g_value_get_double(b) ? -1 : (g_value_get_double(a) > g_value_get_double(b) ? 1 : 0)) ;
+      break ;
+    case G_TYPE_STRING:
+      {
+        const char *str_a = g_value_get_string(a), *str_b = g_value_get_string(b) ;
+
+        if (!str_a || !str_b)
+          result = (str_a ? 1 : (str_b ? -1 : 0)) ;
+        else
+          result = g_utf8_collate(str_a, str_b) ;
+        break ;
+      }
+    default:
+      break ;
+    }
+
+  return result ;
+}
+
+/* Used for single inserts where building keys for every row would be a waste. */
+static int compareRows(ZMapGUIListModel list_model, ListModelRow a, ListModelRow b)
+{
+  ListModelSortFunc sort_func ;
+  int result = 0 ;
+
+  if ((sort_func = getSortFunc(list_model)))
+    {
+      GtkTreeIter iter_a, iter_b ;
+
+      setIter(list_model, &iter_a, a) ;
+      setIter(list_model, &iter_b, b) ;
+
+      result = (sort_func->func)(GTK_TREE_MODEL(list_model), &iter_a, &iter_b, sort_func->data) ;
+    }
+  else if (list_model->sort_column_id >= 0)
+    {
+      GValue value_a = {0}, value_b = {0} ;
+
+      fetchValue(list_model, a, list_model->sort_column_id, &value_a) ;
+      fetchValue(list_model, b, list_model->sort_column_id, &value_b) ;
+
+      result = compareValues(&value_a, &value_b) ;
+
+      g_value_unset(&value_a) ;
+      g_value_unset(&value_b) ;
+    }
+
+  if (list_model->sort_order == GTK_SORT_DESCENDING)
+    result = -result ;
+
+  return result ;
+}
+
+static gint compareKeysCB(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  ZMapGUIListModel list_model = (ZMapGUIListModel)user_data ;
+  ListModelSortKey key_a = (ListModelSortKey)a, key_b = (ListModelSortKey)b ;
+  int result ;
+
+  if (key_a->collate_key && key_b->collate_key)
+    result = strcmp(key_a->collate_key, key_b->collate_key) ;
+  else
+    result = compareValues(&(key_a->value), &(key_b->value)) ;
+
+  if (list_model->sort_order == GTK_SORT_DESCENDING)
+    result = -result ;
+
+  /* Keep equal rows in append order whichever way we sort. */
+  if (!result)
+    result = key_a->row->number - key_b->row->number ;
+
+  return result ;
+}
+
+static gint compareFuncCB(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  ListModelSortData sort_data = (ListModelSortData)user_data ;
+  ListModelSortKey key_a = (ListModelSortKey)a, key_b = (ListModelSortKey)b ;
+  GtkTreeIter iter_a, iter_b ;
+  int result ;
+
+  setIter(sort_data->list_model, &iter_a, key_a->row) ;
+  setIter(sort_data->list_model, &iter_b, key_b->row) ;
+
+  result = (sort_data->sort_func->func)(GTK_TREE_MODEL(sort_data->list_model), &iter_a, &iter_b,
+                                        sort_data->sort_func->data) ;
+
+  if (sort_data->list_model->sort_order == GTK_SORT_DESCENDING)
+    result = -result ;
+
+  if (!result)
+    result = key_a->row->number - key_b->row->number ;
+
+  return result ;
+}
+
+/* Sort the rows, fetching the sort column once per row rather than on every
+ * comparison, then tell the view how the rows moved. */
+static void resort(ZMapGUIListModel list_model)
+{
+  ListModelSortKey keys ;
+  ListModelSortFunc sort_func ;
+  int n_rows, i ;
+  gint *new_order ;
+  GtkTreePath *path ;
+
+  if (!isSorted(list_model) || (n_rows = (int)list_model->order->len) < 2)
+    return ;
+
+  keys = g_new0(ListModelSortKeyStruct, n_rows) ;
+  sort_func = getSortFunc(list_model) ;
+
+  for (i = 0 ; i < n_rows ; i++)
+    {
+      keys[i].row = (ListModelRow)g_ptr_array_index(list_model->order, i) ;
+
+      if (!sort_func)
+        {
+          fetchValue(list_model, keys[i].row, list_model->sort_column_id, &(keys[i].value)) ;
+
+          if (G_VALUE_HOLDS_STRING(&(keys[i].value)) && g_value_get_string(&(keys[i].value)))
+            keys[i].collate_key = g_utf8_collate_key(g_value_get_string(&(keys[i].value)), -1) ;
+        }
+    }
+
+  if (sort_func)
+    {
+      ListModelSortDataStruct sort_data = {list_model, sort_func} ;
+
+      g_qsort_with_data(keys, n_rows, sizeof(ListModelSortKeyStruct), compareFuncCB, &sort_data) ;
+    }
+  else
+    {
+      g_qsort_with_data(keys, n_rows, sizeof(ListModelSortKeyStruct), compareKeysCB, list_model) ;
+    }
+
+  new_order = g_new(gint, n_rows) ;
+
+  for (i = 0 ; i < n_rows ; i++)
+    {
+      new_order[i] = keys[i].row->position ;
+
+      keys[i].row->position = i ;
+      g_ptr_array_index(list_model->order, i) = keys[i].row ;
+
+      if (G_IS_VALUE(&(keys[i].value)))
+        g_value_unset(&(keys[i].value)) ;
+      g_free(keys[i].collate_key) ;
+    }
+
+  path = gtk_tree_path_new() ;
+  gtk_tree_model_rows_reordered(GTK_TREE_MODEL(list_model), path, NULL, new_order) ;
+  gtk_tree_path_free(path) ;
+
+  g_free(new_order) ;
+  g_free(keys) ;
+
+  return ;
+}
+
+static ListModelRow createRow(ZMapGUIListModel list_model, gpointer row_data)
+{
+  ListModelRow row ;
+
+  row = g_slice_new0(ListModelRowStruct) ;
+  row->data = row_data ;
+  row->number = ++(list_model->row_counter) ;
+  row->position = -1 ;
+
+  g_ptr_array_add(list_model->rows, row) ;
+
+  return row ;
+}
+
+/* Put row into the display order, binary searching for its place if we are sorted. */
+static void insertRow(ZMapGUIListModel list_model, ListModelRow row)
+{
+  GPtrArray *order = list_model->order ;
+  int position = (int)order->len ;
+  GtkTreePath *path ;
+  GtkTreeIter iter ;
+
+  if (isSorted(list_model))
+    {
+      int lo = 0, hi = (int)order->len ;
+
+      while (lo < hi)
+        {
+          int mid = lo + (hi - lo) / 2 ;
+
+          if (compareRows(list_model, (ListModelRow)g_ptr_array_index(order, mid), row) <= 0)
+            lo = mid + 1 ;
+          else
+            hi = mid ;
+        }
+
+      position = lo ;
+    }
+
+  g_ptr_array_add(order, NULL) ;
+
+  if (position < (int)order->len - 1)
+    memmove(&(order->pdata[position + 1]), &(order->pdata[position]),
+            (order->len - 1 - position) * sizeof(gpointer)) ;
+
+  order->pdata[position] = row ;
+  renumber(list_model, position) ;
+
+  setIter(list_model, &iter, row) ;
+  path = gtk_tree_path_new_from_indices(position, -1) ;
+  gtk_tree_model_row_inserted(GTK_TREE_MODEL(list_model), path, &iter) ;
+  gtk_tree_path_free(path) ;
+
+  return ;
+}
+
+static void removeRow(ZMapGUIListModel list_model, ListModelRow row)
+{
+  int position ;
+  GtkTreePath *path ;
+
+  if ((position = row->position) < 0)
+    return ;
+
+  g_ptr_array_remove_index(list_model->order, position) ;
+  row->position = -1 ;
+  renumber(list_model, position) ;
+
+  path = gtk_tree_path_new_from_indices(position, -1) ;
+  gtk_tree_model_row_deleted(GTK_TREE_MODEL(list_model), path) ;
+  gtk_tree_path_free(path) ;
+
+  return ;
+}
+
+static void renumber(ZMapGUIListModel list_model, int from)
+{
+  int i ;
+
+  for (i = from ; i < (int)list_model->order->len ; i++)
+    ((ListModelRow)g_ptr_array_index(list_model->order, i))->position = i ;
+
+  return ;
+}
+
+static void freeRow(ZMapGUIListModel list_model, ListModelRow row)
+{
+  if (list_model->row_data_destroy && row->data)
+    (list_model->row_data_destroy)(row->data) ;
+
+  g_slice_free(ListModelRowStruct, row) ;
+
+  return ;
+}
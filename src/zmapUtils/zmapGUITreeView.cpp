@@ -35,6 +35,7 @@
 #include <ZMap/zmapBase.hpp>
 #include <ZMap/zmapUtils.hpp>
 #include <ZMap/zmapUtilsGUI.hpp>
+#include <ZMap/zmapGUIListModel.hpp>
 #include <zmapGUITreeView_I.hpp>
 
 enum
@@ -43,6 +44,8 @@ enum
 
     ZMAP_GUITV_ROW_COUNTER_COLUMN, /* must be first in variadic args... if present ...*/
     ZMAP_GUITV_DATA_PTR_COLUMN, /* must be first in variadic args... if present ...*/
+    ZMAP_GUITV_LAZY_MODEL,      /* must be before column count... if present ...*/
+    ZMAP_GUITV_ROW_DATA_DESTROY,
     ZMAP_GUITV_COLUMN_COUNT, /* otherwise this must be first in variadic args... */
 
     /* specified as blocks */
@@ -126,6 +129,9 @@ static void tuple_no_to_model     (GValue *value, gpointer user_data);
 static void tuple_pointer_to_model(GValue *value, gpointer user_data);
 static GtkTreeView  *createView (ZMapGUITreeView zmap_tv);
 static GtkTreeModel *createModel(ZMapGUITreeView zmap_tv);
+static void lazy_model_value_cb(GValue *value, int column,
+                                gpointer row_data, int row_number,
+                                gpointer user_data);
 
 static int column_index_from_name(ZMapGUITreeView zmap_tv, char *name);
 
@@ -394,13 +400,41 @@ void zMapGUITreeViewUpdateTuple(ZMapGUITreeView zmap_tv, GtkTreeIter *iter, gpoi
   GtkListStore *store;
   GList *tuple_list = (GList *)user_data ;
 
-  store = GTK_LIST_STORE(zmap_tv->tree_model);
+  if(ZMAP_IS_GUILISTMODEL(zmap_tv->tree_model))
+    {
+      /* The row just points at different data now, the values follow. */
+      zMapGUIListModelSetRowData(ZMAP_GUILISTMODEL(zmap_tv->tree_model), iter, user_data);
+    }
+  else
+    {
+      store = GTK_LIST_STORE(zmap_tv->tree_model);
+
+      update_tuple_data_list(zmap_tv, store, iter, FALSE, tuple_list) ;
+    }
+
+  return ;
+}
 
-  update_tuple_data_list(zmap_tv, store, iter, FALSE, tuple_list) ;
+void zMapGUITreeViewRemoveTuple(ZMapGUITreeView zmap_tv, GtkTreeIter *iter)
+{
+  if(ZMAP_IS_GUILISTMODEL(zmap_tv->tree_model))
+    zMapGUIListModelRemove(ZMAP_GUILISTMODEL(zmap_tv->tree_model), iter);
+  else if(GTK_IS_LIST_STORE(zmap_tv->tree_model))
+    gtk_list_store_remove(GTK_LIST_STORE(zmap_tv->tree_model), iter);
 
   return ;
 }
 
+gpointer zMapGUITreeViewGetTupleData(ZMapGUITreeView zmap_tv, GtkTreeIter *iter)
+{
+  gpointer user_data = NULL;
+
+  if(ZMAP_IS_GUILISTMODEL(zmap_tv->tree_model))
+    user_data = zMapGUIListModelGetRowData(ZMAP_GUILISTMODEL(zmap_tv->tree_model), iter);
+
+  return user_data;
+}
+
 ZMapGUITreeView zMapGUITreeViewDestroy(ZMapGUITreeView zmap_tv)
 {
   g_object_unref(G_OBJECT(zmap_tv));
@@ -432,6 +466,18 @@ static void zmap_guitreeview_class_init(ZMapGUITreeViewClass zmap_tv_class)
                                                        "Specify there should be a column holding the pointer.",
                                                        FALSE, ZMAP_PARAM_STATIC_RW));
 
+  g_object_class_install_property(gobject_class,
+                                  ZMAP_GUITV_LAZY_MODEL,
+                                  g_param_spec_boolean("lazy-model", "lazy-model",
+                                                       "Keep the tuple data and call the column "
+                                                       "functions when the view asks for a value.",
+                                                       FALSE, ZMAP_PARAM_STATIC_RW));
+  g_object_class_install_property(gobject_class,
+                                  ZMAP_GUITV_ROW_DATA_DESTROY,
+                                  g_param_spec_pointer("row-data-destroy", "row-data-destroy",
+                                                       "A GDestroyNotify for tuple data held by a lazy-model.",
+                                                       ZMAP_PARAM_STATIC_RW));
+
   g_object_class_install_property(gobject_class,
                                   ZMAP_GUITV_COLUMN_COUNT,
                                   g_param_spec_uint("column-count", "columns",
@@ -652,6 +698,12 @@ static void zmap_guitreeview_set_property(GObject *gobject,
     case ZMAP_GUITV_DATA_PTR_COLUMN:
       zmap_tv->add_data_ptr = g_value_get_boolean(value);
       break;
+    case ZMAP_GUITV_LAZY_MODEL:
+      zmap_tv->lazy_model = g_value_get_boolean(value);
+      break;
+    case ZMAP_GUITV_ROW_DATA_DESTROY:
+      zmap_tv->row_data_destroy = (GDestroyNotify)g_value_get_pointer(value);
+      break;
     case ZMAP_GUITV_COLUMN_COUNT:   /* must be first in variadic args... */
       {
         int requested_count  = g_value_get_uint(value);
@@ -1091,11 +1143,23 @@ static void zmap_guitreeview_simple_add(ZMapGUITreeView zmap_tv,
   GtkListStore *store;
   GtkTreeIter iter;
 
-  store = GTK_LIST_STORE(zmap_tv->tree_model);
+  if(ZMAP_IS_GUILISTMODEL(zmap_tv->tree_model))
+    {
+      /* Nothing is copied, the column funcs are called with user_data when the view
+       * needs a value, so the model takes ownership of it. */
+      if(zmap_tv->lazy_adding)
+        zmap_tv->lazy_rows = g_list_prepend(zmap_tv->lazy_rows, user_data);
+      else
+        zMapGUIListModelAppend(ZMAP_GUILISTMODEL(zmap_tv->tree_model), user_data, NULL);
+    }
+  else
+    {
+      store = GTK_LIST_STORE(zmap_tv->tree_model);
 
-  gtk_list_store_append(store, &iter);
+      gtk_list_store_append(store, &iter);
 
-  update_tuple_data(zmap_tv, store, &iter, TRUE, user_data);
+      update_tuple_data(zmap_tv, store, &iter, TRUE, user_data);
+    }
 
   return ;
 }
@@ -1105,8 +1169,12 @@ static void zmap_guitreeview_simple_add_values(ZMapGUITreeView zmap_tv,
 {
   GList *tmp;
 
+  if(ZMAP_IS_GUILISTMODEL(zmap_tv->tree_model))
+    {
+      zMapLogWarning("%s", "Cannot add a list of values to a lazy-model.");
+    }
   /* step through the list and set the values */
-  if((tmp = values_list))
+  else if((tmp = values_list))
     {
       GtkTreeIter iter;
       GtkListStore *store;
@@ -1128,8 +1196,23 @@ static void zmap_guitreeview_add_list_of_tuples(ZMapGUITreeView zmap_tv,
 {
   zMapGUITreeViewPrepare(zmap_tv);
 
+  /* A lazy-model gets all the rows at once so it only renumbers and sorts them once. */
+  if(ZMAP_IS_GUILISTMODEL(zmap_tv->tree_model))
+    zmap_tv->lazy_adding = TRUE;
+
   g_list_foreach(tuples_list, each_tuple_swap_invoke_add, zmap_tv);
 
+  if(zmap_tv->lazy_adding)
+    {
+      zmap_tv->lazy_rows = g_list_reverse(zmap_tv->lazy_rows);
+
+      zMapGUIListModelAppendRows(ZMAP_GUILISTMODEL(zmap_tv->tree_model), zmap_tv->lazy_rows);
+
+      g_list_free(zmap_tv->lazy_rows);
+      zmap_tv->lazy_rows = NULL;
+      zmap_tv->lazy_adding = FALSE;
+    }
+
   zMapGUITreeViewAttach(zmap_tv);
 
   return ;
@@ -1605,7 +1688,13 @@ static GtkTreeModel *createModel(ZMapGUITreeView zmap_tv)
   GtkListStore *store;
   GType *types;
 
-  if(zmap_tv->column_count > 0)
+  if(zmap_tv->column_count > 0 && zmap_tv->lazy_model)
+    {
+      model = GTK_TREE_MODEL(zMapGUIListModelCreate(zmap_tv->column_count, zmap_tv->column_types,
+                                                    lazy_model_value_cb, zmap_tv,
+                                                    zmap_tv->row_data_destroy)) ;
+    }
+  else if(zmap_tv->column_count > 0)
     {
       types = zmap_tv->column_types;
 
@@ -1630,6 +1719,37 @@ static GtkTreeModel *createModel(ZMapGUITreeView zmap_tv)
   return model ;
 }
 
+/* The lazy-model equivalent of update_tuple_data() for a single cell. */
+static void lazy_model_value_cb(GValue *value, int column,
+                                gpointer row_data, int row_number,
+                                gpointer user_data)
+{
+  ZMapGUITreeView zmap_tv = ZMAP_GUITREEVIEW(user_data);
+  int index = 0;
+
+  if(zmap_tv->tuple_counter)
+    {
+      if(column == index)
+        {
+          g_value_set_int(value, row_number);
+          return ;
+        }
+
+      index++;
+    }
+
+  if(zmap_tv->add_data_ptr && column == index)
+    {
+      tuple_pointer_to_model(value, row_data);
+    }
+  else if(zmap_tv->column_funcs[column])
+    {
+      (zmap_tv->column_funcs[column])(value, row_data);
+    }
+
+  return ;
+}
+
 static int column_index_from_name(ZMapGUITreeView zmap_tv, char *name)
 {
   GQuark name_id, *names_ptr;
@@ -69,6 +69,8 @@ typedef struct _zmapGUITreeViewStruct
   unsigned int add_data_ptr : 1;
   unsigned int resized : 1;   /* Flag to record/control resizing the tree_view */
   unsigned int mapped : 1;    /* Flag to control resizing */
+  unsigned int lazy_model : 1; /* Model is a ZMapGUIListModel, values fetched on demand. */
+  unsigned int lazy_adding : 1; /* add_tuples is collecting lazy_rows. */
   unsigned int sort_index;
   unsigned int column_count;
   unsigned int curr_column;
@@ -96,6 +98,9 @@ typedef struct _zmapGUITreeViewStruct
   GDestroyNotify         sort_destroy;
 
   GList *tag_values_lists;
+
+  GDestroyNotify row_data_destroy; /* lazy_model owns the tuple data. */
+  GList *lazy_rows;                /* tuple data collected by add_tuples to append in one go. */
 } zmapGUITreeViewStruct;
 
 
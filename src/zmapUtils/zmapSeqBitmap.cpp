@@ -0,0 +1,317 @@
+/*  File: zmapSeqBitmap.cpp
+ *  Author: Roy Storey (rds@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Records which parts of a sequence have been marked.
+ *
+ * Exported functions: See ZMap/zmapSeqBitmap.hpp
+ *-------------------------------------------------------------------
+ */
+
+
+/*
+ * Despite the name this is not a bitmap: a bit per base (or per bin) costs memory in
+ * proportion to the sequence length and marking or testing a region means touching every
+ * bit in it. Regions are typically loaded in a handful of large chunks so instead we keep
+ * the marked regions as a sorted array of non-overlapping, non-adjacent intervals. Marking
+ * merges the new region with any it touches and tests are a binary search, so everything
+ * is O(log n) in the number of separate marked regions.
+ *
+ * bin_size is only used when reporting unmarked regions, these are widened out to whole
+ * bins so that callers don't end up with lots of tiny regions between marked ones.
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <stdio.h>
+#include <glib.h>
+
+#include <ZMap/zmapUtils.hpp>
+#include <ZMap/zmapSeqBitmap.hpp>
+
+
+
+typedef struct _zmapSeqBitmapStruct
+{
+  int start, end ;                                          /* Range that can be marked. */
+  int bin_size ;
+
+  GArray *regions ;                                         /* of ZMapSeqBitmapRegionStruct, sorted. */
+} zmapSeqBitmapStruct ;
+
+
+
+static guint findRegion(ZMapSeqBitmap bitmap, int coord) ;
+static GList *addUnmarkedRegion(GList *regions, ZMapSeqBitmap bitmap, int start, int end, int world1, int world2) ;
+
+
+
+/*
+ *                   External interface.
+ */
+
+
+/* Create a bitmap for the size bases from start, bin_size is the granularity of the regions
+ * returned by zmapSeqBitmapGetUnmarkedRegions(). */
+ZMapSeqBitmap zmapSeqBitmapCreate(int start, int size, int bin_size)
+{
+  ZMapSeqBitmap bitmap = NULL ;
+
+  zMapReturnValIfFail((size > 0), bitmap) ;
+
+  bitmap = g_new0(zmapSeqBitmapStruct, 1) ;
+
+  bitmap->start = start ;
+  bitmap->end = start + size - 1 ;
+  bitmap->bin_size = (bin_size > 0 ? bin_size : 1) ;
+  bitmap->regions = g_array_new(FALSE, FALSE, sizeof(ZMapSeqBitmapRegionStruct)) ;
+
+  return bitmap ;
+}
+
+
+/* Mark world1 to world2 inclusive, anything outside the bitmap's range is ignored. */
+void zmapSeqBitmapMarkRegion(ZMapSeqBitmap bitmap, int world1, int world2)
+{
+  ZMapSeqBitmapRegionStruct region ;
+  guint first, last ;
+
+  zMapReturnIfFail(bitmap) ;
+
+  if (world1 > world2)
+    {
+      int tmp = world1 ;
+
+      world1 = world2 ;
+      world2 = tmp ;
+    }
+
+  if (world1 < bitmap->start)
+    world1 = bitmap->start ;
+  if (world2 > bitmap->end)
+    world2 = bitmap->end ;
+
+  if (world1 > world2)
+    return ;
+
+  region.start = world1 ;
+  region.end = world2 ;
+
+  /* Swallow all regions that overlap or are adjacent to the new one. */
+  first = findRegion(bitmap, world1 - 1) ;
+
+  for (last = first ; last < bitmap->regions->len ; last++)
+    {
+      ZMapSeqBitmapRegion curr = &g_array_index(bitmap->regions, ZMapSeqBitmapRegionStruct, last) ;
+
+      if (curr->start > world2 + 1)
+        break ;
+
+      if (curr->start < region.start)
+        region.start = curr->start ;
+      if (curr->end > region.end)
+        region.end = curr->end ;
+    }
+
+  if (last > first)
+    g_array_remove_range(bitmap->regions, first, last - first) ;
+
+  g_array_insert_val(bitmap->regions, first, region) ;
+
+  return ;
+}
+
+
+gboolean zmapSeqBitmapIsRegionFullyMarked(ZMapSeqBitmap bitmap, int world1, int world2)
+{
+  gboolean result = FALSE ;
+  guint index ;
+
+  zMapReturnValIfFail(bitmap, result) ;
+
+  if (world1 > world2)
+    {
+      int tmp = world1 ;
+
+      world1 = world2 ;
+      world2 = tmp ;
+    }
+
+  /* Regions are never adjacent so the whole range must be in one of them. */
+  if ((index = findRegion(bitmap, world1)) < bitmap->regions->len)
+    {
+      ZMapSeqBitmapRegion region = &g_array_index(bitmap->regions, ZMapSeqBitmapRegionStruct, index) ;
+
+      if (region->start <= world1 && region->end >= world2)
+        result = TRUE ;
+    }
+
+  return result ;
+}
+
+
+/* Returns a list of ZMapSeqBitmapRegion in ascending order covering all of world1 to world2
+ * that is not marked, or NULL if it is all marked. Regions are widened to whole bins but
+ * clipped to world1 to world2, anything outside the bitmap's range counts as unmarked.
+ * Caller should free the list and its data with g_free(). */
+GList *zmapSeqBitmapGetUnmarkedRegions(ZMapSeqBitmap bitmap, int world1, int world2)
+{
+  GList *regions = NULL ;
+  guint index ;
+  int pos ;
+
+  zMapReturnValIfFail(bitmap, regions) ;
+
+  if (world1 > world2)
+    {
+      int tmp = world1 ;
+
+      world1 = world2 ;
+      world2 = tmp ;
+    }
+
+  pos = world1 ;
+
+  for (index = findRegion(bitmap, world1) ; index < bitmap->regions->len && pos <= world2 ; index++)
+    {
+      ZMapSeqBitmapRegion region = &g_array_index(bitmap->regions, ZMapSeqBitmapRegionStruct, index) ;
+
+      if (region->start > world2)
+        break ;
+
+      if (region->start > pos)
+        regions = addUnmarkedRegion(regions, bitmap, pos, region->start - 1, world1, world2) ;
+
+      pos = region->end + 1 ;
+    }
+
+  if (pos <= world2)
+    regions = addUnmarkedRegion(regions, bitmap, pos, world2, world1, world2) ;
+
+  regions = g_list_reverse(regions) ;
+
+  return regions ;
+}
+
+
+void zmapSeqBitmapPrint(ZMapSeqBitmap bitmap)
+{
+  guint i ;
+
+  zMapReturnIfFail(bitmap) ;
+
+  printf("SeqBitmap %d -> %d (bin size %d), %u marked regions:\n",
+         bitmap->start, bitmap->end, bitmap->bin_size, bitmap->regions->len) ;
+
+  for (i = 0 ; i < bitmap->regions->len ; i++)
+    {
+      ZMapSeqBitmapRegion region = &g_array_index(bitmap->regions, ZMapSeqBitmapRegionStruct, i) ;
+
+      printf("\t%d -> %d\n", region->start, region->end) ;
+    }
+
+  return ;
+}
+
+
+ZMapSeqBitmap zmapSeqBitmapDestroy(ZMapSeqBitmap bitmap)
+{
+  zMapReturnValIfFail(bitmap, bitmap) ;
+
+  g_array_free(bitmap->regions, TRUE) ;
+
+  g_free(bitmap) ;
+
+  return NULL ;
+}
+
+
+
+
+/*
+ *                   Internal routines.
+ */
+
+
+/* Binary search for the first region that ends at or after coord, returns regions->len if
+ * there isn't one. */
+static guint findRegion(ZMapSeqBitmap bitmap, int coord)
+{
+  guint low = 0, high = bitmap->regions->len, mid ;
+
+  while (low < high)
+    {
+      mid = (low + high) / 2 ;
+
+      if (g_array_index(bitmap->regions, ZMapSeqBitmapRegionStruct, mid).end < coord)
+        low = mid + 1 ;
+      else
+        high = mid ;
+    }
+
+  return low ;
+}
+
+
+/* Prepends start to end widened to the bins it falls in, merging with the previous region if
+ * the widening made them touch. */
+static GList *addUnmarkedRegion(GList *regions, ZMapSeqBitmap bitmap, int start, int end, int world1, int world2)
+{
+  ZMapSeqBitmapRegion prev = NULL ;
+
+  if (bitmap->bin_size > 1)
+    {
+      if (start > bitmap->start)
+        start -= (start - bitmap->start) % bitmap->bin_size ;
+
+      if (end >= bitmap->start)
+        end += bitmap->bin_size - 1 - ((end - bitmap->start) % bitmap->bin_size) ;
+
+      if (start < world1)
+        start = world1 ;
+      if (end > world2)
+        end = world2 ;
+    }
+
+  if (regions)
+    prev = (ZMapSeqBitmapRegion)(regions->data) ;
+
+  if (prev && prev->end >= start - 1)
+    {
+      if (end > prev->end)
+        prev->end = end ;
+    }
+  else
+    {
+      ZMapSeqBitmapRegion region ;
+
+      region = g_new0(ZMapSeqBitmapRegionStruct, 1) ;
+      region->start = start ;
+      region->end = end ;
+
+      regions = g_list_prepend(regions, region) ;
+    }
+
+  return regions ;
+}
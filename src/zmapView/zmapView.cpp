@@ -138,6 +138,10 @@ static void displayDataWindows(ZMapView zmap_view,
                                ZMapFeature highlight_feature, gboolean splice_highlight,
                                gboolean allow_clean) ;
 static gint zmapIdleCB(gpointer cb_data) ;
+static GList *mergePrepare(ZMapView view, ZMapFeatureContext new_features,
+                           gboolean request_as_columns, gboolean revcomp_if_needed) ;
+static void mergeComplete(ZMapView view, ZMapFeatureContextMergeCode result,
+                          ZMapFeatureContext diff_context, GList **masked) ;
 static void enterCB(ZMapWindow window, void *caller_data, void *window_data) ;
 static void leaveCB(ZMapWindow window, void *caller_data, void *window_data) ;
 static void scrollCB(ZMapWindow window, void *caller_data, void *window_data) ;
@@ -754,6 +758,9 @@ gboolean zMapViewReverseComplement(ZMapView zmap_view)
 
       zmapViewBusy(zmap_view, TRUE) ;
 
+      /* Features still being merged must be drawn before the windows are reset. */
+      zmapViewMergesFinish(zmap_view) ;
+
       zMapLogTime(TIMER_REVCOMP,TIMER_CLEAR,0,"Revcomp");
       zMapLogTime(TIMER_EXPOSE,TIMER_CLEAR,0,"Revcomp");
       zMapLogTime(TIMER_UPDATE,TIMER_CLEAR,0,"Revcomp");
@@ -808,6 +815,11 @@ gboolean zMapViewReverseComplement(ZMapView zmap_view)
         zmap_view->feature_cache = g_hash_table_new(NULL, NULL) ;
       }
 
+    zmapViewBlixemCacheClear(zmap_view) ;
+
+    /* The scratch feature's checkpoints have the old coords. */
+    zmapViewScratchClearCheckpoints(zmap_view) ;
+
   return result ;
 }
 
@@ -848,6 +860,8 @@ gboolean zMapViewReset(ZMapView zmap_view)
          sequence. */
       killConnections(zmap_view) ;
 
+      zmapViewLoadedRegionsClear(zmap_view) ;
+
       result = TRUE ;
     }
 
@@ -1436,15 +1450,19 @@ gboolean zmapViewMergeNewFeatures(ZMapView view,
     {
       result = TRUE ;
 
-      zMapFeatureContextExecute((ZMapFeatureAny)(*context),
-                                ZMAPFEATURE_STRUCT_FEATURE,
-                                delete_from_list,
-                                feature_list);
-
-      zMapFeatureContextExecute((ZMapFeatureAny)(view->features),
-                                ZMAPFEATURE_STRUCT_FEATURE,
-                                mark_matching_invalid,
-                                feature_list);
+      /* Both passes walk whole contexts, the second the entire view context, so skip them
+       * once there are no features left to check. */
+      if (feature_list && *feature_list)
+        zMapFeatureContextExecute((ZMapFeatureAny)(*context),
+                                  ZMAPFEATURE_STRUCT_FEATURE,
+                                  delete_from_list,
+                                  feature_list);
+
+      if (feature_list && *feature_list)
+        zMapFeatureContextExecute((ZMapFeatureAny)(view->features),
+                                  ZMAPFEATURE_STRUCT_FEATURE,
+                                  mark_matching_invalid,
+                                  feature_list);
     }
 
   return result ;
@@ -1467,6 +1485,17 @@ void zmapViewEraseFeatures(ZMapView view, ZMapFeatureContext context, GList **fe
 }
 
 
+/* Tell our remote peer features have been loaded when there was no server request to do it,
+ * e.g. all the features requested were already loaded. */
+void zmapViewSendLoaded(ZMapView view, LoadFeaturesData loaded_features)
+{
+  if (view->remote_control && loaded_features)
+    sendViewLoaded(view, loaded_features) ;
+
+  return ;
+}
+
+
 
 
 
@@ -1511,6 +1540,8 @@ void zmapViewResetWindows(ZMapView zmap_view, gboolean revcomp)
 
 
 
+/* Merge the new features into the view's context, returns the diff context of just the new
+ * features in context_inout (NULL if the merge fails). */
 ZMapFeatureContextMergeCode zmapJustMergeContext(ZMapView view, ZMapFeatureContext *context_inout,
                                              ZMapFeatureContextMergeStats *merge_stats_out,
                                              GList **masked,
@@ -1518,16 +1549,139 @@ ZMapFeatureContextMergeCode zmapJustMergeContext(ZMapView view, ZMapFeatureConte
 {
   ZMapFeatureContextMergeCode result = ZMAPFEATURE_CONTEXT_ERROR ;
   ZMapFeatureContext new_features, diff_context = NULL ;
-  GList *featureset_names = NULL;
-  GList *l;
+  GList *featureset_names ;
 
+  /* Merges from sources still running in another thread must be drawn first. */
+  zmapViewMergesFinish(view) ;
 
   new_features = *context_inout ;
 
-  //  printf("just Merge new = %s\n",zMapFeatureContextGetDNAStatus(new_features) ? "yes" : "non");
+  zMapStartTimer("Merge Context","") ;
+
+  featureset_names = mergePrepare(view, new_features, request_as_columns, revcomp_if_needed) ;
+
+  /* Merge the new features !! */
+  result = zMapFeatureContextMerge(&(view->features), &new_features, &diff_context,
+                                   merge_stats_out, featureset_names) ;
+
+  mergeComplete(view, result, diff_context, masked) ;
+
+  /* Return the diff_context which is the just the new features (NULL if merge fails). */
+  *context_inout = diff_context ;
+
+  return result ;
+}
+
+
+/* As zmapJustMergeContext() but the merge is done in another thread so the GUI carries on
+ * handling events meanwhile, the user can scroll, click on features etc. during large loads.
+ * The view's context is not altered until zmapJustMergeContextFinish() is called, which should
+ * only be done once zMapFeatureContextMergeIsFinished() says so. The merge owns the new
+ * context so context_inout is set to NULL.
+ *
+ * Any earlier merges are finished first, collapsing, masking and drawing alter the view's
+ * context which must not happen while the new merge is reading it. */
+ZMapFeatureContextMergeJob zmapJustMergeContextStart(ZMapView view, ZMapFeatureContext *context_inout,
+                                                     gboolean request_as_columns, gboolean revcomp_if_needed)
+{
+  ZMapFeatureContextMergeJob merge_job = NULL ;
+  GList *featureset_names ;
+
+  zmapViewMergesFinish(view) ;
 
   zMapStartTimer("Merge Context","") ;
 
+  featureset_names = mergePrepare(view, *context_inout, request_as_columns, revcomp_if_needed) ;
+
+  if ((merge_job = zMapFeatureContextMergeStart(view->features, *context_inout, featureset_names)))
+    *context_inout = NULL ;
+  else
+    zMapStopTimer("Merge Context","") ;
+
+  return merge_job ;
+}
+
+
+/* Completes a merge from zmapJustMergeContextStart(), results are as for zmapJustMergeContext()
+ * and merge_job is freed. */
+ZMapFeatureContextMergeCode zmapJustMergeContextFinish(ZMapView view, ZMapFeatureContextMergeJob merge_job,
+                                                       ZMapFeatureContext *diff_context_out,
+                                                       ZMapFeatureContextMergeStats *merge_stats_out,
+                                                       GList **masked)
+{
+  ZMapFeatureContextMergeCode result = ZMAPFEATURE_CONTEXT_ERROR ;
+  ZMapFeatureContext diff_context = NULL ;
+
+  result = zMapFeatureContextMergeFinish(merge_job, &diff_context, merge_stats_out) ;
+
+  mergeComplete(view, result, diff_context, masked) ;
+
+  *diff_context_out = diff_context ;
+
+  return result ;
+}
+
+
+void zmapJustDrawContext(ZMapView view, ZMapFeatureContext diff_context,
+                         GList *masked, ZMapFeature highlight_feature,
+                         ZMapConnectionData connect_data)
+{
+  LoadFeaturesData loaded_features = NULL ;
+
+  /* THIS CAN GO ONCE IT'S WORKING.... */
+  /* we need to tell the user what features were loaded but this struct needs to
+   * persist as the information may be passed _after_ the connection has gone. */
+  if (connect_data && connect_data->loaded_features)
+    {
+      loaded_features = connect_data->loaded_features ;
+      zMapLogMessage("copied pointer of ConnectData LoadFeaturesDataStruct"
+                     " to pass to displayDataWindows(): %p -> %p",
+                     connect_data->loaded_features, loaded_features) ;
+    }
+
+  /* Signal the ZMap that there is work to be done. */
+  displayDataWindows(view, view->features, diff_context, 
+                     loaded_features, FALSE, masked, NULL, FALSE, TRUE) ;
+
+  /* Not sure about the timing of the next bit. */
+
+  /* We have to redraw the whole navigator here.  This is a bit of
+   * a pain, but it's due to the scaling we do to make the rest of
+   * the navigator work.  If the length of the sequence changes the
+   * all the previously drawn features need to move.  It also
+   * negates the need to keep state as to the length of the sequence,
+   * the number of times the scale bar has been drawn, etc...
+   * The navigator keeps a summary of the features it draws so only the
+   * new ones need looking at. */
+  zMapWindowNavigatorMergeFeatures(view->navigator_window, view->features, diff_context) ;
+  zMapWindowNavigatorReset(view->navigator_window); /* So reset */
+  zMapWindowNavigatorSetStrand(view->navigator_window, zMapViewGetRevCompStatus(view));
+  /* and draw with _all_ the view's features. */
+  zMapWindowNavigatorDrawFeatures(view->navigator_window, view->features, view->context_map.styles);
+
+  /* signal our caller that we have data. */
+  (*(view_cbs_G->load_data))(view, view->app_data, NULL) ;
+
+  return ;
+}
+
+
+
+
+
+/*
+ *                      Internal routines
+ */
+
+
+/* Sets up the view and the new features ready for merging, returns the list of requested
+ * featureset names. */
+static GList *mergePrepare(ZMapView view, ZMapFeatureContext new_features,
+                           gboolean request_as_columns, gboolean revcomp_if_needed)
+{
+  GList *featureset_names = NULL;
+  GList *l;
+
   if(!view->features)
     {
       /* we need a context with a master_align with a block, all with valid sequence coordinates */
@@ -1644,11 +1798,15 @@ ZMapFeatureContextMergeCode zmapJustMergeContext(ZMapView view, ZMapFeatureConte
 
     }
 
+  return featureset_names ;
+}
 
-  /* Merge the new features !! */
-  result = zMapFeatureContextMerge(&(view->features), &new_features, &diff_context,
-                                   merge_stats_out, featureset_names) ;
 
+/* Tidies up the new features once they are merged, e.g. sorting exons and masking. */
+static void mergeComplete(ZMapView view, ZMapFeatureContextMergeCode result,
+                          ZMapFeatureContext diff_context, GList **masked)
+{
+  GList *l;
 
   //  printf("just Merge view = %s\n",zMapFeatureContextGetDNAStatus(view->features) ? "yes" : "non");
   //  printf("just Merge diff = %s\n",zMapFeatureContextGetDNAStatus(diff_context) ? "yes" : "non");
@@ -1670,18 +1828,6 @@ ZMapFeatureContextMergeCode zmapJustMergeContext(ZMapView view, ZMapFeatureConte
   if (result == ZMAPFEATURE_CONTEXT_OK)
     {
       /*      zMapLogMessage("%s", "Context merge succeeded.") ;*/
-      if(0)
-        {
-          char *x = g_strdup_printf("justMerge req=%d, diff has %d featuresets after merging: ", request_as_columns,g_list_length(diff_context->src_feature_set_names));
-          GList *l;
-          for(l = diff_context->src_feature_set_names;l;l = l->next)
-            {
-              char *y = (char *) g_quark_to_string(GPOINTER_TO_UINT(l->data));
-              x = g_strconcat(x,",",y,NULL);
-            }
-          zMapLogWarning(x,"");
-          printf("%s\n",x);
-        }
 
       /* ensure transcripts have exons in fwd strand order
        * needed for CanvasTranscript... ACEDB did this but pipe scripts return exons in transcript (strand) order
@@ -1705,75 +1851,53 @@ ZMapFeatureContextMergeCode zmapJustMergeContext(ZMapView view, ZMapFeatureConte
 
   zMapStopTimer("Merge Context","") ;
 
-  /* Return the diff_context which is the just the new features (NULL if merge fails). */
-  *context_inout = diff_context ;
-
-  return result ;
-}
-
-
-
-void zmapJustDrawContext(ZMapView view, ZMapFeatureContext diff_context,
-                         GList *masked, ZMapFeature highlight_feature,
-                         ZMapConnectionData connect_data)
-{
-  LoadFeaturesData loaded_features = NULL ;
-
-  /* THIS CAN GO ONCE IT'S WORKING.... */
-  /* we need to tell the user what features were loaded but this struct needs to
-   * persist as the information may be passed _after_ the connection has gone. */
-  if (connect_data && connect_data->loaded_features)
-    {
-      loaded_features = connect_data->loaded_features ;
-      zMapLogMessage("copied pointer of ConnectData LoadFeaturesDataStruct"
-                     " to pass to displayDataWindows(): %p -> %p",
-                     connect_data->loaded_features, loaded_features) ;
-    }
-
-  /* Signal the ZMap that there is work to be done. */
-  displayDataWindows(view, view->features, diff_context, 
-                     loaded_features, FALSE, masked, NULL, FALSE, TRUE) ;
-
-  /* Not sure about the timing of the next bit. */
+  /* Set local feature ids are freed with their featuresets so unlike the quark table this
+   * should not keep growing as columns are loaded and deleted. */
+  {
+    int n_spaces = 0, n_ids = 0 ;
+    gsize n_bytes = 0 ;
 
-  /* We have to redraw the whole navigator here.  This is a bit of
-   * a pain, but it's due to the scaling we do to make the rest of
-   * the navigator work.  If the length of the sequence changes the
-   * all the previously drawn features need to move.  It also
-   * negates the need to keep state as to the length of the sequence,
-   * the number of times the scale bar has been drawn, etc... */
-  zMapWindowNavigatorReset(view->navigator_window); /* So reset */
-  zMapWindowNavigatorSetStrand(view->navigator_window, zMapViewGetRevCompStatus(view));
-  /* and draw with _all_ the view's features. */
-  zMapWindowNavigatorDrawFeatures(view->navigator_window, view->features, view->context_map.styles);
+    zMapFeatureIDGetStats(&n_spaces, &n_ids, &n_bytes) ;
 
-  /* signal our caller that we have data. */
-  (*(view_cbs_G->load_data))(view, view->app_data, NULL) ;
+    if (n_spaces)
+      zMapLogMessage("Local feature ids: %d ids in %d id spaces, %lu bytes of strings.",
+                     n_ids, n_spaces, (unsigned long)n_bytes) ;
+  }
 
   return ;
 }
 
 
 
-
-
-/*
- *                      Internal routines
- */
-
-
 static void eraseAndUndrawContext(ZMapView view, ZMapFeatureContext context_inout)
 {
   ZMapFeatureContext diff_context = NULL;
 
+  /* Features still being merged must be drawn before any are erased. */
+  zmapViewMergesFinish(view) ;
+
   if(!zMapFeatureContextErase(&(view->features), context_inout, &diff_context))
     {
       zMapLogCritical("%s", "Cannot erase feature data from...") ;
     }
   else
     {
+      /* Features may be replaced by new ones with the same ids. */
+      zmapViewBlixemCacheClear(view) ;
+
+      /* Erased features must be fetched again if they are requested. */
+      zmapViewLoadedRegionsClear(view) ;
+
       displayDataWindows(view, view->features, diff_context, NULL, TRUE, NULL, NULL, FALSE, TRUE) ;
 
+      /* The navigator must let go of the features before they are destroyed. */
+      if (zMapWindowNavigatorRemoveFeatures(view->navigator_window, diff_context))
+        {
+          zMapWindowNavigatorReset(view->navigator_window) ;
+          zMapWindowNavigatorSetStrand(view->navigator_window, zMapViewGetRevCompStatus(view)) ;
+          zMapWindowNavigatorDrawFeatures(view->navigator_window, view->features, view->context_map.styles) ;
+        }
+
       zMapFeatureContextDestroy(diff_context, TRUE) ;
     }
 
@@ -2885,6 +3009,7 @@ static gboolean checkStateConnections(ZMapView zmap_view)
           ZMapConnectionData connect_data = NULL ;
           ZMapViewConnectionStepList step_list = NULL ;
           gboolean is_empty = FALSE ;
+          gboolean merge_running = FALSE ;
 
           view_con = (ZMapNewDataSource)(list_item->data) ;
           thread = view_con->thread->GetThread() ;
@@ -2922,6 +3047,15 @@ static gboolean checkStateConnections(ZMapView zmap_view)
               connect_data->loaded_features->xwid = zmap_view->xwid ;
 
               step_list = connect_data->step_list ;
+
+              /* The features from this connection are being merged in another thread, leave
+               * its reply until the merge has finished, see viewGetFeatures(). */
+              if (connect_data->merge_job && !zMapFeatureContextMergeIsFinished(connect_data->merge_job))
+                {
+                  has_step_list++ ;
+
+                  continue ;
+                }
             }
 
           if (!(zMapThreadGetReplyWithData(thread, &reply, &data, &err_msg)))
@@ -3042,7 +3176,12 @@ static gboolean checkStateConnections(ZMapView zmap_view)
 
                             zmapViewStepListStepProcessRequest(step_list, (void *)view_con, request) ;
 
-                            if (zMapConnectionIsFinished(request))
+                            if (connect_data->merge_job)
+                              {
+                                /* Keep the reply to process again once the merge has finished. */
+                                merge_running = TRUE ;
+                              }
+                            else if (zMapConnectionIsFinished(request))
                               {
                                 this_step_finished = TRUE ;
                                 request_type = req_any->type ;
@@ -3076,6 +3215,9 @@ static gboolean checkStateConnections(ZMapView zmap_view)
                            }
                       }
 
+                    if (merge_running)
+                      break ;
+
                     if (reply == ZMAPTHREAD_REPLY_REQERROR)
                       {
                         if (zMapStepOnFailAction(step) == REQUEST_ONFAIL_CANCEL_THREAD
@@ -3223,6 +3365,16 @@ static gboolean checkStateConnections(ZMapView zmap_view)
 
             }
 
+          if (merge_running)
+            {
+              has_step_list++ ;
+
+              if (err_msg)
+                g_free(err_msg) ;
+
+              continue ;
+            }
+
 
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
           /* There is a problem with the zMapThreadExists() call on the Mac,
@@ -3432,6 +3584,8 @@ static gboolean checkStateConnections(ZMapView zmap_view)
 
               if ((connect_data = (ZMapConnectionData)zMapServerConnectionGetUserData(view_con)))
                 {
+                  zmapViewMergeDiscard(zmap_view, connect_data) ;
+
                   if (connect_data->loaded_features)
                     {
                       zmapViewDestroyLoadFeatures(connect_data->loaded_features) ;
@@ -3676,6 +3830,10 @@ static void destroyZMapView(ZMapView *zmap_view_out)
 
   killAllSpawned(zmap_view);
 
+  zmapViewBlixemCacheDestroy(zmap_view) ;
+
+  zmapViewLoadedRegionsDestroy(zmap_view) ;
+
   g_free(zmap_view) ;
 
   *zmap_view_out = NULL ;
@@ -3992,7 +4150,7 @@ static gboolean mergeNewFeatureCB(ZMapWindow window, void *caller_data, void *wi
               ZMapFeature existing_feature = (ZMapFeature)(existing_features->data) ;
 
               char *msg = g_strdup_printf("Feature '%s' already exists in strand %s of featureset %s: overwrite?",
-                                          g_quark_to_string(merge->feature->original_id),
+                                          zMapFeatureIDToString(merge->feature->original_id),
                                           zMapFeatureStrand2Str(merge->feature->strand),
                                           g_quark_to_string(merge->feature_set->original_id)) ;
 
@@ -4361,7 +4519,7 @@ static void commandCB(ZMapWindow window, void *caller_data, void *window_data)
 
             zmapViewLoadFeatures(view, get_data->block, get_data->feature_set_ids, NULL, NULL,
                                  NULL, req_start, req_end, view->thread_fail_silent,
-                                 SOURCE_GROUP_DELAYED, TRUE, FALSE) ;        /* don't terminate, need to keep alive for blixem */
+                                 SOURCE_GROUP_DELAYED, TRUE, FALSE, FALSE) ;        /* don't terminate, need to keep alive for blixem */
 
             break ;
           }
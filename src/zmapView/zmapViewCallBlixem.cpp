@@ -42,6 +42,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>                                            /* for chmod() */
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <string>
 
 #include <gbtools/gbtools.hpp>
@@ -135,11 +136,17 @@ typedef struct ZMapBlixemDataStruct_
 
   gboolean      keep_tmpfiles ;
   gboolean      sleep_on_startup ;
+  gboolean      bgzf_features ;            /* Send features as bgzip'd, tabix indexed GFF. */
 
   char          *fastAFile ;
   GIOChannel    *fasta_channel;
   char          *gff_file ;
+  char          *gff_index_file ;          /* tabix index of gff_file, blixem doesn't remove it. */
   GIOChannel    *gff_channel ;
+  GString       *gff_text ;                /* The gff is built up here and written in one go. */
+
+  ZMapViewBlixemCache cache ;              /* The view's cache. */
+  GPtrArray     *collect ;                 /* Set when only collecting the features to write. */
 
   ZMapGFFAttributeFlags attribute_flags ;
   gboolean over_write ;
@@ -208,6 +215,7 @@ typedef struct BlixemConfigDataStructType
     unsigned int homol_max : 1 ;
     unsigned int keep_tmpfiles : 1 ;
     unsigned int sleep_on_startup : 1 ;
+    unsigned int bgzf_features : 1 ;
     unsigned int assoc_featuresets : 1 ;
   } is_set ;
 
@@ -231,12 +239,63 @@ typedef struct BlixemConfigDataStructType
                                                  to blixem. */
   gboolean      keep_tmpfiles ;
   gboolean      sleep_on_startup ;
+  gboolean      bgzf_features ;               /* file-format is gffv3-bgzf */
 
   GList *assoc_featuresets ;
 
 } BlixemConfigDataStruct, *BlixemConfigData ;
 
 
+/*
+ * Each view caches what it hands to blixem. Formatting the features of a dense alignment
+ * column and writing them and the dna out again takes seconds so we keep:
+ *
+ * - the GFF for every feature written, by featureset, so a launch only formats features
+ *   loaded since the last one (in parallel if there are many),
+ * - links to the last gff and fasta files so that if a launch would write exactly the same
+ *   file we just link the old one to the new name. Blixem removes its input files so it
+ *   always gets a new name.
+ *
+ * The lines are dropped when features are erased or revcomp'd.
+ */
+#define BLIXEM_CACHE_CHUNK_FEATURES 4096
+
+typedef struct BlixemCacheLineStructType
+{
+  ZMapFeature feature ;                                     /* Line is only valid for this feature. */
+  const char *line ;                                        /* GFF line(s) for the feature. */
+} BlixemCacheLineStruct, *BlixemCacheLine ;
+
+typedef struct BlixemCacheSetStructType
+{
+  ZMapFeatureSet feature_set ;
+  GStringChunk *strings ;
+  GHashTable *lines ;                                       /* BlixemCacheLine by feature unique_id. */
+} BlixemCacheSetStruct, *BlixemCacheSet ;
+
+typedef struct ZMapViewBlixemCacheStructType
+{
+  GHashTable *sets ;                                        /* BlixemCacheSet by featureset unique_id. */
+
+  char *gff_file ;                                          /* Link to the last gff file... */
+  char *gff_digest ;                                        /* ...and checksum of its contents. */
+
+  char *fasta_file ;                                        /* Link to the last fasta file... */
+  char *fasta_key ;                                         /* ...and the dna it holds. */
+} ZMapViewBlixemCacheStruct ;
+
+/* A chunk of features to be formatted in a worker thread. */
+typedef struct BlixemFormatJobStructType
+{
+  ZMapBlixemData blixem_data ;
+  gpointer *features ;
+  guint n_features ;
+  ZMapGFFAttributeFlags attribute_flags ;                   /* Each job has its own. */
+  GString *text ;
+  GArray *ends ;                                            /* End of each feature's text. */
+} BlixemFormatJobStruct, *BlixemFormatJob ;
+
+
 static gboolean initBlixemData(ZMapView view, ZMapFeatureBlock block,
                                ZMapHomolType align_type,
                                int offset, int position,
@@ -273,7 +332,23 @@ static void writeFeatureLineList(gpointer data, gpointer user_data) ;
 static void writeFeatureLine(ZMapFeature feature, ZMapBlixemData  blixem_data) ;
 
 static gboolean writeFastAFile(ZMapBlixemData blixem_data);
+static gboolean writeFastADNA(ZMapBlixemData blixem_data) ;
 static gboolean writeFeatureFiles(ZMapBlixemData blixem_data);
+static gboolean writeGFFFile(ZMapBlixemData blixem_data) ;
+static gboolean includeFeatureType(ZMapBlixemData blixem_data, ZMapFeature feature) ;
+static gboolean formatFeatureLine(ZMapBlixemData blixem_data, ZMapFeature feature,
+                                  GString *line, ZMapGFFAttributeFlags attribute_flags) ;
+
+static ZMapViewBlixemCache cacheCreate(void) ;
+static void cacheDestroySetCB(gpointer data) ;
+static BlixemCacheSet cacheGetSet(ZMapBlixemData blixem_data, ZMapFeature feature) ;
+static const char *cacheFindLine(ZMapBlixemData blixem_data, ZMapFeature feature) ;
+static void cacheAddLine(ZMapBlixemData blixem_data, ZMapFeature feature, const char *line, gsize len) ;
+static void cacheFormatCollected(ZMapBlixemData blixem_data) ;
+static void cacheFormatJobCB(gpointer data, gpointer user_data) ;
+static gboolean cacheReuseFile(const char *cache_file, const char *file) ;
+static gboolean cacheKeepFile(char **cache_file_inout, const char *file) ;
+static void blixemExitCB(GPid child_pid, gint child_status, gpointer user_data) ;
 static gboolean initFeatureFile(const char *filename, GString *buffer,
                                  GIOChannel **gio_channel_out, char ** err_out ) ;
 
@@ -431,17 +506,18 @@ gboolean zmapViewCallBlixem(ZMapView view,
 
   if (status)
     {
-      status = buildParamString(blixem_data, argv) ;
+      status = writeFeatureFiles(blixem_data);
     }
 
   if (status)
     {
-      status = writeFeatureFiles(blixem_data);
+      status = writeFastAFile(blixem_data);
     }
 
+  /* Done after writing the files as their names may have changed (e.g. compressed gff). */
   if (status)
     {
-      status = writeFastAFile(blixem_data);
+      status = buildParamString(blixem_data, argv) ;
     }
 
 
@@ -454,6 +530,14 @@ gboolean zmapViewCallBlixem(ZMapView view,
       gpointer pre_exec_data = NULL;
       GPid spawned_pid = 0;
       GError *error = NULL;
+      gboolean remove_index ;
+
+      /* Blixem removes the files it's given but not the tabix index of the gff file so we
+       * wait for it to exit and remove that ourselves. */
+      remove_index = (blixem_data->gff_index_file && !blixem_data->keep_tmpfiles) ;
+
+      if (remove_index)
+        flags = (GSpawnFlags)(flags | G_SPAWN_DO_NOT_REAP_CHILD) ;
 
       /*
        * I'm inserting a lock here until I can check if g_spawn_async() shares code with
@@ -485,6 +569,12 @@ gboolean zmapViewCallBlixem(ZMapView view,
               {
                 string cmdline ;
 
+                if (remove_index)
+                  {
+                    g_child_watch_add(spawned_pid, blixemExitCB, blixem_data->gff_index_file) ;
+                    blixem_data->gff_index_file = NULL ;
+                  }
+
                 buildCmdLine((const char **)argv, cmdline) ;
 
                 zMapLogMessage("Blixem process spawned with PID = '%d' and command line:\"%s\"",
@@ -512,6 +602,9 @@ gboolean zmapViewCallBlixem(ZMapView view,
 
   if (!status)
     {
+      if (blixem_data && blixem_data->gff_index_file && !blixem_data->keep_tmpfiles)
+        g_unlink(blixem_data->gff_index_file) ;
+
       if (err_msg)
         zMapWarning("%s", err_msg) ;
       else
@@ -569,6 +662,48 @@ void zMapViewBlixemSaveChapter(ZMapGuiNotebookChapter chapter, ZMapView view)
 }
 
 
+/* Drops the cached feature lines, must be called when features may have changed in place or
+ * been replaced by others with the same ids. The cached files are kept as they are only reused
+ * if the new ones would be identical. */
+void zmapViewBlixemCacheClear(ZMapView view)
+{
+  if (view && view->blixem_cache)
+    g_hash_table_remove_all(view->blixem_cache->sets) ;
+
+  return ;
+}
+
+
+void zmapViewBlixemCacheDestroy(ZMapView view)
+{
+  ZMapViewBlixemCache cache ;
+
+  if (view && (cache = view->blixem_cache))
+    {
+      g_hash_table_destroy(cache->sets) ;
+
+      if (cache->gff_file)
+        {
+          g_unlink(cache->gff_file) ;
+          g_free(cache->gff_file) ;
+        }
+      g_free(cache->gff_digest) ;
+
+      if (cache->fasta_file)
+        {
+          g_unlink(cache->fasta_file) ;
+          g_free(cache->fasta_file) ;
+        }
+      g_free(cache->fasta_key) ;
+
+      g_free(cache) ;
+      view->blixem_cache = NULL ;
+    }
+
+  return ;
+}
+
+
 /*
  *                     Internal routines.
  */
@@ -591,6 +726,11 @@ static gboolean initBlixemData(ZMapView view, ZMapFeatureBlock block,
 
   blixem_data->view  = view ;
 
+  if (!view->blixem_cache)
+    view->blixem_cache = cacheCreate() ;
+  blixem_data->cache = view->blixem_cache ;
+  blixem_data->gff_text = g_string_new(NULL) ;
+
   blixem_data->config_file = g_strdup(((ZMapFeatureSequenceMap)(view->sequence_mapping->data))->config_file) ;
   blixem_data->line = g_string_new(NULL) ;
   blixem_data->offset = offset ;
@@ -653,8 +793,12 @@ static void deleteBlixemData(ZMapBlixemData *p_blixem_data)
     g_free(blixem_data->fastAFile);
   if (blixem_data->gff_file)
     g_free(blixem_data->gff_file);
+  if (blixem_data->gff_index_file)
+    g_free(blixem_data->gff_index_file);
   if (blixem_data->line)
     g_string_free(blixem_data->line, TRUE ) ;
+  if (blixem_data->gff_text)
+    g_string_free(blixem_data->gff_text, TRUE) ;
   if (blixem_data->attribute_flags)
     g_free(blixem_data->attribute_flags) ;
   if (blixem_data->netid)
@@ -804,6 +948,28 @@ static void getUserPrefsFile(ZMapView view,
           file_prefs->is_set.sleep_on_startup = TRUE ;
         }
 
+      if (zMapConfigIniContextGetString(context, ZMAPSTANZA_BLIXEM_CONFIG, ZMAPSTANZA_BLIXEM_CONFIG,
+                                       ZMAPSTANZA_BLIXEM_FILE_FORMAT, &tmp_string))
+        {
+          if (tmp_string && g_ascii_strcasecmp(tmp_string, ZMAPSTANZA_BLIXEM_FILE_OPT_GFF_BGZF) == 0)
+            {
+              file_prefs->bgzf_features = TRUE ;
+              file_prefs->is_set.bgzf_features = TRUE ;
+            }
+          else if (tmp_string && g_ascii_strcasecmp(tmp_string, ZMAPSTANZA_BLIXEM_FILE_OPT_GFF) == 0)
+            {
+              file_prefs->bgzf_features = FALSE ;
+              file_prefs->is_set.bgzf_features = TRUE ;
+            }
+          else if (tmp_string)
+            {
+              zMapLogWarning("Unsupported blixem %s \"%s\", using \"%s\".",
+                             ZMAPSTANZA_BLIXEM_FILE_FORMAT, tmp_string, ZMAPSTANZA_BLIXEM_FILE_OPT_GFF) ;
+            }
+
+          g_free(tmp_string) ;
+        }
+
       if (zMapConfigIniContextGetBoolean(context, ZMAPSTANZA_BLIXEM_CONFIG, ZMAPSTANZA_BLIXEM_CONFIG,
                                         ZMAPSTANZA_BLIXEM_KILL_EXIT, &tmp_bool))
         {
@@ -975,6 +1141,12 @@ static void overridePrefs(BlixemConfigData dest_prefs, BlixemConfigData src_pref
           dest_prefs->is_set.sleep_on_startup = TRUE ;
         }
 
+      if (src_prefs->is_set.bgzf_features)
+        {
+          dest_prefs->bgzf_features = src_prefs->bgzf_features ;
+          dest_prefs->is_set.bgzf_features = TRUE ;
+        }
+
       if (src_prefs->is_set.kill_on_exit)
         {
           dest_prefs->kill_on_exit = src_prefs->kill_on_exit ;
@@ -1062,6 +1234,8 @@ static void setPrefs(BlixemConfigData curr_prefs, ZMapBlixemData blixem_data)
 
   blixem_data->sleep_on_startup = curr_prefs->sleep_on_startup ;
 
+  blixem_data->bgzf_features = curr_prefs->bgzf_features ;
+
   blixem_data->kill_on_exit = curr_prefs->kill_on_exit ;
 
   if (blixem_data->assoc_featuresets)
@@ -1535,27 +1709,10 @@ static gboolean writeGFFHeader(ZMapBlixemData blixem_data)
   gboolean status = FALSE ;
   zMapReturnValIfFail(blixem_data, status) ;
 
-  /* Get the GFF header text */
-  zMapGFFFormatHeader(TRUE, blixem_data->line,
-                      g_quark_to_string(blixem_data->block->original_id), 
-                      blixem_data->features_min, blixem_data->features_max) ;
-
-  /* Initialise the output file with the header text */
-  char * err_out = NULL ;
-
-  status = initFeatureFile(blixem_data->gff_file, blixem_data->line,
-                           &(blixem_data->gff_channel), &err_out) ;
-
-  if (!status)
-    {
-      blixem_data->errorMsg =
-        g_strdup_printf("Error in zMapViewCallBlixem::writeFeatureFiles(); could not open '%s'.",
-                        blixem_data->gff_file) ;
-      if (err_out)
-        {
-          g_free(err_out) ;
-        }
-    }
+  /* Start the GFF text with the header, the file is written once all the features are added. */
+  status = zMapGFFFormatHeader(FALSE, blixem_data->gff_text,
+                               g_quark_to_string(blixem_data->block->original_id), 
+                               blixem_data->features_min, blixem_data->features_max) ;
 
   return status ;
 }
@@ -1631,9 +1788,15 @@ static void writeRequestedHomologyList(ZMapBlixemData blixem_data)
   /* If a max number of homols is set, clip the list to it */
   limitToMaxHomol(blixem_data) ;
 
-  /* Write the alignments in the list to the file */
+  /* Write the alignments in the list to the file, formatting any not in the cache first. */
   if (blixem_data->align_list)
-    g_list_foreach(blixem_data->align_list, writeFeatureLineList, blixem_data) ;
+    {
+      blixem_data->collect = g_ptr_array_new() ;
+      g_list_foreach(blixem_data->align_list, writeFeatureLineList, blixem_data) ;
+      cacheFormatCollected(blixem_data) ;
+
+      g_list_foreach(blixem_data->align_list, writeFeatureLineList, blixem_data) ;
+    }
 }
 
 
@@ -1733,8 +1896,8 @@ static void writeBAMLine(ZMapBlixemData blixem_data, const GQuark featureset_id,
           g_string_append_c(blixem_data->line, '\n') ;
           g_string_truncate(attribute, (gsize)0);
 
-          zMapGFFOutputWriteLineToGIO(blixem_data->gff_channel, &(blixem_data->errorMsg),
-                                      blixem_data->line, TRUE) ;
+          g_string_append_len(blixem_data->gff_text, blixem_data->line->str, blixem_data->line->len) ;
+          g_string_truncate(blixem_data->line, (gsize)0) ;
         }
     }
 
@@ -2029,6 +2192,12 @@ static gboolean writeFeatureFiles(ZMapBlixemData blixem_data)
           blixem_data->do_transcripts = TRUE ;
           blixem_data->do_basic = TRUE ;
 
+          /* First pass just collects the features so any not in the cache can be formatted
+           * together. */
+          blixem_data->collect = g_ptr_array_new() ;
+          g_hash_table_foreach(feature_set->features, writeFeatureLineHash, blixem_data) ;
+          cacheFormatCollected(blixem_data) ;
+
           g_hash_table_foreach(feature_set->features, writeFeatureLineHash, blixem_data) ;
         }
 
@@ -2041,6 +2210,10 @@ static gboolean writeFeatureFiles(ZMapBlixemData blixem_data)
           blixem_data->do_transcripts = TRUE ;
           blixem_data->do_basic = TRUE ;
 
+          blixem_data->collect = g_ptr_array_new() ;
+          g_list_foreach(blixem_data->assoc_featuresets, writeFeatureSetList, blixem_data) ;
+          cacheFormatCollected(blixem_data) ;
+
           g_list_foreach(blixem_data->assoc_featuresets, writeFeatureSetList, blixem_data) ;
         }
       else
@@ -2049,10 +2222,17 @@ static gboolean writeFeatureFiles(ZMapBlixemData blixem_data)
           blixem_data->do_transcripts = TRUE ;
           blixem_data->do_basic = TRUE ;
 
+          blixem_data->collect = g_ptr_array_new() ;
+          g_hash_table_foreach(blixem_data->block->feature_sets, writeFeatureSetHash, blixem_data) ;
+          cacheFormatCollected(blixem_data) ;
+
           g_hash_table_foreach(blixem_data->block->feature_sets, writeFeatureSetHash, blixem_data) ;
         }
     }
 
+  if (status && !blixem_data->errorMsg)
+    status = writeGFFFile(blixem_data) ;
+
   /* If there was an error writing the data to the file it will
    * be recorded in blixem_data->errorMsg and no further processing will have occurred. */
   if (blixem_data->errorMsg)
@@ -2070,6 +2250,39 @@ static gboolean writeFeatureFiles(ZMapBlixemData blixem_data)
         g_free(channel_error);
     }
 
+  /* Optionally send blixem the features as bgzip'd, sorted GFF with a tabix index, if that
+   * fails we fall back to sending the plain file. */
+  if (status && blixem_data->bgzf_features)
+    {
+      char *bgzf_file ;
+      GError *bgzf_error = NULL ;
+
+      bgzf_file = g_strdup_printf("%s.gz", blixem_data->gff_file) ;
+
+      if (zMapGFFFileToBGZF(blixem_data->gff_file, bgzf_file, &bgzf_error))
+        {
+          g_unlink(blixem_data->gff_file) ;
+          g_free(blixem_data->gff_file) ;
+          blixem_data->gff_file = bgzf_file ;
+          blixem_data->gff_index_file = g_strdup_printf("%s.tbi", bgzf_file) ;
+        }
+      else
+        {
+          char *index_file ;
+
+          zMapLogWarning("Could not compress blixem features file \"%s\", sending it uncompressed: %s",
+                         blixem_data->gff_file, bgzf_error->message) ;
+
+          index_file = g_strdup_printf("%s.tbi", bgzf_file) ;
+          g_unlink(index_file) ;
+          g_free(index_file) ;
+
+          g_error_free(bgzf_error) ;
+          g_unlink(bgzf_file) ;
+          g_free(bgzf_file) ;
+        }
+    }
+
   blixem_data->features_min = start ;
   blixem_data->features_max = end ;
    
@@ -2205,83 +2418,129 @@ static gboolean includeFeature(ZMapBlixemData blixem_data, ZMapFeature feature)
 }
 
 
-/* Write out the given feature to file if it is an alignment and it is of the correct type */
-static gboolean writeFeatureLineAlignment(ZMapBlixemData blixem_data, ZMapFeature feature)
+/* Returns TRUE if the feature is of a type that is being written out, the rules are
+ * different for each type of feature. */
+static gboolean includeFeatureType(ZMapBlixemData blixem_data, ZMapFeature feature)
 {
-  gboolean status = FALSE ;
-  zMapReturnValIfFail(blixem_data && feature, status) ;
+  gboolean include_feature = FALSE ;
+  zMapReturnValIfFail(blixem_data && feature, include_feature) ;
 
-  if (blixem_data->do_alignments &&
-      feature->mode == ZMAPSTYLE_MODE_ALIGNMENT && 
-      feature->feature.homol.type == blixem_data->align_type)
+  if (feature->mode == ZMAPSTYLE_MODE_ALIGNMENT)
     {
-      if (   (*blixem_data->opts == 'X' && feature->feature.homol.type == ZMAPHOMOL_X_HOMOL)
-             || (*blixem_data->opts == 'N' && feature->feature.homol.type == ZMAPHOMOL_N_HOMOL))
+      /* Alignments must be of the correct type. */
+      if (blixem_data->do_alignments && feature->feature.homol.type == blixem_data->align_type)
         {
-          /*
-           * this if could be tidied up, but let's leave existing logic alone
-           * of old 'local sequence' meant in ACEDB, for BAM we get it in GFF and save it in the feature
-           */
-          char *seq_str = NULL ;
-          GList *list_ptr = NULL ;
-          if((list_ptr = g_list_find_custom(blixem_data->local_sequences, feature, findFeature)))
-            {
-              ZMapSequence sequence = (ZMapSequence)list_ptr->data ;
-              seq_str = sequence->sequence ;
-            }
-          
-          status = zMapGFFFormatAttributeSetAlignment(blixem_data->attribute_flags) ;
-
-          status &= zMapGFFWriteFeatureAlignment(feature, blixem_data->attribute_flags, blixem_data->line,
-                                                 blixem_data->over_write, seq_str) ;
+          if (   (*blixem_data->opts == 'X' && feature->feature.homol.type == ZMAPHOMOL_X_HOMOL)
+                 || (*blixem_data->opts == 'N' && feature->feature.homol.type == ZMAPHOMOL_N_HOMOL))
+            include_feature = TRUE ;
         }
     }
+  else if (feature->mode == ZMAPSTYLE_MODE_TRANSCRIPT)
+    {
+      ZMapFeatureSet feature_set = (ZMapFeatureSet)(feature->parent) ;
+      GQuark feature_set_id = feature_set->unique_id ;
 
-  return status ;
+      // Complicated but user can click on a transcript column and then we can end up
+      // exporting some transcripts twice, once for the column clicked on and once for the
+      // transcript set.
+      if (blixem_data->do_transcripts
+          && (blixem_data->align_set != ZMAPWINDOW_ALIGNCMD_NONE
+              || ((!(blixem_data->assoc_featuresets)
+                   || !(g_list_find(blixem_data->assoc_featuresets, GINT_TO_POINTER(feature_set_id)))))))
+        include_feature = TRUE ;
+    }
+  else if (feature->mode == ZMAPSTYLE_MODE_BASIC)
+    {
+      include_feature = blixem_data->do_basic ;
+    }
+
+  return include_feature ;
 }
 
 
-/* Write out the given feature to file if it is a transcript */
-static gboolean writeFeatureLineTranscript(ZMapBlixemData blixem_data, ZMapFeature feature)
+/* Format the given alignment into line. */
+static gboolean formatFeatureLineAlignment(ZMapBlixemData blixem_data, ZMapFeature feature,
+                                           GString *line, ZMapGFFAttributeFlags attribute_flags)
 {
   gboolean status = FALSE ;
   zMapReturnValIfFail(blixem_data && feature, status) ;
 
-  if (blixem_data->do_transcripts && feature->mode == ZMAPSTYLE_MODE_TRANSCRIPT)
+  /*
+   * this if could be tidied up, but let's leave existing logic alone
+   * of old 'local sequence' meant in ACEDB, for BAM we get it in GFF and save it in the feature
+   */
+  char *seq_str = NULL ;
+  GList *list_ptr = NULL ;
+  if((list_ptr = g_list_find_custom(blixem_data->local_sequences, feature, findFeature)))
     {
-      ZMapFeatureSet feature_set = (ZMapFeatureSet)(feature->parent) ;
-      GQuark feature_set_id = feature_set->unique_id ;
+      ZMapSequence sequence = (ZMapSequence)list_ptr->data ;
+      seq_str = sequence->sequence ;
+    }
 
-      // Complicated but user can click on a transcript column and then we can end up
-      // exporting some transcripts twice, once for the column clicked on and once for the
-      // transcript set.
-      if (blixem_data->align_set != ZMAPWINDOW_ALIGNCMD_NONE
-          || ((!(blixem_data->assoc_featuresets)
-               || !(g_list_find(blixem_data->assoc_featuresets, GINT_TO_POINTER(feature_set_id))))))
-        {
-          status = zMapGFFFormatAttributeSetTranscript(blixem_data->attribute_flags) ;
+  status = zMapGFFFormatAttributeSetAlignment(attribute_flags) ;
 
-          status &= zMapGFFWriteFeatureTranscript(feature, blixem_data->attribute_flags,
-                                                  blixem_data->line, blixem_data->over_write) ;
-        }
-    }
+  status &= zMapGFFWriteFeatureAlignment(feature, attribute_flags, line,
+                                         blixem_data->over_write, seq_str) ;
 
   return status ;
 }
 
 
-static gboolean writeFeatureLineBasic(ZMapBlixemData blixem_data, ZMapFeature feature)
+/* Format the given transcript into line. */
+static gboolean formatFeatureLineTranscript(ZMapBlixemData blixem_data, ZMapFeature feature,
+                                            GString *line, ZMapGFFAttributeFlags attribute_flags)
 {
   gboolean status = FALSE ;
   zMapReturnValIfFail(blixem_data && feature, status) ;
 
-  if (blixem_data->do_basic && feature->mode == ZMAPSTYLE_MODE_BASIC)
-    {
-      status = zMapGFFFormatAttributeSetBasic(blixem_data->attribute_flags) ;
+  status = zMapGFFFormatAttributeSetTranscript(attribute_flags) ;
 
-      status &= zMapGFFWriteFeatureBasic(feature, blixem_data->attribute_flags,
-                                         blixem_data->line, blixem_data->over_write) ;
-    }
+  status &= zMapGFFWriteFeatureTranscript(feature, attribute_flags,
+                                          line, blixem_data->over_write) ;
+
+  return status ;
+}
+
+
+static gboolean formatFeatureLineBasic(ZMapBlixemData blixem_data, ZMapFeature feature,
+                                       GString *line, ZMapGFFAttributeFlags attribute_flags)
+{
+  gboolean status = FALSE ;
+  zMapReturnValIfFail(blixem_data && feature, status) ;
+
+  status = zMapGFFFormatAttributeSetBasic(attribute_flags) ;
+
+  status &= zMapGFFWriteFeatureBasic(feature, attribute_flags,
+                                     line, blixem_data->over_write) ;
+
+  return status ;
+}
+
+
+/* Formats the GFF for a feature into line, this is called from worker threads so it must
+ * only change the feature it's given and line/attribute_flags. */
+static gboolean formatFeatureLine(ZMapBlixemData blixem_data, ZMapFeature feature,
+                                  GString *line, ZMapGFFAttributeFlags attribute_flags)
+{
+  gboolean status = FALSE ;
+
+  /* First, revcomp the feature if necessary */
+  if (zMapViewGetRevCompStatus(blixem_data->view))
+    zMapFeatureReverseComplement(blixem_data->view->features, feature) ;
+
+  /* Unset any GFF attributes */
+  zMapGFFFormatAttributeUnsetAll(attribute_flags) ;
+
+  if (feature->mode == ZMAPSTYLE_MODE_ALIGNMENT)
+    status = formatFeatureLineAlignment(blixem_data, feature, line, attribute_flags) ;
+  else if (feature->mode == ZMAPSTYLE_MODE_TRANSCRIPT)
+    status = formatFeatureLineTranscript(blixem_data, feature, line, attribute_flags) ;
+  else if (feature->mode == ZMAPSTYLE_MODE_BASIC)
+    status = formatFeatureLineBasic(blixem_data, feature, line, attribute_flags) ;
+
+  /* Undo any revcomp */
+  if (zMapViewGetRevCompStatus(blixem_data->view))
+    zMapFeatureReverseComplement(blixem_data->view->features, feature) ;
 
   return status ;
 }
@@ -2301,34 +2560,26 @@ static void writeFeatureLine(ZMapFeature feature, ZMapBlixemData  blixem_data)
    * following rules (inherited from acedb): alignment features must be wholly within the
    * blixem max/min to be included, for transcripts we include as many introns/exons as will fit. */
 
-  if (includeFeature(blixem_data, feature))
+  if (includeFeature(blixem_data, feature) && includeFeatureType(blixem_data, feature))
     {
-      /* First, revcomp the feature if necessary */
-      if (zMapViewGetRevCompStatus(blixem_data->view))
-        zMapFeatureReverseComplement(blixem_data->view->features, feature) ;
-
-      /* Unset any GFF attributes */
-      zMapGFFFormatAttributeUnsetAll(blixem_data->attribute_flags) ;
-
-      gboolean status = FALSE ;
+      const char *cached_line ;
 
-      if (feature->mode == ZMAPSTYLE_MODE_ALIGNMENT)
-        status = writeFeatureLineAlignment(blixem_data, feature) ;
-      else if (feature->mode == ZMAPSTYLE_MODE_TRANSCRIPT)
-        status = writeFeatureLineTranscript(blixem_data, feature) ;
-      else if (feature->mode == ZMAPSTYLE_MODE_BASIC)
-        status = writeFeatureLineBasic(blixem_data, feature) ;
-
-      if (status)
+      if (blixem_data->collect)
         {
-          status = zMapGFFOutputWriteLineToGIO(blixem_data->gff_channel,
-                                               &(blixem_data->errorMsg),
-                                               blixem_data->line, TRUE) ;
+          /* Just finding out which features will be written. */
+          g_ptr_array_add(blixem_data->collect, feature) ;
         }
+      else if ((cached_line = cacheFindLine(blixem_data, feature)))
+        {
+          g_string_append(blixem_data->gff_text, cached_line) ;
+        }
+      else if (formatFeatureLine(blixem_data, feature, blixem_data->line, blixem_data->attribute_flags))
+        {
+          cacheAddLine(blixem_data, feature, blixem_data->line->str, blixem_data->line->len) ;
 
-      /* Undo any revcomp */
-      if (zMapViewGetRevCompStatus(blixem_data->view))
-        zMapFeatureReverseComplement(blixem_data->view->features, feature) ;
+          g_string_append_len(blixem_data->gff_text, blixem_data->line->str, blixem_data->line->len) ;
+          g_string_truncate(blixem_data->line, (gsize)0) ;
+        }
     }
 
   return ;
@@ -2482,7 +2733,7 @@ static gint scoreOrderCB(gconstpointer a, gconstpointer b)
  * THE CODING LOGIC IS HORRIBLE HERE BUT I DON'T HAVE ANY TIME TO CORRECT IT NOW, EG.
  *
  *  */
-static gboolean writeFastAFile(ZMapBlixemData blixem_data)
+static gboolean writeFastADNA(ZMapBlixemData blixem_data)
 {
   gboolean status = TRUE ;
   gsize bytes_written ;
@@ -2618,6 +2869,362 @@ static gboolean writeFastAFile(ZMapBlixemData blixem_data)
 
 
 
+/* Writes the fasta file unless the dna is the same as last time, in which case the last file
+ * is linked to the new name. */
+static gboolean writeFastAFile(ZMapBlixemData blixem_data)
+{
+  gboolean status = FALSE ;
+  ZMapViewBlixemCache cache = blixem_data->cache ;
+  char *fasta_key ;
+
+  /* The dna only changes with the region and strand. */
+  fasta_key = g_strdup_printf("%s:%d-%d:%c",
+                              g_quark_to_string(blixem_data->block->unique_id),
+                              blixem_data->scope_min, blixem_data->scope_max,
+                              (zMapViewGetRevCompStatus(blixem_data->view) ? '-' : '+')) ;
+
+  if (cache->fasta_key && strcmp(fasta_key, cache->fasta_key) == 0
+      && cacheReuseFile(cache->fasta_file, blixem_data->fastAFile))
+    {
+      status = TRUE ;
+
+      g_free(fasta_key) ;
+    }
+  else if ((status = writeFastADNA(blixem_data)))
+    {
+      g_free(cache->fasta_key) ;
+      cache->fasta_key = NULL ;
+
+      if (cacheKeepFile(&(cache->fasta_file), blixem_data->fastAFile))
+        cache->fasta_key = fasta_key ;
+      else
+        g_free(fasta_key) ;
+    }
+  else
+    {
+      g_free(fasta_key) ;
+    }
+
+  return status ;
+}
+
+
+/* Writes the gff text to the gff file unless it's the same as last time, in which case the last
+ * file is linked to the new name. */
+static gboolean writeGFFFile(ZMapBlixemData blixem_data)
+{
+  gboolean status = FALSE ;
+  ZMapViewBlixemCache cache = blixem_data->cache ;
+  char *digest ;
+
+  digest = g_compute_checksum_for_data(G_CHECKSUM_MD5,
+                                       (const guchar *)(blixem_data->gff_text->str),
+                                       blixem_data->gff_text->len) ;
+
+  if (cache->gff_digest && strcmp(digest, cache->gff_digest) == 0
+      && cacheReuseFile(cache->gff_file, blixem_data->gff_file))
+    {
+      status = TRUE ;
+
+      g_free(digest) ;
+    }
+  else
+    {
+      char *err_out = NULL ;
+
+      if ((status = initFeatureFile(blixem_data->gff_file, blixem_data->gff_text,
+                                    &(blixem_data->gff_channel), &err_out)))
+        {
+          g_free(cache->gff_digest) ;
+          cache->gff_digest = NULL ;
+
+          /* The link is to the same file so it's fine that the channel is still open. */
+          if (cacheKeepFile(&(cache->gff_file), blixem_data->gff_file))
+            cache->gff_digest = digest ;
+          else
+            g_free(digest) ;
+        }
+      else
+        {
+          blixem_data->errorMsg =
+            g_strdup_printf("Error in zMapViewCallBlixem::writeFeatureFiles(); could not write '%s'.",
+                            blixem_data->gff_file) ;
+
+          if (err_out)
+            g_free(err_out) ;
+
+          g_free(digest) ;
+        }
+    }
+
+  return status ;
+}
+
+
+static ZMapViewBlixemCache cacheCreate(void)
+{
+  ZMapViewBlixemCache cache ;
+
+  cache = g_new0(ZMapViewBlixemCacheStruct, 1) ;
+
+  cache->sets = g_hash_table_new_full(NULL, NULL, NULL, cacheDestroySetCB) ;
+
+  return cache ;
+}
+
+
+static void cacheDestroySetCB(gpointer data)
+{
+  BlixemCacheSet cache_set = (BlixemCacheSet)data ;
+
+  g_hash_table_destroy(cache_set->lines) ;
+  g_string_chunk_free(cache_set->strings) ;
+  g_free(cache_set) ;
+
+  return ;
+}
+
+
+/* Returns the cache for the feature's featureset, creating it if need be, or NULL if the
+ * feature's line can't be cached. */
+static BlixemCacheSet cacheGetSet(ZMapBlixemData blixem_data, ZMapFeature feature)
+{
+  BlixemCacheSet cache_set = NULL ;
+  ZMapFeatureSet feature_set = (ZMapFeatureSet)(feature->parent) ;
+
+  /* Alignments may include sequences fetched just for this blixem. */
+  if (feature_set && !(feature->mode == ZMAPSTYLE_MODE_ALIGNMENT && blixem_data->local_sequences))
+    {
+      gpointer key = GUINT_TO_POINTER(feature_set->unique_id) ;
+
+      if (!(cache_set = (BlixemCacheSet)g_hash_table_lookup(blixem_data->cache->sets, key))
+          || cache_set->feature_set != feature_set)
+        {
+          cache_set = g_new0(BlixemCacheSetStruct, 1) ;
+
+          cache_set->feature_set = feature_set ;
+          cache_set->strings = g_string_chunk_new(BLIXEM_CACHE_CHUNK_FEATURES * 160) ;
+          cache_set->lines = g_hash_table_new_full(NULL, NULL, NULL, g_free) ;
+
+          g_hash_table_replace(blixem_data->cache->sets, key, cache_set) ;
+        }
+    }
+
+  return cache_set ;
+}
+
+
+/* Returns the cached gff for the feature or NULL if there isn't any. */
+static const char *cacheFindLine(ZMapBlixemData blixem_data, ZMapFeature feature)
+{
+  const char *line = NULL ;
+  BlixemCacheSet cache_set ;
+  BlixemCacheLine cache_line ;
+
+  if ((cache_set = cacheGetSet(blixem_data, feature))
+      && (cache_line = (BlixemCacheLine)g_hash_table_lookup(cache_set->lines,
+                                                            GUINT_TO_POINTER(feature->unique_id)))
+      && cache_line->feature == feature)
+    line = cache_line->line ;
+
+  return line ;
+}
+
+
+static void cacheAddLine(ZMapBlixemData blixem_data, ZMapFeature feature, const char *line, gsize len)
+{
+  BlixemCacheSet cache_set ;
+
+  if ((cache_set = cacheGetSet(blixem_data, feature)))
+    {
+      BlixemCacheLine cache_line ;
+
+      cache_line = g_new(BlixemCacheLineStruct, 1) ;
+      cache_line->feature = feature ;
+      cache_line->line = g_string_chunk_insert_len(cache_set->strings, line, len) ;
+
+      g_hash_table_replace(cache_set->lines, GUINT_TO_POINTER(feature->unique_id), cache_line) ;
+    }
+
+  return ;
+}
+
+
+/* Formats the collected features that aren't already in the cache and adds them to it, this is
+ * done a chunk of features at a time on the shared thread pool. Collecting is finished afterwards. */
+static void cacheFormatCollected(ZMapBlixemData blixem_data)
+{
+  GPtrArray *missing ;
+  BlixemFormatJob jobs = NULL ;
+  int n_jobs, i ;
+  guint j ;
+
+  missing = g_ptr_array_new() ;
+
+  for (j = 0 ; j < blixem_data->collect->len ; j++)
+    {
+      ZMapFeature feature = (ZMapFeature)g_ptr_array_index(blixem_data->collect, j) ;
+
+      if (cacheGetSet(blixem_data, feature) && !cacheFindLine(blixem_data, feature))
+        g_ptr_array_add(missing, feature) ;
+    }
+
+  g_ptr_array_free(blixem_data->collect, TRUE) ;
+  blixem_data->collect = NULL ;
+
+  n_jobs = (missing->len + BLIXEM_CACHE_CHUNK_FEATURES - 1) / BLIXEM_CACHE_CHUNK_FEATURES ;
+
+  if (n_jobs)
+    jobs = g_new0(BlixemFormatJobStruct, n_jobs) ;
+
+  for (i = 0 ; i < n_jobs ; i++)
+    {
+      BlixemFormatJob job = &jobs[i] ;
+
+      job->blixem_data = blixem_data ;
+      job->features = &(missing->pdata[i * BLIXEM_CACHE_CHUNK_FEATURES]) ;
+      job->n_features = MIN((guint)BLIXEM_CACHE_CHUNK_FEATURES, missing->len - (i * BLIXEM_CACHE_CHUNK_FEATURES)) ;
+      job->attribute_flags = g_new0(ZMapGFFAttributeFlagsStruct, 1) ;
+      job->text = g_string_sized_new(job->n_features * 160) ;
+      job->ends = g_array_sized_new(FALSE, FALSE, sizeof(gsize), job->n_features) ;
+    }
+
+  if (n_jobs)
+    {
+      GList *job_list = NULL ;
+
+      for (i = n_jobs - 1 ; i >= 0 ; i--)
+        job_list = g_list_prepend(job_list, &jobs[i]) ;
+
+      zMap_g_thread_pool_run(job_list, cacheFormatJobCB, "format blixem features") ;
+
+      g_list_free(job_list) ;
+    }
+
+  /* The cache is only touched from here. */
+  for (i = 0 ; i < n_jobs ; i++)
+    {
+      BlixemFormatJob job = &jobs[i] ;
+      gsize start = 0 ;
+
+      for (j = 0 ; j < job->n_features ; j++)
+        {
+          gsize end = g_array_index(job->ends, gsize, j) ;
+
+          if (end > start)
+            cacheAddLine(blixem_data, (ZMapFeature)(job->features[j]), job->text->str + start, end - start) ;
+
+          start = end ;
+        }
+
+      g_array_free(job->ends, TRUE) ;
+      g_string_free(job->text, TRUE) ;
+      g_free(job->attribute_flags) ;
+    }
+
+  g_free(jobs) ;
+  g_ptr_array_free(missing, TRUE) ;
+
+  return ;
+}
+
+
+/* Runs in a worker thread, formats each of the job's features into its text. */
+static void cacheFormatJobCB(gpointer data, gpointer user_data)
+{
+  BlixemFormatJob job = (BlixemFormatJob)data ;
+  GString *line ;
+  guint i ;
+
+  line = g_string_new(NULL) ;
+
+  for (i = 0 ; i < job->n_features ; i++)
+    {
+      gsize end ;
+
+      if (formatFeatureLine(job->blixem_data, (ZMapFeature)(job->features[i]), line, job->attribute_flags))
+        g_string_append_len(job->text, line->str, line->len) ;
+
+      end = job->text->len ;
+      g_array_append_val(job->ends, end) ;
+    }
+
+  g_string_free(line, TRUE) ;
+
+  return ;
+}
+
+
+/* Replaces file with a link to cache_file, the file's name is kept as it's been passed to
+ * blixem. */
+static gboolean cacheReuseFile(const char *cache_file, const char *file)
+{
+  gboolean result = FALSE ;
+
+  if (cache_file)
+    {
+      char *link_file ;
+
+      link_file = g_strdup_printf("%s.link", file) ;
+
+      if (link(cache_file, link_file) == 0)
+        {
+          if (g_rename(link_file, file) == 0)
+            result = TRUE ;
+          else
+            g_unlink(link_file) ;
+        }
+
+      g_free(link_file) ;
+    }
+
+  return result ;
+}
+
+
+/* Makes a link to file to keep it after blixem has removed it, replacing any previous link. */
+static gboolean cacheKeepFile(char **cache_file_inout, const char *file)
+{
+  gboolean result = FALSE ;
+  char *cache_file ;
+
+  if (*cache_file_inout)
+    {
+      g_unlink(*cache_file_inout) ;
+      g_free(*cache_file_inout) ;
+      *cache_file_inout = NULL ;
+    }
+
+  cache_file = g_strdup_printf("%s.cache", file) ;
+
+  if (link(file, cache_file) == 0)
+    {
+      *cache_file_inout = cache_file ;
+      result = TRUE ;
+    }
+  else
+    {
+      g_free(cache_file) ;
+    }
+
+  return result ;
+}
+
+
+/* Called when blixem exits to remove the tabix index of its gff file. */
+static void blixemExitCB(GPid child_pid, gint child_status, gpointer user_data)
+{
+  char *index_file = (char *)user_data ;
+
+  g_unlink(index_file) ;
+  g_free(index_file) ;
+
+  g_spawn_close_pid(child_pid) ;
+
+  return ;
+}
+
+
 gboolean makeTmpfile(const char *tmp_dir, const char *file_prefix, char **tmp_file_name_out)
 {
   gboolean status = FALSE ;
@@ -287,7 +287,8 @@ static GList *squashStrand(GList *fl, GHashTable *ghash,  GList **splice_list)
   while(fl)
     {
       f = (ZMapFeature) fl->data;
-      f->population = 1;
+      if(!f->population)	/* may already count duplicates merged during parsing */
+	f->population = 1;
       squash_this = FALSE;
 
 #if SQUASH_DEBUG
@@ -295,7 +296,7 @@ static GList *squashStrand(GList *fl, GHashTable *ghash,  GList **splice_list)
 	ZMapAlignBlock ab;
 	GArray *f_gaps = f->feature.homol.align;
 
-	zMapLogMessage("feature: %s %d,%d\n",g_quark_to_string(f->original_id), f->x1,f->x2);
+	zMapLogMessage("feature: %s %d,%d\n",zMapFeatureIDToString(f->original_id), f->x1,f->x2);
 
 	if (f_gaps) for(i = 0;i < f_gaps->len; i++)
 	  {
@@ -330,7 +331,7 @@ static GList *squashStrand(GList *fl, GHashTable *ghash,  GList **splice_list)
       if(squash_this && composite)
 	{
 	  composite->children = g_list_prepend(composite->children,f);
-	  composite->population++;
+	  composite->population += f->population;
 	  f->composite = composite;
 	}
 
@@ -395,7 +396,7 @@ static GList *squashStrand(GList *fl, GHashTable *ghash,  GList **splice_list)
 
 
 	      zMapLogMessage("Adding feature %s (%d, %d) to composite with y1 = %d, y2 = %d",
-			     g_quark_to_string(feature->original_id),
+			     zMapFeatureIDToString(feature->original_id),
 			     feature->x1, feature->x2, y1, y2) ;
 
 	      addCompositeFeature(ghash, composite, feature, y1, y2, len);
@@ -547,7 +548,8 @@ static GList *collapseJoinStrand(GList *fl, GHashTable *ghash, GList *splice_lis
   while(fl)
     {
       f = (ZMapFeature) fl->data ;
-      f->population = 1 ;
+      if(!f->population)	/* may already count duplicates merged during parsing */
+	f->population = 1 ;
 
       collapse_this = join_this = FALSE ;
 
@@ -578,14 +580,14 @@ static GList *collapseJoinStrand(GList *fl, GHashTable *ghash, GList *splice_lis
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
 	zMapDebugPrintf("y1, y2 now: %d, %d\n", y1, y2) ;
 	zMapDebugPrintf("Next feature (%s) has %s: %d, %d\n",
-			g_quark_to_string(f->original_id),
+			zMapFeatureIDToString(f->original_id),
 			(overlap ? "OVERLAP" : "NO OVERLAP"),
 			f->x1, f->x2) ;
 #endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
 	zMapLogMessage("y1, y2 now: %d, %d", y1, y2) ;
 	zMapLogMessage("Next feature (%s) has %s: %d, %d",
-		       g_quark_to_string(f->original_id),
+		       zMapFeatureIDToString(f->original_id),
 		       (overlap ? "OVERLAP" : "NO OVERLAP"),
 		       f->x1, f->x2) ;
       }
@@ -729,7 +731,7 @@ static GList *collapseJoinStrand(GList *fl, GHashTable *ghash, GList *splice_lis
 	{
 	  /* save list of source features for blixem */
 	  composite->children = g_list_prepend(composite->children, f) ;
-	  composite->population++ ;
+	  composite->population += f->population ;
 	  f->composite = composite ;
 	}
 
@@ -763,7 +765,7 @@ static GList *collapseJoinStrand(GList *fl, GHashTable *ghash, GList *splice_lis
 	      g_list_foreach(composite->children, dumpFeaturesCB, composite) ;
 
 	      zMapLogMessage("Adding feature %s (%d, %d) to composite with y1 = %d, y2 = %d",
-			     g_quark_to_string(feature->original_id),
+			     zMapFeatureIDToString(feature->original_id),
 			     feature->x1, feature->x2, y1, y2) ;
 
 	      addCompositeFeature(ghash, composite, feature, y1, y2, y2 - y1);
@@ -794,8 +796,11 @@ static void addCompositeFeature(GHashTable *ghash, ZMapFeature composite, ZMapFe
 {
   char buf[256];
 
-  sprintf(buf,"%d_reads_%s",composite->population,g_quark_to_string(feature->unique_id));
-  composite->unique_id = g_quark_from_string(buf);
+  sprintf(buf,"%d_reads_%s",composite->population,zMapFeatureIDToString(feature->unique_id));
+  if (zMapFeatureIDIsLocal(feature->unique_id))
+    composite->unique_id = zMapFeatureSetCreateLocalID((ZMapFeatureSet)feature->parent, buf);
+  else
+    composite->unique_id = g_quark_from_string(buf);
   sprintf(buf,"Composite_%d_reads",composite->population);
   composite->original_id = g_quark_from_string(buf);
 
@@ -812,7 +817,7 @@ static void addCompositeFeature(GHashTable *ghash, ZMapFeature composite, ZMapFe
 
 #if SQUASH_DEBUG
   zMapLogMessage("composite: %s %d,%d (%d %d %d)\n",
-	 g_quark_to_string(composite->original_id),
+	 zMapFeatureIDToString(composite->original_id),
 	 composite->x1,composite->x2,
 	 composite->flags.joined,composite->flags.squashed,composite->flags.collapsed);
 #endif
@@ -935,7 +940,7 @@ static int makeConcensusSequence(ZMapFeature composite)
 		}
 	      else
 		{
-		  bases[i * N_ALPHABET + index[(int)*seq++]] ++ ;
+		  bases[i * N_ALPHABET + index[(int)*seq++]] += f->population ;
 		}
 	    }
 
@@ -1003,7 +1008,7 @@ static int makeGaps(ZMapFeature composite, ZMapFeature feature, GList **splice_l
 	ZMapAlignBlock ab;
 	GArray *f_gaps = feature->feature.homol.align;
 
-	zMapLogMessage("feature: %s %d,%d\n",g_quark_to_string(feature->original_id), feature->x1,feature->x2);
+	zMapLogMessage("feature: %s %d,%d\n",zMapFeatureIDToString(feature->original_id), feature->x1,feature->x2);
 
 	if (f_gaps) for(i = 0;i < f_gaps->len; i++)
 	  {
@@ -1561,7 +1566,7 @@ static void dumpFeaturesCB(gpointer data, gpointer user_data)
     }
 
   zMapLogMessage("%s:\t%s\t%d\t%d\t%s\tnum_gaps: %d\t%s\t%s",
-		 g_quark_to_string(feature->original_id),
+		 zMapFeatureIDToString(feature->original_id),
 		 strand,
 		 start, end,
 		 gap_str, num_gaps,
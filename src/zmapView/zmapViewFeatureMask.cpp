@@ -59,16 +59,41 @@
 #define PDEBUG          zMapLogWarning
 
 
-/* header of list of features of the same name */
+/* A group of alignments with the same name and strand, the features are in start coord
+ * order and the groups are kept in an array on the featureset, see sortFeatureset(). */
 typedef struct _align_set
 {
       GQuark id;
       Coord x1,x2;
       gboolean masked;  /* by self */
 
+      int n_features;
+      ZMapFeature features[1];  /* really n_features long */
+
 } ZMapViewAlignSetStruct, *ZMapViewAlignSet;
 
 
+/* A group in the masked set that is covered by a group in the masker set. */
+typedef struct
+{
+  guint est;
+  guint mrna;
+}
+ZMapMaskCoverStruct, *ZMapMaskCover;
+
+
+/* One featureset to be masked by another, the covers are found in a worker thread. */
+typedef struct
+{
+  ZMapFeatureSet masked;
+  ZMapFeatureSet masker;
+  gboolean perfect;
+
+  GArray *covers;         /* ZMapMaskCoverStruct in group order, all that could mask */
+}
+ZMapMaskPairStruct, *ZMapMaskPair;
+
+
 typedef struct _ZMapMaskFeatureSetData
 {
       GList *masker;
@@ -79,6 +104,8 @@ typedef struct _ZMapMaskFeatureSetData
       GList *redisplay;       /* existing columns that get masked */
       gboolean perfect;		/* don't mask incomplete homologies */
 //      gboolean exact;		/* exact splicing always NOTE: not used but hard coding could be moved tp this flag */
+      GList *new_sets;        /* featuresets with new data, these need sorting again */
+      GList *pairs;           /* ZMapMaskPair, all the masking to be done */
 }
 ZMapMaskFeatureSetDataStruct, *ZMapMaskFeatureSetData;
 
@@ -92,9 +119,15 @@ static ZMapFeatureContextExecuteStatus maskNewFeaturesetByAll(GQuark key,
                                                          gpointer user_data,
                                                          char **error_out);
 
-static void mask_set_with_set(ZMapFeatureSet masked, ZMapFeatureSet masker,gboolean perfect);
+static void addMaskPair(ZMapMaskFeatureSetData data, ZMapFeatureSet masked, ZMapFeatureSet masker);
+static void runMaskPairs(ZMapMaskFeatureSetData data);
+static void sortFeaturesetCB(gpointer data, gpointer user_data);
+static void maskPairCB(gpointer data, gpointer user_data);
+static void applyMaskPair(ZMapMaskPair pair);
 
-static GList *sortFeatureset(ZMapFeatureSet fset);
+static GArray *mask_set_with_set(ZMapFeatureSet masked, ZMapFeatureSet masker,gboolean perfect);
+
+static GPtrArray *sortFeatureset(ZMapFeatureSet fset);
 
 
 
@@ -134,6 +167,7 @@ GList *zMapViewMaskFeatureSets(ZMapView view, GList *new_feature_set_names)
 
   data->view = view;
   data->perfect = FALSE;		/* original default */
+  data->new_sets = new_feature_set_names;
 
   /* this is the featuresets from the context not the display columns */
   for (fset = new_feature_set_names;fset;fset = fset->next)
@@ -222,6 +256,11 @@ GList *zMapViewMaskFeatureSets(ZMapView view, GList *new_feature_set_names)
 				maskOldFeaturesetByNew,
 				(gpointer) data);
     }
+
+  /* the context walks above only find what needs masking, the work is done here */
+  if(data->pairs)
+    runMaskPairs(data);
+
 #if FILE_DEBUG
   PDEBUG("%s","Completed\n");
 #endif
@@ -290,12 +329,9 @@ static ZMapFeatureContextExecuteStatus maskNewFeaturesetByAll(GQuark key,
 
             masker_set = (ZMapFeatureSet) g_hash_table_lookup(feature_any->children, GUINT_TO_POINTER(set_id));
 
-            // has new data, must need sorting
-            feature_set->masker_sorted_features = sortFeatureset(feature_set);
-
-
+            // has new data, will be sorted again by runMaskPairs()
             if(masker_set)
-              mask_set_with_set(feature_set, masker_set,cb_data->perfect);
+              addMaskPair(cb_data, feature_set, masker_set);
           }
 
         break;
@@ -313,14 +349,12 @@ static ZMapFeatureContextExecuteStatus maskNewFeaturesetByAll(GQuark key,
 
 
 
-/* order features by start coord then end coord reversed */
+/* order groups by start coord then end coord reversed */
 /* regardless of strand this still works */
-gint fsetListOrderCB(gconstpointer a, gconstpointer b)
+static gint fsetListOrderCB(gconstpointer a, gconstpointer b)
 {
-  GList *la = (GList *) a;
-  GList *lb = (GList *) b;
-  ZMapViewAlignSet sa = (ZMapViewAlignSet) la->data;
-  ZMapViewAlignSet sb = (ZMapViewAlignSet) lb->data;
+  ZMapViewAlignSet sa = *(ZMapViewAlignSet *) a;
+  ZMapViewAlignSet sb = *(ZMapViewAlignSet *) b;
 
   if(sa->x1 < sb->x1)
     return(-1);
@@ -334,35 +368,21 @@ gint fsetListOrderCB(gconstpointer a, gconstpointer b)
   return(0);
 }
 
-guint fsetListOrderKey(gconstpointer thing, int digit)
-{
-  guint coord;
-  ZMapViewAlignSet as = (ZMapViewAlignSet) thing;
-
-  if(digit < 4)
-    {
-      coord = G_MAXUINT - as->x2;        /* least significant: end coord reversed */
-    }
-  else
-    {
-      digit -= 4;
-      coord = as->x1;         /* start coord */
-    }
-
-  while (--digit >= 0)
-    coord >>= RADIX_BITS;
-  coord &= 0xff;
-
-  return coord;
-}
 
+/* sort features in random name order using their id quarks
+ * we just want features with the same name and strand to be together
+ * and then in start coord order within those
+ */
+static gint nameStartOrderCB(gconstpointer a, gconstpointer b)
+{
+  ZMapFeature fa = *(ZMapFeature *) a;
+  ZMapFeature fb = *(ZMapFeature *) b;
 
+  if(fa->strand != fb->strand)
+    return((gint) fa->strand - (gint) fb->strand);
 
-/* order feature by start coord */
-gint fsetStartOrderCB(gconstpointer a, gconstpointer b)
-{
-  ZMapFeature fa = (ZMapFeature) a;
-  ZMapFeature fb = (ZMapFeature) b;
+  if(fa->original_id != fb->original_id)
+    return(fa->original_id < fb->original_id ? -1 : 1);
 
   if(fa->x1 < fb->x1)
     return(-1);
@@ -372,127 +392,75 @@ gint fsetStartOrderCB(gconstpointer a, gconstpointer b)
 }
 
 
-
-/* sort features in random name order using thier id quarks
- * we just want features with the same name to be together
- */
-gint nameOrderCB(gconstpointer a, gconstpointer b)
+static void addFeatureCB(gpointer key, gpointer value, gpointer user_data)
 {
-  ZMapFeature fa = (ZMapFeature) a;
-  ZMapFeature fb = (ZMapFeature) b;
-
-  if(fa->strand != fb->strand)
-    return((gint) fa->strand - (gint) fb->strand);
-
-  return ((gint) fa->original_id - (gint) fb->original_id);
+  g_ptr_array_add((GPtrArray *) user_data, value);
 }
 
 
 /* related alignments have the same name but are distinct features
- * so we sort by name  and make lists of these
- * then we prepend an item to hold the start and end coord for the whole list
- *   using a noddy structure (can't get at the list end thanks to glib)
- * then we sort these into start coord then end coord reversed order
+ * so we sort by name and start coord and copy each run of these into a group
+ * with the start and end coord for the whole group
+ * then we sort the groups into start coord then end coord reversed order
+ * everything is in arrays so masking is a sweep along these
  */
-static GList *sortFeatureset(ZMapFeatureSet fset)
+static GPtrArray *sortFeatureset(ZMapFeatureSet fset)
 {
-  GList *l = NULL,*l_out = NULL;
-  GList *gl_start, *gl_end;
+  GPtrArray *features, *groups;
   ZMapViewAlignSet align_set;
-  ZMapFeature f_start,f_end,f;
+  ZMapFeature f_start,f_end;
+  guint start, end;
 
-  if(fset->masker_sorted_features)    /* free existing list of lists */
-    {
-      for(l = fset->masker_sorted_features;l;l = l->next)
-        {
-          g_list_free((GList *) l->data);
-        }
-      g_list_free(fset->masker_sorted_features);
-      fset->masker_sorted_features = NULL;
-    }
-  /* get pointers to all the features grouped according to name */
-  zMap_g_hash_table_get_data(&l, fset->features);
-  l = g_list_sort(l,nameOrderCB);
-
-  /* chop this list into lists per name group and strand
-   * sorted by start coordinate
-   * with a little header struct at the front
-   * then add to another list,
-   */
+  features = g_ptr_array_sized_new(g_hash_table_size(fset->features));
+  g_hash_table_foreach(fset->features, addFeatureCB, features);
+  g_ptr_array_sort(features, nameStartOrderCB);
 
-  for(gl_start = l;gl_start;)
+  groups = g_ptr_array_new_with_free_func(g_free);
+
+  for(start = 0;start < features->len;start = end)
     {
-      f_start = (ZMapFeature) gl_start->data;
+      f_start = (ZMapFeature) g_ptr_array_index(features, start);
 
-      for(gl_end = gl_start;gl_end;gl_end = gl_end->next)
+      for(end = start + 1;end < features->len;end++)
         {
-          f_end = (ZMapFeature) gl_end->data;
+          f_end = (ZMapFeature) g_ptr_array_index(features, end);
           if(f_end->strand != f_start->strand)
             break;
           if(f_end->original_id != f_start->original_id)
             break;
         }
 
-      if(gl_end)
-        {
-          gl_end->prev->next = NULL;
-          gl_end->prev = NULL;
-        }
-
-      gl_start = g_list_sort(gl_start,fsetStartOrderCB);
-
-      align_set = g_new0(ZMapViewAlignSetStruct,1);
-      f = (ZMapFeature) gl_start->data;
-      align_set->id = f->original_id;
-      align_set->x1 = f->x1;
+      align_set = (ZMapViewAlignSet) g_malloc0(sizeof(ZMapViewAlignSetStruct) + (end - start - 1) * sizeof(ZMapFeature));
+      align_set->id = f_start->original_id;
+      align_set->n_features = end - start;
+      memcpy(align_set->features, features->pdata + start, align_set->n_features * sizeof(ZMapFeature));
 
-      l_out = g_list_prepend(l_out, g_list_prepend(gl_start,align_set));
-      for(;gl_start;gl_start = gl_start->next)
-        {
-          f = (ZMapFeature) gl_start->data;
-          align_set->x2 = f->x2;
-        }
+      align_set->x1 = align_set->features[0]->x1;
+      align_set->x2 = align_set->features[align_set->n_features - 1]->x2;
 
-      gl_start = gl_end;
+      g_ptr_array_add(groups, align_set);
     }
 
-  /* order these lists by start coord and end coord reversed */
-
-#if MH17_test_radix_sort
-  /* see zmapRadix#Sort.c for performance stats */
-
-  printf("%s has %d items\n",g_quark_to_string(fset->unique_id),g_list_length(l_out));
-  zMapStartTimer("normal sort","");
-  { int i;
-    for(i = 0;i < 1000;i++)
-      l_out = g_list_sort(l_out,fsetListOrderCB);
-    zMapStopTimer("normal sort","");
-    zMapStartTimer("radix sort","");
-    for(i = 0;i < 1000;i++)
-      l_out = zMapRadixSort(l_out,fsetListOrderKey,8);
-    zMapStopTimer("radix sort","");
-  }
-#else
-  /* merge sort faster fot this data+key combo */
-  l_out = g_list_sort(l_out,fsetListOrderCB);
+  g_ptr_array_free(features, TRUE);
 
-#endif
-  return(l_out);
+  /* order these groups by start coord and end coord reversed */
+  g_ptr_array_sort(groups, fsetListOrderCB);
+
+  return(groups);
 }
 
-static gboolean maskOne(GList *mask_top, GList *f, GList *mask,  gboolean exact, gboolean perfect)
+static gboolean maskOne(ZMapViewAlignSet est, ZMapViewAlignSet mrna, gboolean exact, gboolean perfect)
 {
-  GList *l;
   ZMapFeature f_feat,m_feat;
-  /* NOTE f and mask point to the first feature item after the lists header structs */
+  int f, m;
 
   /* assuming strand data is not relevant and coordinates are always on fwd strand ...
    * see zmapFeature.h/ ZMapFeatureStruct.x1
-   * now match each alignment in the list to the mask
+   * now match each alignment in the group to the mask
    */
-  for(l = mask;f;f = f->next)
+  for(f = 0, m = 0;f < est->n_features;f++)
     {
-      f_feat = (ZMapFeature) f->data;
+      f_feat = est->features[f];
 #if FILE_DEBUG
       if(twitter_G) PDEBUG("fa %d-%d:",f_feat->x1,f_feat->x2);
 #endif
@@ -503,21 +471,18 @@ static gboolean maskOne(GList *mask_top, GList *f, GList *mask,  gboolean exact,
            * annotators want to see all these
            * we may add a menu option to show/hide these
            */
-          GList *last;
           ZMapFeature last_feat;
 
           if(f_feat->feature.homol.y1 != 1)
             return FALSE;
-          for(last = f;last->next; last = last->next)
-            continue;
-          last_feat = (ZMapFeature) last->data;
+          last_feat = est->features[est->n_features - 1];
           if(last_feat->feature.homol.y2 != last_feat->feature.homol.length)
             return FALSE;
         }
 
-      for(;l;l = l->next)
+      for(;m < mrna->n_features;m++)
         {
-          m_feat = (ZMapFeature) l->data;
+          m_feat = mrna->features[m];
 #if FILE_DEBUG
           if(twitter_G) PDEBUG(" ma %d-%d",m_feat->x1,m_feat->x2);
 #endif
@@ -527,13 +492,9 @@ static gboolean maskOne(GList *mask_top, GList *f, GList *mask,  gboolean exact,
 
               if(exact)   /* must match splice junctions */
                 {
-                  /*
-                   * our list of exons has a header struct at the front
-                   * so the first exon has a prev list pointer
-                   */
-                  if(f->prev != mask_top && m_feat->x1 != f_feat->x1)
+                  if(f > 0 && m_feat->x1 != f_feat->x1)
                     return(FALSE);
-                  if(f->next && m_feat->x2 != f_feat->x2)
+                  if(f < est->n_features - 1 && m_feat->x2 != f_feat->x2)
                     return(FALSE);
                 }
               break;
@@ -545,11 +506,11 @@ static gboolean maskOne(GList *mask_top, GList *f, GList *mask,  gboolean exact,
           if(exact)
             return(FALSE);    /* each block must match in turn */
         }
-      if(!l)
+      if(m == mrna->n_features)
         return(FALSE);
 
       if(exact)                     /* set up for next block */
-        l = l->next;
+        m++;
 #if FILE_DEBUG
       if(twitter_G) PDEBUG("%s","\n");
 #endif
@@ -559,15 +520,20 @@ static gboolean maskOne(GList *mask_top, GList *f, GList *mask,  gboolean exact,
   return(TRUE);
 }
 
-static void mask_set_with_set(ZMapFeatureSet masked, ZMapFeatureSet masker, gboolean perfect)
+/* Sweep along the sorted groups of both sets and return every group in masked that is covered
+ * by a group in masker, in the order they would have been tried. Both sets have been sorted
+ * already and this may run alongside other pairs so nothing is changed in the sets: which of
+ * these covers actually mask depends on what earlier pairs masked and is decided afterwards by
+ * applyMaskPair(). Groups masked before this run can't mask or be masked so are skipped here. */
+static GArray *mask_set_with_set(ZMapFeatureSet masked, ZMapFeatureSet masker, gboolean perfect)
 {
-  GList *ESTset,*mRNAset;
-  GList *EST,*mRNA;
-  ZMapViewAlignSet est,mrna;
-  GList *m;
+  GPtrArray *ESTset,*mRNAset;
+  ZMapViewAlignSet est,mrna = NULL;
+  GArray *covers;
+  guint e, first_m, m;
   gboolean exact = FALSE;
 
-  int n_masked = 0;
+  int n_covers = 0;
   int n_failed = 0;
   int n_tried = 0;
 
@@ -588,98 +554,71 @@ static void mask_set_with_set(ZMapFeatureSet masked, ZMapFeatureSet masker, gboo
 
 #if FILE_DEBUG
   PDEBUG("mask set %s with set %s\n",
-         g_quark_to_string(masked->original_id),
-         g_quark_to_string(masker->original_id));
+         zMapFeatureIDToString(masked->original_id),
+         zMapFeatureIDToString(masker->original_id));
 #endif
 
   /* for clarity we pretend we are masking an EST with an mRNA
    * but it could be EST x EST or mRNA x mRNA
    */
-  if(!masked->masker_sorted_features)
-    masked->masker_sorted_features = sortFeatureset(masked);
   ESTset = masked->masker_sorted_features;
-
-  if(!masker->masker_sorted_features)
-    masker->masker_sorted_features = sortFeatureset(masker);
   mRNAset = masker->masker_sorted_features;
+  covers = g_array_new(FALSE, FALSE, sizeof(ZMapMaskCoverStruct));
 
   /* is an EST completely covered by an mRNA?? */
-  for(;ESTset;ESTset = ESTset->next)
+  for(e = 0, first_m = 0;e < ESTset->len;e++)
     {
       n_tried++;
 
-      EST = (GList *) ESTset->data;
-      est = (ZMapViewAlignSet) EST->data;
-#if FILE_DEBUG
+      est = (ZMapViewAlignSet) g_ptr_array_index(ESTset, e);
 
-      if(0)
+      for(;first_m < mRNAset->len;first_m++)
         {
-          /* human chr4/4/4 @ 125917/ 125914  = BC022370.1
-           * 127502- = BX537887.1
-           */
-
-          twitter_G = FALSE ;
-          if(est->id == g_quark_from_string("BX537887.1"))
-            twitter_G = TRUE ;
-        }
-#endif
-      while(mRNAset)
-        {
-          mRNA = (GList *) mRNAset->data;
-          mrna = (ZMapViewAlignSet) mRNA->data;
+          mrna = (ZMapViewAlignSet) g_ptr_array_index(mRNAset, first_m);
 #if FILE_DEBUG
-          if(twitter_G) PDEBUG("find mRNA est %s %d-%d mrna %d-%d",g_quark_to_string(est->id),est->x1,est->x1,mrna->x1,mrna->x2);
+          if(twitter_G) PDEBUG("find mRNA est %s %d-%d mrna %d-%d",zMapFeatureIDToString(est->id),est->x1,est->x1,mrna->x1,mrna->x2);
 #endif
-          if(mrna->x2 > est->x1) // && mrna->x2 >= est->x2)     // why?
+          if(mrna->x2 > est->x1)
             break;
-          mRNAset = mRNAset->next;
         }
-      if(!mRNAset)                        /* no more masking possible */
+      if(first_m == mRNAset->len)           /* no more masking possible */
         break;
 
       if(est->x1 < mrna->x1)              /* is not covered */
         continue;
 
+      if(est->masked)
+        continue;
 
       /* now the mRNA starts at or before the EST and ends after the EST starts */
-      for(m = mRNAset;m && mrna->x1 <= est->x1;m = m->next)
+      for(m = first_m;m < mRNAset->len;m++)
         {
-          mRNA = (GList *) m->data;
-          mrna = (ZMapViewAlignSet) mRNA->data;
+          mrna = (ZMapViewAlignSet) g_ptr_array_index(mRNAset, m);
+
+          if(mrna->x1 > est->x1)
+            break;
 
           if(mrna == est)                     /* matching feature against self */
             continue;
 
 #if FILE_DEBUG
           if(twitter_G) PDEBUG("EST %s = %d-%d (%d), mRNA = %s %d-%d (%d)\n",
-                               g_quark_to_string(est->id), est->x1,est->x2,g_list_length(EST) - 1,
-                               g_quark_to_string(mrna->id),mrna->x1,mrna->x2, g_list_length(mRNA) - 1);
+                               zMapFeatureIDToString(est->id), est->x1,est->x2,est->n_features,
+                               zMapFeatureIDToString(mrna->id),mrna->x1,mrna->x2,mrna->n_features);
 #endif
-          if(!mrna->masked && !est->masked && mrna->x2 >= est->x2)
+          if(!mrna->masked && mrna->x2 >= est->x2)
             {
-              if(maskOne(EST,EST->next,mRNA->next,exact,perfect))
+              if(maskOne(est,mrna,exact,perfect))
                 {     /* this EST is covered by this mRNA */
-                  GList *l;
-                  ZMapFeature f;
-                  n_masked++;
+                  ZMapMaskCoverStruct cover = { e, m };
+
+                  n_covers++;
 #if FILE_DEBUG
-                  if(twitter_G) PDEBUG("%s"," masked\n");
+                  if(twitter_G) PDEBUG("%s"," covered\n");
 #endif
-                  for(l = EST->next;l;l = l->next)
-                    {
-                      f = (ZMapFeature) l->data;
-                      f->feature.homol.flags.masked = TRUE;
-
-                      /* cannot un-display here as we have no windows */
-                      /* must post-process from the view */
-                    }
-
-                  /* ideally we'd like to remove this EST from the list
-                   * but as we can have two copies of this list active (mask self)
-                   * it would be a risky procedure
-                   */
-                  est->masked = TRUE;
-                  break;
+                  /* cannot un-display here as we have no windows */
+                  /* flags are set by applyMaskPair() and displayed from the view */
+                  g_array_append_val(covers, cover);
                 }
               else
                 {
@@ -697,8 +636,10 @@ static void mask_set_with_set(ZMapFeatureSet masked, ZMapFeatureSet masker, gboo
         }
     }
 #if FILE_DEBUG
-  PDEBUG("masked %d, failed %d, tried %d of %d composite features\n", n_masked,n_failed,n_tried,g_list_length(masked->masker_sorted_features));
+  PDEBUG("covered %d, failed %d, tried %d of %d composite features\n", n_covers,n_failed,n_tried,ESTset->len);
 #endif
+
+  return covers;
 }
 
 
@@ -799,7 +740,7 @@ static ZMapFeatureContextExecuteStatus maskOldFeaturesetByNew(GQuark key,
 #if FILE_DEBUG
                         //PDEBUG("%s","has masker in block\n");
 #endif
-                        mask_set_with_set(feature_set,masker_set,cb_data->perfect);
+                        addMaskPair(cb_data, feature_set, masker_set);
                         cb_data->redisplay = g_list_prepend(cb_data->redisplay,
                                                             GUINT_TO_POINTER(feature_set->unique_id));
                       }
@@ -823,3 +764,126 @@ static ZMapFeatureContextExecuteStatus maskOldFeaturesetByNew(GQuark key,
   return status;
 }
 
+
+
+/* Remember that masked is to be masked by masker. */
+static void addMaskPair(ZMapMaskFeatureSetData data, ZMapFeatureSet masked, ZMapFeatureSet masker)
+{
+  ZMapMaskPair pair;
+
+  pair = g_new0(ZMapMaskPairStruct, 1);
+  pair->masked = masked;
+  pair->masker = masker;
+  pair->perfect = data->perfect;
+
+  data->pairs = g_list_append(data->pairs, pair);
+}
+
+
+/* Sorts all the featuresets that need it and then finds the covers for each pair of
+ * featuresets, both on the shared thread pool as they are independent of each other. The pairs
+ * are then applied here in the order they were added so the same groups get masked as when
+ * they were done one after another. */
+static void runMaskPairs(ZMapMaskFeatureSetData data)
+{
+  GHashTable *sort_sets;
+  GList *sort_list = NULL;
+  GList *l;
+
+  zMapStartTimer("MaskFeatureSets", "");
+
+  /* new data must be sorted again, old sorted sets can be used as they are */
+  sort_sets = g_hash_table_new(NULL, NULL);
+
+  for(l = data->pairs;l;l = l->next)
+    {
+      ZMapMaskPair pair = (ZMapMaskPair) l->data;
+      ZMapFeatureSet sets[2] = { pair->masked, pair->masker };
+      int i;
+
+      for(i = 0;i < 2;i++)
+        {
+          if(g_hash_table_lookup(sort_sets, sets[i]))
+            continue;
+
+          if(!sets[i]->masker_sorted_features
+             || g_list_find(data->new_sets, GUINT_TO_POINTER(sets[i]->unique_id)))
+            {
+              g_hash_table_insert(sort_sets, sets[i], sets[i]);
+              sort_list = g_list_prepend(sort_list, sets[i]);
+            }
+        }
+    }
+
+  g_hash_table_destroy(sort_sets);
+
+  zMap_g_thread_pool_run(sort_list, sortFeaturesetCB, "sort featuresets");
+  zMap_g_thread_pool_run(data->pairs, maskPairCB, "mask featuresets");
+
+  for(l = data->pairs;l;l = l->next)
+    {
+      applyMaskPair((ZMapMaskPair) l->data);
+      g_free(l->data);
+    }
+
+  g_list_free(sort_list);
+  g_list_free(data->pairs);
+  data->pairs = NULL;
+
+  zMapStopTimer("MaskFeatureSets", "");
+}
+
+
+static void sortFeaturesetCB(gpointer data, gpointer user_data)
+{
+  ZMapFeatureSet fset = (ZMapFeatureSet) data;
+
+  if(fset->masker_sorted_features)
+    g_ptr_array_free(fset->masker_sorted_features, TRUE);
+
+  fset->masker_sorted_features = sortFeatureset(fset);
+}
+
+
+static void maskPairCB(gpointer data, gpointer user_data)
+{
+  ZMapMaskPair pair = (ZMapMaskPair) data;
+
+  pair->covers = mask_set_with_set(pair->masked, pair->masker, pair->perfect);
+}
+
+
+/* Masks each group by the first of its covers whose masker group is not masked itself, as
+ * the sweep would have done had it run after the earlier pairs. */
+static void applyMaskPair(ZMapMaskPair pair)
+{
+  GPtrArray *ESTset = pair->masked->masker_sorted_features;
+  GPtrArray *mRNAset = pair->masker->masker_sorted_features;
+  guint i;
+  int j;
+
+  if(!pair->covers)
+    return;
+
+  for(i = 0;i < pair->covers->len;i++)
+    {
+      ZMapMaskCover cover = &g_array_index(pair->covers, ZMapMaskCoverStruct, i);
+      ZMapViewAlignSet est = (ZMapViewAlignSet) g_ptr_array_index(ESTset, cover->est);
+      ZMapViewAlignSet mrna = (ZMapViewAlignSet) g_ptr_array_index(mRNAset, cover->mrna);
+
+      if(est->masked || mrna->masked)
+        continue;
+
+      for(j = 0;j < est->n_features;j++)
+        est->features[j]->feature.homol.flags.masked = TRUE;
+
+      /* ideally we'd like to remove this EST from the array
+       * but as we can have two copies of this array active (mask self)
+       * it would be a risky procedure
+       */
+      est->masked = TRUE;
+    }
+
+  g_array_free(pair->covers, TRUE);
+  pair->covers = NULL;
+}
@@ -38,7 +38,9 @@
 #include <string.h>
 
 #include <ZMap/zmapGLibUtils.hpp>
+#include <ZMap/zmapString.hpp>
 #include <ZMap/zmapXML.hpp>
+#include <ZMap/zmapGFF.hpp>
 #include <ZMap/zmapRemoteCommand.hpp>
 /* We are forced to include this to get SOURCE_GROUP_DELAYED, given that this symbol is only
  * used in zmapView that's where it should be defined.....I'll move it some other time. */
@@ -125,6 +127,7 @@ typedef struct RequestDataStructName
   /* Command result. */
   RemoteCommandRCType command_rc ;
   const char *msg ;
+  char *reply_msg ;                                         /* msg if it was allocated. */
   GString *err_msg ;
 
 
@@ -182,12 +185,20 @@ typedef struct RequestDataStructName
   char *format;
 
   gboolean use_mark ;
+  gboolean reload ;                                         /* load_features refetches loaded regions. */
   GList *feature_sets ;
 
   gboolean zoomed ;
 
   int start, end ;
 
+  /* create_features reports features that cannot be created rather than failing the whole
+   * request, skip_feature tells the subfeature/feature end handlers to ignore the current one. */
+  GString *failed_features ;
+  int num_requested_features ;
+  int num_failed_features ;
+  gboolean skip_feature ;
+
 } RequestDataStruct, *RequestData ;
 
 
@@ -213,7 +224,7 @@ static void localProcessRemoteRequest(ZMapViewWindow view_window,
 static void processRequest(ZMapViewWindow view_window,
                            char *command_name, char *request,
                            RemoteCommandRCType *command_rc_out, char **reason_out,
-                           ZMapXMLUtilsEventStack *reply_out) ;
+                           ZMapXMLUtilsEventStack *reply_out, char **reply_msg_out) ;
 static CommandDescriptor cmdGetDesc(GQuark command_id) ;
 
 static gboolean xml_zmap_start_cb(gpointer user_data, ZMapXMLElement zmap_element, ZMapXMLParser parser);
@@ -228,6 +239,11 @@ static gboolean xml_feature_end_cb(gpointer user_data, ZMapXMLElement zmap_eleme
 static gboolean xml_subfeature_end_cb(gpointer user_data, ZMapXMLElement zmap_element, ZMapXMLParser parser);
 static gboolean xml_return_true_cb(gpointer user_data, ZMapXMLElement zmap_element, ZMapXMLParser parser);
 static gboolean xml_column_start_cb(gpointer user_data, ZMapXMLElement zmap_element, ZMapXMLParser parser);
+static gboolean xml_gff_end_cb(gpointer user_data, ZMapXMLElement zmap_element, ZMapXMLParser parser);
+
+static void setDefaultAlignBlock(RequestData request_data) ;
+static gboolean addGFFFeatures(RequestData request_data, char *gff_text, char **err_msg_out) ;
+static void addFailedFeature(RequestData request_data, const char *format, ...) G_GNUC_PRINTF(2, 3) ;
 
 static void copyAddFeature(gpointer key, gpointer value, gpointer user_data) ;
 static ZMapFeature createLocusFeature(ZMapFeatureContext context, ZMapFeature feature,
@@ -239,6 +255,7 @@ static void eraseFeatures(ZMapView view, RequestData request_data) ;
 static gboolean findFeature(ZMapView view, RequestData request_data) ;
 static gboolean mergeNewFeatures(ZMapView view, RequestData request_data,
                                  ZMapFeatureContext *merge_context, GList **feature_list) ;
+static gboolean createFeatures(ZMapView view, RequestData request_data) ;
 static void draw_failed_make_message(gpointer list_data, gpointer user_data) ;
 static void delete_failed_make_message(gpointer list_data, gpointer user_data) ;
 static void loadFeatures(ZMapView view, RequestData request_data) ;
@@ -263,6 +280,7 @@ static CommandDescriptorStruct command_table_G[] =
   {
     {ZACP_FIND_FEATURE,      0, FALSE, FEATURE_DONT_CARE, TRUE},
     {ZACP_CREATE_FEATURE,    0, TRUE,  FEATURE_MUST_NOT,  TRUE},
+    {ZACP_CREATE_FEATURES,   0, TRUE,  FEATURE_MUST_NOT,  TRUE},
     {ZACP_REPLACE_FEATURE,   0, TRUE,  FEATURE_MUST,      TRUE},
     {ZACP_DELETE_FEATURE,    0, TRUE,  FEATURE_MUST,      TRUE},
     {ZACP_GET_FEATURE_NAMES, 0, FALSE, FEATURE_DONT_CARE, FALSE},
@@ -298,6 +316,7 @@ static ZMapXMLObjTagFunctionsStruct view_ends_G[] =
     { "featureset", xml_featureset_end_cb },
     { "feature",    xml_feature_end_cb    },
     { "subfeature", xml_subfeature_end_cb },
+    { "gff",        xml_gff_end_cb        },
     {NULL, NULL}
   } ;
 
@@ -319,6 +338,7 @@ gboolean zMapViewProcessRemoteRequest(ZMapViewWindow view_window,
   gboolean result = FALSE ;
 
   if (strcmp(command_name, ZACP_CREATE_FEATURE) == 0
+      || strcmp(command_name, ZACP_CREATE_FEATURES) == 0
       || strcmp(command_name, ZACP_REPLACE_FEATURE) == 0
       || strcmp(command_name, ZACP_DELETE_FEATURE) == 0
       || strcmp(command_name, ZACP_FIND_FEATURE) == 0
@@ -353,11 +373,15 @@ static void localProcessRemoteRequest(ZMapViewWindow view_window,
   RemoteCommandRCType command_rc = REMOTE_COMMAND_RC_FAILED ;
   char *reason = NULL ;
   ZMapXMLUtilsEventStack reply = NULL ;
+  char *reply_msg = NULL ;
 
-  processRequest(view_window, command_name, request, &command_rc, &reason, &reply) ;
+  processRequest(view_window, command_name, request, &command_rc, &reason, &reply, &reply_msg) ;
 
   (app_reply_func)(command_name, FALSE, command_rc, reason, reply, app_reply_data) ;
 
+  /* The reply refers to the message so it can only go now. */
+  g_free(reply_msg) ;
+
   return ;
 }
 
@@ -366,7 +390,7 @@ static void localProcessRemoteRequest(ZMapViewWindow view_window,
 static void processRequest(ZMapViewWindow view_window,
                            char *command_name, char *request,
                            RemoteCommandRCType *command_rc_out, char **reason_out,
-                           ZMapXMLUtilsEventStack *reply_out)
+                           ZMapXMLUtilsEventStack *reply_out, char **reply_msg_out)
 {
   ZMapXMLParser parser ;
   gboolean cmd_debug = FALSE ;
@@ -408,12 +432,17 @@ static void processRequest(ZMapViewWindow view_window,
           *reply_out = zMapRemoteCommandMessage2Element(request_data.msg) ;
         }
 
+      *reply_msg_out = request_data.reply_msg ;
+
       *command_rc_out = request_data.command_rc ;
 
       g_string_free(request_data.err_msg, FALSE) ;
 
     }
 
+  if (request_data.failed_features)
+    g_string_free(request_data.failed_features, TRUE) ;
+
   /* Free the parser!!! */
   zMapXMLParserDestroy(parser) ;
 
@@ -487,6 +516,11 @@ static gboolean executeRequest(ZMapXMLParser parser, RequestData request_data)
           result = FALSE ;
         }
     }
+  else if (request_data->command_id == g_quark_from_string(ZACP_CREATE_FEATURES))
+    {
+      /* createFeatures sets the request error code/msg if any feature could not be created. */
+      result = createFeatures(view, request_data) ;
+    }
   else if (request_data->command_id == g_quark_from_string(ZACP_DUMP_FEATURES))
     {
       viewDumpContextToFile(view, request_data) ;
@@ -860,6 +894,94 @@ static gboolean mergeNewFeatures(ZMapView view, RequestData request_data,
 }
 
 
+/* All the features of a create_features request go into the view in a single merge and draw.
+ * Features were checked against the view context as they were parsed so any that could not be
+ * created have already been recorded and removed, we only need the merge stats here.
+ *
+ * If any features are created the request has worked and the features that could not be
+ * created are listed in the reply message, it only fails if nothing was added to the view. */
+static gboolean createFeatures(ZMapView view, RequestData request_data)
+{
+  gboolean result = FALSE ;
+  ZMapFeatureContextMergeStats merge_stats = NULL ;
+  GList *feature_list = NULL ;
+  gboolean merged = TRUE ;
+  int num_created = 0 ;
+
+  if (request_data->num_requested_features > request_data->num_failed_features)
+    {
+      if ((merged = zmapViewMergeNewFeatures(view, &(request_data->edit_context), &merge_stats, &feature_list)))
+        {
+          num_created = merge_stats->features_added ;
+
+          zmapViewDrawDiffContext(view, &(request_data->edit_context), NULL) ;
+        }
+
+      g_free(merge_stats) ;
+    }
+
+  if (!merged)
+    {
+      request_data->command_rc = REMOTE_COMMAND_RC_FAILED ;
+
+      g_string_append(request_data->err_msg, "Merge of new features into View feature context failed.\n") ;
+
+      if (request_data->failed_features)
+        g_string_append(request_data->err_msg, request_data->failed_features->str) ;
+    }
+  else if (!(request_data->num_failed_features))
+    {
+      request_data->command_rc = REMOTE_COMMAND_RC_OK ;
+      request_data->msg = "Created features ok !" ;
+
+      result = TRUE ;
+    }
+  else if (!num_created)
+    {
+      request_data->command_rc = REMOTE_COMMAND_RC_FAILED ;
+
+      g_string_append_printf(request_data->err_msg,
+                             "None of the %d features could be created:\n%s",
+                             request_data->num_requested_features, request_data->failed_features->str) ;
+    }
+  else
+    {
+      request_data->command_rc = REMOTE_COMMAND_RC_OK ;
+
+      request_data->reply_msg = g_strdup_printf("Created %d features, %d of %d features could not be created:\n%s",
+                                                num_created,
+                                                request_data->num_failed_features,
+                                                request_data->num_requested_features,
+                                                request_data->failed_features->str) ;
+      request_data->msg = request_data->reply_msg ;
+
+      result = TRUE ;
+    }
+
+  return result ;
+}
+
+
+/* Record one failed feature for the create_features reply. */
+static void addFailedFeature(RequestData request_data, const char *format, ...)
+{
+  va_list args ;
+
+  if (!(request_data->failed_features))
+    request_data->failed_features = g_string_sized_new(500) ;
+
+  va_start(args, format) ;
+  g_string_append_vprintf(request_data->failed_features, format, args) ;
+  va_end(args) ;
+
+  g_string_append_c(request_data->failed_features, '\n') ;
+
+  request_data->num_failed_features++ ;
+
+  return ;
+}
+
+
 /* We get called for any features that failed to get drawn but we may not know why
  * as the error will have been reported by the merge, we can at least tell user
  * to look at log. */
@@ -874,8 +996,8 @@ static void draw_failed_make_message(gpointer list_data, gpointer user_data)
     {
       g_string_append_printf(request_data->err_msg,
                              "Failed to draw feature '%s' [%s]. Feature already exists.\n",
-                             (char *)g_quark_to_string(feature_any->original_id),
-                             (char *)g_quark_to_string(feature_any->unique_id));
+                             (char *)zMapFeatureIDToString(feature_any->original_id),
+                             (char *)zMapFeatureIDToString(feature_any->unique_id));
     }
   else
     {
@@ -883,8 +1005,8 @@ static void draw_failed_make_message(gpointer list_data, gpointer user_data)
 
       g_string_append_printf(request_data->err_msg,
                              "Failed to draw feature '%s' [%s]. Unknown reason, check zmap log file.\n",
-                             (char *)g_quark_to_string(feature_any->original_id),
-                             (char *)g_quark_to_string(feature_any->unique_id));
+                             (char *)zMapFeatureIDToString(feature_any->original_id),
+                             (char *)zMapFeatureIDToString(feature_any->unique_id));
     }
 
   return ;
@@ -902,8 +1024,8 @@ static void delete_failed_make_message(gpointer list_data, gpointer user_data)
 
       g_string_append_printf(request_data->err_msg,
                              "Failed to delete feature '%s' [%s].\n",
-                             (char *)g_quark_to_string(feature_any->original_id),
-                             (char *)g_quark_to_string(feature_any->unique_id));
+                             (char *)zMapFeatureIDToString(feature_any->original_id),
+                             (char *)zMapFeatureIDToString(feature_any->unique_id));
     }
 
   return ;
@@ -1005,7 +1127,7 @@ static void loadFeatures(ZMapView view, RequestData request_data)
   if (request_data->command_rc == REMOTE_COMMAND_RC_OK)
     zmapViewLoadFeatures(view, request_data->edit_block, request_data->feature_sets, NULL,
                          NULL, NULL, start, end, view->thread_fail_silent,
-                         SOURCE_GROUP_DELAYED, TRUE, TRUE) ;
+                         SOURCE_GROUP_DELAYED, TRUE, TRUE, request_data->reload) ;
 
   return ;
 }
@@ -1181,6 +1303,29 @@ static gboolean xml_request_start_cb(gpointer user_data, ZMapXMLElement set_elem
                 {
                   err_msg = g_strdup_printf("Value \"%s\" for \"load\" attr is unknown.", g_quark_to_string(load_id)) ;
 
+                  result = FALSE ;
+                }
+            }
+
+          /* Regions already loaded for a featureset are not requested again unless asked. */
+          if (result && (attr = zMapXMLElementGetAttributeByName(set_element, "reload")))
+            {
+              GQuark reload_id ;
+
+              reload_id = zMapXMLAttributeGetValue(attr) ;
+
+              if (zMapLogQuarkIsStr(reload_id, "true"))
+                {
+                  request_data->reload = TRUE ;
+                }
+              else if (zMapLogQuarkIsStr(reload_id, "false"))
+                {
+                  request_data->reload = FALSE ;
+                }
+              else
+                {
+                  err_msg = g_strdup_printf("Value \"%s\" for \"reload\" attr is unknown.", g_quark_to_string(reload_id)) ;
+
                   result = FALSE ;
                 }
             }
@@ -1388,45 +1533,8 @@ static gboolean xml_featureset_start_cb(gpointer user_data, ZMapXMLElement set_e
     load_features = TRUE ;
 
 
-  /* Default to master align if client did not specify one. */
-  if (!(request_data->orig_align))
-    {
-      /* default to master align. */
-      request_data->orig_align = request_data->orig_context->master_align ;
-
-      if (request_data->cmd_desc->is_edit)
-        {
-          request_data->edit_align
-            = (ZMapFeatureAlignment)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_align)) ;
-          zMapFeatureContextAddAlignment(request_data->edit_context, request_data->edit_align, FALSE) ;
-
-          if (request_data->command_id == g_quark_from_string(ZACP_REPLACE_FEATURE))
-            {
-              request_data->replace_align
-                = (ZMapFeatureAlignment)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_align)) ;
-              zMapFeatureContextAddAlignment(request_data->replace_context, request_data->replace_align, FALSE) ;
-            }
-        }
-    }
-
-  /* Default to first block if client did not specify one. */
-  if (!(request_data->orig_block))
-    {
-      request_data->orig_block = (ZMapFeatureBlock)zMap_g_hash_table_nth(request_data->orig_context->master_align->blocks, 0) ;
-
-      if (request_data->cmd_desc->is_edit)
-        {
-          request_data->edit_block = (ZMapFeatureBlock)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_block)) ;
-          zMapFeatureAlignmentAddBlock(request_data->edit_align, request_data->edit_block) ;
-
-          if (request_data->command_id == g_quark_from_string(ZACP_REPLACE_FEATURE))
-            {
-              request_data->replace_block
-                = (ZMapFeatureBlock)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_block)) ;
-              zMapFeatureAlignmentAddBlock(request_data->replace_align, request_data->replace_block) ;
-            }
-        }
-    }
+  /* Default to master align and first block if client did not specify them. */
+  setDefaultAlignBlock(request_data) ;
 
 
   /* Now process the featureset. */
@@ -1496,8 +1604,11 @@ static gboolean xml_featureset_start_cb(gpointer user_data, ZMapXMLElement set_e
             {
               if (request_data->orig_feature_set)
                 {
-                  feature_set
-                    = (ZMapFeatureSet)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_feature_set)) ;
+                  /* A request may name the same featureset more than once, only copy it the
+                   * first time or features added under the earlier element are lost. */
+                  if (!(feature_set = zMapFeatureBlockGetSetByID(request_data->edit_block, unique_set_id)))
+                    feature_set
+                      = (ZMapFeatureSet)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_feature_set)) ;
                 }
               else
                 {
@@ -1732,6 +1843,273 @@ static gboolean xml_column_start_cb(gpointer user_data, ZMapXMLElement column_el
 
 
 
+/*
+ * Handler for the "gff" element of the create_features command, the element content is
+ * GFF (version 2 or 3) to be used instead of or as well as feature elements, e.g.
+ *
+ * <request command="create_features" view_id="0x85d78c8">
+ *   <gff>##gff-version 3
+ * chr6-18	manual	gene	...
+ *   </gff>
+ * </request>
+ *
+ * As with feature elements, features that cannot be created are reported in the
+ * reply but do not stop the others being created.
+ */
+static gboolean xml_gff_end_cb(gpointer user_data, ZMapXMLElement gff_element, ZMapXMLParser parser)
+{
+  gboolean result = TRUE ;
+  RequestData request_data = (RequestData)user_data ;
+  char *gff_text = NULL ;
+  char *err_msg = NULL ;
+
+  if (request_data->command_id != g_quark_from_string(ZACP_CREATE_FEATURES))
+    {
+      err_msg = g_strdup_printf("\"gff\" element is only valid for the \"%s\" command.", ZACP_CREATE_FEATURES) ;
+
+      result = FALSE ;
+    }
+  else if (!(gff_text = zMapXMLElementStealContent(gff_element)))
+    {
+      err_msg = g_strdup("\"gff\" element has no content.") ;
+
+      result = FALSE ;
+    }
+  else
+    {
+      setDefaultAlignBlock(request_data) ;
+
+      result = addGFFFeatures(request_data, gff_text, &err_msg) ;
+    }
+
+  if (!result)
+    {
+      request_data->command_rc = REMOTE_COMMAND_RC_BAD_ARGS ;
+
+      zMapXMLParserRaiseParsingError(parser, err_msg) ;
+
+      g_free(err_msg) ;
+    }
+
+  return result ;
+}
+
+
+/* Default to master align and first block if client did not specify them. */
+static void setDefaultAlignBlock(RequestData request_data)
+{
+  if (!(request_data->orig_align))
+    {
+      /* default to master align. */
+      request_data->orig_align = request_data->orig_context->master_align ;
+
+      if (request_data->cmd_desc->is_edit)
+        {
+          request_data->edit_align
+            = (ZMapFeatureAlignment)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_align)) ;
+          zMapFeatureContextAddAlignment(request_data->edit_context, request_data->edit_align, FALSE) ;
+
+          if (request_data->command_id == g_quark_from_string(ZACP_REPLACE_FEATURE))
+            {
+              request_data->replace_align
+                = (ZMapFeatureAlignment)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_align)) ;
+              zMapFeatureContextAddAlignment(request_data->replace_context, request_data->replace_align, FALSE) ;
+            }
+        }
+    }
+
+  if (!(request_data->orig_block))
+    {
+      request_data->orig_block = (ZMapFeatureBlock)zMap_g_hash_table_nth(request_data->orig_context->master_align->blocks, 0) ;
+
+      if (request_data->cmd_desc->is_edit)
+        {
+          request_data->edit_block = (ZMapFeatureBlock)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_block)) ;
+          zMapFeatureAlignmentAddBlock(request_data->edit_align, request_data->edit_block) ;
+
+          if (request_data->command_id == g_quark_from_string(ZACP_REPLACE_FEATURE))
+            {
+              request_data->replace_block
+                = (ZMapFeatureBlock)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_block)) ;
+              zMapFeatureAlignmentAddBlock(request_data->replace_align, request_data->replace_block) ;
+            }
+        }
+    }
+
+  return ;
+}
+
+
+/* Parse gff_text (which we take ownership of) with the view's source/style mappings and move
+ * the resulting features into the edit block. Lines the parser rejects and features that
+ * already exist are recorded as failed features, only a bad header is an error for the
+ * whole request. */
+static gboolean addGFFFeatures(RequestData request_data, char *gff_text, char **err_msg_out)
+{
+  gboolean result = TRUE ;
+  ZMapView view = request_data->view_window->parent_view ;
+  gboolean revcomped = zMapViewGetRevCompStatus(view) ;
+  char **gff_lines, **line ;
+  int gff_version = ZMAPGFF_VERSION_UNKNOWN ;
+  ZMapGFFParser gff_parser = NULL ;
+  ZMapFeatureBlock gff_block ;
+  gboolean done_header = FALSE ;
+  ZMapGFFHeaderState header_state = GFF_HEADER_NONE ;
+  GList *feature_sets = NULL, *set_item ;
+
+  gff_lines = g_strsplit(gff_text, "\n", -1) ;
+  g_free(gff_text) ;
+
+  /* The gff-version directive must come first but may be indented in the xml. */
+  for (line = gff_lines ; *line && zMapStringBlank(*line) ; line++)
+    ;
+
+  if (!(*line) || !zMapGFFGetVersionFromString(g_strchug(*line), &gff_version))
+    {
+      *err_msg_out = g_strdup("\"gff\" element must start with a \"##gff-version 2\" or \"3\" line.") ;
+
+      result = FALSE ;
+    }
+  else if (!(gff_parser = zMapGFFCreateParser(gff_version, view->view_sequence->sequence,
+                                              view->view_sequence->start, view->view_sequence->end)))
+    {
+      *err_msg_out = g_strdup("Could not create GFF parser for \"gff\" element.") ;
+
+      result = FALSE ;
+    }
+
+  if (result)
+    {
+      zMapGFFParseSetSourceHash(gff_parser,
+                                view->context_map.featureset_2_column, view->context_map.source_2_sourcedata) ;
+      zMapGFFParserInitForFeatures(gff_parser, &(view->context_map.styles), FALSE) ;
+      zMapGFFSetDefaultToBasic(gff_parser, TRUE) ;
+
+      for ( ; *line ; line++)
+        {
+          g_strchomp(*line) ;
+
+          if (!done_header && zMapGFFParseHeader(gff_parser, *line, &done_header, &header_state))
+            continue ;
+
+          done_header = TRUE ;
+
+          if (!zMapGFFParseLine(gff_parser, *line))
+            {
+              GError *error = zMapGFFGetError(gff_parser) ;
+
+              if (zMapGFFTerminated(gff_parser))
+                {
+                  *err_msg_out = g_strdup_printf("GFF parsing stopped at line %d: %s",
+                                                 zMapGFFGetLineNumber(gff_parser),
+                                                 (error ? error->message : "unknown error")) ;
+
+                  result = FALSE ;
+
+                  break ;
+                }
+              else if (error)
+                {
+                  request_data->num_requested_features++ ;
+
+                  addFailedFeature(request_data, "GFF line %d: %s", zMapGFFGetLineNumber(gff_parser), error->message) ;
+                }
+            }
+        }
+    }
+
+  g_strfreev(gff_lines) ;
+
+  /* Parse into a scratch block, the parser resets the block coords which must not happen to
+   * the edit block. */
+  gff_block = (ZMapFeatureBlock)zMapFeatureAnyCopy((ZMapFeatureAny)(request_data->orig_block)) ;
+
+  if (result && zMapGFFGetFeatures(gff_parser, gff_block))
+    {
+      zMapGFFSetFreeOnDestroy(gff_parser, FALSE) ;
+
+      zMap_g_hash_table_get_data(&feature_sets, gff_block->feature_sets) ;
+
+      for (set_item = feature_sets ; set_item ; set_item = set_item->next)
+        {
+          ZMapFeatureSet gff_set = (ZMapFeatureSet)(set_item->data) ;
+          ZMapFeatureSet orig_set, edit_set ;
+          GList *features = NULL, *feature_item ;
+
+          orig_set = zMapFeatureBlockGetSetByID(request_data->orig_block, gff_set->unique_id) ;
+
+          if (!(edit_set = zMapFeatureBlockGetSetByID(request_data->edit_block, gff_set->unique_id)))
+            {
+              edit_set = (ZMapFeatureSet)zMapFeatureAnyCopy((ZMapFeatureAny)gff_set) ;
+              zMapFeatureBlockAddFeatureSet(request_data->edit_block, edit_set) ;
+
+              if (!(edit_set->loaded))
+                {
+                  ZMapSpan span ;
+
+                  span = g_new0(ZMapSpanStruct, 1) ;
+                  span->x1 = request_data->orig_block->block_to_sequence.block.x1 ;
+                  span->x2 = request_data->orig_block->block_to_sequence.block.x2 ;
+                  edit_set->loaded = g_list_append(NULL, span) ;
+                }
+
+              request_data->edit_context->req_feature_set_names
+                = g_list_append(request_data->edit_context->req_feature_set_names,
+                                GINT_TO_POINTER(gff_set->original_id)) ;
+            }
+
+          zMap_g_hash_table_get_data(&features, gff_set->features) ;
+
+          for (feature_item = features ; feature_item ; feature_item = feature_item->next)
+            {
+              ZMapFeature feature = (ZMapFeature)(feature_item->data) ;
+
+              request_data->num_requested_features++ ;
+
+              zMapFeatureSetRemoveFeature(gff_set, feature) ;
+
+              if (orig_set && zMapFeatureSetGetFeatureByID(orig_set, feature->unique_id))
+                {
+                  addFailedFeature(request_data, "Feature \"%s\" with id \"%s\" already exists in featureset \"%s\".",
+                                   zMapFeatureIDToString(feature->original_id), zMapFeatureIDToString(feature->unique_id),
+                                   zMapFeatureName((ZMapFeatureAny)gff_set)) ;
+
+                  zMapFeatureDestroy(feature) ;
+                }
+              else if (!zMapFeatureSetAddFeature(edit_set, feature))
+                {
+                  addFailedFeature(request_data, "Feature \"%s\" with id \"%s\" occurs more than once in request.",
+                                   zMapFeatureIDToString(feature->original_id), zMapFeatureIDToString(feature->unique_id)) ;
+
+                  zMapFeatureDestroy(feature) ;
+                }
+              else if (revcomped)
+                {
+                  zMapFeatureReverseComplement(request_data->orig_context, feature) ;
+                }
+            }
+
+          g_list_free(features) ;
+        }
+
+      g_list_free(feature_sets) ;
+    }
+  else if (result)
+    {
+      *err_msg_out = g_strdup("Could not retrieve features from GFF parser for \"gff\" element.") ;
+
+      result = FALSE ;
+    }
+
+  zMapFeatureBlockDestroy(gff_block, TRUE) ;
+
+  if (gff_parser)
+    zMapGFFDestroyParser(gff_parser) ;
+
+  return result ;
+}
+
+
 static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_element, ZMapXMLParser parser)
 {
   gboolean result = TRUE ;
@@ -1750,8 +2128,16 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
   int start = 0, end = 0 ;
   double score = 0.0 ;
   ZMapStyleMode mode = ZMAPSTYLE_MODE_INVALID ;
+  gboolean bulk_create = (request_data->command_id == g_quark_from_string(ZACP_CREATE_FEATURES)) ;
 
 
+  /* For create_features each feature stands alone, don't let a failed one leak into the next. */
+  if (bulk_create)
+    {
+      request_data->edit_feature = NULL ;
+      request_data->skip_feature = FALSE ;
+    }
+
   /* Must have following attributes for all feature level operations. */
   if (result && (attr = zMapXMLElementGetAttributeByName(feature_element, "name")))
     {
@@ -1835,7 +2221,13 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
 
       feature_unique_id = zMapFeatureCreateID(mode, feature_name, strand, start, end, 0, 0) ;
 
-      feature = zMapFeatureSetGetFeatureByID(request_data->orig_feature_set, feature_unique_id) ;
+      if (request_data->orig_feature_set)
+        feature = zMapFeatureSetGetFeatureByID(request_data->orig_feature_set, feature_unique_id) ;
+      else
+        feature = NULL ;
+
+      if (bulk_create)
+        request_data->num_requested_features++ ;
 
       /* More complicated for feature replace.... */
       if (request_data->command_id == g_quark_from_string(ZACP_REPLACE_FEATURE))
@@ -1893,7 +2285,18 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
         }
       else if (feature_exists == FEATURE_MUST_NOT)
         {
-          if (feature)
+          if (bulk_create
+              && (feature || zMapFeatureSetGetFeatureByID(request_data->edit_feature_set, feature_unique_id)))
+            {
+              /* For create_features just report the feature and carry on with the rest. */
+              addFailedFeature(request_data, "Feature \"%s\" with id \"%s\" %s in featureset \"%s\".",
+                               feature_name, g_quark_to_string(feature_unique_id),
+                               (feature ? "already exists" : "occurs more than once"),
+                               zMapFeatureName((ZMapFeatureAny)(request_data->edit_feature_set))) ;
+
+              request_data->skip_feature = TRUE ;
+            }
+          else if (feature)
             {
               /* If we _do_ find the feature then it's a serious error. */
               char *err_msg ;
@@ -1912,7 +2315,7 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
 
 
   /* ok, now we can do something. */
-  if (result)
+  if (result && !(request_data->skip_feature))
     {
       ZMapFeatureSet featureset ;
       ZMapFeature feature ;
@@ -1999,6 +2402,7 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
 
               /* SURELY WE ONLY DO THIS FOR A CREATE OR REPLACE/CREATE...... */
               if (request_data->command_id == g_quark_from_string(ZACP_CREATE_FEATURE)
+                  || bulk_create
                   || (request_data->command_id == g_quark_from_string(ZACP_REPLACE_FEATURE)
                       && request_data->replace_stage == REPLACE_CREATE_FEATURE))
                 {
@@ -2048,12 +2452,17 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
                     }
                 }
 
+              /* create_features doesn't need the list, its features were checked against the
+               * view context above. */
               if (request_data->command_id != g_quark_from_string(ZACP_REPLACE_FEATURE)
                   || request_data->replace_stage == REPLACE_DELETE_FEATURE)
                 {
-                  feature_any = zMapFeatureAnyCopy((ZMapFeatureAny)request_data->edit_feature) ;
+                  if (!bulk_create)
+                    {
+                      feature_any = zMapFeatureAnyCopy((ZMapFeatureAny)request_data->edit_feature) ;
 
-                  request_data->edit_feature_list = g_list_prepend(request_data->edit_feature_list, feature_any) ;
+                      request_data->edit_feature_list = g_list_prepend(request_data->edit_feature_list, feature_any) ;
+                    }
                 }
               else
                 {
@@ -2066,7 +2475,17 @@ static gboolean xml_feature_start_cb(gpointer user_data, ZMapXMLElement feature_
 
           if (g_error)
             {
-              zMapCritical("Error creating feature", g_error->message) ;
+              if (bulk_create)
+                {
+                  addFailedFeature(request_data, "Error creating feature \"%s\": %s", feature_name, g_error->message) ;
+
+                  request_data->skip_feature = TRUE ;
+                }
+              else
+                {
+                  zMapCritical("Error creating feature", g_error->message) ;
+                }
+
               g_error_free(g_error) ;
             }
 
@@ -2081,8 +2500,14 @@ static gboolean xml_feature_end_cb(gpointer user_data, ZMapXMLElement sub_elemen
 {
   gboolean result = TRUE ;
   RequestData request_data = (RequestData)user_data;
+  gboolean bulk_create = (request_data->command_id == g_quark_from_string(ZACP_CREATE_FEATURES)) ;
 
-  if (request_data->command_id == g_quark_from_string(ZACP_CREATE_FEATURE))
+  if (bulk_create && request_data->skip_feature)
+    {
+      /* Already reported as failed by xml_feature_start_cb(). */
+      request_data->skip_feature = FALSE ;
+    }
+  else if (request_data->command_id == g_quark_from_string(ZACP_CREATE_FEATURE) || bulk_create)
     {
       /* I don't really like this error handling, it seems wierd.... */
       if (!(request_data->edit_feature))
@@ -2094,6 +2519,20 @@ static gboolean xml_feature_end_cb(gpointer user_data, ZMapXMLElement sub_elemen
 
           result = FALSE ;
         }
+      else if (bulk_create
+               && ZMAPFEATURE_IS_TRANSCRIPT(request_data->edit_feature)
+               && !(ZMAPFEATURE_HAS_EXONS(request_data->edit_feature)))
+        {
+          ZMapFeature feature = request_data->edit_feature ;
+
+          addFailedFeature(request_data, "Feature \"%s\" with id \"%s\" is a transcript with no exons.",
+                           zMapFeatureIDToString(feature->original_id), zMapFeatureIDToString(feature->unique_id)) ;
+
+          zMapFeatureSetRemoveFeature(request_data->edit_feature_set, feature) ;
+          zMapFeatureDestroy(feature) ;
+
+          request_data->edit_feature = NULL ;
+        }
       else if (ZMAPFEATURE_IS_TRANSCRIPT(request_data->edit_feature)
                && !(ZMAPFEATURE_HAS_EXONS(request_data->edit_feature)))
         {
@@ -2127,6 +2566,10 @@ static gboolean xml_subfeature_end_cb(gpointer user_data, ZMapXMLElement sub_ele
   ZMapFeature feature ;
 
 
+  /* Feature has already been reported as failed by create_features. */
+  if (request_data->skip_feature)
+    return result ;
+
   if (request_data->command_id != g_quark_from_string(ZACP_REPLACE_FEATURE)
       || request_data->replace_stage == REPLACE_DELETE_FEATURE)
     feature = request_data->edit_feature ;
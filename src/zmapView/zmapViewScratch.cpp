@@ -56,6 +56,18 @@ typedef enum
 } ZMapEditType ;
 
 
+/* The state of the scratch feature after an edit operation. Building the feature means
+ * replaying every operation since the last clear/save, so to avoid that cost growing with
+ * the edit history each operation keeps a copy of the feature as it was after that operation
+ * and the feature is rebuilt from the latest valid checkpoint. */
+typedef struct _ScratchCheckpointStruct
+{
+  ZMapFeature feature ;        /* stand-alone copy of the scratch feature */
+  gboolean start_end_set ;     /* value of view->scratch_start_end_set */
+  gboolean first_merge ;       /* whether the next merge would be the first */
+} ScratchCheckpointStruct, *ScratchCheckpoint ;
+
+
 /* Data about each edit operation in the Scratch column */
 typedef struct _EditOperationStruct
 {
@@ -70,6 +82,8 @@ typedef struct _EditOperationStruct
   ZMapFeatureSubPart subpart;  /* the subpart to use, if applicable */
   gboolean use_subfeature;     /* if true, use the clicked subfeature; otherwise use the entire feature */
   ZMapBoundaryType boundary;   /* the boundary type for a single-coord feature */
+  ScratchCheckpoint checkpoint; /* state after this operation, NULL if not made yet or no
+                                 * longer valid, e.g. after revcomp */
 } EditOperationStruct, *EditOperation;
 
 
@@ -87,7 +101,9 @@ typedef struct _ScratchMergeDataStruct
 
 
 /* Local function declarations */
-static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature feature) ;
+static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature feature,
+                                        GList *list_item, gboolean first_merge) ;
+static void checkpointDestroy(ScratchCheckpoint checkpoint) ;
 static void scratchFeatureRecreate(ZMapView view) ;
 void scratchRemoveFeature(gpointer list_data, gpointer user_data) ;
 
@@ -126,6 +142,8 @@ static void editOperationDestroy(EditOperation operation)
       if (operation->subpart)
         g_free(operation->subpart) ;
 
+      checkpointDestroy(operation->checkpoint) ;
+
       g_free(operation);
     }
 }
@@ -174,7 +192,7 @@ static gboolean scratchClearRedoStack(ZMapView view)
           view->edit_list = g_list_delete_link(view->edit_list, item) ;
           item = next_item ;
 
-          g_free(operation) ;
+          editOperationDestroy(operation) ;
           operation = NULL ;
         }
     }
@@ -365,7 +383,7 @@ void scratchRemoveFeature(gpointer list_data, gpointer user_data)
                   operation->src_feature_ids = g_list_delete_link(operation->src_feature_ids, cur_item) ;
                   changed = TRUE ;
                   char *msg = g_strdup_printf("Feature '%s' is no longer valid and has been removed from the Annotation column.\n",
-                                              g_quark_to_string(feature->original_id)) ;
+                                              zMapFeatureIDToString(feature->original_id)) ;
                   zMapWarning("%s", msg) ;
                   g_free(msg) ;
                 }
@@ -373,9 +391,14 @@ void scratchRemoveFeature(gpointer list_data, gpointer user_data)
         }
     }
 
-  /* If we've changed the list of source features we need to recreate the scratch feature */
+  /* If we've changed the list of source features we need to recreate the scratch feature
+   * from scratch. */
   if (changed)
-    scratchFeatureRecreate(view);
+    {
+      zmapViewScratchClearCheckpoints(view) ;
+
+      scratchFeatureRecreate(view);
+    }
 }
 
 
@@ -675,7 +698,7 @@ static gboolean scratchMergeFeature(ScratchMergeData merge_data,
           if (*merge_data->error == NULL)
             {
               g_set_error(merge_data->error, g_quark_from_string("ZMap"), 99,
-                          "Failed to merge feature '%s'.\n", g_quark_to_string(feature->original_id));
+                          "Failed to merge feature '%s'.\n", zMapFeatureIDToString(feature->original_id));
             }
         }
     }
@@ -954,6 +977,75 @@ static gboolean scratchDoSaveOperation(ScratchMergeData merge_data)
 }
 
 
+/*!
+ * \brief Make a checkpoint of the scratch feature as it is now
+ */
+static ScratchCheckpoint checkpointCreate(ZMapView view, ZMapFeature scratch_feature, gboolean first_merge)
+{
+  ScratchCheckpoint checkpoint = NULL ;
+  ZMapFeature feature ;
+
+  if ((feature = (ZMapFeature)zMapFeatureAnyCopy((ZMapFeatureAny)scratch_feature)))
+    {
+      /* The copy shares the list of variations, which gets freed when the scratch feature is
+       * erased, so take our own copy of it. */
+      feature->feature.transcript.variations = g_list_copy(scratch_feature->feature.transcript.variations) ;
+
+      checkpoint = g_new0(ScratchCheckpointStruct, 1) ;
+      checkpoint->feature = feature ;
+      checkpoint->start_end_set = scratchGetStartEndFlag(view) ;
+      checkpoint->first_merge = first_merge ;
+    }
+
+  return checkpoint ;
+}
+
+
+/*!
+ * \brief Make a new scratch feature from the given checkpoint
+ */
+static ZMapFeature checkpointRestore(ZMapView view, ScratchCheckpoint checkpoint)
+{
+  ZMapFeature feature ;
+
+  if ((feature = (ZMapFeature)zMapFeatureAnyCopy((ZMapFeatureAny)checkpoint->feature)))
+    {
+      feature->feature.transcript.variations = g_list_copy(checkpoint->feature->feature.transcript.variations) ;
+
+      scratchSetStartEndFlag(view, checkpoint->start_end_set) ;
+    }
+
+  return feature ;
+}
+
+
+static void checkpointDestroy(ScratchCheckpoint checkpoint)
+{
+  if (checkpoint)
+    {
+      zMapFeatureRemoveTranscriptVariations(checkpoint->feature, NULL) ;
+      zMapFeatureAnyDestroy((ZMapFeatureAny)checkpoint->feature) ;
+
+      g_free(checkpoint) ;
+    }
+}
+
+
+/*!
+ * \brief Remove the checkpoints of all operations from the given one onwards
+ */
+static void checkpointsClearFrom(GList *list_item)
+{
+  for ( ; list_item ; list_item = list_item->next)
+    {
+      EditOperation operation = (EditOperation)(list_item->data) ;
+
+      checkpointDestroy(operation->checkpoint) ;
+      operation->checkpoint = NULL ;
+    }
+}
+
+
 /*!
  * \brief Utility to delete all exons from the given feature
  */
@@ -1015,46 +1107,77 @@ static ZMapFeature scratchCreateNewFeature(ZMapView zmap_view)
   g_return_val_if_fail(feature_set, NULL) ;
 
   ZMapStrand strand = ZMAPSTRAND_FORWARD ;
+  ZMapFeature feature = NULL ;
+  GList *list_item = NULL ;
+  GList *replay_item = zmap_view->edit_list_start ;
+  gboolean first_merge = TRUE ;
 
-  /* Create the feature with default values */
-  GError *g_error = NULL ;
-
-  ZMapFeature feature = zMapFeatureCreateFromStandardData(SCRATCH_FEATURE_NAME,
-                                                          NULL,
-                                                          "transcript",
-                                                          ZMAPSTYLE_MODE_TRANSCRIPT,
-                                                          &feature_set->style,
-                                                          0,
-                                                          0,
-                                                          FALSE,
-                                                          0.0,
-                                                          strand,
-                                                          &g_error);
+  /* Find the latest operation we have a checkpoint for, we only need to replay the operations
+   * after it. */
+  for (list_item = zmap_view->edit_list_end ; list_item ; list_item = list_item->prev)
+    {
+      EditOperation operation = (EditOperation)(list_item->data) ;
 
-  if (feature)
+      if (operation->checkpoint)
+        {
+          if ((feature = checkpointRestore(zmap_view, operation->checkpoint)))
+            {
+              first_merge = operation->checkpoint->first_merge ;
+              replay_item = (list_item == zmap_view->edit_list_end ? NULL : list_item->next) ;
+            }
+
+          break ;
+        }
+
+      if (list_item == zmap_view->edit_list_start)
+        break ;
+    }
+
+  if (!feature)
     {
-      zMapFeatureTranscriptInit(feature);
-      zMapFeatureAddTranscriptStartEnd(feature, FALSE, 0, FALSE);
-      //zMapFeatureAddTranscriptCDS(feature, TRUE, cds_start, cds_end);
+      /* Create the feature with default values */
+      GError *g_error = NULL ;
 
+      feature = zMapFeatureCreateFromStandardData(SCRATCH_FEATURE_NAME,
+                                                  NULL,
+                                                  "transcript",
+                                                  ZMAPSTYLE_MODE_TRANSCRIPT,
+                                                  &feature_set->style,
+                                                  0,
+                                                  0,
+                                                  FALSE,
+                                                  0.0,
+                                                  strand,
+                                                  &g_error);
+
+      if (feature)
+        {
+          zMapFeatureTranscriptInit(feature);
+          zMapFeatureAddTranscriptStartEnd(feature, FALSE, 0, FALSE);
+          //zMapFeatureAddTranscriptCDS(feature, TRUE, cds_start, cds_end);
+        }
+
+      if (g_error)
+        {
+          zMapCritical("Error creating temp feature for Annotation column", g_error->message) ;
+          g_error_free(g_error) ;
+        }
+    }
+
+  if (feature)
+    {
       /* Create the exons */
-      scratchFeatureRecreateExons(zmap_view, feature) ;
+      scratchFeatureRecreateExons(zmap_view, feature, replay_item, first_merge) ;
 
       /* Update the feature ID because the coords may have changed */
       feature->unique_id = zMapFeatureCreateID(feature->mode,
-                                               (char *)g_quark_to_string(feature->original_id),
+                                               (char *)zMapFeatureIDToString(feature->original_id),
                                                feature->strand,
                                                feature->x1,
                                                feature->x2,
                                                0, 0);
     }
 
-  if (g_error)
-    {
-      zMapCritical("Error creating temp feature for Annotation column", g_error->message) ;
-      g_error_free(g_error) ;
-    }
-
   return feature ;
 }
 
@@ -1145,9 +1268,12 @@ static void handBuiltInit(ZMapView zmap_view, ZMapFeatureSequenceMap sequence, Z
 
 
 /*!
- * /brief Recreate the scratch feature's list of exons from the list of merged features
+ * /brief Recreate the scratch feature's list of exons from the list of merged features,
+ * starting at list_item and finishing at the end of the valid list. Each operation
+ * done is checkpointed.
  */
-static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature scratch_feature)
+static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature scratch_feature,
+                                        GList *list_item, gboolean first_merge)
 {
   /* Get the singleton features that exist in each strand of the scatch column */
   ZMapFeatureSet scratch_featureset = zmapViewScratchGetFeatureset(view);
@@ -1155,8 +1281,6 @@ static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature scratch_featu
   /* Loop through each feature in the merge list and merge it in */
   GError *error = NULL;
   ScratchMergeDataStruct merge_data = {view, scratch_featureset, scratch_feature, &error, NULL};
-  GList *list_item = view->edit_list_start;
-  gboolean first_merge = TRUE ;
 
   while (list_item)
     {
@@ -1215,6 +1339,9 @@ static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature scratch_featu
               view->edit_list_start = view->edit_list_start->next ;
             }
 
+          /* Later operations may have been checkpointed with this one in place. */
+          checkpointsClearFrom(next_item) ;
+
           /* Now delete the item from the list and free the data */
           view->edit_list = g_list_delete_link(view->edit_list, list_item) ;
           list_item = NULL ;
@@ -1222,6 +1349,10 @@ static void scratchFeatureRecreateExons(ZMapView view, ZMapFeature scratch_featu
           editOperationDestroy(operation) ;
           operation = NULL ;
         }
+      else if (!operation->checkpoint)
+        {
+          operation->checkpoint = checkpointCreate(view, scratch_feature, first_merge) ;
+        }
 
       /* If we're at the last item in the valid list, finish now */
       if (list_item == view->edit_list_end)
@@ -1835,3 +1966,15 @@ void zmapViewScratchResetAttributes(ZMapView view)
   view->int_values[ZMAPINT_SCRATCH_ATTRIBUTE_FEATURE] = 0 ;
   view->int_values[ZMAPINT_SCRATCH_ATTRIBUTE_FEATURESET] = 0 ;
 }
+
+
+/*
+ * \brief Discard the checkpointed states of the scratch feature, must be called when they are
+ * no longer valid e.g. on revcomp. The next operation rebuilds the feature from the full list.
+ */
+void zmapViewScratchClearCheckpoints(ZMapView view)
+{
+  zMapReturnIfFail(view) ;
+
+  checkpointsClearFrom(view->edit_list) ;
+}
@@ -35,12 +35,22 @@
 #include <string.h>
 
 #include <ZMap/zmapGLibUtils.hpp>
+#include <ZMap/zmapSeqBitmap.hpp>
 
 #include <zmapView_P.hpp>
 
 
 
 
+/* Gaps between loaded regions are rounded out to this many bases so we don't make lots of
+ * tiny requests, any duplicate features are dropped when the results are merged. */
+#define LOADED_REGIONS_BIN_SIZE 1000
+
+/* Above this many unloaded regions we just request the span of them all. */
+#define LOADED_REGIONS_MAX_REQUESTS 4
+
+
+
 typedef struct FindStylesStructType
 {
   ZMapStyleTree *all_styles_tree ;
@@ -89,6 +99,7 @@ static void drawableCB(ZMapFeatureTypeStyle style, gpointer user_data) ;
 
 static gboolean viewGetFeatures(ZMapView zmap_view,
                                     ZMapServerReqGetFeatures feature_req, ZMapConnectionData connect_data) ;
+static void viewGetFeaturesFinish(ZMapView zmap_view, ZMapConnectionData connect_data) ;
 
 
 static bool setUpServerConnectionByScheme(ZMapView zmap_view,
@@ -96,6 +107,18 @@ static bool setUpServerConnectionByScheme(ZMapView zmap_view,
                                           bool &terminate,
                                           GError **error) ;
 
+static ZMapNewDataSource requestServerUnloaded(ZMapView view, ZMapNewDataSource view_conn,
+                                               ZMapFeatureBlock block_orig, GList *req_featuresets, GList *req_biotypes,
+                                               ZMapConfigSource server,
+                                               const char *req_sequence, int req_start, int req_end,
+                                               gboolean dna_requested, gboolean terminate, gboolean show_warning,
+                                               gboolean reload, gboolean *all_loaded_out) ;
+static GList *getUnloadedRegions(ZMapView view, GList *feature_sets, int start, int end) ;
+static void freeRegions(GList *regions) ;
+static gint regionCmp(gconstpointer a, gconstpointer b) ;
+static GQuark loadedRegionsKey(GQuark feature_set_id) ;
+static void loadedRegionsDestroyCB(gpointer data) ;
+
 
 
 //
@@ -179,7 +202,7 @@ void zMapViewSetUpServerConnection(ZMapView zmap_view,
               /* Load the features for the server */
               zmapViewLoadFeatures(zmap_view, NULL, req_featuresets, req_biotypes, current_server,
                                    req_sequence, req_start, req_end, thread_fail_silent,
-                                   SOURCE_GROUP_START,TRUE, terminate) ;
+                                   SOURCE_GROUP_START,TRUE, terminate, FALSE) ;
             }
         }
     }
@@ -432,13 +455,18 @@ gboolean zmapViewSetUpServerConnections(ZMapView zmap_view, GList *settings_list
  *
  *
  * NOTE block is NULL for startup requests
+ *
+ * If reload is TRUE the whole range is requested even where it has been loaded before so
+ * that data changed in the source is fetched again, otherwise already loaded parts are
+ * skipped, see requestServerUnloaded().
  */
 void zmapViewLoadFeatures(ZMapView view, ZMapFeatureBlock block_orig, 
                           GList *req_sources, GList *req_biotypes,
                           ZMapConfigSource server,
                           const char *req_sequence, int features_start, int features_end,
                           const bool thread_fail_silent,
-                          gboolean group_flag, gboolean make_new_connection, gboolean terminate)
+                          gboolean group_flag, gboolean make_new_connection, gboolean terminate,
+                          gboolean reload)
 {
   GList * sources = NULL;
   GHashTable *ghash = NULL;
@@ -467,6 +495,7 @@ void zmapViewLoadFeatures(ZMapView view, ZMapFeatureBlock block_orig,
       GQuark dna_quark = zMapStyleCreateID(ZMAP_FIXED_STYLE_DNA_NAME) ;
       GQuark threeft_quark = zMapStyleCreateID(ZMAP_FIXED_STYLE_3FT_NAME) ;
       GQuark showtrans_quark = zMapStyleCreateID(ZMAP_FIXED_STYLE_SHOWTRANSLATION_NAME) ;
+      gboolean all_loaded = FALSE ;
 
       /* We need the DNA if we are showing DNA, 3FT or ShowTranslation */
       if (req_sources && 
@@ -477,10 +506,13 @@ void zmapViewLoadFeatures(ZMapView view, ZMapFeatureBlock block_orig,
           dna_requested = TRUE ;
         }
 
-      view_conn = zmapViewRequestServer(view, NULL, block_orig, req_sources, req_biotypes, server,
-                                        req_sequence, req_start, req_end, dna_requested, terminate, !view->thread_fail_silent);
+      view_conn = requestServerUnloaded(view, NULL, block_orig, req_sources, req_biotypes, server,
+                                        req_sequence, req_start, req_end, dna_requested, terminate, !view->thread_fail_silent,
+                                        reload, &all_loaded) ;
       if(view_conn)
         requested = TRUE;
+      else if (all_loaded)
+        g_list_free(req_sources) ;                          /* not passed on to any thread. */
     }
   else
     {
@@ -529,6 +561,7 @@ void zmapViewLoadFeatures(ZMapView view, ZMapFeatureBlock block_orig,
             {
               GList *req_featuresets = NULL;
               int existing = FALSE;
+              gboolean all_loaded = FALSE ;
 
               //          zMapLogMessage("Load features %s from %s, group = %d",
               //                         g_quark_to_string(featureset),server->url,server->group) ;
@@ -647,13 +680,16 @@ void zmapViewLoadFeatures(ZMapView view, ZMapFeatureBlock block_orig,
               view_conn = (make_new_connection ? NULL : (existing ? view_conn : NULL)) ;
 
 
-              view_conn = zmapViewRequestServer(view, view_conn, block_orig, req_featuresets, req_biotypes,
+              view_conn = requestServerUnloaded(view, view_conn, block_orig, req_featuresets, req_biotypes,
                                                 server, req_sequence, req_start, req_end,
                                                 dna_requested,
-                                                (!existing && terminate), !view->thread_fail_silent) ;
+                                                (!existing && terminate), !view->thread_fail_silent,
+                                                reload, &all_loaded) ;
 
               if(view_conn)
                 requested = TRUE;
+              else if (all_loaded)
+                g_list_free(req_featuresets) ;              /* not passed on to any thread. */
 
 
               // g_list_free(req_featuresets); no! this list gets used by threads
@@ -731,6 +767,114 @@ void zmapViewDestroyLoadFeatures(LoadFeaturesData loaded_features)
 }
 
 
+/* Record that start to end (fwd strand) of feature_sets has been fetched from their source so
+ * later requests for the same data can be trimmed or skipped, see requestServerUnloaded(). */
+void zmapViewLoadedRegionsMark(ZMapView view, GList *feature_sets, int start, int end)
+{
+  ZMapFeatureSequenceMap sequence_map = view->view_sequence ;
+  GList *l ;
+
+  /* Without the sequence extent there's no range to record in. */
+  if (!sequence_map || !sequence_map->end || start > end)
+    return ;
+
+  if (!view->loaded_regions)
+    view->loaded_regions = g_hash_table_new_full(NULL, NULL, NULL, loadedRegionsDestroyCB) ;
+
+  for (l = feature_sets ; l ; l = l->next)
+    {
+      GQuark key = loadedRegionsKey(GPOINTER_TO_UINT(l->data)) ;
+      ZMapSeqBitmap bitmap ;
+
+      if (!(bitmap = (ZMapSeqBitmap)g_hash_table_lookup(view->loaded_regions, GUINT_TO_POINTER(key))))
+        {
+          bitmap = zmapSeqBitmapCreate(sequence_map->start, sequence_map->end - sequence_map->start + 1,
+                                       LOADED_REGIONS_BIN_SIZE) ;
+
+          g_hash_table_insert(view->loaded_regions, GUINT_TO_POINTER(key), bitmap) ;
+        }
+
+      zmapSeqBitmapMarkRegion(bitmap, start, end) ;
+    }
+
+  return ;
+}
+
+
+/* Called whenever features may have been removed from the view. */
+void zmapViewLoadedRegionsClear(ZMapView view)
+{
+  if (view && view->loaded_regions)
+    g_hash_table_remove_all(view->loaded_regions) ;
+
+  return ;
+}
+
+
+void zmapViewLoadedRegionsDestroy(ZMapView view)
+{
+  if (view && view->loaded_regions)
+    {
+      g_hash_table_destroy(view->loaded_regions) ;
+      view->loaded_regions = NULL ;
+    }
+
+  return ;
+}
+
+
+/* Finishes and draws all merges of features from sources that are still running, this waits
+ * for them so must be called before anything else alters or redraws the view's context. The
+ * replies are still processed as normal by checkStateConnections(). */
+void zmapViewMergesFinish(ZMapView zmap_view)
+{
+  GList *list_item ;
+
+  for (list_item = zmap_view->connection_list ; list_item ; list_item = g_list_next(list_item))
+    {
+      ZMapNewDataSource view_con = (ZMapNewDataSource)(list_item->data) ;
+      ZMapConnectionData connect_data ;
+
+      if ((connect_data = (ZMapConnectionData)zMapServerConnectionGetUserData(view_con))
+          && connect_data->merge_job)
+        viewGetFeaturesFinish(zmap_view, connect_data) ;
+    }
+
+  return ;
+}
+
+
+/* The connection is going away so its reply will not be processed, any merge of its features
+ * is finished (and drawn unless the view is going too). */
+void zmapViewMergeDiscard(ZMapView zmap_view, ZMapConnectionData connect_data)
+{
+  if (connect_data->merge_job)
+    {
+      if (zmap_view->state != ZMAPVIEW_DYING)
+        {
+          viewGetFeaturesFinish(zmap_view, connect_data) ;
+        }
+      else
+        {
+          ZMapFeatureContext diff_context = NULL ;
+          ZMapFeatureContextMergeStats merge_stats = NULL ;
+
+          if (zMapFeatureContextMergeFinish(connect_data->merge_job,
+                                            &diff_context, &merge_stats) == ZMAPFEATURE_CONTEXT_OK)
+            zMapFeatureContextDestroy(diff_context, TRUE) ;
+
+          g_free(merge_stats) ;
+
+          connect_data->merge_job = NULL ;
+        }
+    }
+
+  connect_data->merge_finished = FALSE ;
+
+  return ;
+}
+
+
 
 
 //
@@ -1394,6 +1538,14 @@ static gboolean processDataRequests(void *user_data, ZMapServerReqAny req_any)
         /* features and getstatus combined as they can both display data */
         ZMapServerReqGetFeatures get_features = (ZMapServerReqGetFeatures)req_any ;
 
+        /* This reply was kept while its features were merged, see viewGetFeatures(). */
+        if (connect_data->merge_job || connect_data->merge_finished)
+          {
+            result = viewGetFeatures(zmap_view, connect_data->get_features, connect_data) ;
+
+            break ;
+          }
+
         if (req_any->response != ZMAP_SERVERRESPONSE_OK)
           result = FALSE ;
 
@@ -1639,63 +1791,246 @@ static void drawableCB(ZMapFeatureTypeStyle style, gpointer user_data)
 
 
 
-static gboolean viewGetFeatures(ZMapView zmap_view, ZMapServerReqGetFeatures feature_req, ZMapConnectionData connect_data)
+/* Requests only the parts of req_start to req_end that haven't already been loaded for all of
+ * req_featuresets, as one request per unloaded region. If everything is already loaded
+ * nothing is requested, NULL is returned and all_loaded_out is set TRUE; the caller still owns
+ * req_featuresets in that case.
+ *
+ * DNA requests are not trimmed (the DNA source is remembered as the view's sequence server),
+ * nor are requests where the featuresets aren't known until the source tells us. If reload
+ * is TRUE nothing is trimmed so that data changed in the source since it was loaded is
+ * fetched again. */
+static ZMapNewDataSource requestServerUnloaded(ZMapView view, ZMapNewDataSource view_conn,
+                                               ZMapFeatureBlock block_orig, GList *req_featuresets, GList *req_biotypes,
+                                               ZMapConfigSource server,
+                                               const char *req_sequence, int req_start, int req_end,
+                                               gboolean dna_requested, gboolean terminate, gboolean show_warning,
+                                               gboolean reload, gboolean *all_loaded_out)
 {
-  gboolean result = FALSE ;
-  ZMapFeatureContext new_features = NULL ;
-  ZMapFeatureContextMergeCode merge_results = ZMAPFEATURE_CONTEXT_ERROR ;
-  ZMapFeatureContext diff_context = NULL ;
-  GList *masked;
-
-
-  zMapPrintTimer(NULL, "Got Features from Thread") ;
-
-  /* May be a new context or a merge with an existing one. */
-  /*
-   * MH17: moved mergeAndDrawContext code here:
-   * Error handling is rubbish here...stuff needs to be free whether there is an error or not.
-   *
-   * new_features should be freed (but not the data...ahhhh actually the merge should
-   * free any replicated data...yes, that is what should happen. Then when it comes to
-   * the diff we should not free the data but should free all our structs...
-   *
-   * We should free the context_inout context here....actually better
-   * would to have a "free" flag............
-   *  */
-  if (feature_req->context)
+  ZMapNewDataSource new_conn = NULL ;
+  GList *regions, *l ;
+
+  *all_loaded_out = FALSE ;
+
+  if (dna_requested || reload || !req_featuresets)
+    return zmapViewRequestServer(view, view_conn, block_orig, req_featuresets, req_biotypes, server,
+                                 req_sequence, req_start, req_end, dna_requested, terminate, show_warning) ;
+
+  if (!(regions = getUnloadedRegions(view, req_featuresets, req_start, req_end)))
     {
-      ZMapFeatureContextMergeStats merge_stats = NULL ;
+      LoadFeaturesData loaded_features ;
 
-      new_features = feature_req->context ;
+      zMapLogMessage("Not requesting %s (%d featuresets) %d -> %d from %s, already loaded.",
+                     g_quark_to_string(GPOINTER_TO_UINT(req_featuresets->data)), g_list_length(req_featuresets),
+                     req_start, req_end, server->url()) ;
 
-      merge_results = zmapJustMergeContext(zmap_view,
-                                           &new_features, &merge_stats,
-                                           &masked, connect_data->session.request_as_columns, TRUE) ;
+      /* Our peer is still waiting to be told the features are loaded. */
+      loaded_features = zmapViewCreateLoadFeatures(req_featuresets) ;
+      loaded_features->status = TRUE ;
+      loaded_features->start = req_start ;
+      loaded_features->end = req_end ;
 
-      connect_data->loaded_features->merge_stats = *merge_stats ;
+      zmapViewSendLoaded(view, loaded_features) ;
+
+      zmapViewDestroyLoadFeatures(loaded_features) ;
+
+      *all_loaded_out = TRUE ;
+
+      return NULL ;
+    }
+
+  /* Our peer expects one features_loaded per request so for them, or if there are lots of
+   * holes, we just trim the already loaded ends off the request. */
+  if (regions->next && (view->remote_control || g_list_length(regions) > LOADED_REGIONS_MAX_REQUESTS))
+    {
+      ZMapSeqBitmapRegion first = (ZMapSeqBitmapRegion)(regions->data) ;
+      ZMapSeqBitmapRegion last = (ZMapSeqBitmapRegion)(g_list_last(regions)->data) ;
+
+      first->end = last->end ;
+
+      freeRegions(regions->next) ;
+      regions->next = NULL ;
+    }
+
+  for (l = regions ; l ; l = l->next)
+    {
+      ZMapSeqBitmapRegion region = (ZMapSeqBitmapRegion)(l->data) ;
+      GList *featuresets = req_featuresets ;
+      ZMapNewDataSource conn ;
+
+      if (region->start != req_start || region->end != req_end)
+        zMapLogMessage("Requesting %s (%d featuresets) %d -> %d of %d -> %d from %s, rest already loaded.",
+                       g_quark_to_string(GPOINTER_TO_UINT(req_featuresets->data)), g_list_length(req_featuresets),
+                       region->start, region->end, req_start, req_end, server->url()) ;
+
+      /* The featureset list is handed over to the request so each one needs its own. */
+      if (l != regions)
+        {
+          featuresets = g_list_copy(req_featuresets) ;
+          view_conn = NULL ;
+        }
+
+      if ((conn = zmapViewRequestServer(view, view_conn, block_orig, featuresets, req_biotypes, server,
+                                        req_sequence, region->start, region->end,
+                                        dna_requested, terminate, show_warning)))
+        new_conn = conn ;
+    }
+
+  freeRegions(regions) ;
+
+  return new_conn ;
+}
 
-      g_free(merge_stats) ;
 
+/* Returns the union of the parts of start to end not yet loaded for each of feature_sets as
+ * a list of ZMapSeqBitmapRegion in ascending order, NULL if they are all loaded. */
+static GList *getUnloadedRegions(ZMapView view, GList *feature_sets, int start, int end)
+{
+  GList *regions = NULL, *l ;
+
+  for (l = feature_sets ; l ; l = l->next)
+    {
+      GQuark key = loadedRegionsKey(GPOINTER_TO_UINT(l->data)) ;
+      ZMapSeqBitmap bitmap = NULL ;
 
+      if (view->loaded_regions)
+        bitmap = (ZMapSeqBitmap)g_hash_table_lookup(view->loaded_regions, GUINT_TO_POINTER(key)) ;
 
-      if (merge_results == ZMAPFEATURE_CONTEXT_OK)
+      if (!bitmap)
         {
-          diff_context = new_features ;
+          /* Nothing loaded for this one so the whole range is needed. */
+          ZMapSeqBitmapRegion region ;
+
+          freeRegions(regions) ;
+
+          region = g_new0(ZMapSeqBitmapRegionStruct, 1) ;
+          region->start = start ;
+          region->end = end ;
+
+          return g_list_append(NULL, region) ;
+        }
 
-          zmapJustDrawContext(zmap_view, diff_context, masked, NULL, connect_data) ;
+      regions = g_list_concat(regions, zmapSeqBitmapGetUnmarkedRegions(bitmap, start, end)) ;
+    }
+
+  regions = g_list_sort(regions, regionCmp) ;
+
+  for (l = regions ; l && l->next ; )
+    {
+      ZMapSeqBitmapRegion region = (ZMapSeqBitmapRegion)(l->data) ;
+      ZMapSeqBitmapRegion next = (ZMapSeqBitmapRegion)(l->next->data) ;
+
+      if (next->start <= region->end + 1)
+        {
+          if (next->end > region->end)
+            region->end = next->end ;
 
-          result = TRUE ;
+          g_free(next) ;
+          regions = g_list_delete_link(regions, l->next) ;
         }
       else
         {
+          l = l->next ;
+        }
+    }
+
+  return regions ;
+}
+
+
+static void freeRegions(GList *regions)
+{
+  GList *l ;
+
+  for (l = regions ; l ; l = l->next)
+    g_free(l->data) ;
+
+  g_list_free(regions) ;
+
+  return ;
+}
+
+
+static gint regionCmp(gconstpointer a, gconstpointer b)
+{
+  ZMapSeqBitmapRegion region_a = (ZMapSeqBitmapRegion)a ;
+  ZMapSeqBitmapRegion region_b = (ZMapSeqBitmapRegion)b ;
+  gint result = 0 ;
+
+  if (region_a->start < region_b->start)
+    result = -1 ;
+  else if (region_a->start > region_b->start)
+    result = 1 ;
+
+  return result ;
+}
+
+
+/* Requests may give featuresets by their original or unique names. */
+static GQuark loadedRegionsKey(GQuark feature_set_id)
+{
+  return zMapFeatureSetCreateID((char *)g_quark_to_string(feature_set_id)) ;
+}
+
+
+static void loadedRegionsDestroyCB(gpointer data)
+{
+  zmapSeqBitmapDestroy((ZMapSeqBitmap)data) ;
+
+  return ;
+}
+
+
+
+/* The features are merged into the view in another thread so the GUI carries on handling
+ * events during large loads. checkStateConnections() keeps the reply while the merge is running
+ * and passes it back here once it has finished, it's then drawn and the result returned. */
+static gboolean viewGetFeatures(ZMapView zmap_view, ZMapServerReqGetFeatures feature_req, ZMapConnectionData connect_data)
+{
+  gboolean result = FALSE ;
+
+  if (connect_data->merge_job && zMapFeatureContextMergeIsFinished(connect_data->merge_job))
+    viewGetFeaturesFinish(zmap_view, connect_data) ;
+
+  if (connect_data->merge_finished)
+    {
+      /* Merged and drawn, perhaps already by zmapViewMergesFinish(). */
+      connect_data->merge_finished = FALSE ;
+
+      result = connect_data->merge_result ;
+    }
+  else if (connect_data->merge_job)
+    {
+      result = TRUE ;
+    }
+  else
+    {
+      zMapPrintTimer(NULL, "Got Features from Thread") ;
+
+      /* May be a new context or a merge with an existing one. */
+      /*
+       * MH17: moved mergeAndDrawContext code here:
+       * Error handling is rubbish here...stuff needs to be free whether there is an error or not.
+       *
+       * new_features should be freed (but not the data...ahhhh actually the merge should
+       * free any replicated data...yes, that is what should happen. Then when it comes to
+       * the diff we should not free the data but should free all our structs...
+       *
+       * We should free the context_inout context here....actually better
+       * would to have a "free" flag............
+       *  */
+      if (feature_req->context)
+        {
+          ZMapFeatureContext new_features = feature_req->context ;
+
+          /* The merge owns the new features from here on. */
           feature_req->context = NULL ;
 
-          if (merge_results == ZMAPFEATURE_CONTEXT_NONE)
+          if ((connect_data->merge_job = zmapJustMergeContextStart(zmap_view, &new_features,
+                                                                    connect_data->session.request_as_columns,
+                                                                    TRUE)))
             {
-              g_set_error(&connect_data->error, ZMAP_VIEW_ERROR, ZMAPVIEW_ERROR_CONTEXT_EMPTY,
-                          "Context merge failed because no new features found in new context.") ;
-
-              zMapLogWarning("%s", connect_data->error->message) ;
+              result = TRUE ;
             }
           else
             {
@@ -1703,9 +2038,9 @@ static gboolean viewGetFeatures(ZMapView zmap_view, ZMapServerReqGetFeatures fea
                           "Context merge failed, serious error.") ;
 
               zMapLogCritical("%s", connect_data->error->message) ;
-            }
 
-          result = FALSE ;
+              result = FALSE ;
+            }
         }
     }
 
@@ -1713,6 +2048,65 @@ static gboolean viewGetFeatures(ZMapView zmap_view, ZMapServerReqGetFeatures fea
 }
 
 
+/* Completes the merge started by viewGetFeatures() and draws the new features, waiting for the
+ * merge if it's still running. The result is kept for when the reply is processed again. */
+static void viewGetFeaturesFinish(ZMapView zmap_view, ZMapConnectionData connect_data)
+{
+  gboolean result = FALSE ;
+  ZMapFeatureContextMergeCode merge_results = ZMAPFEATURE_CONTEXT_ERROR ;
+  ZMapFeatureContextMergeStats merge_stats = NULL ;
+  ZMapFeatureContext diff_context = NULL ;
+  GList *masked = NULL ;
+
+  merge_results = zmapJustMergeContextFinish(zmap_view, connect_data->merge_job,
+                                             &diff_context, &merge_stats, &masked) ;
+
+  connect_data->merge_job = NULL ;
+
+  if (merge_stats)
+    {
+      connect_data->loaded_features->merge_stats = *merge_stats ;
+
+      g_free(merge_stats) ;
+    }
+
+  /* Either way we now hold everything the source has for the requested range. */
+  if (merge_results == ZMAPFEATURE_CONTEXT_OK || merge_results == ZMAPFEATURE_CONTEXT_NONE)
+    zmapViewLoadedRegionsMark(zmap_view, connect_data->feature_sets, connect_data->start, connect_data->end) ;
+
+  if (merge_results == ZMAPFEATURE_CONTEXT_OK)
+    {
+      zmapJustDrawContext(zmap_view, diff_context, masked, NULL, connect_data) ;
+
+      result = TRUE ;
+    }
+  else
+    {
+      if (merge_results == ZMAPFEATURE_CONTEXT_NONE)
+        {
+          g_set_error(&connect_data->error, ZMAP_VIEW_ERROR, ZMAPVIEW_ERROR_CONTEXT_EMPTY,
+                      "Context merge failed because no new features found in new context.") ;
+
+          zMapLogWarning("%s", connect_data->error->message) ;
+        }
+      else
+        {
+          g_set_error(&connect_data->error, ZMAP_VIEW_ERROR, ZMAPVIEW_ERROR_CONTEXT_SERIOUS,
+                      "Context merge failed, serious error.") ;
+
+          zMapLogCritical("%s", connect_data->error->message) ;
+        }
+
+      result = FALSE ;
+    }
+
+  connect_data->merge_finished = TRUE ;
+  connect_data->merge_result = result ;
+
+  return ;
+}
+
+
 
 
 
@@ -164,6 +164,12 @@ typedef struct ZMapConnectionDataStructType
 
   LoadFeaturesData loaded_features ;                            /* List of feature sets loaded for this connection. */
 
+  /* The features are merged into the view in another thread, see viewGetFeatures(). */
+  ZMapFeatureContextMergeJob merge_job ;
+  gboolean merge_finished ;                                   /* Merge finished and drawn but reply
+                                                               not yet processed. */
+  gboolean merge_result ;
+
 } ZMapConnectionDataStruct, *ZMapConnectionData ;
 
 
@@ -176,6 +182,10 @@ typedef struct ZMapConnectionDataStructType
 
 
 
+/* Cache of what was last handed to blixem, see zmapViewCallBlixem.cpp */
+typedef struct ZMapViewBlixemCacheStructType *ZMapViewBlixemCache ;
+
+
 /* A "View" is a set of one or more windows that display data retrieved from one or
  * more servers. Note that the "View" windows are _not_ top level windows, they are panes
  * within a container widget that is supplied as a parent of the View then the View
@@ -313,6 +323,10 @@ typedef struct _ZMapViewStruct
    * killed when view dies (default is TRUE). */
   gboolean kill_blixems ;
   GList *spawned_processes ;
+  ZMapViewBlixemCache blixem_cache ;      /* Saves reformatting/rewriting files for blixem. */
+
+  GHashTable *loaded_regions ;            /* featureset unique id -> ZMapSeqBitmap of fwd strand
+                                           * coords already fetched from its source. */
 
   gboolean xremote_client ;               /* true if this zmap is an xremote client */
 
@@ -372,6 +386,8 @@ gboolean zmapViewCallBlixem(ZMapView view, ZMapFeatureBlock block,
 			    GList *features, ZMapFeatureSet feature_set,
 			    GList *source, GList *local_sequences,
 			    GPid *child_pid, gboolean *kill_on_exit) ;
+void zmapViewBlixemCacheClear(ZMapView view) ;
+void zmapViewBlixemCacheDestroy(ZMapView view) ;
 
 ZMapFeatureContext zmapViewMergeInContext(ZMapView view,
                                           ZMapFeatureContext context, ZMapFeatureContextMergeStats *merge_stats_out) ;
@@ -393,6 +409,14 @@ void zmapViewCWHDestroy(GHashTable **ghash);
 LoadFeaturesData zmapViewCreateLoadFeatures(GList *feature_sets) ;
 LoadFeaturesData zmapViewCopyLoadFeatures(LoadFeaturesData loaded_features_in) ;
 void zmapViewDestroyLoadFeatures(LoadFeaturesData loaded_features) ;
+void zmapViewSendLoaded(ZMapView view, LoadFeaturesData loaded_features) ;
+
+void zmapViewLoadedRegionsMark(ZMapView view, GList *feature_sets, int start, int end) ;
+void zmapViewLoadedRegionsClear(ZMapView view) ;
+void zmapViewLoadedRegionsDestroy(ZMapView view) ;
+
+void zmapViewMergesFinish(ZMapView zmap_view) ;
+void zmapViewMergeDiscard(ZMapView zmap_view, ZMapConnectionData connect_data) ;
 
 
 
@@ -406,7 +430,8 @@ void zmapViewLoadFeatures(ZMapView view, ZMapFeatureBlock block_orig, GList *req
                           ZMapConfigSource server,
                           const char *req_sequence, int features_start, int features_end, 
                           const bool thread_fail_silent,
-                          gboolean group, gboolean make_new_connection, gboolean terminate) ;
+                          gboolean group, gboolean make_new_connection, gboolean terminate,
+                          gboolean reload) ;
 
 GQuark zmapViewSrc2FSetGetID(GHashTable *source_2_featureset, char *source_name) ;
 GList *zmapViewSrc2FSetGetList(GHashTable *source_2_featureset, GList *source_list) ;
@@ -455,6 +480,7 @@ void zmapViewScratchRemoveFeatures(ZMapView view, GList *feature_list) ;
 void zmapViewScratchSaveFeature(ZMapView window, GQuark feature_id) ;
 void zmapViewScratchSaveFeatureSet(ZMapView window, GQuark feature_set_id) ;
 void zmapViewScratchResetAttributes(ZMapView view) ;
+void zmapViewScratchClearCheckpoints(ZMapView view) ;
 
 
 gboolean zmapViewSetUpServerConnections(ZMapView zmap_view, GList *settings_list, GError **error) ;
@@ -465,6 +491,12 @@ ZMapFeatureContextMergeCode zmapJustMergeContext(ZMapView view, ZMapFeatureConte
                                                  ZMapFeatureContextMergeStats *merge_stats_out,
                                                  GList **masked,
                                                  gboolean request_as_columns, gboolean revcomp_if_needed) ;
+ZMapFeatureContextMergeJob zmapJustMergeContextStart(ZMapView view, ZMapFeatureContext *context_inout,
+                                                     gboolean request_as_columns, gboolean revcomp_if_needed) ;
+ZMapFeatureContextMergeCode zmapJustMergeContextFinish(ZMapView view, ZMapFeatureContextMergeJob merge_job,
+                                                       ZMapFeatureContext *diff_context_out,
+                                                       ZMapFeatureContextMergeStats *merge_stats_out,
+                                                       GList **masked) ;
 void zmapJustDrawContext(ZMapView view, ZMapFeatureContext diff_context,
                          GList *masked, ZMapFeature highlight_feature,
                          ZMapConnectionData connect_data) ;
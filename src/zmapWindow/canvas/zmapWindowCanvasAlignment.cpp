@@ -54,6 +54,7 @@ static void zMapWindowCanvasAlignmentPaintFeature(ZMapWindowFeaturesetItem featu
 static void zMapWindowCanvasAlignmentGetFeatureExtent(ZMapWindowCanvasFeature feature, ZMapSpan span, double *width) ;
 static void zmapWindowCanvasAlignmentPreZoom(ZMapWindowFeaturesetItem featureset) ;
 static void zMapWindowCanvasAlignmentZoomSet(ZMapWindowFeaturesetItem featureset, GdkDrawable *drawable) ;
+static void alignmentIndex(ZMapWindowFeaturesetItem featureset) ;
 static ZMapWindowCanvasFeature zMapWindowCanvasAlignmentAddFeature(ZMapWindowFeaturesetItem featureset,
    ZMapFeature feature, double y1, double y2) ;
 static void zMapWindowCanvasAlignmentFreeSet(ZMapWindowFeaturesetItem featureset) ;
@@ -73,6 +74,11 @@ static void align_gap_free(AlignGap ag) ;
 static AlignGap align_gap_alloc(void) ;
 static AlignGap makeGapped(ZMapFeature feature, double offset, FooCanvasItem *foo,
                            int start, int end, GArray *align_gaps, gboolean is_forward) ;
+static gboolean alignIsForward(ZMapFeature feature) ;
+static AlignSeqGap getSeqGaps(ZMapWindowCanvasAlignment align, guint *n_gaps_out) ;
+static void alignmentFreeFeature(ZMapWindowCanvasFeature feature) ;
+static AlignGap makeDisplayGaps(ZMapWindowFeaturesetItem featureset, ZMapFeature feature,
+                                int start, int end, AlignSeqGap seq_gaps, guint n_gaps) ;
 
 
 
@@ -109,15 +115,17 @@ void zMapWindowCanvasAlignmentInit(void)
   funcs[FUNC_PAINT]  = (void *)zMapWindowCanvasAlignmentPaintFeature;
   funcs[FUNC_PRE_ZOOM] = (void *)zmapWindowCanvasAlignmentPreZoom ;
   funcs[FUNC_ZOOM]   = (void *)zMapWindowCanvasAlignmentZoomSet;
+  funcs[FUNC_INDEX]  = (void *)alignmentIndex ;
   funcs[FUNC_FREE]   = (void *)zMapWindowCanvasAlignmentFreeSet;
   funcs[FUNC_ADD]    = (void *)zMapWindowCanvasAlignmentAddFeature;
   funcs[FUNC_POINT]   = (void *)alignmentPoint;
 
-  zMapWindowCanvasFeatureSetSetFuncs(FEATURE_ALIGN, funcs, (size_t)0) ;
+  zMapWindowCanvasFeatureSetSetFuncs(FEATURE_ALIGN, funcs, sizeof(zmapWindowCanvasAlignmentSetStruct)) ;
 
 
   feature_funcs[CANVAS_FEATURE_FUNC_EXTENT] = (void *)zMapWindowCanvasAlignmentGetFeatureExtent ;
   feature_funcs[CANVAS_FEATURE_FUNC_SUBPART] = (void *)zmapWindowCanvasAlignmentGetSubPart ;
+  feature_funcs[CANVAS_FEATURE_FUNC_FREE] = (void *)alignmentFreeFeature ;
 
   zMapWindowCanvasFeatureSetSize(FEATURE_ALIGN, feature_funcs, sizeof(zmapWindowCanvasAlignmentStruct)) ;
 
@@ -336,30 +344,51 @@ static void zMapWindowCanvasAlignmentPaintFeature(ZMapWindowFeaturesetItem featu
       /*
        * create a list of things to draw at this zoom taking onto account bases per pixel
        *
-       * Note that: The function makeGapped() returns data in canvas pixel coordinates
-       * _relative_to_ the start of the feature, that is the quantity feature->feature->x1.
-       * Hence the rather arcane looking arithmetic on coordinates in the section below
-       * where these are modified for cases that are truncated.
+       * The match blocks are held in sequence coords and only need converting to pixels here,
+       * so zooming does not throw them away. Note that the list of things to draw is in canvas
+       * pixel coordinates _relative_to_ the start of the feature, that is the quantity
+       * feature->feature->x1, which may have been modified above for cases that are truncated.
        */
-      if (!align->gapped)
-        {
-          ZMapHomol homol = &feature->feature->feature.homol;
-          gboolean is_forward = (feature->feature->strand == homol->strand);
-
-          if (homol->strand == ZMAPSTRAND_REVERSE)
-            is_forward = !is_forward;
+      AlignSeqGap seq_gaps ;
+      AlignGap gapped ;
+      guint n_gaps = 0 ;
+      gboolean free_gapped = FALSE ;
 
-          align->gapped = zMapWindowCanvasAlignmentMakeGapped(featureset, feature,
-                                                              feature->feature->x1,
-                                                              feature->feature->x2,
-                                                              homol->align, is_forward) ;
+      if (featureset->type == FEATURE_ALIGN && featureset->opt && (seq_gaps = getSeqGaps(align, &n_gaps)))
+        {
+          gapped = makeDisplayGaps(featureset, feature->feature,
+                                   feature->feature->x1, feature->feature->x2,
+                                   seq_gaps, n_gaps) ;
+        }
+      else
+        {
+          /* alignment in a column of another type (mis-config), there is no column scratch
+           * space so make the list on the fly. */
+          gapped = zMapWindowCanvasAlignmentMakeGapped(featureset, feature,
+                                                       feature->feature->x1,
+                                                       feature->feature->x2,
+                                                       feature->feature->feature.homol.align,
+                                                       alignIsForward(feature->feature)) ;
+          free_gapped = TRUE ;
         }
 
       zMapCanvasDrawBoxGapped(drawable,
                               featureset->colinear_colours,
                               fill_set, outline_set, ufill, outline,
                               featureset, feature,
-                              x1, x2, align->gapped) ;
+                              x1, x2, gapped) ;
+
+      if (free_gapped)
+        {
+          AlignGap ag, del ;
+
+          for (ag = gapped ; ag ; )
+            {
+              del = ag ;
+              ag = ag->next ;
+              align_gap_free(del) ;
+            }
+        }
     }
 
 
@@ -480,10 +509,14 @@ static void zMapWindowCanvasAlignmentPaintFeature(ZMapWindowFeaturesetItem featu
               if (cy2 < expose->area.y)
                 continue;
 
+              ZMapWindowCanvasAlignment feat_align = (ZMapWindowCanvasAlignment)feat ;
               ColinearityType colinearity ;
 
-              colinearity = getInterBlockColinearity(featureset,
-                                                     (ZMapWindowCanvasAlignment)feat, (ZMapWindowCanvasAlignment)(feat->right)) ;
+              /* normally precomputed by alignmentIndex(). */
+              if (feat_align->colinear_right == feat->right)
+                colinearity = feat_align->right_colinearity ;
+              else
+                colinearity = getInterBlockColinearity(featureset, feat_align, next) ;
 
               colour = zMapCanvasDrawGetColinearGdkColor(ZMAP_WINDOW_FEATURESET_ITEM(featureset)->colinear_colours, colinearity) ;
 
@@ -582,43 +615,54 @@ static void zmapWindowCanvasAlignmentPreZoom(ZMapWindowFeaturesetItem featureset
 
 
 /*
- * if we are displaying a gapped alignment, recalculate this data
- * do this by freeing the existing data, new stuff will be added by the paint function
+ * Gapped alignments keep their match blocks in sequence coords and are converted to pixels
+ * by the paint function so there is nothing to recalculate on zoom.
  *
  * NOTE ref to FreeSet() below -> drawable may be NULL
  */
 static void zMapWindowCanvasAlignmentZoomSet(ZMapWindowFeaturesetItem featureset, GdkDrawable *drawable)
 {
-  ZMapSkipList sl;
-
   zMapReturnIfFail(featureset) ;
 
-  /* NOTE display index will be null on first call */
+  //printf("alignment zoom: %ld %ld %ld\n",n_block_alloc, n_gap_alloc, n_gap_free);
+
+  return ;
+}
+
 
-  /* feature specific eg bumped gapped alignments - adjust gaps display */
-  for(sl = zMapSkipListFirst(featureset->display_index); sl; sl = sl->next)
+
+/* The column has been sorted and linked and has a new display index: work out the colinearity
+ * between each pair of linked alignments now so the paint code only has to look it up. */
+static void alignmentIndex(ZMapWindowFeaturesetItem featureset)
+{
+  GList *l ;
+
+  zMapReturnIfFail(featureset) ;
+
+  for (l = featureset->features ; l ; l = l->next)
     {
-      ZMapWindowCanvasAlignment align = (ZMapWindowCanvasAlignment) sl->data;
-      AlignGap ag, del;
+      ZMapWindowCanvasAlignment align = (ZMapWindowCanvasAlignment)l->data ;
+      ZMapWindowCanvasFeature right = align->feature.right ;
 
       if (align->feature.type != FEATURE_ALIGN)/* we could have other types in the col due to mis-config */
-        continue;
+        continue ;
 
-      /* delete the old, these get created on paint */
-      for(ag = align->gapped; ag;)
+      if (right && right->type == FEATURE_ALIGN && align->feature.feature && right->feature)
         {
-          del = ag;
-          ag = ag->next;
-          align_gap_free(del);
+          align->colinear_right = right ;
+          align->right_colinearity = getInterBlockColinearity(featureset, align, (ZMapWindowCanvasAlignment)right) ;
+        }
+      else
+        {
+          align->colinear_right = NULL ;
+          align->right_colinearity = COLINEAR_INVALID ;
         }
-      align->gapped = NULL;
     }
 
-  //printf("alignment zoom: %ld %ld %ld\n",n_block_alloc, n_gap_alloc, n_gap_free);
+  return ;
 }
 
 
-
 static ZMapWindowCanvasFeature zMapWindowCanvasAlignmentAddFeature(ZMapWindowFeaturesetItem featureset,
                                                                    ZMapFeature feature, double y1, double y2)
 {
@@ -654,8 +698,32 @@ static ZMapWindowCanvasFeature zMapWindowCanvasAlignmentAddFeature(ZMapWindowFea
 
 static void zMapWindowCanvasAlignmentFreeSet(ZMapWindowFeaturesetItem featureset)
 {
+  ZMapWindowCanvasAlignmentSet align_set ;
+  GList *l ;
+
+  zMapReturnIfFail(featureset) ;
+
   /* frees gapped data _and does not alloc any more_ */
-  zMapWindowCanvasAlignmentZoomSet(featureset,NULL);
+  for (l = featureset->features ; l ; l = l->next)
+    {
+      ZMapWindowCanvasFeature feature = (ZMapWindowCanvasFeature)l->data ;
+
+      if (feature->type != FEATURE_ALIGN)/* we could have other types in the col due to mis-config */
+        continue ;
+
+      alignmentFreeFeature(feature) ;
+    }
+
+  if (featureset->type == FEATURE_ALIGN && (align_set = (ZMapWindowCanvasAlignmentSet)featureset->opt))
+    {
+      if (align_set->display_gaps)
+        {
+          g_array_free(align_set->display_gaps, TRUE) ;
+          align_set->display_gaps = NULL ;
+        }
+    }
+
+  return ;
 }
 
 
@@ -918,7 +986,7 @@ static gboolean hasNCSplices(ZMapFeature left, ZMapFeature right, gboolean *left
    */
 
 #if DEBUG_SPLICE
-  zMapLogWarning("splice %s",g_quark_to_string(left->unique_id));
+  zMapLogWarning("splice %s",zMapFeatureIDToString(left->unique_id));
 #endif
 
   // 3' end of exon: get 1 base of last exon  + 2 from intron
@@ -1183,6 +1251,232 @@ static AlignGap makeGapped(ZMapFeature feature, double offset, FooCanvasItem *fo
 
 
 
+/* Match blocks are drawn according to the boundary at the start of the block in the direction
+ * of the alignment. */
+static gboolean alignIsForward(ZMapFeature feature)
+{
+  ZMapHomol homol = &feature->feature.homol ;
+  gboolean is_forward ;
+
+  is_forward = (feature->strand == homol->strand) ;
+
+  if (homol->strand == ZMAPSTRAND_REVERSE)
+    is_forward = !is_forward ;
+
+  return is_forward ;
+}
+
+
+/* Returns the match blocks of a gapped alignment in sequence coords, creating them the first
+ * time the alignment is painted. These do not depend on the zoom so are kept until the canvas
+ * feature is freed. Returns NULL if the alignment is ungapped. */
+static AlignSeqGap getSeqGaps(ZMapWindowCanvasAlignment align, guint *n_gaps_out)
+{
+  AlignSeqGap seq_gaps = NULL ;
+  ZMapFeature feature ;
+  GArray *align_blocks ;
+
+  zMapReturnValIfFail(align && align->feature.feature && n_gaps_out, seq_gaps) ;
+
+  feature = align->feature.feature ;
+  align_blocks = feature->feature.homol.align ;
+
+  if (align->feature.type == FEATURE_ALIGN && align_blocks && align_blocks->len)
+    {
+      if (!align->seq_gaps)
+        {
+          gboolean is_forward = alignIsForward(feature) ;
+          ZMapAlignBlock last_ab = NULL ;
+          guint i ;
+
+          align->seq_gaps = g_new(AlignSeqGapStruct, align_blocks->len) ;
+
+          for (i = 0 ; i < align_blocks->len ; i++)
+            {
+              ZMapAlignBlock ab = &g_array_index(align_blocks, ZMapAlignBlockStruct, i) ;
+              AlignSeqGap seq_gap = align->seq_gaps + i ;
+
+              seq_gap->t1 = ab->t1 ;
+              seq_gap->t2 = ab->t2 ;
+              seq_gap->boundary = GAP_VLINE ;
+              seq_gap->colinearity = COLINEAR_INVALID ;
+
+              if (last_ab)
+                {
+                  AlignBlockBoundaryType boundary_type = (is_forward ? ab->start_boundary : ab->end_boundary) ;
+
+                  if (boundary_type == ALIGN_BLOCK_BOUNDARY_INTRON)
+                    {
+                      seq_gap->boundary = GAP_VLINE_INTRON ;
+                      seq_gap->colinearity = getIntraBlockColinearity(feature, last_ab, ab) ;
+                    }
+                }
+
+              last_ab = ab ;
+            }
+
+          align->n_seq_gaps = align_blocks->len ;
+        }
+
+      seq_gaps = align->seq_gaps ;
+      *n_gaps_out = align->n_seq_gaps ;
+    }
+
+  return seq_gaps ;
+}
+
+
+/* Called whenever an alignment canvas feature is freed. */
+static void alignmentFreeFeature(ZMapWindowCanvasFeature feature)
+{
+  ZMapWindowCanvasAlignment align = (ZMapWindowCanvasAlignment)feature ;
+
+  zMapReturnIfFail(feature && feature->type == FEATURE_ALIGN) ;
+
+  if (align->seq_gaps)
+    {
+      g_free(align->seq_gaps) ;
+      align->seq_gaps = NULL ;
+    }
+
+  align->n_seq_gaps = 0 ;
+
+  return ;
+}
+
+
+static guint appendDisplayGap(GArray *display_gaps, int y1, int y2, GappedAlignFeaturesType type,
+                              ColinearityType colinearity, gboolean edge)
+{
+  AlignGapStruct gap = { 0 } ;
+
+  gap.y1 = y1 ;
+  gap.y2 = y2 ;
+  gap.type = type ;
+  gap.colinearity = colinearity ;
+  gap.edge = edge ;
+
+  g_array_append_val(display_gaps, gap) ;
+
+  return display_gaps->len - 1 ;
+}
+
+
+/* As for makeGapped() but works from the cached sequence coord blocks and builds the list in
+ * the column's scratch array so nothing is allocated per alignment. The list is only valid
+ * until the next alignment in the column is painted.
+ *
+ * Boxes closer than a pixel are merged and squashed reads get their edge blocks flagged, the
+ * results are clipped to start/end and are relative to start in canvas pixels, exactly as
+ * from zMapWindowCanvasAlignmentMakeGapped(). */
+static AlignGap makeDisplayGaps(ZMapWindowFeaturesetItem featureset, ZMapFeature feature,
+                                int start, int end, AlignSeqGap seq_gaps, guint n_gaps)
+{
+  AlignGap display_ag = NULL ;
+  ZMapWindowCanvasAlignmentSet align_set = (ZMapWindowCanvasAlignmentSet)featureset->opt ;
+  FooCanvasItem *foo = (FooCanvasItem *)featureset ;
+  GArray *display_gaps ;
+  double offset ;
+  int fy1, max_y ;
+  int last_box = -1 ;
+  guint i ;
+
+  if (!align_set->display_gaps)
+    align_set->display_gaps = g_array_new(FALSE, TRUE, sizeof(AlignGapStruct)) ;
+
+  display_gaps = align_set->display_gaps ;
+  g_array_set_size(display_gaps, 0) ;
+
+  offset = featureset->dy - featureset->start ;
+
+  foo_canvas_w2c(foo->canvas, 0, start + offset, NULL, &fy1) ;
+  foo_canvas_w2c(foo->canvas, 0, end + 1 + offset, NULL, &max_y) ;
+  max_y -= fy1 ;
+
+  for (i = 0 ; i < n_gaps ; i++)
+    {
+      AlignSeqGap seq_gap = seq_gaps + i ;
+      AlignGap box ;
+      int cy1, cy2 ;
+      gboolean edge = FALSE ;
+
+      /* get pixel coords of block relative to feature y1, +1 to cover all of last base on cy2 */
+      foo_canvas_w2c(foo->canvas, 0, seq_gap->t1 + offset, NULL, &cy1) ;
+      foo_canvas_w2c(foo->canvas, 0, seq_gap->t2 + 1 + offset, NULL, &cy2) ;
+      cy1 -= fy1 ;
+      cy2 -= fy1 ;
+
+      if (last_box >= 0)
+        {
+          box = &g_array_index(display_gaps, AlignGapStruct, last_box) ;
+
+          if (i == 1 && (feature->flags.squashed_start))
+            {
+              box->edge = TRUE ;
+
+              if (box->y2 - box->y1 > 2)
+                last_box = -1 ;                             /* force a new box if the colours are visible */
+            }
+
+          if (i == (n_gaps - 1) && (feature->flags.squashed_end))
+            {
+              if (last_box >= 0 && box->y2 - box->y1 > 2)
+                last_box = -1 ;                             /* force a new box if the colours are visible */
+
+              edge = TRUE ;
+            }
+        }
+
+      if (last_box >= 0)
+        {
+          int box_y2 = g_array_index(display_gaps, AlignGapStruct, last_box).y2 ;
+
+          if (box_y2 == cy1 && cy2 != cy1)
+            {
+              /* extend last box and add a line where last box ended */
+              appendDisplayGap(display_gaps, box_y2, box_y2, GAP_HLINE, COLINEAR_INVALID, FALSE) ;
+
+              g_array_index(display_gaps, AlignGapStruct, last_box).y2 = cy2 ;
+            }
+          else if (box_y2 < cy1 - 1)
+            {
+              /* visible gap between boxes: add a colinear line */
+              appendDisplayGap(display_gaps, box_y2, cy1, seq_gap->boundary, seq_gap->colinearity, FALSE) ;
+            }
+
+          if (box_y2 < cy1)
+            {
+              /* create new box if edges do not overlap */
+              last_box = -1 ;
+            }
+        }
+
+      if (last_box < 0)
+        {
+          /* add a new box */
+          last_box = (int)appendDisplayGap(display_gaps, cy1, cy2, GAP_BOX, COLINEAR_INVALID, edge) ;
+        }
+    }
+
+  /* clip to the (possibly truncated) feature and link up the list. */
+  for (i = 0 ; i < display_gaps->len ; i++)
+    {
+      AlignGap ag = &g_array_index(display_gaps, AlignGapStruct, i) ;
+
+      ag->y1 = CLAMP(ag->y1, 0, max_y) ;
+      ag->y2 = CLAMP(ag->y2, 0, max_y) ;
+
+      ag->next = (i + 1 < display_gaps->len ? ag + 1 : NULL) ;
+    }
+
+  if (display_gaps->len)
+    display_ag = &g_array_index(display_gaps, AlignGapStruct, 0) ;
+
+  return display_ag ;
+}
+
+
+
 // Where an alignment has multiple separate matches to a sequence this function will calculate the
 // colinearity of adjacent matches given the align and next parameters.
 //
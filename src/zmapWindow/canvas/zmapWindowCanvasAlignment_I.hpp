@@ -42,13 +42,40 @@
 
 
 
+/* A match block of a gapped alignment in sequence coordinates. These are derived once per
+ * alignment from the feature's align blocks and kept across zooms, only the conversion to
+ * pixels is redone at paint time. */
+typedef struct AlignSeqGapStructType
+{
+  int t1, t2 ;					    /* target (sequence) coords of the block. */
+
+  GappedAlignFeaturesType boundary ;		    /* GAP_VLINE or GAP_VLINE_INTRON, how the
+						       block joins the previous one. */
+
+  ColinearityType colinearity ;			    /* colinearity with the previous block if
+						       boundary is GAP_VLINE_INTRON. */
+} AlignSeqGapStruct, *AlignSeqGap ;
+
+
+/* Per column data. */
+typedef struct _zmapWindowCanvasAlignmentSetStruct
+{
+  GArray *display_gaps ;			    /* AlignGapStruct, scratch space for the boxes and
+						       lines of the alignment currently being painted. */
+
+} zmapWindowCanvasAlignmentSetStruct, *ZMapWindowCanvasAlignmentSet ;
+
+
+
 typedef struct _zmapWindowCanvasAlignmentStruct
 {
   zmapWindowCanvasFeatureStruct feature;	/* all the common stuff */
 
   /* NOTE that we can have: alignment.feature->feature->feature.homol */
 
-  AlignGap gapped;		/* boxes and lines to draw when bumped */
+  /* match blocks to draw when bumped (lazy evaluation), freed with the canvas feature. */
+  AlignSeqGap seq_gaps ;
+  guint n_seq_gaps ;
 
   /* stuff for displaying homology status derived from feature data when loading */
 
@@ -64,6 +91,11 @@ typedef struct _zmapWindowCanvasAlignmentStruct
   /* has homology and gaps data (lazy evaluation) */
   gboolean bump_set ;
 
+  /* colinearity with the feature to the right, set when the column is indexed, only valid
+   * while colinear_right is still feature.right (links are remade when features are added). */
+  ZMapWindowCanvasFeature colinear_right ;
+  ColinearityType right_colinearity ;
+
 
 } zmapWindowCanvasAlignmentStruct, *ZMapWindowCanvasAlignment;
 
@@ -958,7 +958,8 @@ void zMapCanvasFeaturesetDrawSpliceHighlights(ZMapWindowFeaturesetItem featurese
         }
     }
 
-  g_list_foreach(feature->splice_positions, highlightSplice, &highlight_data) ;
+  for (guint i = 0 ; i < feature->splice_positions->len ; i++)
+    highlightSplice(&g_array_index(feature->splice_positions, ZMapSplicePositionStruct, i), &highlight_data) ;
 
   return ;
 }
@@ -41,9 +41,6 @@
 #include <zmapWindowCanvasFeature_I.hpp>
 
 
-static void freeSplicePosCB(gpointer data, gpointer user_data_unused) ;
-
-
 
 /*
  *                Globals
@@ -53,6 +50,7 @@ static ZMapWindowCanvasFeatureClass feature_class_G = NULL ;
 
 static gpointer feature_extent_G[FEATURE_N_TYPE] = { 0 } ;
 static gpointer feature_subpart_G[FEATURE_N_TYPE] = { 0 } ;
+static gpointer feature_free_G[FEATURE_N_TYPE] = { 0 } ;
 
 static long n_block_alloc = 0;
 static long n_feature_alloc = 0;
@@ -105,6 +103,7 @@ void zMapWindowCanvasFeatureSetSize(int featuretype, gpointer *feature_funcs, si
 
   feature_extent_G[featuretype] = feature_funcs[CANVAS_FEATURE_FUNC_EXTENT] ;
   feature_subpart_G[featuretype] = feature_funcs[CANVAS_FEATURE_FUNC_SUBPART] ;
+  feature_free_G[featuretype] = feature_funcs[CANVAS_FEATURE_FUNC_FREE] ;
 
   return ;
 }
@@ -215,27 +214,30 @@ gboolean zMapWindowCanvasFeatureGetFeatureExtent(ZMapWindowCanvasFeature feature
 void zMapWindowCanvasFeatureAddSplicePos(ZMapWindowCanvasFeature feature_item, int feature_pos,
                                          gboolean match, ZMapBoundaryType boundary_type)
 {
-  ZMapSplicePosition splice_pos ;
+  ZMapSplicePositionStruct splice_pos = { 0 } ;
   enum {SPLICE_WIDTH = 10} ;
   int splice_incr = SPLICE_WIDTH - 1 ;
 
-  splice_pos = g_new0(ZMapSplicePositionStruct, 1) ;
-  splice_pos->match = match ;
-  splice_pos->boundary_type = boundary_type ;
+  splice_pos.match = match ;
+  splice_pos.boundary_type = boundary_type ;
 
   if (boundary_type == ZMAPBOUNDARY_5_SPLICE)
     {
-      splice_pos->start = feature_pos ;
-      splice_pos->end = feature_pos + splice_incr  ;
+      splice_pos.start = feature_pos ;
+      splice_pos.end = feature_pos + splice_incr  ;
     }
   else
     {
-      splice_pos->start = feature_pos - splice_incr ;
-      splice_pos->end = feature_pos ;
+      splice_pos.start = feature_pos - splice_incr ;
+      splice_pos.end = feature_pos ;
     }
 
+  /* Positions are held in one packed array per feature so painting them is just a walk
+   * through the array. */
+  if (!feature_item->splice_positions)
+    feature_item->splice_positions = g_array_new(FALSE, FALSE, sizeof(ZMapSplicePositionStruct)) ;
 
-  feature_item->splice_positions = g_list_append(feature_item->splice_positions, splice_pos) ;
+  g_array_append_val(feature_item->splice_positions, splice_pos) ;
 
   return ;
 }
@@ -243,11 +245,12 @@ void zMapWindowCanvasFeatureAddSplicePos(ZMapWindowCanvasFeature feature_item, i
 
 void zMapWindowCanvasFeatureRemoveSplicePos(ZMapWindowCanvasFeature feature_item)
 {
-  g_list_foreach(feature_item->splice_positions, freeSplicePosCB, NULL) ;
-
-  g_list_free(feature_item->splice_positions) ;
+  if (feature_item->splice_positions)
+    {
+      g_array_free(feature_item->splice_positions, TRUE) ;
 
-  feature_item->splice_positions = NULL ;
+      feature_item->splice_positions = NULL ;
+    }
 
   return ;
 }
@@ -276,8 +279,8 @@ GString *zMapWindowCanvasFeature2Txt(ZMapWindowCanvasFeature canvas_feature)
     g_string_append_printf(canvas_feature_text, "%sContained ZMapFeature %p \"%s\" (unique id = \"%s\")\n",
                            indent,
                            canvas_feature->feature,
-                           (char *)g_quark_to_string(canvas_feature->feature->original_id),
-                           (char *)g_quark_to_string(canvas_feature->feature->unique_id)) ;
+                           (char *)zMapFeatureIDToString(canvas_feature->feature->original_id),
+                           (char *)zMapFeatureIDToString(canvas_feature->feature->unique_id)) ;
 
   g_string_append_printf(canvas_feature_text, "%sScore:  %g\n",
                          indent, canvas_feature->score) ;
@@ -602,12 +605,18 @@ void zmapWindowCanvasFeatureFree(gpointer thing)
 {
   ZMapWindowCanvasFeature feat = NULL ;
   zmapWindowCanvasFeatureType type ;
+  ZMapWindowCanvasFreeFeatureFunc func ;
 
   zMapReturnIfFail(thing && feature_class_G) ;
 
   feat = (ZMapWindowCanvasFeature) thing ;
   type = feat->type ;
 
+  /* features are recycled so anything they hold must go now. */
+  if (type > FEATURE_INVALID && type < FEATURE_N_TYPE
+      && (func = (ZMapWindowCanvasFreeFeatureFunc)feature_free_G[type]))
+    func(feat) ;
+
   if(!feature_class_G->struct_size[type])
     type = FEATURE_INVALID ;                /* catch all for simple features */
 
@@ -619,17 +628,3 @@ void zmapWindowCanvasFeatureFree(gpointer thing)
 
 
 
-/*
- *                    Internal routines
- */
-
-
-static void freeSplicePosCB(gpointer data, gpointer user_data_unused)
-{
-  ZMapSplicePosition splice_pos = (ZMapSplicePosition)data ; /* for debugging. */
-
-  g_free(splice_pos) ;
-
-  return ;
-}
-
@@ -40,6 +40,7 @@ typedef enum
   {
     CANVAS_FEATURE_FUNC_EXTENT,
     CANVAS_FEATURE_FUNC_SUBPART,
+    CANVAS_FEATURE_FUNC_FREE,                               /* free type specific data. */
     CANVAS_FEATURE_FUNC_N_FUNC
   } ZMapWindowCanvasFeatureFunc ;
 
@@ -129,9 +130,9 @@ typedef struct _zmapWindowCanvasFeatureStruct
 
   ZMapWindowCanvasFeature left,right;	/* for exons and alignments, NULL for simple features */
 
-  /* NULL if splice highlighting is off, contains positions of all places highlights
-   * need to be drawn within feature if highlighting is on. */
-  GList *splice_positions ;
+  /* NULL if splice highlighting is off, contains positions (ZMapSplicePositionStruct) of all
+   * places highlights need to be drawn within feature if highlighting is on. */
+  GArray *splice_positions ;
 
   /* NOT SURE IF WE NEED A SEPARATE LIST, THESE TWO THING MIGHT BE MUTUALLY EXCLUSIVE.... */
   GList *non_splice_positions ;
@@ -118,6 +118,9 @@ static double featurePoint(ZMapWindowFeaturesetItem fi, ZMapWindowCanvasFeature
 static double graphicsPoint(ZMapWindowFeaturesetItem fi, ZMapWindowCanvasFeature gs,
                             double item_x, double item_y, int cx, int cy,
                             double local_x, double local_y, double x_off) ;
+static gboolean pointTestFeature(ZMapWindowFeaturesetItem fi, ZMapWindowCanvasFeature gs,
+                                 double item_x, double item_y, int cx, int cy,
+                                 double local_x, double local_y, double x_off, double *best_inout) ;
 
 static void setFeaturesetColours(ZMapWindowFeaturesetItem featureset, ZMapWindowCanvasFeature feature);
 
@@ -141,6 +144,8 @@ void zmap_window_canvas_featureset_expose_feature(ZMapWindowFeaturesetItem fi, Z
 static guint32 gdk_color_to_rgba(GdkColor *color) ;
 
 static void itemLinkSideways(ZMapWindowFeaturesetItem fi) ;
+static gboolean indexNeedsPreparing(ZMapWindowFeaturesetItem fi) ;
+static void prepareIndexCB(gpointer data, gpointer user_data_unused) ;
 #if NOT_USED
 static gint setNameCmp(gconstpointer a, gconstpointer b) ;
 #endif
@@ -204,6 +209,7 @@ static gpointer _featureset_extent_G[FEATURE_N_TYPE] = { 0 };
 static gpointer _featureset_free_G[FEATURE_N_TYPE] = { 0 };
 static gpointer _featureset_pre_zoom_G[FEATURE_N_TYPE] = { 0 };
 static gpointer _featureset_zoom_G[FEATURE_N_TYPE] = { 0 };
+static gpointer _featureset_index_G[FEATURE_N_TYPE] = { 0 };
 static gpointer _featureset_point_G[FEATURE_N_TYPE] = { 0 };
 static gpointer _featureset_add_G[FEATURE_N_TYPE] = { 0 };
 
@@ -470,8 +476,8 @@ GString *zMapWindowCanvasFeatureset2Txt(ZMapWindowFeaturesetItem featureset_item
     g_string_append_printf(canvas_featureset_text, "%spoint_feature ZMapFeature %p \"%s\" (unique id = \"%s\")\n",
                            indent,
                            featureset_item->point_feature,
-                           (char *)g_quark_to_string(featureset_item->point_feature->original_id),
-                           (char *)g_quark_to_string(featureset_item->point_feature->unique_id)) ;
+                           (char *)zMapFeatureIDToString(featureset_item->point_feature->original_id),
+                           (char *)zMapFeatureIDToString(featureset_item->point_feature->unique_id)) ;
   else
     g_string_append_printf(canvas_featureset_text, "%spoint_feature ZMapFeature NULL\n", indent) ;
 
@@ -681,6 +687,7 @@ void zMapWindowCanvasFeatureSetSetFuncs(int featuretype,
   _featureset_colour_G[featuretype] = set_funcs[FUNC_COLOUR];
   _featureset_pre_zoom_G[featuretype] = set_funcs[FUNC_PRE_ZOOM];
   _featureset_zoom_G[featuretype] = set_funcs[FUNC_ZOOM];
+  _featureset_index_G[featuretype] = set_funcs[FUNC_INDEX];
   _featureset_free_G[featuretype] = set_funcs[FUNC_FREE];
   _featureset_point_G[featuretype] = set_funcs[FUNC_POINT];
   _featureset_add_G[featuretype] = set_funcs[FUNC_ADD];
@@ -1251,6 +1258,7 @@ void  zmap_window_featureset_item_item_bounds (FooCanvasItem *item, double *x1,
 void zMapWindowCanvasFeaturesetIndex(ZMapWindowFeaturesetItem fi)
 {
   GList *features;
+  ZMapWindowFeatureItemIndexFunc func ;
 
   zMapReturnIfFail(fi) ;
 
@@ -1278,6 +1286,45 @@ void zMapWindowCanvasFeaturesetIndex(ZMapWindowFeaturesetItem fi)
 
   fi->display_index = zMapSkipListCreate(features, NULL) ;
 
+  /* let the feature type precompute anything that depends on the linking/ordering. */
+  if ((fi->type > 0 && fi->type < FEATURE_N_TYPE)
+      && (func = (ZMapWindowFeatureItemIndexFunc)_featureset_index_G[fi->type]))
+    func(fi) ;
+
+  return ;
+}
+
+
+/* Columns smaller than this are not worth handing to another thread. */
+#define PREPARE_INDEX_MIN_FEATURES 1000
+
+
+/* Called from the window code after a load or a zoom with all the featureset items in the window,
+ * any that will need their index rebuilding on the next expose have their features sorted and
+ * linked (the expensive part of making the index) in parallel on the shared thread pool.
+ *
+ * This only touches each featureset's own feature list, the GUI thread waits for all the work
+ * to finish before returning so nothing else can get at the featuresets meanwhile. The skip
+ * lists themselves are still made on demand by zMapWindowCanvasFeaturesetIndex() as the skip
+ * list code uses a global free list. */
+void zMapWindowCanvasFeaturesetPrepareIndexes(GList *featureset_items)
+{
+  GList *l ;
+  GList *prepare_list = NULL ;
+
+  for (l = featureset_items ; l ; l = l->next)
+    {
+      ZMapWindowFeaturesetItem fi = (ZMapWindowFeaturesetItem)(l->data) ;
+
+      if (indexNeedsPreparing(fi))
+        prepare_list = g_list_prepend(prepare_list, fi) ;
+    }
+
+  /* Waits for all the columns to be done. */
+  zMap_g_thread_pool_run(prepare_list, prepareIndexCB, "index columns") ;
+
+  g_list_free(prepare_list) ;
+
   return ;
 }
 
@@ -1436,7 +1483,7 @@ static void zmap_window_featureset_item_item_draw(FooCanvasItem *item, GdkDrawab
 
       /*
         if(debug && feat->feature)
-        printf("feat: %s %lx %f %f\n",g_quark_to_string(feat->feature->unique_id), feat->flags,
+        printf("feat: %s %lx %f %f\n",zMapFeatureIDToString(feat->feature->unique_id), feat->flags,
         feat->y1,feat->y2);
       */
 
@@ -2111,6 +2158,20 @@ gboolean zmapWindowCanvasFeatureValid(ZMapWindowCanvasFeature feature)
 }
 
 
+/* Returns the first feature in the display index that could overlap y1 to y2, callers walk
+ * forwards from here until features start after y2. */
+ZMapSkipList zmapWindowCanvasFeaturesetFindFirst(ZMapWindowFeaturesetItem featureset, double y1, double y2)
+{
+  ZMapSkipList sl = NULL ;
+
+  zMapReturnValIfFail(featureset, sl) ;
+
+  sl = zmap_window_canvas_featureset_find_feature_coords(NULL, featureset, y1, y2) ;
+
+  return sl ;
+}
+
+
 static ZMapWindowCanvasFeature zmap_window_canvas_featureset_find_feature(ZMapWindowFeaturesetItem fi,
                                                                           ZMapFeature feature)
 {
@@ -2625,7 +2686,7 @@ GList *zMapWindowFeaturesetFindFeatures(ZMapWindowFeaturesetItem featureset_item
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
           char *name ;
 
-          name = g_quark_to_string(gs->feature->original_id) ;
+          name = zMapFeatureIDToString(gs->feature->original_id) ;
 #endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
           if(gs->flags & FEATURE_HIDDEN)        /* we are setting focus on visible features ! */
@@ -2857,6 +2918,8 @@ gboolean zmapWindowCanvasFeaturesetFreeDisplayLists(ZMapWindowFeaturesetItem fea
       zMapSkipListDestroy(featureset_item_inout->display_index, NULL) ;
       featureset_item_inout->display_index = NULL ;
       featureset_item_inout->curr_item = NULL ;
+      zmapWindowCanvasFeaturesetPointIndexFree(featureset_item_inout) ;
+      zmapWindowCanvasFeaturesetFilterIndexFree(featureset_item_inout) ;
 
       if (featureset_item_inout->display)
         {
@@ -2929,6 +2992,8 @@ gboolean zMapWindowFeaturesetItemSetStyle(ZMapWindowFeaturesetItem featureset_it
       zMapSkipListDestroy(featureset_item->display_index, NULL);
       featureset_item->display_index = NULL;
       featureset_item->curr_item = NULL ;
+      zmapWindowCanvasFeaturesetPointIndexFree(featureset_item) ;
+      zmapWindowCanvasFeaturesetFilterIndexFree(featureset_item) ;
 
 
       if (featureset_item->display)        /* was re-binned */
@@ -2948,6 +3013,10 @@ gboolean zMapWindowFeaturesetItemSetStyle(ZMapWindowFeaturesetItem featureset_it
 
 
   featureset_item->style = style;                /* includes col width */
+
+  /* score mode may have changed. */
+  zmapWindowCanvasFeaturesetFilterIndexFree(featureset_item) ;
+
   featureset_item->width = style->width;
   featureset_item->x_off = zMapStyleDensityStagger(style) * featureset_item->set_index;
   featureset_item->x_off += zMapStyleOffset(style);
@@ -3270,6 +3339,50 @@ double featureset_background_point(FooCanvasItem *item,int cx, int cy, FooCanvas
 
 
 
+/* Test a single feature against the cursor position, if it's closer than *best_inout then
+ * it becomes the point feature and TRUE is returned. */
+static gboolean pointTestFeature(ZMapWindowFeaturesetItem fi, ZMapWindowCanvasFeature gs,
+                                 double item_x, double item_y, int cx, int cy,
+                                 double local_x, double local_y, double x_off, double *best_inout)
+{
+  gboolean result = FALSE ;
+  ZMapWindowFeatureItemPointFunc point_func = NULL ;
+  double this_one ;
+  double left ;
+
+  if (gs->flags & FEATURE_HIDDEN)
+    return result ;
+
+  /* check for feature type specific point code, otherwise default to standard point func. */
+  if (gs->type > 0 && gs->type < FEATURE_N_TYPE)
+    point_func = (ZMapWindowFeatureItemPointFunc)_featureset_point_G[gs->type] ;
+
+  if (!point_func)
+    point_func = gs->type < FEATURE_GRAPHICS ? featurePoint : graphicsPoint ;
+
+  left = x_off ;
+
+  if (zMapStyleGetMode(fi->style) != ZMAPSTYLE_MODE_GRAPH)
+    left += fi->width / 2 - gs->width / 2 ;
+
+  if ((this_one = point_func(fi, gs, item_x, item_y, cx, cy, local_x, local_y, left)) < *best_inout)
+    {
+      fi->point_feature = gs->feature ;
+
+      /*
+       * NOTE: this could concievably cause a memory fault if we freed point_canvas_feature
+       * but that seems unlikely if we don-t nove the cursor
+       */
+      fi->point_canvas_feature = gs ;
+      *best_inout = this_one ;
+
+      result = TRUE ;
+    }
+
+  return result ;
+}
+
+
 /* how far are we from the cursor? */
 /* can't return foo canvas item for the feature as they are not in the canvas,
  * so return the featureset foo item adjusted to point at the nearest feature */
@@ -3283,7 +3396,6 @@ double  zmap_window_featureset_item_foo_point(FooCanvasItem *item,
                                               FooCanvasItem **actual_item)
 {
   double best = 1.0e36 ;                                    /* Default value from foocanvas code. */
-  ZMapWindowFeatureItemPointFunc point_func = NULL;
   ZMapWindowFeaturesetItem fi = (ZMapWindowFeaturesetItem)item;
   ZMapWindowCanvasFeature gs;
   ZMapSkipList sl;
@@ -3363,76 +3475,74 @@ double  zmap_window_featureset_item_foo_point(FooCanvasItem *item,
 
       x_off = fi->dx + fi->x_off;
 
-      /* NOTE there is a flake in world coords at low zoom */
-      /* NOTE close_enough is zero */
-      sl = zmap_window_canvas_featureset_find_feature_coords(zMapWindowFeatureFullCmp, fi, y1, y2) ;
-
-
-      /* AGH....HATEFUL....STOP RETURNING FROM THE MIDDLE OF STUFF..... */
-      //printf("point %s        %f,%f %d,%d: %p\n",g_quark_to_string(fi->id),x,y,cx,cy,sl);
-      if (!sl)
-        return featureset_background_point(item, cx, cy, actual_item) ;
-
-
-      for (; sl ; sl = sl->next)
+      /* Bumped columns can have a huge pileup at any one position so use the point index
+       * to go straight to the features under the cursor. */
+      if (fi->bumped && fi->point_index)
         {
-          double this_one;
-          double left;
-
-          gs = (ZMapWindowCanvasFeature) sl->data;
+          GList *candidates, *l ;
 
-          // printf("y1,2: %.1f %.1f,   gs: %s %lx %f %f\n",y1,y2, g_quark_to_string(gs->feature->unique_id), gs->flags, gs->y1,gs->y2);
+          candidates = zmapWindowCanvasFeaturesetPointIndexFind(fi, local_x - x_off - (fi->width / 2), y1, y2) ;
 
-          n++;
-          if (gs->flags & FEATURE_HIDDEN)
-            continue;
+          for (l = candidates ; l ; l = l->next)
+            {
+              n++ ;
 
+              if (pointTestFeature(fi, (ZMapWindowCanvasFeature)(l->data),
+                                   item_x, item_y, cx, cy, local_x, local_y, x_off, &best))
+                {
+                  *actual_item = item ;
 
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-          /* Perhaps this works for normal features BUT it's completely broken for glyphs....if
-             it's done at all it should be in the specific feature point routines. */
+                  if (!best)
+                    break ;
+                }
+            }
 
-          // mh17: if best is 1e36 this is silly:
-          //          if (gs->y1 > y2  + best)
-          if (gs->y1 > y2)                /* y2 has close_enough factored in */
-            break;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
+          g_list_free(candidates) ;
+        }
+      else
+        {
+          /* NOTE there is a flake in world coords at low zoom */
+          /* NOTE close_enough is zero */
+          sl = zmap_window_canvas_featureset_find_feature_coords(zMapWindowFeatureFullCmp, fi, y1, y2) ;
 
 
-          /* check for feature type specific point code, otherwise default to standard point func. */
-          point_func = NULL;
+          /* AGH....HATEFUL....STOP RETURNING FROM THE MIDDLE OF STUFF..... */
+          //printf("point %s        %f,%f %d,%d: %p\n",g_quark_to_string(fi->id),x,y,cx,cy,sl);
+          if (!sl)
+            return featureset_background_point(item, cx, cy, actual_item) ;
 
-          if (gs->type > 0 && gs->type < FEATURE_N_TYPE)
-            point_func = (ZMapWindowFeatureItemPointFunc)_featureset_point_G[gs->type] ;
 
-          if (!point_func)
-            point_func = gs->type < FEATURE_GRAPHICS ? featurePoint : graphicsPoint;
+          for (; sl ; sl = sl->next)
+            {
+              gs = (ZMapWindowCanvasFeature) sl->data;
 
-          left = x_off;
+              // printf("y1,2: %.1f %.1f,   gs: %s %lx %f %f\n",y1,y2, g_quark_to_string(gs->feature->unique_id), gs->flags, gs->y1,gs->y2);
 
-          if(zMapStyleGetMode(fi->style) != ZMAPSTYLE_MODE_GRAPH)
-            left += fi->width / 2 - gs->width / 2;
+              n++;
 
-          if ((this_one = point_func(fi, gs, item_x, item_y, cx, cy, local_x, local_y, left)) < best)
-            {
-              fi->point_feature = gs->feature;
-              *actual_item = item;
-              //printf("overlaps x\n");
 
-              /*
-               * NOTE: this could concievably cause a memory fault if we freed point_canvas_feature
-               * but that seems unlikely if we don-t nove the cursor
-               */
-              fi->point_canvas_feature = gs;
-              best = this_one;
+#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
+              /* Perhaps this works for normal features BUT it's completely broken for glyphs....if
+                 it's done at all it should be in the specific feature point routines. */
 
+              // mh17: if best is 1e36 this is silly:
+              //          if (gs->y1 > y2  + best)
+              if (gs->y1 > y2)                /* y2 has close_enough factored in */
+                break;
+#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
-              if(!best)        /* can't get better */
+              if (pointTestFeature(fi, gs, item_x, item_y, cx, cy, local_x, local_y, x_off, &best))
                 {
-                  /* and if we don't quit we will look at every other feature,
-                   * pointlessly, although that makes no difference to the user
-                   */
-                  break;
+                  *actual_item = item;
+                  //printf("overlaps x\n");
+
+                  if(!best)        /* can't get better */
+                    {
+                      /* and if we don't quit we will look at every other feature,
+                       * pointlessly, although that makes no difference to the user
+                       */
+                      break;
+                    }
                 }
             }
         }
@@ -3446,7 +3556,7 @@ double  zmap_window_featureset_item_foo_point(FooCanvasItem *item,
   { char *x = "";
     extern int n_item_pick; // foo canvas debug
 
-    if(fi->point_feature) x = (char *) g_quark_to_string(fi->point_feature->unique_id);
+    if(fi->point_feature) x = (char *) zMapFeatureIDToString(fi->point_feature->unique_id);
 
     zMapLogWarning("point tried %d/ %d features (%.1f,%.1f) @ %s (picked = %d)",
                    n,fi->n_features, item_x, item_y, x, n_item_pick);
@@ -3638,72 +3748,12 @@ int zMapWindowCanvasFeaturesetFilter(gpointer gfilter, double value, gboolean hi
 {
   ZMapWindowFilter filter = (ZMapWindowFilter)gfilter ;
   ZMapWindowFeaturesetItem fi = (ZMapWindowFeaturesetItem) filter->featureset ;
-  ZMapSkipList sl;
   int was = fi->n_filtered;
-  double score;
 
   fi->filter_value = value;
-  fi->n_filtered = 0;
-
-  for(sl = zMapSkipListFirst(fi->display_index); sl; sl = sl->next)
-    {
-      ZMapWindowCanvasFeature feature = (ZMapWindowCanvasFeature) sl->data;        /* base struct of all features */
-      ZMapWindowCanvasFeature f;
-
-      if (!zmapWindowCanvasFeatureValid(feature))
-        continue;
-
-      if(feature->left)                /* we do joined up alignments */
-        continue;
-
-      if( !feature->feature->flags.has_score && !feature->feature->population)
-        continue;
-
-
-      /* get score for whole series of alignments */
-      for(f = feature, score = 0.0; f; f = f->right)
-        {
-          double feature_score = feature->feature->population;
-
-          if(!feature_score)
-            {
-              feature_score = feature->feature->score;
-              /* NOTE feature->score is normalised, feature->feature->score is what we filter by */
-
-              if(zMapStyleGetScoreMode(*f->feature->style) == ZMAPSCORE_PERCENT)
-                feature_score = f->feature->feature.homol.percent_id;
-            }
-          if(feature_score > score)
-            score = feature_score;
-        }
-
-      /* set flags for whole series based on max score: filter is all below value */
-      for(f = feature; f; f = f->right)
-        {
-          if(score < value)
-            {
-              f->flags |= FEATURE_HIDE_FILTER | FEATURE_HIDDEN;
-              fi->n_filtered++;
-
-              /* NOTE many of these may be FEATURE_SUMMARISED which is not operative during bump
-               * so setting HIDDEN here must be done for the filtered features only
-               * Hmmm... not quite sure of the mechanism, but putting this if
-               * outside the brackets give a glitch on set column focus when bumped (features not painted)
-               * .... summarised features (FEATURE_SUMMARISED set but not HIDDEN bue to bumping) set to hidden when bumped
-               */
-            }
-          else
-            {
-              /* reset in case score went down */
 
-              f->flags &= ~FEATURE_HIDE_FILTER;
-              if(!(f->flags & FEATURE_HIDE_REASON))
-                f->flags &= ~FEATURE_HIDDEN;
-              else if(fi->bumped && (f->flags & FEATURE_HIDE_REASON) == FEATURE_SUMMARISED)
-                f->flags &= ~FEATURE_HIDDEN;
-            }
-        }
-    }
+  /* features are kept sorted by score so only those between the old and new values change. */
+  fi->n_filtered = zmapWindowCanvasFeaturesetFilterIndexApply(fi, value) ;
 
   if(fi->n_filtered != was)
     {
@@ -3954,6 +4004,8 @@ int zMapWindowFeaturesetItemRemoveFeature(FooCanvasItem *foo, ZMapFeature featur
       zMapSkipListDestroy(fi->display_index, NULL);
       fi->display_index = NULL;
       fi->curr_item = NULL ;
+      zmapWindowCanvasFeaturesetPointIndexFree(fi) ;
+      zmapWindowCanvasFeaturesetFilterIndexFree(fi) ;
 
       /* is still sorted if it was before */
     }
@@ -4013,6 +4065,8 @@ void zMapWindowFeaturesetRemoveAllGraphics(ZMapWindowFeaturesetItem featureset_i
       /* zMapSkipListDestroy(featureset_item->display_index, NULL); */
       featureset_item->display_index = NULL;
       featureset_item->curr_item = NULL ;
+      zmapWindowCanvasFeaturesetPointIndexFree(featureset_item) ;
+      zmapWindowCanvasFeaturesetFilterIndexFree(featureset_item) ;
     }
 
   featureset_item->n_features = 0 ;
@@ -4092,6 +4146,8 @@ int zMapWindowFeaturesetRemoveGraphics(ZMapWindowFeaturesetItem featureset_item,
       zMapSkipListDestroy(fi->display_index, NULL);
       fi->display_index = NULL;
       fi->curr_item = NULL ;
+      zmapWindowCanvasFeaturesetPointIndexFree(fi) ;
+      zmapWindowCanvasFeaturesetFilterIndexFree(fi) ;
 
       /* is still sorted if it was before */
     }
@@ -4199,6 +4255,8 @@ int zMapWindowFeaturesetItemRemoveSet(FooCanvasItem *foo, ZMapFeatureSet feature
       zMapSkipListDestroy(fi->display_index, NULL);
       fi->display_index = NULL;
       fi->curr_item = NULL ;
+      zmapWindowCanvasFeaturesetPointIndexFree(fi) ;
+      zmapWindowCanvasFeaturesetFilterIndexFree(fi) ;
 
       /* is still sorted if it was before */
     }
@@ -4290,7 +4348,7 @@ static void featuresetAddToIndex(ZMapWindowFeaturesetItem featureset_item, ZMapW
       ZMapFeature feature = feat->feature;
 
       printf("add item %s %s @%p %p: %ld/%d style %p/%p %s\n",
-             g_quark_to_string(featureset_item->id),g_quark_to_string(feature->unique_id),
+             g_quark_to_string(featureset_item->id),zMapFeatureIDToString(feature->unique_id),
              featureset, feature,
              featureset_item->n_features, g_list_length(featureset_item->features),
              featureset->style, *feature->style, g_quark_to_string(featureset->style->unique_id));
@@ -4311,6 +4369,8 @@ static void featuresetAddToIndex(ZMapWindowFeaturesetItem featureset_item, ZMapW
         zMapSkipListDestroy(featureset_item->display_index, NULL) ;
         featureset_item->display_index = NULL ;
         featureset_item->curr_item = NULL ;
+        zmapWindowCanvasFeaturesetPointIndexFree(featureset_item) ;
+        zmapWindowCanvasFeaturesetFilterIndexFree(featureset_item) ;
       }
     }
   /* must set this independantly as empty columns with no index get flagged as sorted */
@@ -4358,7 +4418,7 @@ static void setFeaturesetColours(ZMapWindowFeaturesetItem fi, ZMapWindowCanvasFe
 
       if (tmp_debug)
         zMapUtilsDebugPrintf(stderr, "Feature: \"%s\", \"%s\"\n",
-                             g_quark_to_string(feature->original_id), g_quark_to_string(feature->unique_id)) ;
+                             zMapFeatureIDToString(feature->original_id), zMapFeatureIDToString(feature->unique_id)) ;
 
       /* diff style: set colour from style */
       /* cache style for a single featureset
@@ -4524,6 +4584,38 @@ static void itemLinkSideways(ZMapWindowFeaturesetItem fi)
 
 
 
+/* Will the next zMapWindowCanvasFeaturesetIndex() have to sort/link a lot of features ? */
+static gboolean indexNeedsPreparing(ZMapWindowFeaturesetItem fi)
+{
+  gboolean result = FALSE ;
+
+  if (fi && !fi->display_index && fi->n_features >= PREPARE_INDEX_MIN_FEATURES
+      && ((fi->link_sideways && !fi->linked_sideways) || !fi->features_sorted))
+    result = TRUE ;
+
+  return result ;
+}
+
+
+/* Does the sorting/linking part of zMapWindowCanvasFeaturesetIndex(), may be run in a
+ * worker thread so must only touch the featureset's own data. */
+static void prepareIndexCB(gpointer data, gpointer user_data_unused)
+{
+  ZMapWindowFeaturesetItem fi = (ZMapWindowFeaturesetItem)data ;
+
+  if (fi->link_sideways && !fi->linked_sideways)
+    itemLinkSideways(fi) ;
+
+  if (!fi->features_sorted)
+    {
+      fi->features = g_list_sort(fi->features, zMapWindowFeatureCmp) ;
+      fi->features_sorted = TRUE ;
+    }
+
+  return ;
+}
+
+
 /* Default function to check if the given x,y coord is within a feature, this
  * function assumes the feature is box-like. */
 static double featurePoint(ZMapWindowFeaturesetItem fi, ZMapWindowCanvasFeature gs,
@@ -4653,6 +4745,8 @@ static void zmap_window_featureset_item_item_destroy (GtkObject *object)
           featureset_item->display_index = NULL;
           featureset_item->features_sorted = FALSE;
           featureset_item->curr_item = NULL ;
+          zmapWindowCanvasFeaturesetPointIndexFree(featureset_item) ;
+          zmapWindowCanvasFeaturesetFilterIndexFree(featureset_item) ;
         }
       if(featureset_item->display)        /* was re-binned */
         {
@@ -107,8 +107,29 @@ typedef double (*ZMapWindowFeatureItemPointFunc)(ZMapWindowFeaturesetItem fi, ZM
 
 typedef void (*ZMapWindowFeatureFreeFunc)(ZMapWindowFeaturesetItem featureset) ;
 
+/* Called once the display index has been made, features are sorted and linked sideways. */
+typedef void (*ZMapWindowFeatureItemIndexFunc)(ZMapWindowFeaturesetItem featureset) ;
+
 typedef void (*ZMapWindowCanvasGetExtentFunc)(ZMapWindowCanvasFeature feature, ZMapSpan span, double *width) ;
 typedef ZMapFeatureSubPart (*ZMapWindowCanvasGetSubPartFunc) (FooCanvasItem *foo, ZMapFeature feature, double x, double y) ;
+typedef void (*ZMapWindowCanvasFreeFeatureFunc)(ZMapWindowCanvasFeature feature) ;
+
+
+
+/* Drawing primitives handed out by zMapWindowCanvasFeaturesetExport(), coords are world. */
+typedef enum {ZMAPWINDOW_EXPORT_BOX, ZMAPWINDOW_EXPORT_LINE} ZMapWindowCanvasExportType ;
+
+typedef struct ZMapWindowCanvasExportStructType
+{
+  ZMapWindowCanvasExportType type ;
+
+  double x1, y1, x2, y2 ;                                   /* line is x1,y1 to x2,y2 */
+
+  gboolean fill_set, outline_set ;                          /* line is drawn in outline colour. */
+  gulong fill_pixel, outline_pixel ;
+} ZMapWindowCanvasExportStruct, *ZMapWindowCanvasExport ;
+
+typedef void (*ZMapWindowCanvasExportFunc)(ZMapWindowCanvasExport primitive, gpointer user_data) ;
 
 
 
@@ -250,6 +271,7 @@ gboolean zMapWindowCanvasFeaturesetGetSpliceColour(ZMapWindowFeaturesetItem feat
                                                    gulong *border_pixel, gulong *fill_pixel) ;
 
 void zMapWindowCanvasFeaturesetIndex(ZMapWindowFeaturesetItem fi);
+void zMapWindowCanvasFeaturesetPrepareIndexes(GList *featureset_items) ;
 
 gboolean zMapWindowCanvasFeaturesetGetSeqCoord(ZMapWindowFeaturesetItem featureset,
                                                gboolean is_set, double x, double y, long *start, long *end);
@@ -263,6 +285,8 @@ GList *zMapWindowFeaturesetFindFeatures(ZMapWindowFeaturesetItem featureset, dou
 GList *zMapWindowFeaturesetFindGroupedFeatures(ZMapWindowFeaturesetItem featureset_item, double y1, double y2,
                                                gboolean canonical_only) ;
 void zMapWindowFeaturesetFreeGroupedFeatures(GList *grouped_features) ;
+int zMapWindowCanvasFeaturesetExport(ZMapWindowFeaturesetItem featureset, double y1, double y2,
+                                     double min_height, ZMapWindowCanvasExportFunc func, gpointer func_data) ;
 
 void zMapWindowCanvasFeaturesetPaintFeature(ZMapWindowFeaturesetItem featureset, ZMapWindowCanvasFeature feature,
 					    GdkDrawable *drawable, GdkEventExpose *expose);
@@ -544,7 +544,7 @@ gboolean zMapWindowCanvasFeaturesetBump(ZMapWindowFeaturesetItem featureset, ZMa
                                                                  GUINT_TO_POINTER(feature->bump_col))) ;
 
                 /* printf("offset feature %s @ %p %f,%f %d = %f\n",
-                   g_quark_to_string(feature->feature->unique_id), feature,
+                   zMapFeatureIDToString(feature->feature->unique_id), feature,
                    feature->y1,feature->y2,(int) feature->bump_col, width); */
 
 
@@ -592,6 +592,9 @@ gboolean zMapWindowCanvasFeaturesetBump(ZMapWindowFeaturesetItem featureset, ZMa
       result = TRUE ;
     }
 
+  /* Offsets have all changed so the point index must be rebuilt, if unbumped it's just freed. */
+  zmapWindowCanvasFeaturesetPointIndexCreate(featureset) ;
+
 
   return result ;
 }
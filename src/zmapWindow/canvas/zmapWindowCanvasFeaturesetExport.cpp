@@ -0,0 +1,441 @@
+/*  File: zmapWindowCanvasFeaturesetExport.cpp
+ *  Author: Ed Griffiths (edgrif@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: Walks the features of a featureset in a range handing
+ *              simple drawing primitives to a caller supplied function,
+ *              used to export columns to vector formats.
+ *
+ * Exported functions: See zmapWindowCanvasFeatureset.hpp
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <glib.h>
+
+#include <ZMap/zmapUtilsLog.hpp>
+#include <ZMap/zmapSkipList.hpp>
+#include <zmapWindowCanvasDraw.hpp>
+#include <zmapWindowCanvasFeatureset_I.hpp>
+#include <zmapWindowCanvasFeature_I.hpp>
+#include <zmapWindowCanvasTranscript_I.hpp>
+
+
+
+/*
+ * Exporting a whole chromosome used to produce one primitive per feature even though
+ * thousands of them could end up on the same point of the output. Here we only export
+ * features that would be drawn at the current zoom, i.e. not hidden for any reason including
+ * summarise (which hides features completely covered by others), and we merge features
+ * that would be drawn on the same output rows into one primitive.
+ *
+ * Primitives are binned by the x position of their centre (i.e. the bump sub-column, score
+ * width boxes share a centre) and by colour, each bin holds one primitive not yet passed
+ * to the caller. A box less than min_height tall, or one with no outline and the same x
+ * extent, is merged into its bin if it is within min_height of it, otherwise the bin is
+ * flushed and restarted with the new box. Lines (introns, alignment gaps) are merged in
+ * the same way. Features are taken in start coord order from the display index so bins
+ * that end before the current feature can be flushed as we go, this means each bin gives
+ * at most one primitive per output row plus one per feature taller than a row, however
+ * many features there are.
+ *
+ * Exons and alignment blocks are exported as boxes joined by lines (introns and gaps), other
+ * features just as their bounding box. The CDS of an exon is exported as a separate box in
+ * the CDS colours. Glyphs, text, sequence and graph columns are not exported.
+ */
+
+
+
+typedef struct ExportDataStructType
+{
+  ZMapWindowFeaturesetItem featureset ;
+
+  double min_height ;                                       /* world coords of one output unit. */
+
+  ZMapWindowCanvasExportFunc func ;
+  gpointer func_data ;
+
+  /* Colours of the current feature or part of it. */
+  gboolean fill_set, outline_set ;
+  gulong fill_pixel, outline_pixel ;
+
+  /* Of ZMapWindowCanvasExport, one per bin, not yet passed to func. */
+  GList *bins ;
+
+  int n_primitives ;
+} ExportDataStruct, *ExportData ;
+
+
+
+static void exportFeature(ExportData export_data, ZMapWindowCanvasFeature feature) ;
+static void exportExon(ExportData export_data, ZMapWindowCanvasFeature feature, double x1, double x2) ;
+static void exportBox(ExportData export_data, double x1, double x2, double y1, double y2) ;
+static void exportLine(ExportData export_data, double x, double y1, double y2) ;
+static void exportAdd(ExportData export_data, ZMapWindowCanvasExport primitive, gboolean mergeable) ;
+static gboolean sameBin(ZMapWindowCanvasExport bin, ZMapWindowCanvasExport primitive) ;
+static void exportFlush(ExportData export_data, double y) ;
+static gboolean clampToFeatureset(ExportData export_data, double *y1_inout, double *y2_inout) ;
+
+
+
+/*
+ *                  External routines
+ */
+
+
+/* Calls func for the primitives needed to draw the features of the featureset that overlap
+ * y1 to y2, min_height is the height in world coords of one unit of the output, features
+ * smaller than this are merged where possible. Returns the number of primitives exported. */
+int zMapWindowCanvasFeaturesetExport(ZMapWindowFeaturesetItem featureset, double y1, double y2,
+                                     double min_height, ZMapWindowCanvasExportFunc func, gpointer func_data)
+{
+  ExportDataStruct export_data = {NULL} ;
+  ZMapSkipList sl ;
+
+  zMapReturnValIfFail((featureset && func && y1 <= y2), 0) ;
+
+  switch (featureset->type)
+    {
+    case FEATURE_BASIC:
+    case FEATURE_ALIGN:
+    case FEATURE_TRANSCRIPT:
+    case FEATURE_ASSEMBLY:
+      break ;
+
+    default:
+      return 0 ;
+    }
+
+  if (!featureset->display_index)
+    zMapWindowCanvasFeaturesetIndex(featureset) ;
+
+  export_data.featureset = featureset ;
+  export_data.min_height = min_height ;
+  export_data.func = func ;
+  export_data.func_data = func_data ;
+
+  for (sl = zmapWindowCanvasFeaturesetFindFirst(featureset, y1, y2) ; sl ; sl = sl->next)
+    {
+      ZMapWindowCanvasFeature feature = (ZMapWindowCanvasFeature)(sl->data) ;
+
+      if (feature->y1 > y2)
+        break ;
+
+      if (feature->y2 < y1 || !zmapWindowCanvasFeatureValid(feature) || (feature->flags & FEATURE_HIDDEN))
+        continue ;
+
+      /* Nothing from here on can be merged into bins that end before this feature. */
+      exportFlush(&export_data, feature->y1) ;
+
+      exportFeature(&export_data, feature) ;
+    }
+
+  exportFlush(&export_data, G_MAXDOUBLE) ;
+
+  return export_data.n_primitives ;
+}
+
+
+
+
+/*
+ *                  Internal routines
+ */
+
+
+static void exportFeature(ExportData export_data, ZMapWindowCanvasFeature feature)
+{
+  ZMapWindowFeaturesetItem featureset = export_data->featureset ;
+  ZMapFeature zmap_feature = feature->feature ;
+  GArray *blocks = NULL ;
+  double x1 = 0.0, x2 = 0.0 ;
+  int colours_set ;
+
+  if (!zMapWindowCanvasCalcHorizCoords(featureset, feature, &x1, &x2))
+    return ;
+
+  colours_set = zMapWindowCanvasFeaturesetGetColours(featureset, feature,
+                                                     &export_data->fill_pixel, &export_data->outline_pixel) ;
+  export_data->fill_set = ((colours_set & WINDOW_FOCUS_CACHE_FILL) ? TRUE : FALSE) ;
+  export_data->outline_set = ((colours_set & WINDOW_FOCUS_CACHE_OUTLINE) ? TRUE : FALSE) ;
+
+  if (!export_data->fill_set && !export_data->outline_set)
+    return ;
+
+  /* Transcripts already have a canvas feature per exon and intron. Inside an alignment
+   * smaller than one unit there is nothing to see so just do its box. */
+  if (featureset->type == FEATURE_TRANSCRIPT)
+    {
+      ZMapWindowCanvasTranscript transcript = (ZMapWindowCanvasTranscript)feature ;
+
+      if (transcript->sub_type == TRANSCRIPT_EXON)
+        exportExon(export_data, feature, x1, x2) ;
+      else
+        exportLine(export_data, (x1 + x2) / 2, feature->y1, feature->y2) ;
+
+      return ;
+    }
+  else if (ZMAPFEATURE_IS_ALIGNMENT(zmap_feature) && feature->y2 - feature->y1 + 1 > export_data->min_height)
+    {
+      blocks = zmap_feature->feature.homol.align ;
+    }
+
+  if (!blocks || blocks->len < 2)
+    {
+      exportBox(export_data, x1, x2, feature->y1, feature->y2) ;
+    }
+  else
+    {
+      ZMapAlignBlock prev = NULL ;
+      guint i ;
+
+      /* Blocks may be in either order depending on strand. */
+      for (i = 0 ; i < blocks->len ; i++)
+        {
+          ZMapAlignBlock block = &g_array_index(blocks, ZMapAlignBlockStruct, i) ;
+
+          if (prev)
+            {
+              if (block->t1 > prev->t2 + 1)
+                exportLine(export_data, (x1 + x2) / 2, prev->t2 + 1, block->t1 - 1) ;
+              else if (prev->t1 > block->t2 + 1)
+                exportLine(export_data, (x1 + x2) / 2, block->t2 + 1, prev->t1 - 1) ;
+            }
+
+          exportBox(export_data, x1, x2, block->t1, block->t2) ;
+
+          prev = block ;
+        }
+    }
+
+  return ;
+}
+
+
+/* Splits the exon into UTR and CDS boxes, coloured as in transcriptPaintFeature(). */
+static void exportExon(ExportData export_data, ZMapWindowCanvasFeature feature, double x1, double x2)
+{
+  ZMapTranscript transcript = &feature->feature->feature.transcript ;
+  double y1 = feature->y1, y2 = feature->y2 ;
+
+  if (transcript->flags.cds && transcript->cds_start > y1 && transcript->cds_start < y2)
+    {
+      exportBox(export_data, x1, x2, y1, transcript->cds_start - 1) ;
+      y1 = transcript->cds_start ;
+    }
+
+  if (transcript->flags.cds && transcript->cds_end > y1 && transcript->cds_end < y2)
+    {
+      exportBox(export_data, x1, x2, transcript->cds_end + 1, y2) ;
+      y2 = transcript->cds_end ;
+    }
+
+  if (transcript->flags.cds && transcript->cds_start <= y1 && transcript->cds_end >= y2)
+    {
+      FooCanvasItem *foo = (FooCanvasItem *)(export_data->featureset) ;
+      ZMapStyleColourType ct ;
+      GdkColor *gdk_fill = NULL, *gdk_outline = NULL ;
+
+      ct = ((feature->flags & WINDOW_FOCUS_GROUP_FOCUSSED)
+            ? ZMAPSTYLE_COLOURTYPE_SELECTED : ZMAPSTYLE_COLOURTYPE_NORMAL) ;
+      zMapStyleGetColours(*feature->feature->style,
+                          STYLE_PROP_TRANSCRIPT_CDS_COLOURS, ct, &gdk_fill, NULL, &gdk_outline) ;
+
+      /* No cds fill means background, no cds outline means the utr outline. */
+      export_data->fill_set = (gdk_fill ? TRUE : FALSE) ;
+      if (gdk_fill)
+        export_data->fill_pixel = foo_canvas_get_color_pixel(foo->canvas, zMap_gdk_color_to_rgba(gdk_fill)) ;
+
+      if (gdk_outline)
+        {
+          export_data->outline_set = TRUE ;
+          export_data->outline_pixel = foo_canvas_get_color_pixel(foo->canvas, zMap_gdk_color_to_rgba(gdk_outline)) ;
+        }
+    }
+
+  if (export_data->fill_set || export_data->outline_set)
+    exportBox(export_data, x1, x2, y1, y2) ;
+
+  return ;
+}
+
+
+static void exportBox(ExportData export_data, double x1, double x2, double y1, double y2)
+{
+  ZMapWindowCanvasExportStruct box ;
+
+  if (!clampToFeatureset(export_data, &y1, &y2))
+    return ;
+
+  y2 += 1 ;                                                 /* to cover last base. */
+
+  box.type = ZMAPWINDOW_EXPORT_BOX ;
+  box.x1 = x1 ;
+  box.x2 = x2 ;
+  box.y1 = y1 ;
+  box.y2 = y2 ;
+  box.fill_set = export_data->fill_set ;
+  box.fill_pixel = (export_data->fill_set ? export_data->fill_pixel : 0) ;
+  box.outline_set = export_data->outline_set ;
+  box.outline_pixel = (export_data->outline_set ? export_data->outline_pixel : 0) ;
+
+  exportAdd(export_data, &box, ((y2 - y1) < export_data->min_height || !box.outline_set)) ;
+
+  return ;
+}
+
+
+/* Lines are drawn in the outline colour, or the fill colour if there isn't one. */
+static void exportLine(ExportData export_data, double x, double y1, double y2)
+{
+  ZMapWindowCanvasExportStruct line ;
+
+  if (!clampToFeatureset(export_data, &y1, &y2))
+    return ;
+
+  y2 += 1 ;
+
+  line.type = ZMAPWINDOW_EXPORT_LINE ;
+  line.x1 = line.x2 = x ;
+  line.y1 = y1 ;
+  line.y2 = y2 ;
+  line.fill_set = FALSE ;
+  line.fill_pixel = 0 ;
+  line.outline_set = TRUE ;
+  line.outline_pixel = (export_data->outline_set ? export_data->outline_pixel : export_data->fill_pixel) ;
+
+  exportAdd(export_data, &line, TRUE) ;
+
+  return ;
+}
+
+
+/* Merges the primitive into its bin if it is mergeable and within min_height of it,
+ * otherwise the bin is passed to func and replaced by the primitive. Boxes that are not
+ * mergeable because of their height are only merged with boxes of the same x extent. */
+static void exportAdd(ExportData export_data, ZMapWindowCanvasExport primitive, gboolean mergeable)
+{
+  ZMapWindowCanvasExport bin = NULL ;
+  GList *l ;
+
+  for (l = export_data->bins ; l ; l = l->next)
+    {
+      if (sameBin((ZMapWindowCanvasExport)(l->data), primitive))
+        {
+          bin = (ZMapWindowCanvasExport)(l->data) ;
+          break ;
+        }
+    }
+
+  if (!bin)
+    {
+      bin = g_new(ZMapWindowCanvasExportStruct, 1) ;
+      *bin = *primitive ;
+
+      export_data->bins = g_list_prepend(export_data->bins, bin) ;
+    }
+  else if (mergeable
+           && (primitive->y2 - primitive->y1 < export_data->min_height
+               || (primitive->x1 == bin->x1 && primitive->x2 == bin->x2))
+           && primitive->y1 <= bin->y2 + export_data->min_height
+           && primitive->y2 >= bin->y1 - export_data->min_height)
+    {
+      if (primitive->x1 < bin->x1)
+        bin->x1 = primitive->x1 ;
+      if (primitive->x2 > bin->x2)
+        bin->x2 = primitive->x2 ;
+      if (primitive->y1 < bin->y1)
+        bin->y1 = primitive->y1 ;
+      if (primitive->y2 > bin->y2)
+        bin->y2 = primitive->y2 ;
+    }
+  else
+    {
+      export_data->func(bin, export_data->func_data) ;
+      export_data->n_primitives++ ;
+
+      *bin = *primitive ;
+    }
+
+  return ;
+}
+
+
+/* Bins are by type, colour and the x coord of the centre, i.e. the bump sub-column. */
+static gboolean sameBin(ZMapWindowCanvasExport bin, ZMapWindowCanvasExport primitive)
+{
+  gboolean result = FALSE ;
+
+  if (bin->type == primitive->type
+      && bin->x1 + bin->x2 == primitive->x1 + primitive->x2
+      && bin->fill_set == primitive->fill_set && bin->fill_pixel == primitive->fill_pixel
+      && bin->outline_set == primitive->outline_set && bin->outline_pixel == primitive->outline_pixel)
+    result = TRUE ;
+
+  return result ;
+}
+
+
+/* Passes to func and removes all bins that end more than min_height before y. */
+static void exportFlush(ExportData export_data, double y)
+{
+  GList *l, *next ;
+
+  for (l = export_data->bins ; l ; l = next)
+    {
+      ZMapWindowCanvasExport bin = (ZMapWindowCanvasExport)(l->data) ;
+
+      next = l->next ;
+
+      if (bin->y2 + export_data->min_height < y)
+        {
+          export_data->func(bin, export_data->func_data) ;
+          export_data->n_primitives++ ;
+
+          g_free(bin) ;
+          export_data->bins = g_list_delete_link(export_data->bins, l) ;
+        }
+    }
+
+  return ;
+}
+
+
+/* Features can extend beyond the featureset, they are truncated just as they are when painted. */
+static gboolean clampToFeatureset(ExportData export_data, double *y1_inout, double *y2_inout)
+{
+  gboolean result = FALSE ;
+  ZMapWindowFeaturesetItem featureset = export_data->featureset ;
+
+  if (*y1_inout < featureset->start)
+    *y1_inout = featureset->start ;
+  if (*y2_inout > featureset->end)
+    *y2_inout = featureset->end ;
+
+  if (*y1_inout <= *y2_inout)
+    result = TRUE ;
+
+  return result ;
+}
@@ -0,0 +1,307 @@
+/*  File: zmapWindowCanvasFeaturesetFilterIndex.cpp
+ *  Author: Ed Griffiths (edgrif@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: An index of the features in a featureset sorted by
+ *              score used to filter the featureset by score.
+ *
+ * Exported functions: See zmapWindowCanvasFeatureset_I.hpp
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <glib.h>
+
+#include <ZMap/zmapUtilsLog.hpp>
+#include <ZMap/zmapUtilsDebug.hpp>
+#include <ZMap/zmapSkipList.hpp>
+#include <zmapWindowCanvasFeatureset_I.hpp>
+#include <zmapWindowCanvasFeature_I.hpp>
+
+
+
+/*
+ * The filter hides all features (or for joined up alignments, all series of features) whose
+ * score is below the filter value. The filter code used to walk the whole skip list working
+ * out the score of every series each time the filter slider moved, which for a column of a
+ * million short reads was far too slow to follow the slider.
+ *
+ * Here we work out the score of each series once and keep the series sorted by score, the
+ * filtered series are then always the first n in the index. When the value changes only the
+ * series with scores between the old and new values have to be hidden or unhidden.
+ *
+ * The index must be freed whenever the display_index is freed (features may have been added
+ * or removed or relinked) or the style changes (score mode), it is rebuilt by the next filter
+ * operation which sets the flags of every feature as the old code did.
+ */
+
+
+
+/* One of these per series of joined up features, or per feature if not joined. */
+typedef struct FilterIndexEntryStructType
+{
+  double score ;                                            /* max score over the series. */
+  ZMapWindowCanvasFeature feature ;                         /* first in series. */
+} FilterIndexEntryStruct, *FilterIndexEntry ;
+
+
+typedef struct ZMapWindowCanvasFilterIndexStructType
+{
+  GArray *entries ;                                         /* of FilterIndexEntryStruct sorted by score. */
+
+  guint n_hidden ;                                          /* entries[0 .. n_hidden - 1] are filtered. */
+} ZMapWindowCanvasFilterIndexStruct ;
+
+
+
+static void filterIndexCreate(ZMapWindowFeaturesetItem featureset) ;
+static double seriesScore(ZMapWindowCanvasFeature feature) ;
+static guint findFirstShown(ZMapWindowCanvasFilterIndex filter_index, double value) ;
+static int setSeriesFiltered(ZMapWindowFeaturesetItem featureset, ZMapWindowCanvasFeature feature, gboolean filtered) ;
+static gint entryCmp(gconstpointer a, gconstpointer b) ;
+
+
+
+
+/*
+ *                  External routines
+ */
+
+
+/* Filter the featureset so that all features with a score below value are hidden, building
+ * the index if there isn't one. Returns the number of features now filtered, the caller
+ * should compare this with featureset->n_filtered to see if anything changed. */
+int zmapWindowCanvasFeaturesetFilterIndexApply(ZMapWindowFeaturesetItem featureset, double value)
+{
+  int n_filtered = 0 ;
+  ZMapWindowCanvasFilterIndex filter_index ;
+  guint first_shown, i ;
+
+  zMapReturnValIfFail(featureset, n_filtered) ;
+
+  /* Nothing displayed yet so nothing to filter. */
+  if (!featureset->display_index)
+    return n_filtered ;
+
+  if (!featureset->filter_index)
+    {
+      /* No idea which features have been flagged so set them all. */
+      filterIndexCreate(featureset) ;
+
+      filter_index = featureset->filter_index ;
+      first_shown = findFirstShown(filter_index, value) ;
+
+      for (i = 0 ; i < filter_index->entries->len ; i++)
+        {
+          FilterIndexEntry entry = &g_array_index(filter_index->entries, FilterIndexEntryStruct, i) ;
+          int n_series ;
+
+          n_series = setSeriesFiltered(featureset, entry->feature, (i < first_shown)) ;
+
+          if (i < first_shown)
+            n_filtered += n_series ;
+        }
+    }
+  else
+    {
+      /* Only the series between the old and new values change. */
+      filter_index = featureset->filter_index ;
+      first_shown = findFirstShown(filter_index, value) ;
+      n_filtered = featureset->n_filtered ;
+
+      for (i = filter_index->n_hidden ; i < first_shown ; i++)
+        {
+          FilterIndexEntry entry = &g_array_index(filter_index->entries, FilterIndexEntryStruct, i) ;
+
+          n_filtered += setSeriesFiltered(featureset, entry->feature, TRUE) ;
+        }
+
+      for (i = first_shown ; i < filter_index->n_hidden ; i++)
+        {
+          FilterIndexEntry entry = &g_array_index(filter_index->entries, FilterIndexEntryStruct, i) ;
+
+          n_filtered -= setSeriesFiltered(featureset, entry->feature, FALSE) ;
+        }
+    }
+
+  filter_index->n_hidden = first_shown ;
+
+  return n_filtered ;
+}
+
+
+void zmapWindowCanvasFeaturesetFilterIndexFree(ZMapWindowFeaturesetItem featureset)
+{
+  zMapReturnIfFail(featureset) ;
+
+  if (featureset->filter_index)
+    {
+      g_array_free(featureset->filter_index->entries, TRUE) ;
+      g_free(featureset->filter_index) ;
+
+      featureset->filter_index = NULL ;
+    }
+
+  return ;
+}
+
+
+
+
+/*
+ *                  Internal routines
+ */
+
+
+/* Makes the index from the display_index with no series counted as filtered. */
+static void filterIndexCreate(ZMapWindowFeaturesetItem featureset)
+{
+  ZMapWindowCanvasFilterIndex filter_index ;
+  ZMapSkipList sl ;
+
+  filter_index = g_new0(ZMapWindowCanvasFilterIndexStruct, 1) ;
+  filter_index->entries = g_array_new(FALSE, FALSE, sizeof(FilterIndexEntryStruct)) ;
+
+  for (sl = zMapSkipListFirst(featureset->display_index) ; sl ; sl = sl->next)
+    {
+      ZMapWindowCanvasFeature feature = (ZMapWindowCanvasFeature)sl->data ;
+      FilterIndexEntryStruct entry ;
+
+      if (!zmapWindowCanvasFeatureValid(feature))
+        continue ;
+
+      if (feature->left)                                    /* we do joined up alignments */
+        continue ;
+
+      if (!feature->feature->flags.has_score && !feature->feature->population)
+        continue ;
+
+      entry.score = seriesScore(feature) ;
+      entry.feature = feature ;
+
+      g_array_append_val(filter_index->entries, entry) ;
+    }
+
+  g_array_sort(filter_index->entries, entryCmp) ;
+
+  featureset->filter_index = filter_index ;
+
+  return ;
+}
+
+
+/* Get the score for a whole series of alignments. As the filter always has, this uses the
+ * population or score of the first feature unless the style says to use percent id.
+ * NOTE feature->score is normalised, feature->feature->score is what we filter by. */
+static double seriesScore(ZMapWindowCanvasFeature feature)
+{
+  double score = 0.0 ;
+  ZMapWindowCanvasFeature f ;
+
+  for (f = feature ; f ; f = f->right)
+    {
+      double feature_score = feature->feature->population ;
+
+      if (!feature_score)
+        {
+          feature_score = feature->feature->score ;
+
+          if (zMapStyleGetScoreMode(*f->feature->style) == ZMAPSCORE_PERCENT)
+            feature_score = f->feature->feature.homol.percent_id ;
+        }
+
+      if (feature_score > score)
+        score = feature_score ;
+    }
+
+  return score ;
+}
+
+
+/* Binary search for the first entry with score >= value, the filter hides all below value. */
+static guint findFirstShown(ZMapWindowCanvasFilterIndex filter_index, double value)
+{
+  guint low = 0, high = filter_index->entries->len, mid ;
+
+  while (low < high)
+    {
+      mid = (low + high) / 2 ;
+
+      if (g_array_index(filter_index->entries, FilterIndexEntryStruct, mid).score < value)
+        low = mid + 1 ;
+      else
+        high = mid ;
+    }
+
+  return low ;
+}
+
+
+/* Set flags for a whole series, returns the number of features in the series. */
+static int setSeriesFiltered(ZMapWindowFeaturesetItem featureset, ZMapWindowCanvasFeature feature, gboolean filtered)
+{
+  int n_features = 0 ;
+  ZMapWindowCanvasFeature f ;
+
+  for (f = feature ; f ; f = f->right)
+    {
+      if (filtered)
+        {
+          /* NOTE many of these may be FEATURE_SUMMARISED which is not operative during bump
+           * so setting HIDDEN here must be done for the filtered features only. */
+          f->flags |= FEATURE_HIDE_FILTER | FEATURE_HIDDEN ;
+        }
+      else
+        {
+          f->flags &= ~FEATURE_HIDE_FILTER ;
+
+          if (!(f->flags & FEATURE_HIDE_REASON))
+            f->flags &= ~FEATURE_HIDDEN ;
+          else if (featureset->bumped && (f->flags & FEATURE_HIDE_REASON) == FEATURE_SUMMARISED)
+            f->flags &= ~FEATURE_HIDDEN ;
+        }
+
+      n_features++ ;
+    }
+
+  return n_features ;
+}
+
+
+/* Sort by score, the order of series with the same score doesn't matter as they are always
+ * filtered together. */
+static gint entryCmp(gconstpointer a, gconstpointer b)
+{
+  FilterIndexEntry entry_a = (FilterIndexEntry)a ;
+  FilterIndexEntry entry_b = (FilterIndexEntry)b ;
+  gint result = 0 ;
+
+  if (entry_a->score < entry_b->score)
+    result = -1 ;
+  else if (entry_a->score > entry_b->score)
+    result = 1 ;
+
+  return result ;
+}
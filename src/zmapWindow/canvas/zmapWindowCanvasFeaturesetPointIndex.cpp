@@ -0,0 +1,408 @@
+/*  File: zmapWindowCanvasFeaturesetPointIndex.cpp
+ *  Author: Ed Griffiths (edgrif@sanger.ac.uk)
+ *  Copyright (c) 2006-2017: Genome Research Ltd.
+ *-------------------------------------------------------------------
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------
+ * This file is part of the ZMap genome database package
+ * originally written by:
+ *
+ *      Ed Griffiths (Sanger Institute, UK) edgrif@sanger.ac.uk
+ *        Roy Storey (Sanger Institute, UK) rds@sanger.ac.uk
+ *   Malcolm Hinsley (Sanger Institute, UK) mh17@sanger.ac.uk
+ *       Gemma Guest (Sanger Institute, UK) gb10@sanger.ac.uk
+ *      Steve Miller (Sanger Institute, UK) sm23@sanger.ac.uk
+ *
+ * Description: A 2D index of the features in a bumped featureset used
+ *              to find the feature(s) under the cursor.
+ *
+ * Exported functions: See zmapWindowCanvasFeatureset_I.hpp
+ *-------------------------------------------------------------------
+ */
+
+#include <ZMap/zmap.hpp>
+
+#include <glib.h>
+
+#include <ZMap/zmapUtilsLog.hpp>
+#include <ZMap/zmapUtilsDebug.hpp>
+#include <ZMap/zmapSkipList.hpp>
+#include <zmapWindowCanvasFeatureset_I.hpp>
+#include <zmapWindowCanvasFeature_I.hpp>
+
+
+
+/*
+ * When a column is bumped the features are spread out into sub-columns ("lanes") which all
+ * share the same bump_offset. The skip list is only sorted by y so to find the feature under
+ * the cursor the point() code used to find the first feature at y and then look at every
+ * feature after it, on a bumped column of short reads that's most of the column every time
+ * the mouse moves.
+ *
+ * Here we keep the features grouped by lane, the lanes sorted by their x extent and the features
+ * within each lane sorted by y. Both arrays carry a running maximum of their end coord so that
+ * we can binary search to the last possible candidate and then stop scanning backwards as soon
+ * as nothing earlier can reach the cursor, so a point() is O(log n) plus the number of features
+ * actually under the cursor, regardless of the depth of the pileup.
+ *
+ * The index is built by the bump code and must be freed whenever the display_index is freed
+ * or the features are rebumped, features that are hidden are still indexed, the point code
+ * checks the flags as it always has.
+ */
+
+
+
+/* One of these per feature. */
+typedef struct PointIndexEntryStructType
+{
+  double offset ;                                           /* bump_offset of the lane. */
+  double x1, x2 ;                                           /* x extent relative to column centre. */
+  double y1, y2 ;                                           /* canvas y extent as tested by point(). */
+  double max_y2 ;                                           /* max y2 of this and previous entries in lane. */
+
+  ZMapWindowCanvasFeature feature ;
+} PointIndexEntryStruct, *PointIndexEntry ;
+
+
+/* One of these per sub-column. */
+typedef struct PointIndexLaneStructType
+{
+  double x1, x2 ;                                           /* extent of widest feature in lane. */
+  double max_x2 ;                                           /* max x2 of this and previous lanes. */
+
+  guint first ;                                             /* index of first entry in lane. */
+  guint n_entries ;
+} PointIndexLaneStruct, *PointIndexLane ;
+
+
+typedef struct ZMapWindowCanvasPointIndexStructType
+{
+  GArray *entries ;                                         /* of PointIndexEntryStruct */
+  GArray *lanes ;                                           /* of PointIndexLaneStruct */
+} ZMapWindowCanvasPointIndexStruct ;
+
+
+
+/* point() functions allow one pixel grace either side of a feature. */
+#define POINT_INDEX_X_GRACE 1.0
+
+
+
+static gboolean indexableFeature(ZMapWindowCanvasFeature feature) ;
+static gint entryCmp(gconstpointer a, gconstpointer b) ;
+static gint laneCmp(gconstpointer a, gconstpointer b) ;
+static void findInLane(ZMapWindowCanvasPointIndex point_index, PointIndexLane lane,
+                       double x, double y1, double y2, GList **candidates_inout) ;
+
+
+
+
+/*
+ *                  External routines
+ */
+
+
+/* Build the point index for a bumped featureset, any existing index is freed first.
+ * If the featureset contains features that are not box-like (glyphs, graphs etc) or
+ * is not bumped then no index is made and point() falls back to scanning the skip list. */
+gboolean zmapWindowCanvasFeaturesetPointIndexCreate(ZMapWindowFeaturesetItem featureset)
+{
+  gboolean result = FALSE ;
+  ZMapWindowCanvasPointIndex point_index ;
+  ZMapSkipList sl ;
+  guint i ;
+
+  zMapReturnValIfFail(featureset, FALSE) ;
+
+  zmapWindowCanvasFeaturesetPointIndexFree(featureset) ;
+
+  if (!featureset->bumped || !featureset->display_index
+      || (featureset->layer & ZMAP_CANVAS_LAYER_DECORATION)
+      || zMapStyleGetMode(featureset->style) == ZMAPSTYLE_MODE_GRAPH)
+    return result ;
+
+  point_index = g_new0(ZMapWindowCanvasPointIndexStruct, 1) ;
+  point_index->entries = g_array_sized_new(FALSE, FALSE, sizeof(PointIndexEntryStruct), featureset->n_features) ;
+  point_index->lanes = g_array_new(FALSE, FALSE, sizeof(PointIndexLaneStruct)) ;
+
+  result = TRUE ;
+
+  for (sl = zMapSkipListFirst(featureset->display_index) ; sl ; sl = sl->next)
+    {
+      ZMapWindowCanvasFeature feature = (ZMapWindowCanvasFeature)(sl->data) ;
+      PointIndexEntryStruct entry ;
+
+      if (!zmapWindowCanvasFeatureValid(feature))
+        continue ;
+
+      if (!indexableFeature(feature))
+        {
+          result = FALSE ;
+          break ;
+        }
+
+      /* These must be the same coords as tested by featurePoint()/alignmentPoint(). */
+      if (feature->type == FEATURE_ALIGN)
+        {
+          entry.y1 = feature->feature->x1 ;
+          entry.y2 = feature->feature->x2 ;
+        }
+      else
+        {
+          entry.y1 = feature->y1 ;
+          entry.y2 = feature->y2 ;
+        }
+      zmapWindowFeaturesetS2Ccoords(&entry.y1, &entry.y2) ;
+
+      entry.offset = feature->bump_offset ;
+      entry.x1 = feature->bump_offset - (feature->width / 2) ;
+      entry.x2 = feature->bump_offset + (feature->width / 2) ;
+      entry.feature = feature ;
+
+      g_array_append_val(point_index->entries, entry) ;
+    }
+
+  if (!result || !point_index->entries->len)
+    {
+      g_array_free(point_index->entries, TRUE) ;
+      g_array_free(point_index->lanes, TRUE) ;
+      g_free(point_index) ;
+
+      return FALSE ;
+    }
+
+  /* Group into lanes and within a lane sort by y. */
+  g_array_sort(point_index->entries, entryCmp) ;
+
+  for (i = 0 ; i < point_index->entries->len ; i++)
+    {
+      PointIndexEntry entry = &g_array_index(point_index->entries, PointIndexEntryStruct, i) ;
+      PointIndexLane lane = NULL ;
+
+      if (point_index->lanes->len)
+        {
+          PointIndexEntry first ;
+
+          lane = &g_array_index(point_index->lanes, PointIndexLaneStruct, point_index->lanes->len - 1) ;
+          first = &g_array_index(point_index->entries, PointIndexEntryStruct, lane->first) ;
+
+          if (first->offset != entry->offset)
+            lane = NULL ;
+        }
+
+      if (!lane)
+        {
+          PointIndexLaneStruct new_lane = {0.0} ;
+
+          new_lane.x1 = entry->x1 ;
+          new_lane.x2 = entry->x2 ;
+          new_lane.first = i ;
+
+          g_array_append_val(point_index->lanes, new_lane) ;
+          lane = &g_array_index(point_index->lanes, PointIndexLaneStruct, point_index->lanes->len - 1) ;
+
+          entry->max_y2 = entry->y2 ;
+        }
+      else
+        {
+          PointIndexEntry prev = entry - 1 ;
+
+          if (entry->x1 < lane->x1)
+            lane->x1 = entry->x1 ;
+          if (entry->x2 > lane->x2)
+            lane->x2 = entry->x2 ;
+
+          entry->max_y2 = (prev->max_y2 > entry->y2 ? prev->max_y2 : entry->y2) ;
+        }
+
+      lane->n_entries++ ;
+    }
+
+  /* Lanes are currently in offset order, features may be centred so sort on the actual extent. */
+  g_array_sort(point_index->lanes, laneCmp) ;
+
+  for (i = 0 ; i < point_index->lanes->len ; i++)
+    {
+      PointIndexLane lane = &g_array_index(point_index->lanes, PointIndexLaneStruct, i) ;
+
+      if (i && (lane - 1)->max_x2 > lane->x2)
+        lane->max_x2 = (lane - 1)->max_x2 ;
+      else
+        lane->max_x2 = lane->x2 ;
+    }
+
+  featureset->point_index = point_index ;
+
+  return result ;
+}
+
+
+/* Returns a list of the features that might be under the cursor, x is relative to the centre
+ * of the column (as bump offsets are) and y1,y2 is the canvas y range to look in.
+ * Caller must g_list_free() the list. */
+GList *zmapWindowCanvasFeaturesetPointIndexFind(ZMapWindowFeaturesetItem featureset,
+                                                double x, double y1, double y2)
+{
+  GList *candidates = NULL ;
+  ZMapWindowCanvasPointIndex point_index ;
+  int low, high ;
+
+  zMapReturnValIfFail(featureset && featureset->point_index, NULL) ;
+
+  point_index = featureset->point_index ;
+
+  /* Binary search for the last lane that starts to the left of x... */
+  low = 0 ;
+  high = (int)point_index->lanes->len - 1 ;
+  while (low <= high)
+    {
+      int mid = (low + high) / 2 ;
+      PointIndexLane lane = &g_array_index(point_index->lanes, PointIndexLaneStruct, mid) ;
+
+      if (lane->x1 - POINT_INDEX_X_GRACE < x)
+        low = mid + 1 ;
+      else
+        high = mid - 1 ;
+    }
+
+  /* ...then work back until no earlier lane can reach x. */
+  for ( ; high >= 0 ; high--)
+    {
+      PointIndexLane lane = &g_array_index(point_index->lanes, PointIndexLaneStruct, high) ;
+
+      if (lane->max_x2 + POINT_INDEX_X_GRACE <= x)
+        break ;
+
+      if (lane->x2 + POINT_INDEX_X_GRACE > x)
+        findInLane(point_index, lane, x, y1, y2, &candidates) ;
+    }
+
+  return candidates ;
+}
+
+
+void zmapWindowCanvasFeaturesetPointIndexFree(ZMapWindowFeaturesetItem featureset)
+{
+  zMapReturnIfFail(featureset) ;
+
+  if (featureset->point_index)
+    {
+      g_array_free(featureset->point_index->entries, TRUE) ;
+      g_array_free(featureset->point_index->lanes, TRUE) ;
+      g_free(featureset->point_index) ;
+
+      featureset->point_index = NULL ;
+    }
+
+  return ;
+}
+
+
+
+
+/*
+ *                  Internal routines
+ */
+
+
+/* We can only index features whose point() function tests a simple box. */
+static gboolean indexableFeature(ZMapWindowCanvasFeature feature)
+{
+  gboolean result = FALSE ;
+
+  switch (feature->type)
+    {
+    case FEATURE_BASIC:
+    case FEATURE_TRANSCRIPT:
+      result = TRUE ;
+      break ;
+
+    case FEATURE_ALIGN:
+      result = (feature->feature != NULL) ;
+      break ;
+
+    default:
+      break ;
+    }
+
+  return result ;
+}
+
+
+/* Sort by lane and then by start. */
+static gint entryCmp(gconstpointer a, gconstpointer b)
+{
+  PointIndexEntry entry_a = (PointIndexEntry)a ;
+  PointIndexEntry entry_b = (PointIndexEntry)b ;
+
+  if (entry_a->offset < entry_b->offset)
+    return -1 ;
+  else if (entry_a->offset > entry_b->offset)
+    return 1 ;
+  else if (entry_a->y1 < entry_b->y1)
+    return -1 ;
+  else if (entry_a->y1 > entry_b->y1)
+    return 1 ;
+
+  return 0 ;
+}
+
+
+static gint laneCmp(gconstpointer a, gconstpointer b)
+{
+  PointIndexLane lane_a = (PointIndexLane)a ;
+  PointIndexLane lane_b = (PointIndexLane)b ;
+
+  if (lane_a->x1 < lane_b->x1)
+    return -1 ;
+  else if (lane_a->x1 > lane_b->x1)
+    return 1 ;
+
+  return 0 ;
+}
+
+
+/* Add all features in the lane that overlap y1,y2 and x to the candidate list. */
+static void findInLane(ZMapWindowCanvasPointIndex point_index, PointIndexLane lane,
+                       double x, double y1, double y2, GList **candidates_inout)
+{
+  PointIndexEntry entries ;
+  int low, high ;
+
+  entries = &g_array_index(point_index->entries, PointIndexEntryStruct, lane->first) ;
+
+  /* Find the last feature starting at or before y2... */
+  low = 0 ;
+  high = (int)lane->n_entries - 1 ;
+  while (low <= high)
+    {
+      int mid = (low + high) / 2 ;
+
+      if (entries[mid].y1 <= y2)
+        low = mid + 1 ;
+      else
+        high = mid - 1 ;
+    }
+
+  /* ...and work back while something could still overlap y1. */
+  for ( ; high >= 0 && entries[high].max_y2 >= y1 ; high--)
+    {
+      PointIndexEntry entry = &entries[high] ;
+
+      if (entry->y2 >= y1
+          && entry->x1 - POINT_INDEX_X_GRACE < x && entry->x2 + POINT_INDEX_X_GRACE > x)
+        *candidates_inout = g_list_prepend(*candidates_inout, entry->feature) ;
+    }
+
+  return ;
+}
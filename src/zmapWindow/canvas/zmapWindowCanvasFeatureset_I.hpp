@@ -148,6 +148,15 @@ typedef struct _pixRect
 
 
 
+/* Index of bumped features by sub-column and position, used to find the feature under the
+ * cursor, see zmapWindowCanvasFeaturesetPointIndex.cpp. */
+typedef struct ZMapWindowCanvasPointIndexStructType *ZMapWindowCanvasPointIndex ;
+
+/* Index of features by score used to filter by score, see zmapWindowCanvasFeaturesetFilterIndex.cpp. */
+typedef struct ZMapWindowCanvasFilterIndexStructType *ZMapWindowCanvasFilterIndex ;
+
+
+
 
 /* Oh goodness....what is all this for ?? */
 #define N_FEAT_ALLOC      1000
@@ -312,6 +321,9 @@ typedef struct ZMapWindowFeaturesetItemStructType
   // Used to cursor through canvasfeatures in the skiplist, reset to NULL when the skiplist is deleted.
   ZMapSkipList curr_item ;
 
+  /* Built when bumped to speed up point(), must be freed when the skiplist is deleted. */
+  ZMapWindowCanvasPointIndex point_index ;
+
 
   int set_index ;			/* for staggered columns (heatmaps) */
 
@@ -365,6 +377,9 @@ typedef struct ZMapWindowFeaturesetItemStructType
 
   double filter_value ;                                     /* active level, default 0.0 */
   int n_filtered ;
+
+  /* Built by the first filter operation, must be freed when the skiplist is deleted. */
+  ZMapWindowCanvasFilterIndex filter_index ;
   gboolean enable_filter ;                                  /* has score in a feature and style allows it */
 
 
@@ -379,7 +394,16 @@ PixRect zmapWindowCanvasFeaturesetSummarise(PixRect pix,
 					    ZMapWindowFeaturesetItem featureset, ZMapWindowCanvasFeature feature);
 void zmapWindowCanvasFeaturesetSummariseFree(ZMapWindowFeaturesetItem featureset, PixRect pix);
 
+gboolean zmapWindowCanvasFeaturesetPointIndexCreate(ZMapWindowFeaturesetItem featureset) ;
+GList *zmapWindowCanvasFeaturesetPointIndexFind(ZMapWindowFeaturesetItem featureset,
+                                                double x, double y1, double y2) ;
+void zmapWindowCanvasFeaturesetPointIndexFree(ZMapWindowFeaturesetItem featureset) ;
+
+int zmapWindowCanvasFeaturesetFilterIndexApply(ZMapWindowFeaturesetItem featureset, double value) ;
+void zmapWindowCanvasFeaturesetFilterIndexFree(ZMapWindowFeaturesetItem featureset) ;
+
 gboolean zmapWindowCanvasFeaturesetFreeDisplayLists(ZMapWindowFeaturesetItem featureset_item_inout) ;
+ZMapSkipList zmapWindowCanvasFeaturesetFindFirst(ZMapWindowFeaturesetItem featureset, double y1, double y2) ;
 
 void zmapWindowFeaturesetS2Ccoords(double *start_inout, double *end_inout) ;
 gboolean zmapWindowCanvasFeatureValid(ZMapWindowCanvasFeature feature) ;
@@ -336,7 +336,7 @@ ZMapWindowCanvasGlyph zMapWindowCanvasGetGlyph(ZMapWindowFeaturesetItem features
           /* put this at a higher level...... */
 
           zMapLogWarning("Could not find sub feature glyph shape for feature \"%s\" at %d, %d",
-                         g_quark_to_string(feature->original_id), feature->x1, feature->x2) ;
+                         zMapFeatureIDToString(feature->original_id), feature->x1, feature->x2) ;
 #endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
         }
@@ -720,7 +720,7 @@ static ZMapWindowCanvasFeature glyphAddFeature(ZMapWindowFeaturesetItem features
   if (!shape)
     {
       zMapLogWarning("Could not find glyph shape for feature \"%s\" at %d, %d",
-                     g_quark_to_string(feature->original_id), feature->x1, feature->x2) ;
+                     zMapFeatureIDToString(feature->original_id), feature->x1, feature->x2) ;
     }
   else
     {
@@ -518,7 +518,7 @@ static void graphPaintFeature(ZMapWindowFeaturesetItem featureset, ZMapWindowCan
 
         if (debug_G && feature && feature->feature)
           zMapDebugPrint(debug_G, "Feature %s -\tbin: %.f, %.f\tfeature: %d, %d\tdiff: %.f, %.f",
-                         g_quark_to_string(feature->feature->original_id),
+                         zMapFeatureIDToString(feature->feature->original_id),
                          feature->y1, feature->y2,
                          feature->feature->x1, feature->feature->x2,
                          feature->y1 - feature->feature->x1, feature->y2 - feature->feature->x2) ;
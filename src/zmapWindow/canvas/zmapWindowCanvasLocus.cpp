@@ -156,7 +156,7 @@ static void zMapWindowCanvasLocusPaintFeature(ZMapWindowFeaturesetItem featurese
   x1 = featureset->dx + featureset->x_off;
   x2 = x1 + locus->x_off;
 
-  text = (char *) g_quark_to_string(feature->feature->original_id);
+  text = (char *) zMapFeatureIDToString(feature->feature->original_id);
   len = strlen(text);
   pango_layout_set_text (lset->pango.layout, text, len);
   locus->x_wid = len * lset->pango.text_width;
@@ -406,7 +406,7 @@ static void zMapWindowCanvasLocusZoomSet(ZMapWindowFeaturesetItem featureset, Gd
       locus->ytext = locus->feature.feature->x1;
       locus->x_off = ZMAP_LOCUS_LINE_WIDTH;
 
-      text = (char *) g_quark_to_string(locus->feature.feature->original_id);
+      text = (char *) zMapFeatureIDToString(locus->feature.feature->original_id);
       len = strlen(text);
 
       if(locusFeatureIsFiltered(lset->filter, text))
@@ -52,6 +52,12 @@ static void zmapWindowCanvasSequenceSetColour(FooCanvasItem *foo,
                                               GdkColor *default_fill, GdkColor *default_border) ;
 static ZMapFeatureSubPart zmapWindowCanvasSequenceGetSubPartSpan(FooCanvasItem *foo,
                                                                      ZMapFeature feature, double x, double y) ;
+static ZMapWindowCanvasSequenceAtlas sequenceAtlasGet(GdkDrawable *drawable, ZMapWindowFeaturesetItem featureset) ;
+static gboolean sequenceAtlasCreate(ZMapWindowCanvasSequenceAtlas atlas, GdkDrawable *drawable,
+                                    ZMapWindowCanvasPango pango, GdkColor *draw) ;
+static gboolean sequenceAtlasDrawText(ZMapWindowCanvasSequenceAtlas atlas, GdkDrawable *drawable,
+                                      const char *text, int n_chars, int x, int y) ;
+static void sequenceAtlasFree(ZMapWindowCanvasSequenceAtlas atlas) ;
 
 
 
@@ -89,7 +95,7 @@ void zMapWindowCanvasSequenceInit(void)
   /* it would have been better to make a SequenceSet struct to wrap the Pango in case we ant to add anything,
    * search for pango-> and ->opt to find all occurences
    */
-  zMapWindowCanvasFeatureSetSetFuncs(FEATURE_SEQUENCE, funcs, sizeof(zmapWindowCanvasPangoStruct)) ;
+  zMapWindowCanvasFeatureSetSetFuncs(FEATURE_SEQUENCE, funcs, sizeof(ZMapWindowCanvasSequenceSetStruct)) ;
 
 
   feature_funcs[CANVAS_FEATURE_FUNC_SUBPART] = (void *)zmapWindowCanvasSequenceGetSubPartSpan ;
@@ -435,6 +441,7 @@ static void zmapWindowCanvasSequencePaintFeature(ZMapWindowFeaturesetItem featur
   GList *hl;        /* iterator through highlight */
   ZMapFrame frame ;
   ZMapWindowCanvasPango pango = NULL ;
+  ZMapWindowCanvasSequenceAtlas atlas = NULL ;
 
   zMapReturnIfFail(featureset && feature && feature->feature) ;
 
@@ -452,6 +459,8 @@ static void zmapWindowCanvasSequencePaintFeature(ZMapWindowFeaturesetItem featur
 
   zmapWindowCanvasSequenceSetRow(featureset, seq);
 
+  atlas = sequenceAtlasGet(drawable, featureset) ;
+
   //zMapDebugPrintf("Seq paint %s index= %p\n", g_quark_to_string(featureset->id), featureset->display_index);
 
   /* restrict to actual expose area, any expose will fetch the whole feature */
@@ -563,8 +572,6 @@ static void zmapWindowCanvasSequencePaintFeature(ZMapWindowFeaturesetItem featur
       while (*q)
         q++;
 
-      pango_layout_set_text(pango->layout, seq->text, q - seq->text);        /* be careful of last short row */
-
       /* need to get pixel coordinates for pango */
       foo_canvas_w2c (foo->canvas, featureset->dx, y_paint + featureset->dy, &cx, &cy);
 
@@ -573,8 +580,14 @@ static void zmapWindowCanvasSequencePaintFeature(ZMapWindowFeaturesetItem featur
 
       //if(sequence->frame == ZMAPFRAME_2) zMapDebugPrintf("3FT paint dna %s @ %ld = %d (%ld)\n",seq->text, y_paint, cy, seq->offset);
 
-      pango_renderer_draw_layout(pango->renderer, pango->layout,
-                                 cx * PANGO_SCALE, (cy + seq->offset) * PANGO_SCALE) ;
+      /* Draw the row from the atlas if we can, pango is only needed for anything odd. */
+      if (!atlas || !sequenceAtlasDrawText(atlas, drawable, seq->text, q - seq->text, cx, cy + seq->offset))
+        {
+          pango_layout_set_text(pango->layout, seq->text, q - seq->text);        /* be careful of last short row */
+
+          pango_renderer_draw_layout(pango->renderer, pango->layout,
+                                     cx * PANGO_SCALE, (cy + seq->offset) * PANGO_SCALE) ;
+        }
 
 
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
@@ -687,7 +700,269 @@ static void zmapWindowCanvasSequenceFreeSet(ZMapWindowFeaturesetItem featureset)
     }
 
   if(pango)
-    zmapWindowCanvasFeaturesetFreePango(pango);
+    {
+      sequenceAtlasFree(&(((ZMapWindowCanvasSequenceSet)pango)->atlas)) ;
+
+      zmapWindowCanvasFeaturesetFreePango(pango);
+    }
+
+  return ;
+}
+
+
+
+/* Return the glyph atlas for the column, (re)making it if the drawable or colour have changed,
+ * returns NULL if we can't make one and pango should be used. */
+static ZMapWindowCanvasSequenceAtlas sequenceAtlasGet(GdkDrawable *drawable, ZMapWindowFeaturesetItem featureset)
+{
+  ZMapWindowCanvasSequenceAtlas atlas = NULL ;
+  ZMapWindowCanvasPango pango ;
+  GdkColor *draw = NULL ;
+
+  if (!drawable || !(pango = (ZMapWindowCanvasPango)(featureset->opt)) || !pango->layout)
+    return atlas ;
+
+  atlas = &(((ZMapWindowCanvasSequenceSet)pango)->atlas) ;
+
+  zMapStyleGetColours(featureset->style, STYLE_PROP_COLOURS, ZMAPSTYLE_COLOURTYPE_NORMAL, NULL, &draw, NULL) ;
+
+  if (atlas->drawable != drawable
+      || atlas->text_width != pango->text_width || atlas->text_height != pango->text_height
+      || (draw && !gdk_color_equal(draw, &(atlas->colour))))
+    {
+      sequenceAtlasFree(atlas) ;
+
+      atlas->drawable = drawable ;
+
+      if (!draw || !sequenceAtlasCreate(atlas, drawable, pango, draw))
+        {
+          /* Remember we failed so we don't keep retrying on every expose. */
+          sequenceAtlasFree(atlas) ;
+
+          atlas->drawable = drawable ;
+          atlas->text_width = pango->text_width ;
+          atlas->text_height = pango->text_height ;
+          if (draw)
+            atlas->colour = *draw ;
+          atlas->failed = TRUE ;
+        }
+    }
+
+  if (atlas->failed)
+    atlas = NULL ;
+
+  return atlas ;
+}
+
+
+/* Render every character we might show once through pango into an offscreen pixmap and keep
+ * the antialiased coverage of each pixel so rows can be drawn with the text's alpha. */
+static gboolean sequenceAtlasCreate(ZMapWindowCanvasSequenceAtlas atlas, GdkDrawable *drawable,
+                                    ZMapWindowCanvasPango pango, GdkColor *draw)
+{
+  gboolean result = FALSE ;
+  GdkVisual *visual ;
+  GdkPixmap *pixmap ;
+  GdkGC *pixmap_gc ;
+  PangoRenderer *renderer ;
+  GdkImage *image ;
+  GdkColor black = {0, 0, 0, 0}, white = {0, 0xffff, 0xffff, 0xffff} ;
+  int max_advance = 0 ;
+  int i, x, y ;
+
+  /* We need to pull the coverage back out of the rendered pixels. */
+  visual = gdk_drawable_get_visual(drawable) ;
+  if (!visual || visual->type != GDK_VISUAL_TRUE_COLOR
+      || pango->text_width <= 0 || pango->text_height <= 0)
+    return result ;
+
+  atlas->text_width = pango->text_width ;
+  atlas->text_height = pango->text_height ;
+
+  /* Use pango's own advances so rows are spaced exactly as pango would space them. */
+  for (i = 0 ; i < SEQUENCE_ATLAS_N_CHARS ; i++)
+    {
+      char c = (char)(SEQUENCE_ATLAS_FIRST_CHAR + i) ;
+      PangoRectangle logical ;
+
+      pango_layout_set_text(pango->layout, &c, 1) ;
+      pango_layout_get_extents(pango->layout, NULL, &logical) ;
+
+      atlas->advances[i] = logical.width ;
+      if (logical.width > max_advance)
+        max_advance = logical.width ;
+    }
+
+  /* Glyphs can overhang their advance so leave some room either side. */
+  atlas->pad = (atlas->text_height / 4) + 1 ;
+  atlas->cell_width = PANGO_PIXELS_CEIL(max_advance) + (2 * atlas->pad) ;
+  atlas->width = atlas->cell_width * SEQUENCE_ATLAS_N_CHARS ;
+
+  pixmap = gdk_pixmap_new(drawable, atlas->width, atlas->text_height, -1) ;
+  pixmap_gc = gdk_gc_new(pixmap) ;
+  gdk_gc_set_rgb_fg_color(pixmap_gc, &black) ;
+  gdk_draw_rectangle(pixmap, pixmap_gc, TRUE, 0, 0, atlas->width, atlas->text_height) ;
+
+  renderer = gdk_pango_renderer_new(gdk_drawable_get_screen(drawable)) ;
+  gdk_pango_renderer_set_drawable(GDK_PANGO_RENDERER(renderer), pixmap) ;
+  gdk_pango_renderer_set_gc(GDK_PANGO_RENDERER(renderer), pixmap_gc) ;
+  gdk_pango_renderer_set_override_color(GDK_PANGO_RENDERER(renderer), PANGO_RENDER_PART_FOREGROUND, &white) ;
+
+  for (i = 0 ; i < SEQUENCE_ATLAS_N_CHARS ; i++)
+    {
+      char c = (char)(SEQUENCE_ATLAS_FIRST_CHAR + i) ;
+
+      pango_layout_set_text(pango->layout, &c, 1) ;
+      pango_renderer_draw_layout(renderer, pango->layout, ((i * atlas->cell_width) + atlas->pad) * PANGO_SCALE, 0) ;
+    }
+
+  gdk_pango_renderer_set_override_color(GDK_PANGO_RENDERER(renderer), PANGO_RENDER_PART_FOREGROUND, NULL) ;
+  gdk_pango_renderer_set_drawable(GDK_PANGO_RENDERER(renderer), NULL) ;
+  gdk_pango_renderer_set_gc(GDK_PANGO_RENDERER(renderer), NULL) ;
+  g_object_unref(renderer) ;
+
+  if ((image = gdk_drawable_get_image(pixmap, 0, 0, atlas->width, atlas->text_height)))
+    {
+      guint32 max_red = (1 << visual->red_prec) - 1 ;
+      guint32 max_green = (1 << visual->green_prec) - 1 ;
+      guint32 max_blue = (1 << visual->blue_prec) - 1 ;
+
+      atlas->coverage = g_new0(guchar, atlas->width * atlas->text_height) ;
+
+      /* White on black so each channel is the coverage, subpixel rendering may differ
+       * between channels so take the largest. */
+      for (y = 0 ; y < atlas->text_height ; y++)
+        {
+          for (x = 0 ; x < atlas->width ; x++)
+            {
+              guint32 pixel = gdk_image_get_pixel(image, x, y) ;
+              guint32 red, green, blue, alpha ;
+
+              red = (((pixel & visual->red_mask) >> visual->red_shift) * 255) / max_red ;
+              green = (((pixel & visual->green_mask) >> visual->green_shift) * 255) / max_green ;
+              blue = (((pixel & visual->blue_mask) >> visual->blue_shift) * 255) / max_blue ;
+
+              alpha = MAX(red, MAX(green, blue)) ;
+
+              atlas->coverage[(y * atlas->width) + x] = (guchar)alpha ;
+            }
+        }
+
+      g_object_unref(image) ;
+    }
+
+  g_object_unref(pixmap_gc) ;
+  g_object_unref(pixmap) ;
+
+  if (atlas->coverage)
+    {
+      atlas->colour = *draw ;
+
+      result = TRUE ;
+    }
+
+  return result ;
+}
+
+
+/* Draw a row of text from the atlas, returns FALSE without drawing anything if there are
+ * characters not in the atlas. The whole row is put together in an RGBA pixbuf, the text
+ * colour with the glyph coverage as alpha, and drawn with one call so it is blended over
+ * whatever is underneath (e.g. highlights) just as pango's antialiased text would be. */
+static gboolean sequenceAtlasDrawText(ZMapWindowCanvasSequenceAtlas atlas, GdkDrawable *drawable,
+                                      const char *text, int n_chars, int x, int y)
+{
+  gboolean result = TRUE ;
+  int row_width, rowstride, total = 0, pos ;
+  guchar *pixels ;
+  guchar red, green, blue ;
+  int i, px, py ;
+
+  for (i = 0 ; i < n_chars && result ; i++)
+    {
+      if (text[i] < SEQUENCE_ATLAS_FIRST_CHAR || text[i] > SEQUENCE_ATLAS_LAST_CHAR)
+        result = FALSE ;
+      else
+        total += atlas->advances[text[i] - SEQUENCE_ATLAS_FIRST_CHAR] ;
+    }
+
+  if (!result || !n_chars)
+    return result ;
+
+  row_width = PANGO_PIXELS_CEIL(total) + (2 * atlas->pad) + 1 ;
+
+  if (!atlas->row || gdk_pixbuf_get_width(atlas->row) < row_width)
+    {
+      if (atlas->row)
+        g_object_unref(atlas->row) ;
+
+      atlas->row = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, row_width, atlas->text_height) ;
+    }
+
+  pixels = gdk_pixbuf_get_pixels(atlas->row) ;
+  rowstride = gdk_pixbuf_get_rowstride(atlas->row) ;
+
+  red = atlas->colour.red >> 8 ;
+  green = atlas->colour.green >> 8 ;
+  blue = atlas->colour.blue >> 8 ;
+
+  for (py = 0 ; py < atlas->text_height ; py++)
+    {
+      guchar *p = pixels + (py * rowstride) ;
+
+      for (px = 0 ; px < row_width ; px++, p += 4)
+        {
+          p[0] = red ;
+          p[1] = green ;
+          p[2] = blue ;
+          p[3] = 0 ;
+        }
+    }
+
+  /* Characters go where pango would put them, overlapping edges take the larger coverage. */
+  for (i = 0, pos = 0 ; i < n_chars ; i++)
+    {
+      int cell = text[i] - SEQUENCE_ATLAS_FIRST_CHAR ;
+
+      if (text[i] != ' ')
+        {
+          int dest_x = PANGO_PIXELS(pos) ;
+          int width = MIN(atlas->cell_width, row_width - dest_x) ;
+
+          for (py = 0 ; py < atlas->text_height ; py++)
+            {
+              guchar *src = atlas->coverage + (py * atlas->width) + (cell * atlas->cell_width) ;
+              guchar *dest = pixels + (py * rowstride) + (dest_x * 4) + 3 ;
+
+              for (px = 0 ; px < width ; px++, dest += 4)
+                {
+                  if (src[px] > *dest)
+                    *dest = src[px] ;
+                }
+            }
+        }
+
+      pos += atlas->advances[cell] ;
+    }
+
+  gdk_draw_pixbuf(drawable, NULL, atlas->row, 0, 0, x - atlas->pad, y, row_width, atlas->text_height,
+                  GDK_RGB_DITHER_NONE, 0, 0) ;
+
+  return result ;
+}
+
+
+static void sequenceAtlasFree(ZMapWindowCanvasSequenceAtlas atlas)
+{
+  zMapReturnIfFail(atlas) ;
+
+  if (atlas->coverage)
+    g_free(atlas->coverage) ;
+
+  if (atlas->row)
+    g_object_unref(atlas->row) ;
+
+  memset(atlas, 0, sizeof(ZMapWindowCanvasSequenceAtlasStruct)) ;
 
   return ;
 }
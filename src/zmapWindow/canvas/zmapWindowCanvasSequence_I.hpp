@@ -91,4 +91,46 @@ typedef struct zmapWindowCanvasSequenceStructType
 
 
 
+/* Sequence text is drawn from a pre-rendered image of all the characters we might display,
+ * the alphabet is tiny so this is much quicker than running every row through pango on every
+ * expose. Each character is a cell of cell_width x text_height holding its antialiased
+ * coverage, rows are put together from the cells at pango's advances and drawn in one go. */
+#define SEQUENCE_ATLAS_FIRST_CHAR  ' '
+#define SEQUENCE_ATLAS_LAST_CHAR   '~'
+#define SEQUENCE_ATLAS_N_CHARS     (SEQUENCE_ATLAS_LAST_CHAR - SEQUENCE_ATLAS_FIRST_CHAR + 1)
+
+typedef struct ZMapWindowCanvasSequenceAtlasStructType
+{
+  GdkDrawable *drawable ;                                   /* atlas is only valid for this drawable. */
+
+  GdkColor colour ;                                         /* colour text is drawn in. */
+
+  int text_width, text_height ;                             /* pango's cell size when made. */
+
+  int advances[SEQUENCE_ATLAS_N_CHARS] ;                    /* pango units. */
+  int pad ;                                                 /* room for overhang each side of a glyph. */
+  int cell_width, width ;
+
+  guchar *coverage ;                                        /* width x text_height, 0 - 255. */
+
+  GdkPixbuf *row ;                                          /* RGBA, reused for each row. */
+
+  gboolean failed ;                                         /* couldn't make atlas, use pango. */
+
+} ZMapWindowCanvasSequenceAtlasStruct, *ZMapWindowCanvasSequenceAtlas ;
+
+
+
+/* Per column data, the pango struct must be first as the common text code expects
+ * featureset->opt to be a ZMapWindowCanvasPango. */
+typedef struct ZMapWindowCanvasSequenceSetStructType
+{
+  zmapWindowCanvasPangoStruct pango ;
+
+  ZMapWindowCanvasSequenceAtlasStruct atlas ;
+
+} ZMapWindowCanvasSequenceSetStruct, *ZMapWindowCanvasSequenceSet ;
+
+
+
 #endif /* !ZMAP_CANVAS_SEQUENCE_I_H */
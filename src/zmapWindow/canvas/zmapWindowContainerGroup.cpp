@@ -375,7 +375,7 @@ static void zmap_window_container_group_update (FooCanvasItem *item, double i2w_
         ZMapFeatureAny f = ((ZMapWindowContainerGroup) item)->feature_any;
 
         if(f)
-          name = (char *) g_quark_to_string(f->unique_id);
+          name = (char *) zMapFeatureIDToString(f->unique_id);
         x = g_strdup_printf("group %s level %d",name, ((ZMapWindowContainerGroup) item)->level);
         printf("group update 1 %s: %f %f %f %f\n", x, item->x1, item->y1, item->x2, item->y2);
       }
@@ -398,7 +398,7 @@ static void zmap_window_container_group_update (FooCanvasItem *item, double i2w_
         ZMapFeatureAny f = ((ZMapWindowContainerGroup) item)->feature_any;
 
         if(f)
-          name = (char *) g_quark_to_string(f->unique_id);
+          name = (char *) zMapFeatureIDToString(f->unique_id);
         x = g_strdup_printf("group %s level %d",name, ((ZMapWindowContainerGroup) item)->level);
         printf("group update 2 %s: %f %f %f %f\n", x, item->x1, item->y1, item->x2, item->y2);
       }
@@ -740,7 +740,7 @@ static ZMapFeatureContextExecuteStatus undisplayFeaturesCB(GQuark key,
       {
         /* CHRIST, WHAT IS THIS CODE....?????????? */
 
-        zMapLogWarning("FeatureSet %s", g_quark_to_string(feature_any->unique_id));
+        zMapLogWarning("FeatureSet %s", zMapFeatureIDToString(feature_any->unique_id));
         break;
       }
     case ZMAPFEATURE_STRUCT_FEATURE:
@@ -786,7 +786,7 @@ static ZMapFeatureContextExecuteStatus undisplayFeaturesCB(GQuark key,
           }
         else
           {
-            zMapLogWarning("Failed to find feature \"%s\"", g_quark_to_string(feature->original_id));
+            zMapLogWarning("Failed to find feature \"%s\"", zMapFeatureIDToString(feature->original_id));
             status = ZMAP_CONTEXT_EXEC_STATUS_ERROR ;
           }
 
@@ -1844,7 +1844,7 @@ void zmapWindowUpdateInfoPanel(ZMapWindow window,
                                    dna_start, dna_end, &display_start, &display_end) ;
 
 
-      select.feature_desc.feature_name   = (char *)g_quark_to_string(feature->original_id) ;
+      select.feature_desc.feature_name   = (char *)zMapFeatureIDToString(feature->original_id) ;
       select.feature_desc.feature_term   = g_strdup_printf("%s", seq_term) ;
       select.feature_desc.feature_variation_string = NULL ;
       select.feature_desc.feature_start  = g_strdup_printf("%d", display_start) ;
@@ -2123,7 +2123,7 @@ void zmapWindowUpdateInfoPanel(ZMapWindow window,
       if (ZMAPFEATURE_IS_BASIC(feature) && feature->feature.basic.flags.variation_str)
         {
           select.feature_desc.feature_name = g_strdup_printf("%s (%s)",
-                                                             (char *)g_quark_to_string(feature->original_id),
+                                                             (char *)zMapFeatureIDToString(feature->original_id),
                                                              (char *)(strlen(feature->feature.basic.variation_str)
                                                                       < max_variation_str_len
                                                                       ? feature->feature.basic.variation_str
@@ -2149,7 +2149,7 @@ void zmapWindowUpdateInfoPanel(ZMapWindow window,
         }
       else
         {
-          select.feature_desc.feature_name = g_strdup((char *)g_quark_to_string(feature->original_id)) ;
+          select.feature_desc.feature_name = g_strdup((char *)zMapFeatureIDToString(feature->original_id)) ;
         }
 
       if (feature->mode == ZMAPSTYLE_MODE_BASIC && feature->feature.basic.known_name)
@@ -2645,7 +2645,7 @@ static ZMapFeatureContextExecuteStatus undisplayFeaturesCB(GQuark key,
   switch(feature_any->struct_type)
     {
     case ZMAPFEATURE_STRUCT_FEATURESET:
-      zMapLogWarning("FeatureSet %s", g_quark_to_string(feature_any->unique_id));
+      zMapLogWarning("FeatureSet %s", zMapFeatureIDToString(feature_any->unique_id));
       break;
     case ZMAPFEATURE_STRUCT_FEATURE:
       {
@@ -2690,7 +2690,7 @@ static ZMapFeatureContextExecuteStatus undisplayFeaturesCB(GQuark key,
             status = ZMAP_CONTEXT_EXEC_STATUS_OK;
           }
         else
-          zMapLogWarning("Failed to find feature \"%s\"", g_quark_to_string(feature->original_id));
+          zMapLogWarning("Failed to find feature \"%s\"", zMapFeatureIDToString(feature->original_id));
 
         break;
       }
@@ -6157,7 +6157,7 @@ static gboolean keyboardEvent(ZMapWindow window, GdkEventKey *key_event)
                 char *seq_name = NULL, *gene_name = NULL, *title;
 
                 seq_name  = (char *)g_quark_to_string(context->original_id) ;
-                gene_name = (char *)g_quark_to_string(feature->original_id) ;
+                gene_name = (char *)zMapFeatureIDToString(feature->original_id) ;
 
                 title = g_strdup_printf("ZMap - %s%s%s",
                                         seq_name,
@@ -227,7 +227,7 @@ char *zmapWindowDNAChoose(ZMapWindow window, FooCanvasItem *feature_item, ZMapWi
 
   dna_data->dna_entry = entry = gtk_entry_new() ;
   gtk_entry_set_activates_default (GTK_ENTRY(entry), TRUE) ;
-  gtk_entry_set_text(GTK_ENTRY(entry), g_quark_to_string(feature->original_id)) ;
+  gtk_entry_set_text(GTK_ENTRY(entry), zMapFeatureIDToString(feature->original_id)) ;
   gtk_box_pack_start(GTK_BOX(topbox), entry, FALSE, FALSE, 0) ;
 
 
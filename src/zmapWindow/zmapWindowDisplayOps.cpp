@@ -479,7 +479,7 @@ static void setUpFeatureTranscript(gboolean revcomped, ZMapWindowDisplayStyle di
 {
   char *name ;
 
-  name = (char *)g_quark_to_string(feature->original_id) ;
+  name = (char *)zMapFeatureIDToString(feature->original_id) ;
 
   switch (display_style->paste_feature)
     {
@@ -558,7 +558,7 @@ static void setUpFeatureOther(ZMapWindowDisplayStyle display_style, ZMapFeature
   selected_end = feature->x2 ;
   selected_length = feature->x2 - feature->x1 + 1 ;
 
-  feature_coord.name = (char *)g_quark_to_string(feature->original_id) ;
+  feature_coord.name = (char *)zMapFeatureIDToString(feature->original_id) ;
   feature_coord.start = selected_start ;
   feature_coord.end = selected_end ;
   feature_coord.length = selected_length ;
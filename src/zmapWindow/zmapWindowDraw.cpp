@@ -97,6 +97,8 @@ typedef struct VisCoordsStructType
 static void toggleColumnInMultipleBlocks(ZMapWindow window, const char *name,
                                          GQuark align_id, GQuark block_id,
                                          gboolean force_to, gboolean force) ;
+static void collectFeaturesetItemsCB(ZMapWindowContainerGroup container, FooCanvasPoints *points,
+                                     ZMapContainerLevelType level, gpointer user_data) ;
 static void preZoomCB(ZMapWindowContainerGroup container, FooCanvasPoints *points,
                       ZMapContainerLevelType level, gpointer user_data) ;
 static void positionColumnCB(ZMapWindowContainerGroup container, FooCanvasPoints *points,
@@ -766,12 +768,34 @@ void zmapWindowDrawZoom(ZMapWindow window)
   preZoomCB,
   window) ;
 
+  zmapWindowDrawPrepareIndexes(window) ;
+
   zmapWindowFullReposition(window->feature_root_group,TRUE, "draw zoom") ;
 
   return ;
 }
 
 
+/* Columns build their feature indexes lazily on their first expose, which means they are
+ * all built one after another in the GUI thread. Calling this after a load or zoom does the
+ * expensive part for all the columns that need it in parallel. */
+void zmapWindowDrawPrepareIndexes(ZMapWindow window)
+{
+  GList *featureset_items = NULL ;
+
+  zmapWindowContainerUtilsExecute(window->feature_root_group,
+                                  ZMAPCONTAINER_LEVEL_FEATURESET,
+                                  collectFeaturesetItemsCB,
+                                  &featureset_items) ;
+
+  zMapWindowCanvasFeaturesetPrepareIndexes(featureset_items) ;
+
+  g_list_free(featureset_items) ;
+
+  return ;
+}
+
+
 
 
 void zmapWindowDrawSeparatorFeatures(ZMapWindow           window,
@@ -1078,6 +1102,24 @@ static void printItem(FooCanvasItem *item, int indent, char *prefix)
 
 
 
+/* Make a list of all the featureset items in the window. */
+static void collectFeaturesetItemsCB(ZMapWindowContainerGroup container, FooCanvasPoints *points,
+                                     ZMapContainerLevelType level, gpointer user_data)
+{
+  GList **featureset_items_inout = (GList **)user_data ;
+
+  if (level == ZMAPCONTAINER_LEVEL_FEATURESET)
+    {
+      ZMapWindowFeaturesetItem cfs ;
+
+      if ((cfs = zmapWindowContainerGetFeatureSetItem((ZMapWindowContainerFeatureSet)container)))
+        *featureset_items_inout = g_list_prepend(*featureset_items_inout, cfs) ;
+    }
+
+  return ;
+}
+
+
 /* GFunc called for all container groups (but some don't have functions for
  * prezoom etc) to prepare for zooming.
  */
@@ -1280,7 +1322,7 @@ static void printChild(gpointer data, gpointer user_data)
 
   any_feature = zmapWindowItemGetFeatureAny(container);
 
-  printf("%s ", g_quark_to_string(any_feature->unique_id)) ;
+  printf("%s ", zMapFeatureIDToString(any_feature->unique_id)) ;
 
   return ;
 }
@@ -939,6 +939,9 @@ void zMapWindowDrawContext(ZMapCanvasData     canvas_data,
 
   zMapLogTime(TIMER_DRAW_CONTEXT,TIMER_STOP,canvas_data->feature_count,"");
 
+  /* New features mean the column indexes must be rebuilt, do the work for all columns at once. */
+  zmapWindowDrawPrepareIndexes(canvas_data->window) ;
+
   //  hideEmpty(canvas_data->window);        /* done by caller */
 
   return ;
@@ -1426,7 +1429,7 @@ static ZMapFeatureContextExecuteStatus windowDrawContextCB(GQuark   key_id,
   feature_type = feature_any->struct_type;
 
   if(window_draw_context_debug_G)
-    zMapLogWarning("windowDrawContext: drawing %s", g_quark_to_string(feature_any->unique_id));
+    zMapLogWarning("windowDrawContext: drawing %s", zMapFeatureIDToString(feature_any->unique_id));
 
   /* Note in the below code for each feature type we either find that it already exists or
    * we create a new one. */
@@ -1643,7 +1646,7 @@ static ZMapFeatureContextExecuteStatus windowDrawContextCB(GQuark   key_id,
         if (!canvas_data->curr_set)
           {
             char *x = g_strdup_printf("cannot find set %s, available are: ",
-                                      g_quark_to_string(feature_any->unique_id));
+                                      zMapFeatureIDToString(feature_any->unique_id));
             {
               GList *l;
               char *x;
@@ -2391,7 +2394,7 @@ static void ProcessListFeature(gpointer data, gpointer user_data)
 
 #if MH17_REVCOMP_DEBUG > 1
   if(featureset_data->frame != ZMAPFRAME_NONE)
-    printf("ProcessFeature %s %d-%d\n",g_quark_to_string(feature->original_id), feature->x1,feature->x2);
+    printf("ProcessFeature %s %d-%d\n",zMapFeatureIDToString(feature->original_id), feature->x1,feature->x2);
 #endif
 
 
@@ -2423,8 +2426,8 @@ static void ProcessListFeature(gpointer data, gpointer user_data)
 
           err_msg = g_strdup_printf("no style for feature set \"%s\", feature \"%s\", (%s)",
                                     g_quark_to_string(feature_set->original_id),
-                                    g_quark_to_string(feature->original_id),
-                                    g_quark_to_string(feature->unique_id));
+                                    zMapFeatureIDToString(feature->original_id),
+                                    zMapFeatureIDToString(feature->unique_id));
 
 
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
@@ -2509,7 +2512,7 @@ static void ProcessListFeature(gpointer data, gpointer user_data)
   else
     zMapLogWarning("need a style '%s' for feature '%s'",
                    g_quark_to_string(feature->style_id),
-                   g_quark_to_string(feature->original_id));
+                   zMapFeatureIDToString(feature->original_id));
 
 #endif
 
@@ -2533,7 +2536,7 @@ static void ProcessListFeature(gpointer data, gpointer user_data)
     }
   else
     zMapLogWarning("definitely need a style for feature '%s'",
-                   g_quark_to_string(feature->original_id));
+                   zMapFeatureIDToString(feature->original_id));
 
   if(feature_item)
     featureset_data->feature_count++;
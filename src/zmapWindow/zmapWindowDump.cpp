@@ -37,8 +37,9 @@
  * THIS CODE IS ESSENTIALLY COMMENTED OUT BECAUSE THE g2 LIBRARY CALLS
  * ARE BEING REPLACED WITH THE GtkPrint FUNCTIONS.
  *
- * OPTIONS THAT CALL THIS CODE WILL BE NO-OPS.....
- *
+ * OPTIONS THAT CALL THIS CODE WILL BE NO-OPS.....EXCEPT FOR POSTSCRIPT
+ * AND ENCAPSULATED POSTSCRIPT OF FEATURESET COLUMNS WHICH ARE NOW
+ * WRITTEN DIRECTLY, SEE dumpFeaturesetItem().
  *
  */
 
@@ -60,6 +61,7 @@
  */
 
 #include <string.h>
+#include <stdarg.h>
 #include <math.h>
 #include <glib.h>
 
@@ -89,6 +91,13 @@ typedef enum {ORIENTATION_PORTRAIT, ORIENTATION_LANDSCAPE} DumpOrientation ;
 typedef enum {ASPECT_AS_IS, ASPECT_FITPAGE} DumpAspect ;
 
 
+/* Postscript is buffered and written out in chunks of about this size. */
+#define DUMP_PS_BUFFER_SIZE 65536
+
+#define DUMP_A4_WIDTH  595
+#define DUMP_A4_HEIGHT 842
+
+
 
 typedef struct
 {
@@ -115,6 +124,16 @@ typedef struct
   char *levels[10];
   char *names[10];
 
+  /* Postscript output, primitives are streamed to the channel via the buffer. */
+  GString *ps_buffer ;
+  gboolean ps_error ;
+  double x_mul, y_mul ;                                     /* world to output units. */
+  double min_height ;                                       /* world height of one output unit. */
+  GdkColormap *colormap ;
+  gboolean ps_pixel_set ;
+  gulong ps_pixel ;                                         /* current postscript colour. */
+  int n_primitives ;
+
 } DumpOptionsStruct, *DumpOptions ;
 
 /* Notes on GdkColor *current_background_colour; in struct above:
@@ -169,12 +188,19 @@ static void dumpCB(ZMapWindowContainerGroup container_parent, FooCanvasPoints *p
                    ZMapContainerLevelType level, gpointer user_data);
 static void itemCB(gpointer data, gpointer user_data) ;
 static void dumpFeatureCB(gpointer data, gpointer user_data);
+static void dumpFeaturesetItem(ZMapWindowFeaturesetItem featureset_item, DumpOptions dump_opts) ;
+static void dumpPrimitiveCB(ZMapWindowCanvasExport primitive, gpointer user_data) ;
 
 
-static int openPS(DumpOptions dump_opts) ;
-static int openEPSF(DumpOptions dump_opts) ;
+static gboolean openPS(DumpOptions dump_opts) ;
+static gboolean openEPSF(DumpOptions dump_opts) ;
 static int openGD(DumpOptions dump_opts) ;
-static int setScalingPS(DumpOptions dump_opts) ;
+static void setScalingPS(DumpOptions dump_opts) ;
+static gboolean openPostscript(DumpOptions dump_opts, const char *header, int width, int height) ;
+static gboolean closePostscript(DumpOptions dump_opts) ;
+static void psSetColour(DumpOptions dump_opts, gulong pixel) ;
+static void psAppendNumbers(GString *ps, const char *op, int n_numbers, ...) ;
+static void psFlush(DumpOptions dump_opts, gboolean force) ;
 
 static gboolean chooseDump(DumpOptions dump_opts) ;
 static void setSensitive(GtkWidget *button, gpointer cb_data, gboolean active) ;
@@ -282,10 +308,10 @@ printf("dump exent: %d %f,%f %f,%f\n",dump_opts->extent,dump_opts->x1,dump_opts-
       switch (dump_opts->format)
         {
         case DUMP_PS:
-          dump_opts->g2_id = openPS(dump_opts) ;
+          result = openPS(dump_opts) ;
           break ;
         case DUMP_EPSF:
-          dump_opts->g2_id = openEPSF(dump_opts) ;
+          result = openEPSF(dump_opts) ;
           break ;
         case DUMP_PNG:
         case DUMP_JPEG:
@@ -293,6 +319,13 @@ printf("dump exent: %d %f,%f %f,%f\n",dump_opts->extent,dump_opts->x1,dump_opts-
           break ;
         }
 
+      if (!result)
+        {
+          g_hash_table_destroy(dump_opts->ink_colours) ;
+
+          return result ;
+        }
+
 
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
       g2_set_font_size(dump_opts->g2_id,30.0);
@@ -310,6 +343,9 @@ printf("dump exent: %d %f,%f %f,%f\n",dump_opts->extent,dump_opts->x1,dump_opts-
       g2_close(dump_opts->g2_id) ;
 #endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
+      if (dump_opts->ps_buffer)
+        result = closePostscript(dump_opts) ;
+
 
       g_hash_table_destroy(dump_opts->ink_colours) ;
 
@@ -495,71 +531,21 @@ static void setSensitive(GtkWidget *button, gpointer data, gboolean active)
 }
 
 
-/* Make a raw postscript file. */
-static int openPS(DumpOptions dump_opts)
+/* Make a raw postscript file scaled to an A4 page. */
+static gboolean openPS(DumpOptions dump_opts)
 {
-  int g2_id = 0 ;
-
-  g2_id = setScalingPS(dump_opts) ;
-
-
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-  double a4_width = 595.0, a4_height = 842.0 ;
-  double pixels_per_unit_x;
-  double pixels_per_unit_y;
-  double x1, y1, x2, y2 ;
-  double canvas_width, canvas_height ;
-  double x_origin, y_origin ;
-  double paper_mul, x_mul, y_mul ;
-
-  x1 = dump_opts->x1 ;
-  y1 = dump_opts->y1 ;
-  x2 = dump_opts->x2 ;
-  y2 = dump_opts->y2 ;
-
-
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-  g2_id = g2_open_PS(dump_opts->filename, g2_A4, g2_PS_port) ;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
-
-
-  x_origin = x1 ;
-  y_origin = y1 ;
-
-
-  pixels_per_unit_x = dump_opts->window->canvas->pixels_per_unit_x ;
-
-  pixels_per_unit_y = dump_opts->window->canvas->pixels_per_unit_y ;
-
-  if (dump_opts->extent == EXTENT_WHOLE)
-    pixels_per_unit_y = zMapWindowGetZoomMin(dump_opts->window) ;
-
-
-  canvas_width = ((x2 - x1 + 1) * pixels_per_unit_x) ;
-  canvas_height = ((y2 - y1 + 1) * pixels_per_unit_y) ;
-
-
-  /* redo this scaling stuff to be more accurate once I have everything working.... */
-  if (canvas_width > canvas_height)
-    paper_mul = a4_width / canvas_width ;
-  else
-    paper_mul = a4_height / canvas_height ;
-
-
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-  x_mul = a4_width / (x2 - x1 + 1) ;
-  y_mul = a4_height / (y2 - y1 + 1) ;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
-
-  x_mul = (a4_width / (x2 - x1 + 1)) * paper_mul ;
-  y_mul = (a4_height / (y2 - y1 + 1)) * paper_mul ;
-
+  gboolean result = FALSE ;
 
-  g2_set_coordinate_system(dump_opts->g2_id, x_origin, y_origin, x_mul, y_mul) ;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
+  setScalingPS(dump_opts) ;
 
+  if ((result = openPostscript(dump_opts, "%!PS-Adobe-3.0", DUMP_A4_WIDTH, DUMP_A4_HEIGHT)))
+    {
+      /* Landscape is drawn on the portrait page rotated. */
+      if (dump_opts->orientation == ORIENTATION_LANDSCAPE)
+        g_string_append_printf(dump_opts->ps_buffer, "%d 0 translate 90 rotate\n", DUMP_A4_WIDTH) ;
+    }
 
-  return g2_id ;
+  return result ;
 }
 
 
@@ -569,43 +555,31 @@ static int openPS(DumpOptions dump_opts)
  * EPS can be scaled when included in a document
  */
 
-static int openEPSF(DumpOptions dump_opts)
+static gboolean openEPSF(DumpOptions dump_opts)
 {
-  int g2_id = 0 ;
+  gboolean result = FALSE ;
   double canvas_width, canvas_height ;
   double x_origin, y_origin ;
-  double x_mul, y_mul ;
-
-  scale2Canvas(dump_opts, &canvas_width, &canvas_height, &x_origin, &y_origin, &x_mul, &y_mul) ;
 
+  scale2Canvas(dump_opts, &canvas_width, &canvas_height, &x_origin, &y_origin, &dump_opts->x_mul, &dump_opts->y_mul) ;
 
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-  g2_id = g2_open_EPSF_CLIP(dump_opts->filename, canvas_width, canvas_height) ;
+  result = openPostscript(dump_opts, "%!PS-Adobe-3.0 EPSF-3.0", (int)ceil(canvas_width), (int)ceil(canvas_height)) ;
 
-  g2_set_coordinate_system(dump_opts->g2_id, x_origin, y_origin, x_mul, y_mul) ;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
-
-
-  return g2_id ;
+  return result ;
 }
 
 
 
 
 /* Set up scaling for postscript. */
-static int setScalingPS(DumpOptions dump_opts)
+static void setScalingPS(DumpOptions dump_opts)
 {
-  int g2_id = 0 ;
-
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-  enum g2_PS_orientation orientation ;
-  double a4_width = 595.0, a4_height = 842.0 ;
+  double a4_width, a4_height ;
   double pixels_per_unit_x;
   double pixels_per_unit_y;
   double x1, y1, x2, y2 ;
   double canvas_width, canvas_height ;
-  double x_origin, y_origin ;
-  double paper_mul, x_mul, y_mul ;
+  double paper_mul ;
 
 
   /* Get coords of section to be exported, could be whole alignment or just visible window. */
@@ -642,71 +616,115 @@ static int setScalingPS(DumpOptions dump_opts)
 
   if (dump_opts->orientation == ORIENTATION_PORTRAIT)
     {
-      orientation = g2_PS_port ;
-      a4_width = 595.0 ;
-      a4_height = 842.0 ;
+      a4_width = DUMP_A4_WIDTH ;
+      a4_height = DUMP_A4_HEIGHT ;
     }
   else
     {
-      orientation = g2_PS_land ;
-      a4_width = 842.0 ;
-      a4_height = 595.0 ;
+      a4_width = DUMP_A4_HEIGHT ;
+      a4_height = DUMP_A4_WIDTH ;
     }
 
-  g2_id = g2_open_PS(dump_opts->filename, g2_A4, orientation) ;
-
-
 
   if (dump_opts->aspect == ASPECT_AS_IS)
     {
-
-      if (canvas_width > canvas_height)
-        paper_mul = a4_width / canvas_width ;
-      else
+      /* Biggest that fits both ways. */
+      paper_mul = a4_width / canvas_width ;
+      if (a4_height / canvas_height < paper_mul)
         paper_mul = a4_height / canvas_height ;
 
+      dump_opts->x_mul = pixels_per_unit_x * paper_mul ;
+      dump_opts->y_mul = pixels_per_unit_y * paper_mul ;
+    }
+  else
+    {
+      dump_opts->x_mul = a4_width / (x2 - x1 + 1) ;
+      dump_opts->y_mul = a4_height / (y2 - y1 + 1) ;
+    }
 
+  return ;
+}
 
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-      x_mul = (a4_width / (x2 - x1 + 1)) * paper_mul ;
-      y_mul = (a4_height / (y2 - y1 + 1)) * paper_mul ;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
-
-      x_mul = pixels_per_unit_x * paper_mul ;
-      y_mul = pixels_per_unit_y * paper_mul ;
 
+/* Opens the output and writes the postscript header, features are then streamed out as
+ * they are found so memory use does not depend on the number of features. */
+static gboolean openPostscript(DumpOptions dump_opts, const char *header, int width, int height)
+{
+  gboolean result = TRUE ;
+  GString *ps ;
 
-    }
-  else
+  if (dump_opts->filename)
     {
-      x_mul = a4_width / (x2 - x1 + 1) ;
-      y_mul = a4_height / (y2 - y1 + 1) ;
-    }
+      GError *error = NULL ;
 
+      if (!(dump_opts->channel = g_io_channel_new_file(dump_opts->filename, "w", &error)))
+        {
+          zMapWarning("Could not open \"%s\" for export: %s", dump_opts->filename, error->message) ;
 
-#ifdef ED_G_NEVER_INCLUDE_THIS_CODE
-  if (dump_opts->orientation == ORIENTATION_PORTRAIT)
+          g_error_free(error) ;
+          result = FALSE ;
+        }
+    }
+
+  if (result && dump_opts->channel)
     {
-      x_origin = x1 ;
-      y_origin = y1 * y_mul ;
+      dump_opts->colormap = gtk_widget_get_colormap(GTK_WIDGET(dump_opts->window->canvas)) ;
+      dump_opts->min_height = 1.0 / dump_opts->y_mul ;
+
+      ps = dump_opts->ps_buffer = g_string_sized_new(DUMP_PS_BUFFER_SIZE + 256) ;
+
+      g_string_append_printf(ps, "%s\n", header) ;
+      g_string_append_printf(ps, "%%%%BoundingBox: 0 0 %d %d\n", width, height) ;
+      g_string_append(ps, "%%Creator: ZMap\n") ;
+      g_string_append(ps, "%%Pages: 1\n") ;
+      g_string_append(ps, "%%EndComments\n") ;
+
+      /* Short names for the operators we use to keep the file small. */
+      g_string_append(ps, "%%BeginProlog\n") ;
+      g_string_append(ps, "/C { setrgbcolor } bind def\n") ;
+      g_string_append(ps, "/F { rectfill } bind def\n") ;
+      g_string_append(ps, "/S { rectstroke } bind def\n") ;
+      g_string_append(ps, "/L { moveto lineto stroke } bind def\n") ;
+      g_string_append(ps, "%%EndProlog\n") ;
+
+      g_string_append(ps, "%%Page: 1 1\n") ;
+      g_string_append(ps, "0 setlinewidth\n") ;
     }
-  else
+  else if (result)
     {
-      x_origin = x1 ;
-      y_origin = y1 * y_mul ;
+      result = FALSE ;
     }
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
-  x_origin = y_origin = 0.0;
+  return result ;
+}
 
-  g2_set_coordinate_system(g2_id, x_origin, y_origin, x_mul, y_mul) ;
-#endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
 
-  return g2_id ;
-}
+static gboolean closePostscript(DumpOptions dump_opts)
+{
+  gboolean result ;
+
+  g_string_append(dump_opts->ps_buffer, "showpage\n") ;
+  g_string_append(dump_opts->ps_buffer, "%%EOF\n") ;
+
+  psFlush(dump_opts, TRUE) ;
+
+  g_string_free(dump_opts->ps_buffer, TRUE) ;
+  dump_opts->ps_buffer = NULL ;
 
+  /* We only close the channel if we opened it. */
+  if (dump_opts->filename)
+    {
+      g_io_channel_shutdown(dump_opts->channel, TRUE, NULL) ;
+      g_io_channel_unref(dump_opts->channel) ;
+      dump_opts->channel = NULL ;
+    }
+
+  zMapLogMessage("Exported %d drawing primitives.", dump_opts->n_primitives) ;
 
+  result = !dump_opts->ps_error ;
 
+  return result ;
+}
 
 
 
@@ -800,7 +818,7 @@ static void dumpCB(ZMapWindowContainerGroup container_parent, FooCanvasPoints *p
     }
     if ((any = zmapWindowItemGetFeatureAny(foo)))     // we get a log warning if this is a strand
       {
-        name = (char *) g_quark_to_string(any->original_id) ;
+        name = (char *) zMapFeatureIDToString(any->original_id) ;
       }
     else if(ZMAP_IS_CONTAINER_STRAND(container_parent))
     {
@@ -867,7 +885,7 @@ static void itemCB(gpointer data, gpointer user_data)
             if ((feature = zmapWindowItemGetFeature(item)))
               {
                 printf("group feature %s/ %s at %f,%f,%f,%f: %s\n",
-                  G_OBJECT_TYPE_NAME(item), g_quark_to_string(feature->original_id),
+                  G_OBJECT_TYPE_NAME(item), zMapFeatureIDToString(feature->original_id),
                   item->x1,item->y1,item->x2,item->y2,
                   ZMAP_IS_CANVAS_ITEM(item)? "CanvasGroup": "");
               }
@@ -875,6 +893,11 @@ static void itemCB(gpointer data, gpointer user_data)
 
         }
       }
+    else if (ZMAP_IS_WINDOW_FEATURESET_ITEM(item))
+      {
+        if (dump_options->ps_buffer && dumpItemIsVisible(item, dump_options))
+          dumpFeaturesetItem(ZMAP_WINDOW_FEATURESET_ITEM(item), dump_options) ;
+      }
     else
       {
          dumpFeatureCB(item, user_data) ;
@@ -1046,6 +1069,135 @@ static void dumpFeatureCB(gpointer data, gpointer user_data)
 
 
 
+/* Featureset items hold all the features of a column, possibly millions of them, so instead
+ * of a primitive per feature we get just what's needed to draw the features at the output
+ * resolution and write them straight out. */
+static void dumpFeaturesetItem(ZMapWindowFeaturesetItem featureset_item, DumpOptions dump_opts)
+{
+  zMapWindowCanvasFeaturesetExport(featureset_item, dump_opts->y1, dump_opts->y2,
+                                   dump_opts->min_height, dumpPrimitiveCB, dump_opts) ;
+
+  return ;
+}
+
+
+/* Output coords have their origin at bottom left so y is inverted. */
+static void dumpPrimitiveCB(ZMapWindowCanvasExport primitive, gpointer user_data)
+{
+  DumpOptions dump_opts = (DumpOptions)user_data ;
+  GString *ps = dump_opts->ps_buffer ;
+  double x1, y1, x2, y2 ;
+
+  x1 = (primitive->x1 - dump_opts->x1) * dump_opts->x_mul ;
+  x2 = (primitive->x2 - dump_opts->x1) * dump_opts->x_mul ;
+  y1 = (dump_opts->y2 - primitive->y2) * dump_opts->y_mul ;
+  y2 = (dump_opts->y2 - primitive->y1) * dump_opts->y_mul ;
+
+  if (primitive->type == ZMAPWINDOW_EXPORT_LINE)
+    {
+      psSetColour(dump_opts, primitive->outline_pixel) ;
+      psAppendNumbers(ps, "L", 4, x2, y2, x1, y1) ;
+    }
+  else
+    {
+      if (primitive->fill_set)
+        {
+          psSetColour(dump_opts, primitive->fill_pixel) ;
+          psAppendNumbers(ps, "F", 4, x1, y1, x2 - x1, y2 - y1) ;
+        }
+
+      if (primitive->outline_set)
+        {
+          psSetColour(dump_opts, primitive->outline_pixel) ;
+          psAppendNumbers(ps, "S", 4, x1, y1, x2 - x1, y2 - y1) ;
+        }
+    }
+
+  dump_opts->n_primitives++ ;
+
+  psFlush(dump_opts, FALSE) ;
+
+  return ;
+}
+
+
+/* Colours are only output when they change, consecutive features are usually the same. */
+static void psSetColour(DumpOptions dump_opts, gulong pixel)
+{
+  if (!dump_opts->ps_pixel_set || pixel != dump_opts->ps_pixel)
+    {
+      GdkColor colour = {0} ;
+
+      gdk_colormap_query_color(dump_opts->colormap, pixel, &colour) ;
+
+      psAppendNumbers(dump_opts->ps_buffer, "C", 3,
+                      colour.red / 65535.0, colour.green / 65535.0, colour.blue / 65535.0) ;
+
+      dump_opts->ps_pixel = pixel ;
+      dump_opts->ps_pixel_set = TRUE ;
+    }
+
+  return ;
+}
+
+
+/* Numbers must be written with '.' whatever the locale. */
+static void psAppendNumbers(GString *ps, const char *op, int n_numbers, ...)
+{
+  va_list args ;
+  char number[G_ASCII_DTOSTR_BUF_SIZE] ;
+  int i ;
+
+  va_start(args, n_numbers) ;
+
+  for (i = 0 ; i < n_numbers ; i++)
+    {
+      g_ascii_formatd(number, sizeof(number), "%.2f", va_arg(args, double)) ;
+      g_string_append(ps, number) ;
+      g_string_append_c(ps, ' ') ;
+    }
+
+  va_end(args) ;
+
+  g_string_append(ps, op) ;
+  g_string_append_c(ps, '\n') ;
+
+  return ;
+}
+
+
+/* Write out the buffer when it's full or if forced, stops writing after an error. */
+static void psFlush(DumpOptions dump_opts, gboolean force)
+{
+  GString *ps = dump_opts->ps_buffer ;
+
+  if ((force || ps->len >= DUMP_PS_BUFFER_SIZE) && ps->len)
+    {
+      if (!dump_opts->ps_error)
+        {
+          GError *error = NULL ;
+          gsize bytes_written = 0 ;
+
+          if (g_io_channel_write_chars(dump_opts->channel, ps->str, ps->len,
+                                       &bytes_written, &error) != G_IO_STATUS_NORMAL)
+            {
+              zMapLogWarning("Export failed: %s", (error ? error->message : "unknown error")) ;
+
+              if (error)
+                g_error_free(error) ;
+
+              dump_opts->ps_error = TRUE ;
+            }
+        }
+
+      g_string_truncate(ps, 0) ;
+    }
+
+  return ;
+}
+
+
+
 #if NOT_USED
 /* Looks for a colour in our hash table of colours and returns the corresponding ink id.
  * There is a strict limit of 256 colours in g2's interface to the libgd package so
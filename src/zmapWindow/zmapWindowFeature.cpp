@@ -796,15 +796,15 @@ FooCanvasItem *zmapWindowFeatureFactoryRunSingle(GHashTable *ftoi_hash,
 
       if(ftoi_hash)
         {
-          if(!feature_stack->col_hash[strand])
+          if(!feature_stack->col_set[strand])
             {
-              feature_stack->col_hash[strand] = zmapWindowFToIGetSetHash(ftoi_hash,
-                                                                         feature_stack->align->unique_id,
-                                                                         feature_stack->block->unique_id,
-                                                                         feature_stack->feature_set->unique_id, strand, frame);
+              feature_stack->col_set[strand] = zmapWindowFToIGetSet(ftoi_hash,
+                                                                    feature_stack->align->unique_id,
+                                                                    feature_stack->block->unique_id,
+                                                                    feature_stack->feature_set->unique_id, strand, frame);
             }
 
-          zmapWindowFToIAddSetFeature(feature_stack->col_hash[strand],
+          zmapWindowFToIAddSetFeature(feature_stack->col_set[strand],
                                       feature->unique_id, feature_item, feature);
 
         }
@@ -880,7 +880,7 @@ char *zmapWindowFeatureTranscriptFASTA(ZMapFeature feature, ZMapSequenceType seq
       char *dna, *seq_name = NULL, *gene_name = NULL;
 
       seq_name  = (char *)g_quark_to_string(context->original_id);
-      gene_name = (char *)g_quark_to_string(feature->original_id);
+      gene_name = (char *)zMapFeatureIDToString(feature->original_id);
 
       if ((dna = zMapFeatureGetTranscriptDNA(feature, spliced, cds_only)))
         {
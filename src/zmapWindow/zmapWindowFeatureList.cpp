@@ -296,7 +296,6 @@ static void feature_add_simple(ZMapGUITreeView zmap_tv,
 {
   ZMapWindowFeatureList zmap_tv_feature;
   ZMapFeature feature = (ZMapFeature)user_data;
-  AddSimpleDataFeatureStruct add_simple = {NULL};
 
   zmap_tv_feature = ZMAP_WINDOWFEATURELIST(zmap_tv);
 
@@ -307,18 +306,23 @@ static void feature_add_simple(ZMapGUITreeView zmap_tv,
       setup_tree(zmap_tv_feature, feature->mode);
     }
 
-  /* Always add the feature... */
-  add_simple.feature = (ZMapFeatureAny)feature;
-
-  /* Only add the window if display_forward_coords == TRUE */
-  if(zmap_tv_feature->window &&
-     zmap_tv_feature->window->display_forward_coords == TRUE)
-    add_simple.window = zmap_tv_feature->window;
-
   if(zmap_tv_feature->feature_type != ZMAPSTYLE_MODE_INVALID &&
      zmap_tv_feature->feature_type == feature->mode &&
      parent_class_G->add_tuple_simple)
-    (* parent_class_G->add_tuple_simple)(zmap_tv, &add_simple);
+    {
+      AddSimpleDataFeature add_simple;
+
+      /* Always add the feature, the model owns the row from here... */
+      add_simple = g_new0(AddSimpleDataFeatureStruct, 1);
+      add_simple->feature = (ZMapFeatureAny)feature;
+
+      /* Only add the window if display_forward_coords == TRUE */
+      if(zmap_tv_feature->window &&
+         zmap_tv_feature->window->display_forward_coords == TRUE)
+        add_simple->window = zmap_tv_feature->window;
+
+      (* parent_class_G->add_tuple_simple)(zmap_tv, add_simple);
+    }
 
   return ;
 }
@@ -343,6 +347,8 @@ static void setup_tree(ZMapWindowFeatureList zmap_tv,
   g_object_set(G_OBJECT(zmap_tv),
              "row-counter-column",  TRUE,
              "data-ptr-column",     FALSE,
+             "lazy-model",          TRUE,
+             "row-data-destroy",    (gpointer)g_free,
              "column_count",        g_list_length(column_titles),
              "column_names",        column_titles,
              "column_types",        column_types,
@@ -380,7 +386,7 @@ static void feature_name_to_value(GValue *value, gpointer feature_data)
 
   if(G_VALUE_TYPE(value) == G_TYPE_STRING)
     {
-      the_name = g_quark_to_string(feature->original_id) ;
+      the_name = zMapFeatureIDToString(feature->original_id) ;
 
       if ((temp_name = (char *)zMapStringAbbrevStr(the_name)))
         the_name = temp_name ;
@@ -987,13 +993,6 @@ typedef struct
   gboolean                  list_incomplete;
 } ModelForeachStruct, *ModelForeach;
 
-typedef struct
-{
-  ZMapFeatureAny feature;
-  ZMapWindow     window;
-  FooCanvasItem *item;
-} AddSimpleDataFeatureItemStruct, *AddSimpleDataFeatureItem;
-
 /*!
  * \brief The data we hold on the data pointer. See zMapWindowFeatureItemListGetItem()
  */
@@ -1005,6 +1004,21 @@ typedef struct
     feature_id;
 } SerialisedFeatureSearchStruct, *SerialisedFeatureSearch;
 
+/* One of these per row, kept by the lazy model, the column funcs are called with it whenever
+ * the view wants a value. The first members must match AddSimpleDataFeatureStruct as the
+ * ZMapWindowFeatureList column funcs are shared. The set strand/frame and the lookup ids are
+ * worked out once when the row is made. */
+typedef struct
+{
+  ZMapFeatureAny feature;
+  ZMapWindow     window;
+  FooCanvasItem *item;
+
+  SerialisedFeatureSearchStruct lookup;
+  ZMapStrand set_strand;
+  ZMapFrame  set_frame;
+} AddSimpleDataFeatureItemStruct, *AddSimpleDataFeatureItem;
+
 static void zmap_windowfeatureitemlist_class_init(ZMapWindowFeatureItemListClass zmap_tv_class);
 static void zmap_windowfeatureitemlist_init(ZMapWindowFeatureItemList zmap_tv);
 static void zmap_windowfeatureitemlist_set_property(GObject *gobject,
@@ -1038,7 +1052,10 @@ static gboolean update_foreach_cb(GtkTreeModel *model,
                           GtkTreePath  *path,
                           GtkTreeIter  *iter,
                           gpointer      user_data);
-static void free_serialised_data_cb(gpointer user_data);
+static AddSimpleDataFeatureItem feature_item_row_create(ZMapWindowFeatureItemList zmap_tv,
+                                                        ZMapFeatureAny feature,
+                                                        FooCanvasItem *item);
+static void feature_item_row_free(gpointer user_data);
 static void invoke_tuple_remove(gpointer list_data, gpointer user_data);
 static gboolean fetch_lookup_data(ZMapWindowFeatureItemList zmap_tv,
                           GtkTreeModel             *model,
@@ -1118,15 +1135,15 @@ void zMapWindowFeatureItemListUpdateItem(ZMapWindowFeatureItemList zmap_tv,
                                GtkTreeIter              *tree_iterator,
                                FooCanvasItem            *feature_item)
 {
-  SerialisedFeatureSearch feature_data;
-
-  if(fetch_lookup_data(zmap_tv, ZMAP_GUITREEVIEW(zmap_tv)->tree_model,
-                   tree_iterator, &feature_data, NULL, NULL))
-    free_serialised_data_cb(feature_data);
+  ZMapFeatureAny feature;
 
-  zmap_tv->window = window;
-  zMapGUITreeViewUpdateTuple(ZMAP_GUITREEVIEW(zmap_tv), tree_iterator, feature_item);
-  zmap_tv->window = NULL;
+  if((feature = zmapWindowItemGetFeatureAny(feature_item)))
+    {
+      zmap_tv->window = window;
+      zMapGUITreeViewUpdateTuple(ZMAP_GUITREEVIEW(zmap_tv), tree_iterator,
+                                 feature_item_row_create(zmap_tv, feature, feature_item));
+      zmap_tv->window = NULL;
+    }
 
   return ;
 }
@@ -1400,7 +1417,6 @@ static void feature_item_add_simple(ZMapGUITreeView zmap_tv,
   ID2Canvas id2c = (ID2Canvas) user_data;
   FooCanvasItem *item = FOO_CANVAS_ITEM(id2c->item);
   ZMapFeature feature = (ZMapFeature) id2c->feature_any;
-  AddSimpleDataFeatureItemStruct add_simple = {NULL};
 
   zmap_tv_feature = ZMAP_WINDOWFEATUREITEMLIST(zmap_tv);
 
@@ -1413,20 +1429,16 @@ static void feature_item_add_simple(ZMapGUITreeView zmap_tv,
         setup_item_tree(zmap_tv_feature, feature->mode);
       }
 
-        /* Always add the feature & the item... */
-      add_simple.feature   = (ZMapFeatureAny)feature;
-      add_simple.item      = item;
-
-      if(zmap_tv_feature->window &&
-         zmap_tv_feature->window->display_forward_coords)
-      add_simple.window  = zmap_tv_feature->window;
-
       if (  zmap_tv_feature->feature_type != ZMAPSTYLE_MODE_INVALID &&
             /* zmap_tv_feature->feature_type == feature->mode && */
             feature->mode != ZMAPSTYLE_MODE_INVALID &&
             feature_item_parent_class_G->add_tuple_simple)
         {
-          (* feature_item_parent_class_G->add_tuple_simple)(zmap_tv, &add_simple);
+          /* Always add the feature & the item, the model owns the row from here. */
+          (* feature_item_parent_class_G->add_tuple_simple)(zmap_tv,
+                                                           feature_item_row_create(zmap_tv_feature,
+                                                                                   (ZMapFeatureAny)feature,
+                                                                                   item));
         }
     }
 
@@ -1451,6 +1463,8 @@ static void setup_item_tree(ZMapWindowFeatureItemList zmap_tv,
   g_object_set(G_OBJECT(zmap_tv),
              "row-counter-column",  TRUE,
              "data-ptr-column",     FALSE,
+             "lazy-model",          TRUE,
+             "row-data-destroy",    (gpointer)feature_item_row_free,
              "column_count",        g_list_length(column_titles),
              "column_names",        column_titles,
              "column_types",        column_types,
@@ -1649,20 +1663,8 @@ static void feature_item_type_get_titles_types_funcs(ZMapStyleMode feature_type,
 static void feature_item_data_strand_to_value(GValue *value, gpointer feature_item_data)
 {
   AddSimpleDataFeatureItem add_data = (AddSimpleDataFeatureItem)feature_item_data;
-  FooCanvasItem *feature_item = FOO_CANVAS_ITEM(add_data->item);
-  ZMapWindowContainerGroup feature_set_container;
-  ZMapWindowContainerFeatureSet container;
 
-  if((feature_set_container = zmapWindowContainerCanvasItemGetContainer(feature_item)))
-    {
-      container = (ZMapWindowContainerFeatureSet)feature_set_container;
-
-      g_value_set_uint(value, zmapWindowContainerFeatureSetGetStrand(container)) ;
-    }
-  else
-    {
-      zMapLogWarning("%s", "Failed to get Parent Contianer.");
-    }
+  g_value_set_uint(value, add_data->set_strand) ;
 
   return ;
 }
@@ -1670,62 +1672,85 @@ static void feature_item_data_strand_to_value(GValue *value, gpointer feature_it
 static void feature_item_data_frame_to_value(GValue *value, gpointer feature_item_data)
 {
   AddSimpleDataFeatureItem add_data = (AddSimpleDataFeatureItem)feature_item_data;
-  FooCanvasItem *feature_item = FOO_CANVAS_ITEM(add_data->item);
-  ZMapWindowContainerGroup feature_set_container;
-  ZMapWindowContainerFeatureSet container;
 
-  if((feature_set_container = zmapWindowContainerCanvasItemGetContainer(feature_item)))
-    {
-      container = (ZMapWindowContainerFeatureSet)feature_set_container;
-
-      g_value_set_uint(value, zmapWindowContainerFeatureSetGetFrame(container)) ;
-    }
-  else
-    {
-      zMapLogWarning("%s", "Failed to get Parent Contianer.");
-    }
+  g_value_set_uint(value, add_data->set_frame) ;
 
   return ;
 }
 
+/* The lookup data belongs to the row so there's nothing for the caller to free. */
 static void feature_pointer_serialised_to_value (GValue *value, gpointer feature_item_data)
 {
-  AddSimpleDataFeature add_data = (AddSimpleDataFeature)feature_item_data;
-  ZMapFeatureAny        feature = add_data->feature;
-  SerialisedFeatureSearch feature_data = NULL;
+  AddSimpleDataFeatureItem add_data = (AddSimpleDataFeatureItem)feature_item_data;
 
-  if((feature_data = g_new0(SerialisedFeatureSearchStruct, 1)))
+  g_value_set_pointer(value, &(add_data->lookup));
+
+  return ;
+}
+
+/* Make the data for a row, the strand/frame of the parent container and the ids we'll need to
+ * find the item again are looked up here, once, rather than for every value fetch. */
+static AddSimpleDataFeatureItem feature_item_row_create(ZMapWindowFeatureItemList zmap_tv,
+                                                        ZMapFeatureAny feature,
+                                                        FooCanvasItem *item)
+{
+  AddSimpleDataFeatureItem add_data;
+  SerialisedFeatureSearch feature_data;
+  ZMapWindowContainerGroup feature_set_container;
+
+  add_data = g_new0(AddSimpleDataFeatureItemStruct, 1);
+
+  add_data->feature = feature;
+  add_data->item    = item;
+
+  if(zmap_tv->window && zmap_tv->window->display_forward_coords)
+    add_data->window = zmap_tv->window;
+
+  feature_data = &(add_data->lookup);
+  feature_data->feature_id = feature->unique_id;
+
+  if(feature->parent)
     {
-      feature_data->feature_id = feature->unique_id;
+      ZMapFeatureSet fset = (ZMapFeatureSet) feature->parent;
 
-      if(feature->parent)
-      {
-        ZMapFeatureSet fset = (ZMapFeatureSet) feature->parent;
-
-        feature_data->set_id = fset->unique_id;
-/*        feature_data->set_id = feature->parent->unique_id;*/
-        if(feature->parent->parent)
-          {
-            feature_data->block_id = feature->parent->parent->unique_id;
-            if(feature->parent->parent->parent)
+      feature_data->set_id = fset->unique_id;
+      if(feature->parent->parent)
+        {
+          feature_data->block_id = feature->parent->parent->unique_id;
+          if(feature->parent->parent->parent)
             {
               feature_data->align_id = feature->parent->parent->parent->unique_id;
             }
-          }
-      }
-#ifdef DEBUG_FREE_DATA
-      zMapShowMsg(ZMAP_MSG_INFORMATION,
-              "creating a data struct for feature %s",
-              g_quark_to_string(feature_data->feature_id));
-#endif /* DEBUG_FREE_DATA */
-      /* Someone needs to free this! done in free_serialised_data_cb */
-      g_value_set_pointer(value, feature_data);
+        }
+    }
+
+  if((feature_set_container = zmapWindowContainerCanvasItemGetContainer(item)))
+    {
+      ZMapWindowContainerFeatureSet container = (ZMapWindowContainerFeatureSet)feature_set_container;
+
+      add_data->set_strand = zmapWindowContainerFeatureSetGetStrand(container);
+      add_data->set_frame  = zmapWindowContainerFeatureSetGetFrame(container);
     }
   else
     {
-      zMapShowMsg(ZMAP_MSG_INFORMATION, "%s", "Failed creating cache data");
+      zMapLogWarning("%s", "Failed to get Parent Contianer.");
     }
 
+  return add_data;
+}
+
+static void feature_item_row_free(gpointer user_data)
+{
+  AddSimpleDataFeatureItem add_data = (AddSimpleDataFeatureItem)user_data;
+
+#ifdef DEBUG_FREE_DATA
+  zMapShowMsg(ZMAP_MSG_INFORMATION,
+            "Freeing data for feature %s",
+            g_quark_to_string(add_data->lookup.feature_id));
+#endif /* DEBUG_FREE_DATA */
+
+  g_free(add_data);
+
   return ;
 }
 
@@ -1778,25 +1803,13 @@ static gboolean update_foreach_cb(GtkTreeModel *model,
    * feature.  Failure though means we remove the tuple. */
   if(item)
     {
-      AddSimpleDataFeatureItemStruct add_simple = { NULL };
       ZMapFeatureAny feature = NULL;
 
       feature = zmapWindowItemGetFeatureAny(item);
 
-      add_simple.feature = feature;
-      add_simple.item    = item;
-
-      if(full_data->feature_list->window &&
-       full_data->feature_list->window->display_forward_coords == TRUE)
-      add_simple.window = full_data->feature_list->window;
-
-      /* We need to free this data here as it got allocated earlier
-       * and will be allocated again (from the feature) as a result
-       * of the update */
-
-      free_serialised_data_cb(feature_data);
-
-      zMapGUITreeViewUpdateTuple(ZMAP_GUITREEVIEW(full_data->feature_list), iter, &add_simple);
+      /* The old row data, which feature_data points into, is freed by the update. */
+      zMapGUITreeViewUpdateTuple(ZMAP_GUITREEVIEW(full_data->feature_list), iter,
+                                 feature_item_row_create(full_data->feature_list, feature, item));
     }
   else
     {
@@ -1819,21 +1832,6 @@ static gboolean update_foreach_cb(GtkTreeModel *model,
   return result;
 }
 
-static void free_serialised_data_cb(gpointer user_data)
-{
-  SerialisedFeatureSearch feature_data = (SerialisedFeatureSearch)user_data;
-
-#ifdef DEBUG_FREE_DATA
-  zMapShowMsg(ZMAP_MSG_INFORMATION,
-            "Freeing data for feature %s",
-            g_quark_to_string(feature_data->feature_id));
-#endif /* DEBUG_FREE_DATA */
-
-  g_free(feature_data);
-
-  return ;
-}
-
 static void invoke_tuple_remove(gpointer list_data, gpointer user_data)
 {
   ModelForeach full_data = (ModelForeach)user_data;
@@ -1847,17 +1845,9 @@ static void invoke_tuple_remove(gpointer list_data, gpointer user_data)
 
       model = full_data->model;
 
+      /* The row data is freed by the model. */
       if(gtk_tree_model_get_iter(model, &iter, path))
-      {
-        SerialisedFeatureSearch feature_data;
-
-        /* We need to free this data here, as ait got allocated earlier */
-        if(fetch_lookup_data(full_data->feature_list, model, &iter,
-                         &feature_data, NULL, NULL))
-          free_serialised_data_cb(feature_data);
-
-        gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
-      }
+        zMapGUITreeViewRemoveTuple(ZMAP_GUITREEVIEW(full_data->feature_list), &iter);
 
       /* free path??? */
     }
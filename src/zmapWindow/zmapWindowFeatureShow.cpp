@@ -387,7 +387,7 @@ void zmapWindowFeatureShow(ZMapWindow window, FooCanvasItem *item, const gboolea
       /* Look for a reusable window, if we find one then that gets used. */
       show = findReusableShow(window->feature_show_windows, editable) ;
 
-      feature_name = (char *)g_quark_to_string(feature->original_id) ;
+      feature_name = (char *)zMapFeatureIDToString(feature->original_id) ;
 
       title = g_strdup(feature_name) ;
 
@@ -617,7 +617,7 @@ static void showFeature(ZMapWindowFeatureShow show, ZMapGuiNotebook extras_noteb
   char *feature_name ;
   GtkWidget *notebook_widg ;
 
-  feature_name = (char *)g_quark_to_string(show->feature->original_id) ;
+  feature_name = (char *)zMapFeatureIDToString(show->feature->original_id) ;
 
   /* Make the notebook. */
   show->feature_book = createFeatureBook(show, feature_name, show->feature, show->item, extras_notebook) ;
@@ -816,7 +816,7 @@ static ZMapGuiNotebook createFeatureBook(ZMapWindowFeatureShow show, char *name,
       if (show->zmapWindow->int_values[ZMAPINT_SCRATCH_ATTRIBUTE_FEATURE])
         feature_name = g_strdup(g_quark_to_string(show->zmapWindow->int_values[ZMAPINT_SCRATCH_ATTRIBUTE_FEATURE])) ;
       else
-        feature_name = g_strdup(g_quark_to_string(feature->original_id)) ;
+        feature_name = g_strdup(zMapFeatureIDToString(feature->original_id)) ;
 
       zMapGUINotebookCreateTagValue(paragraph, "Feature Name", NULL,
                                     ZMAPGUI_NOTEBOOK_TAGVALUE_SIMPLE,
@@ -2833,7 +2833,7 @@ static void saveChapter(ZMapGuiNotebookChapter chapter, ChapterFeature chapter_f
 
               /* Update the feature ID because the coords may have changed */
               feature->unique_id = zMapFeatureCreateID(feature->mode,
-                                                       (char *)g_quark_to_string(feature->original_id),
+                                                       (char *)zMapFeatureIDToString(feature->original_id),
                                                        feature->strand,
                                                        feature->x1,
                                                        feature->x2,
@@ -403,7 +403,7 @@ void zMapWindowFocusDump(char *str)
               if(!z->feature)
                 name = "canvas item";
               else
-                name = g_quark_to_string(z->feature->unique_id);
+                name = zMapFeatureIDToString(z->feature->unique_id);
             }
           else if (ZMAP_IS_CONTAINER_GROUP(hot))
             {
@@ -411,7 +411,7 @@ void zMapWindowFocusDump(char *str)
               if(!g->feature_any)
                 name = "group";
               else
-                name = g_quark_to_string(g->feature_any->unique_id);
+                name = zMapFeatureIDToString(g->feature_any->unique_id);
               level = (int) g->level;
 
             }
@@ -450,7 +450,7 @@ void zMapWindowFocusDump(char *str)
           if(!z->feature)
             name = "canvas item";
           else
-            name = g_quark_to_string(z->feature->unique_id);
+            name = zMapFeatureIDToString(z->feature->unique_id);
           level = 0;
         }
       else if (ZMAP_IS_CONTAINER_GROUP(hot))
@@ -459,7 +459,7 @@ void zMapWindowFocusDump(char *str)
           if(!g->feature_any)
             name = "group";
           else
-            name = g_quark_to_string(g->feature_any->unique_id);
+            name = zMapFeatureIDToString(g->feature_any->unique_id);
           level = (int) g->level;
 
         }
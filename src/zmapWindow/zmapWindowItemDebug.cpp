@@ -112,7 +112,7 @@ void zmapWindowItemDebugItemToString(GString *string_arg, FooCanvasItem *item)
       ZMapFeatureAny feature_any;
 
       feature_any = zmapWindowItemGetFeatureAny(item);
-      g_string_append_printf(string_arg, " \"%s\"", (char *)g_quark_to_string(feature_any->unique_id));
+      g_string_append_printf(string_arg, " \"%s\"", (char *)zMapFeatureIDToString(feature_any->unique_id));
     }
 
   if (is_container)
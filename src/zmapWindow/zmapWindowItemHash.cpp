@@ -34,6 +34,7 @@
 
 #include <ZMap/zmap.hpp>
 
+#include <stdlib.h>
 #include <string.h>
 #include <ZMap/zmapUtils.hpp>
 #include <ZMap/zmapFeature.hpp>
@@ -109,6 +110,31 @@ typedef struct ItemSearchStruct_
 
 
 
+/* Index of the feature ids in one column set so that wildcard searches of the set do not have
+ * to match every id in the set's hash table. Ids added while drawing are kept in an unsorted
+ * pending array and merged into the sorted array at the next search, removed ids are only
+ * noted and are squeezed out of the sorted array once there are enough of them. */
+typedef struct
+{
+  const char *name ;                                        /* Quark string, never freed. */
+  GQuark id ;
+} NameIndexEntryStruct, *NameIndexEntry ;
+
+typedef struct ZMapWindowFToINameIndexStructType
+{
+  GArray *sorted ;                                          /* NameIndexEntryStruct by name. */
+  GArray *pending ;                                         /* Added since the last search. */
+
+  GHashTable *removed ;                                     /* ids removed but still in sorted. */
+
+  /* Trigram -> GArray of ids, only built when a search has no literal prefix, i.e. is a
+   * substring search such as "*abc*". */
+  GHashTable *trigrams ;
+
+} ZMapWindowFToINameIndexStruct ;
+
+
+
 typedef struct
 {
   ItemSearch curr_search ;                                    /* Current search params. */
@@ -123,7 +149,8 @@ typedef struct
 
 
 static void destroyIDHash(gpointer data) ;
-static void doHashSet(GHashTable *hash_table, GList *search, GList **result) ;
+static void doHashSet(GHashTable *hash_table, ZMapWindowFToINameIndex name_index,
+                      GList *search, GList **result) ;
 static void searchItemHash(gpointer key, gpointer value, gpointer user_data) ;
 static void addItem(gpointer key, gpointer value, gpointer user_data) ;
 static GQuark rootCanvasID(void);
@@ -140,6 +167,18 @@ static GQuark makeSetIDFromStr(GQuark set_id, ZMapStrand strand, GQuark frame_id
 static GQuark feature_same_name_id(ZMapFeature feature);
 static void print_search_data(ZMapWindowFToISetSearchData search_data);
 
+static ZMapWindowFToINameIndex nameIndexCreate(void) ;
+static void nameIndexAdd(ZMapWindowFToINameIndex name_index, GQuark id) ;
+static void nameIndexRemove(ZMapWindowFToINameIndex name_index, GQuark id) ;
+static void nameIndexClear(ZMapWindowFToINameIndex name_index) ;
+static GList *nameIndexFind(ZMapWindowFToINameIndex name_index, const char *pattern) ;
+static void nameIndexDestroy(ZMapWindowFToINameIndex name_index) ;
+static void nameIndexUpdate(ZMapWindowFToINameIndex name_index) ;
+static void nameIndexAddTrigrams(ZMapWindowFToINameIndex name_index, const char *name, GQuark id) ;
+static GArray *nameIndexFindTrigrams(ZMapWindowFToINameIndex name_index, const char *pattern) ;
+static int nameIndexCompareCB(const void *a, const void *b) ;
+static void freeTrigramCB(gpointer data) ;
+
 
 static gboolean window_ftoi_debug_G = FALSE;
 
@@ -349,6 +388,7 @@ gboolean zmapWindowFToIAddSet(GHashTable *feature_context_to_item,
           iset = g_new0(ID2CanvasStruct, 1) ;
           iset->item = set_item ;
           iset->hash_table = g_hash_table_new_full(NULL, NULL, NULL, destroyIDHash) ;
+          iset->name_index = nameIndexCreate() ;
           iset->feature_any = item_feature ;
 
           g_hash_table_insert(block->hash_table, GUINT_TO_POINTER(set_id), iset) ;
@@ -382,6 +422,7 @@ gboolean zmapWindowFToIRemoveSet(GHashTable *feature_context_to_item,
       if(remove_features)
         {
           g_hash_table_remove_all(iset->hash_table);
+          nameIndexClear(iset->name_index) ;
           result = TRUE;
         }
       else
@@ -397,12 +438,12 @@ gboolean zmapWindowFToIRemoveSet(GHashTable *feature_context_to_item,
 
 
 
-/* return the hash table for a set to allow repeated inserts more quickly */
-GHashTable *zmapWindowFToIGetSetHash(GHashTable *feature_context_to_item,
-                                  GQuark align_id, GQuark block_id,
-                                  GQuark set_id, ZMapStrand set_strand, ZMapFrame set_frame)
+/* return the set to allow repeated inserts more quickly */
+ID2Canvas zmapWindowFToIGetSet(GHashTable *feature_context_to_item,
+                               GQuark align_id, GQuark block_id,
+                               GQuark set_id, ZMapStrand set_strand, ZMapFrame set_frame)
 {
-  GHashTable *hash_table = NULL ;
+  ID2Canvas result = NULL ;
   ID2Canvas align = NULL ;
   ID2Canvas block = NULL ;
   ID2Canvas iset = NULL ;
@@ -418,15 +459,15 @@ GHashTable *zmapWindowFToIGetSetHash(GHashTable *feature_context_to_item,
       && (iset = (ID2Canvas)g_hash_table_lookup(block->hash_table,
                                                    GUINT_TO_POINTER(tmp_set_id))))
     {
-      hash_table = iset->hash_table ;
+      result = iset ;
     }
 
-  return hash_table ;
+  return result ;
 }
 
 
 
-gboolean zmapWindowFToIAddSetFeature(GHashTable *iset,        GQuark feature_id, FooCanvasItem *feature_item, ZMapFeature feature)
+gboolean zmapWindowFToIAddSetFeature(ID2Canvas iset, GQuark feature_id, FooCanvasItem *feature_item, ZMapFeature feature)
 {
   ID2Canvas ID2C = NULL ;
   /* mh17: changed insert to replace to allow bumping of compressed features
@@ -446,11 +487,13 @@ gboolean zmapWindowFToIAddSetFeature(GHashTable *iset,        GQuark feature_id,
       g_hash_table_insert(set->hash_table, GUINT_TO_POINTER(feature_id), ID2C) ;
     }
 #else
-  ID2C = (ID2Canvas)g_hash_table_lookup(iset, GUINT_TO_POINTER(feature_id));
+  ID2C = (ID2Canvas)g_hash_table_lookup(iset->hash_table, GUINT_TO_POINTER(feature_id));
   if(!ID2C)
     {
       ID2C = g_new0(ID2CanvasStruct, 1) ;
-      g_hash_table_insert(iset, GUINT_TO_POINTER(feature_id), ID2C) ;
+      g_hash_table_insert(iset->hash_table, GUINT_TO_POINTER(feature_id), ID2C) ;
+
+      nameIndexAdd(iset->name_index, feature_id) ;
     }
 
   ID2C->item = feature_item ;
@@ -474,7 +517,7 @@ gboolean zmapWindowFToIAddFeature(GHashTable *feature_context_to_item,
                                   FooCanvasItem *feature_item, ZMapFeature feature)
 {
   gboolean result = FALSE ;
-  GHashTable *hset = NULL ;
+  ID2Canvas iset = NULL ;
 
 
   if(window_ftoi_debug_G)
@@ -483,9 +526,9 @@ gboolean zmapWindowFToIAddFeature(GHashTable *feature_context_to_item,
       printHashKeys(align_id, block_id, set_id, feature_id);
     }
 
-  if((hset = zmapWindowFToIGetSetHash(feature_context_to_item, align_id, block_id, set_id, set_strand, set_frame)))
+  if((iset = zmapWindowFToIGetSet(feature_context_to_item, align_id, block_id, set_id, set_strand, set_frame)))
     {
-        result = zmapWindowFToIAddSetFeature(hset,        feature_id, feature_item, feature);
+        result = zmapWindowFToIAddSetFeature(iset, feature_id, feature_item, feature);
     }
   return result ;
 }
@@ -535,6 +578,8 @@ gboolean zmapWindowFToIRemoveFeature(GHashTable *feature_context_to_item,
                                                    GUINT_TO_POINTER(feature_id))))
     {
       result = g_hash_table_remove(iset->hash_table, GUINT_TO_POINTER(feature_id)) ;
+
+      nameIndexRemove(iset->name_index, feature_id) ;
     }
 
   return result ;
@@ -950,7 +995,7 @@ GList *zmapWindowFToIFindItemSetFull(ZMapWindow window,GHashTable *feature_conte
       search = g_list_append(search, &terminal_search) ;            /* Terminal stop. */
 
       /* Now do the recursive search */
-      doHashSet(feature_context_to_item, search, &result) ;
+      doHashSet(feature_context_to_item, NULL, search, &result) ;
 
       g_list_free(search) ;
       search = NULL ;
@@ -969,7 +1014,7 @@ GList *zmapWindowFToIFindItemSetFull(ZMapWindow window,GHashTable *feature_conte
       search = g_list_append(search, &terminal_search) ;            /* Terminal stop. */
 
       /* Now do the recursive search */
-      doHashSet(feature_context_to_item, search, &result) ;
+      doHashSet(feature_context_to_item, NULL, search, &result) ;
 
       g_list_free(search) ;
       search = NULL ;
@@ -1165,7 +1210,7 @@ GList *zmapWindowFToISetSearchPerform(ZMapWindow window,GHashTable *feature_cont
            g_quark_to_string(search_data->set_id),
            search_data->strand_str,
            search_data->frame_str,
-           g_quark_to_string(search_data->feature_id)) ;
+           zMapFeatureIDToString(search_data->feature_id)) ;
 
 
   if(search_data->search_function == zmapWindowFToIFindItemSetFull
@@ -1305,6 +1350,9 @@ static void destroyIDHash(gpointer data)
   if(id->hash_table)            /* Feature ID2Canvas don't need hash_tables... */
     g_hash_table_destroy(id->hash_table) ;
 
+  if (id->name_index)
+    nameIndexDestroy(id->name_index) ;
+
 #ifdef RDS_DEBUG_ITEM_IN_HASH_DESTROY
   printf("     |--- destroyIDHash (%x): freeing id2canvas\n", id->item);
 #endif /* RDS_DEBUG_ITEM_IN_HASH_DESTROY */
@@ -1329,8 +1377,11 @@ static void destroyIDHash(gpointer data)
  * Note the common pattern in the "stop" and "continue" sections below of either
  * operating on all items in the current hash table or just the requested item in
  * current hash.
+ *
+ * name_index is the index of hash_table's keys if it has one (only sets do).
  *  */
-static void doHashSet(GHashTable *hash_table, GList *search, GList **results_inout)
+static void doHashSet(GHashTable *hash_table, ZMapWindowFToINameIndex name_index,
+                      GList *search, GList **results_inout)
 {
   ItemSearch curr_search, next_search ;
   GQuark curr_search_id, next_search_id ;
@@ -1373,6 +1424,25 @@ printf("cur_search id = %s (%d) ... %s, %d\n", g_quark_to_string(curr_search_id)
 #endif
         }
         }
+      else if (curr_search_id != wild_card && curr_search->is_reg_exp && name_index)
+        {
+          /* Only look at the ids the index says match rather than every item in the hash. */
+          GList *ids, *curr ;
+          GList *found = NULL ;
+
+          ids = nameIndexFind(name_index, g_quark_to_string(curr_search_id)) ;
+
+          for (curr = ids ; curr ; curr = g_list_next(curr))
+            {
+              if ((item_id = (ID2Canvas)g_hash_table_lookup(hash_table, curr->data))
+                  && (!curr_search->pred_func || curr_search->pred_func(item_id->feature_any, curr_search->user_data)))
+                found = g_list_prepend(found, item_id) ;
+            }
+
+          g_list_free(ids) ;
+
+          results = g_list_concat(results, g_list_reverse(found)) ;
+        }
       else if (curr_search_id == wild_card || curr_search->is_reg_exp)
         {
           curr_search->results = &results ;
@@ -1412,7 +1482,7 @@ printf("do hash set list %s ,reg = %d\n",g_quark_to_string(curr_search->search_q
 
               if ((item_id = (ID2Canvas)g_hash_table_lookup(hash_table,l->data)))
                 {
-                  doHashSet(item_id->hash_table, search_data.search, search_data.results) ;
+                  doHashSet(item_id->hash_table, item_id->name_index, search_data.search, search_data.results) ;
                 }
               else if(curr_search->is_reg_exp)
                 {
@@ -1426,7 +1496,7 @@ printf("do hash set list %s ,reg = %d\n",g_quark_to_string(curr_search->search_q
       else if ((item_id = (ID2Canvas)g_hash_table_lookup(hash_table,
                                                     GUINT_TO_POINTER(curr_search_id))))
         {
-          doHashSet(item_id->hash_table, search_data.search, search_data.results) ;
+          doHashSet(item_id->hash_table, item_id->name_index, search_data.search, search_data.results) ;
         }
       else if (curr_search_id == wild_card || curr_search->is_reg_exp)
         {
@@ -1459,13 +1529,13 @@ static void addItem(gpointer key, gpointer value, gpointer user_data)
       *results = g_list_append(*results, hash_item); // ->item) ;
 
 #if MH17_SEARCH_DEBUG
-      printf("added: %d %s, %s %p\n",curr_search->is_reg_exp, g_quark_to_string(curr_search->search_quark), g_quark_to_string(GPOINTER_TO_UINT(key)),hash_item->item);
+      printf("added: %d %s, %s %p\n",curr_search->is_reg_exp, g_quark_to_string(curr_search->search_quark), zMapFeatureIDToString(GPOINTER_TO_UINT(key)),hash_item->item);
 #endif
   }
 #if MH17_SEARCH_DEBUG
   else
   {
-      printf("filtered: %d %s, %s\n",curr_search->is_reg_exp, g_quark_to_string(curr_search->search_quark), g_quark_to_string(GPOINTER_TO_UINT(key)));
+      printf("filtered: %d %s, %s\n",curr_search->is_reg_exp, g_quark_to_string(curr_search->search_quark), zMapFeatureIDToString(GPOINTER_TO_UINT(key)));
   }
 #endif
   return ;
@@ -1482,9 +1552,9 @@ static void searchItemHash(gpointer key, gpointer value, gpointer user_data)
       || filterOnRegExp(search->curr_search, key))
     {
 #if MH17_SEARCH_DEBUG
-      printf("do hash set %s\n",g_quark_to_string(GPOINTER_TO_UINT(key)));
+      printf("do hash set %s\n",zMapFeatureIDToString(GPOINTER_TO_UINT(key)));
 #endif
-      doHashSet(hash_item->hash_table, search->search, search->results) ;
+      doHashSet(hash_item->hash_table, hash_item->name_index, search->search, search->results) ;
     }
 
   return ;
@@ -1528,7 +1598,7 @@ static void printGlist(gpointer data, gpointer user_data)
   if (window_ftoi_debug_G)
     printf("%s:  %s\n",
            (feature_type ? feature_type : "<no feature data attached>"),
-           (feature_id ? g_quark_to_string(feature_id) : "")) ;
+           (feature_id ? zMapFeatureIDToString(feature_id) : "")) ;
 
   return ;
 }
@@ -1559,12 +1629,13 @@ gboolean filterOnRegExp(ItemSearch curr_search, gpointer user_data)
   char *pattern, *key_string ;
   GQuark key_id = GPOINTER_TO_INT(user_data) ;
 
-  key_string = (char *)g_quark_to_string(key_id) ;
+  /* Feature keys may be ids local to their featureset. */
+  key_string = (char *)zMapFeatureIDToString(key_id) ;
 
   pattern = (char *)g_quark_to_string(curr_search->search_quark) ;
 
   /* Compare pattern to hash key string, _not_ features unique_id string. */
-  if (g_pattern_match_simple(pattern, key_string))
+  if (key_string && g_pattern_match_simple(pattern, key_string))
     result = TRUE ;
 
   return result ;
@@ -1633,7 +1704,7 @@ static GQuark feature_same_name_id(ZMapFeature feature)
        * unique ids are constructed as original-id_stuff
        * so by adding an _ we get unique original id's
        */
-  g_string_append_printf(reg_ex_name, "%s_*", (char *)g_quark_to_string(feature->original_id)) ;
+  g_string_append_printf(reg_ex_name, "%s_*", (char *)zMapFeatureIDToString(feature->original_id)) ;
 
   reg_ex_name    = g_string_ascii_down(reg_ex_name) ;
   reg_ex_name_id = g_quark_from_string(reg_ex_name->str) ;
@@ -1662,7 +1733,7 @@ static void print_search_data(ZMapWindowFToISetSearchData search_data)
 
   printf("  set_id: '%s'\n", (search_data->set_id ? g_quark_to_string(search_data->set_id) : "0"));
 
-  printf("  feature_id: '%s'\n", (search_data->feature_id ? g_quark_to_string(search_data->feature_id) : "0"));
+  printf("  feature_id: '%s'\n", (search_data->feature_id ? zMapFeatureIDToString(search_data->feature_id) : "0"));
 
   printf("  strand: '%s'\n", (search_data->strand_str ? search_data->strand_str : "<unset>"));
 
@@ -1670,3 +1741,332 @@ static void print_search_data(ZMapWindowFToISetSearchData search_data)
 
   return ;
 }
+
+
+
+/*
+ *          Name index functions, see ZMapWindowFToINameIndexStruct.
+ */
+
+/* Packs the first three chars of a string into an int for use as a hash key. */
+#define NAME_INDEX_TRIGRAM(STR) \
+  ((((guint)(guchar)(STR)[0]) << 16) | (((guint)(guchar)(STR)[1]) << 8) | ((guint)(guchar)(STR)[2]))
+
+
+static ZMapWindowFToINameIndex nameIndexCreate(void)
+{
+  ZMapWindowFToINameIndex name_index ;
+
+  name_index = g_new0(ZMapWindowFToINameIndexStruct, 1) ;
+
+  name_index->sorted = g_array_new(FALSE, FALSE, sizeof(NameIndexEntryStruct)) ;
+  name_index->pending = g_array_new(FALSE, FALSE, sizeof(NameIndexEntryStruct)) ;
+  name_index->removed = g_hash_table_new(NULL, NULL) ;
+
+  return name_index ;
+}
+
+
+static void nameIndexAdd(ZMapWindowFToINameIndex name_index, GQuark id)
+{
+  /* If the id was removed and is now back then it's still in the index. */
+  if (!g_hash_table_remove(name_index->removed, GUINT_TO_POINTER(id)))
+    {
+      NameIndexEntryStruct entry ;
+
+      /* Feature ids may be local to their featureset (e.g. collapsed reads from GFF3), an id
+       * that no longer has a string can't be searched for so is left out. */
+      if ((entry.name = zMapFeatureIDToString(id)))
+        {
+          entry.id = id ;
+
+          g_array_append_val(name_index->pending, entry) ;
+
+          if (name_index->trigrams)
+            nameIndexAddTrigrams(name_index, entry.name, id) ;
+        }
+    }
+
+  return ;
+}
+
+
+static void nameIndexRemove(ZMapWindowFToINameIndex name_index, GQuark id)
+{
+  g_hash_table_insert(name_index->removed, GUINT_TO_POINTER(id), GUINT_TO_POINTER(id)) ;
+
+  return ;
+}
+
+
+static void nameIndexClear(ZMapWindowFToINameIndex name_index)
+{
+  g_array_set_size(name_index->sorted, 0) ;
+  g_array_set_size(name_index->pending, 0) ;
+  g_hash_table_remove_all(name_index->removed) ;
+
+  if (name_index->trigrams)
+    {
+      g_hash_table_destroy(name_index->trigrams) ;
+      name_index->trigrams = NULL ;
+    }
+
+  return ;
+}
+
+
+static void nameIndexDestroy(ZMapWindowFToINameIndex name_index)
+{
+  nameIndexClear(name_index) ;
+
+  g_array_free(name_index->sorted, TRUE) ;
+  g_array_free(name_index->pending, TRUE) ;
+  g_hash_table_destroy(name_index->removed) ;
+
+  g_free(name_index) ;
+
+  return ;
+}
+
+
+/* Returns a list of the ids in the index that match the glob style pattern.
+ *
+ * If the pattern starts with a literal prefix only the range of ids with that prefix is
+ * looked at (found by binary search), otherwise if the pattern has a literal run of at
+ * least three chars only the ids containing its rarest trigram are looked at, otherwise
+ * we have to look at all the ids. */
+static GList *nameIndexFind(ZMapWindowFToINameIndex name_index, const char *pattern)
+{
+  GList *ids = NULL ;
+  GPatternSpec *pattern_spec ;
+  NameIndexEntry entries ;
+  gboolean check_removed ;
+  GArray *candidates = NULL ;
+  size_t prefix_len ;
+  guint i ;
+
+  nameIndexUpdate(name_index) ;
+
+  entries = (NameIndexEntry)(name_index->sorted->data) ;
+  check_removed = (g_hash_table_size(name_index->removed) > 0) ;
+
+  pattern_spec = g_pattern_spec_new(pattern) ;
+
+  if ((prefix_len = strcspn(pattern, "*?")))
+    {
+      guint low = 0, high = name_index->sorted->len ;
+
+      while (low < high)
+        {
+          guint mid = low + ((high - low) / 2) ;
+
+          if (strncmp(entries[mid].name, pattern, prefix_len) < 0)
+            low = mid + 1 ;
+          else
+            high = mid ;
+        }
+
+      for (i = low ; i < name_index->sorted->len && strncmp(entries[i].name, pattern, prefix_len) == 0 ; i++)
+        {
+          if ((!check_removed || !g_hash_table_lookup(name_index->removed, GUINT_TO_POINTER(entries[i].id)))
+              && g_pattern_match_string(pattern_spec, entries[i].name))
+            ids = g_list_prepend(ids, GUINT_TO_POINTER(entries[i].id)) ;
+        }
+    }
+  else if ((candidates = nameIndexFindTrigrams(name_index, pattern)))
+    {
+      for (i = 0 ; i < candidates->len ; i++)
+        {
+          GQuark id = g_array_index(candidates, GQuark, i) ;
+          const char *name ;
+
+          if ((!check_removed || !g_hash_table_lookup(name_index->removed, GUINT_TO_POINTER(id)))
+              && (name = zMapFeatureIDToString(id))
+              && g_pattern_match_string(pattern_spec, name))
+            ids = g_list_prepend(ids, GUINT_TO_POINTER(id)) ;
+        }
+
+      g_array_free(candidates, TRUE) ;
+    }
+  else
+    {
+      for (i = 0 ; i < name_index->sorted->len ; i++)
+        {
+          if ((!check_removed || !g_hash_table_lookup(name_index->removed, GUINT_TO_POINTER(entries[i].id)))
+              && g_pattern_match_string(pattern_spec, entries[i].name))
+            ids = g_list_prepend(ids, GUINT_TO_POINTER(entries[i].id)) ;
+        }
+    }
+
+  g_pattern_spec_free(pattern_spec) ;
+
+  return g_list_reverse(ids) ;
+}
+
+
+/* Merge any ids added since the last search into the sorted array, squeezing out removed
+ * ids as we go. If nothing has been added we only bother to squeeze out removed ids once
+ * they are a sizeable fraction of the index. */
+static void nameIndexUpdate(ZMapWindowFToINameIndex name_index)
+{
+  guint num_removed ;
+
+  num_removed = g_hash_table_size(name_index->removed) ;
+
+  if (name_index->pending->len || num_removed > (name_index->sorted->len / 4))
+    {
+      GArray *merged ;
+      NameIndexEntry sorted, pending ;
+      guint num_sorted, num_pending ;
+      guint i = 0, j = 0 ;
+
+      num_sorted = name_index->sorted->len ;
+      num_pending = name_index->pending->len ;
+
+      qsort(name_index->pending->data, num_pending, sizeof(NameIndexEntryStruct), nameIndexCompareCB) ;
+
+      sorted = (NameIndexEntry)(name_index->sorted->data) ;
+      pending = (NameIndexEntry)(name_index->pending->data) ;
+
+      merged = g_array_sized_new(FALSE, FALSE, sizeof(NameIndexEntryStruct), (num_sorted + num_pending)) ;
+
+      while (i < num_sorted || j < num_pending)
+        {
+          NameIndexEntry next ;
+
+          if (j == num_pending || (i < num_sorted && strcmp(sorted[i].name, pending[j].name) <= 0))
+            next = &sorted[i++] ;
+          else
+            next = &pending[j++] ;
+
+          if (!num_removed || !g_hash_table_lookup(name_index->removed, GUINT_TO_POINTER(next->id)))
+            g_array_append_val(merged, *next) ;
+        }
+
+      g_array_free(name_index->sorted, TRUE) ;
+      name_index->sorted = merged ;
+      g_array_set_size(name_index->pending, 0) ;
+
+      /* The trigram lists may hold the removed ids so they must be rebuilt. */
+      if (num_removed)
+        {
+          g_hash_table_remove_all(name_index->removed) ;
+
+          if (name_index->trigrams)
+            {
+              g_hash_table_destroy(name_index->trigrams) ;
+              name_index->trigrams = NULL ;
+            }
+        }
+    }
+
+  return ;
+}
+
+
+static void nameIndexAddTrigrams(ZMapWindowFToINameIndex name_index, const char *name, GQuark id)
+{
+  size_t name_len ;
+  size_t i ;
+
+  name_len = strlen(name) ;
+
+  for (i = 0 ; i + 3 <= name_len ; i++)
+    {
+      gpointer trigram = GUINT_TO_POINTER(NAME_INDEX_TRIGRAM(name + i)) ;
+      GArray *ids ;
+
+      if (!(ids = (GArray *)g_hash_table_lookup(name_index->trigrams, trigram)))
+        {
+          ids = g_array_new(FALSE, FALSE, sizeof(GQuark)) ;
+          g_hash_table_insert(name_index->trigrams, trigram, ids) ;
+        }
+
+      /* A trigram may occur more than once in a name, only record the id once. */
+      if (!ids->len || g_array_index(ids, GQuark, (ids->len - 1)) != id)
+        g_array_append_val(ids, id) ;
+    }
+
+  return ;
+}
+
+
+/* Returns a copy of the list of ids containing the rarest trigram in the literal parts of
+ * pattern or NULL if pattern has no literal part of at least three chars. If the pattern has
+ * a trigram that no id contains then an empty array is returned. The trigram lists are built
+ * the first time they are needed and then kept up to date by nameIndexAdd(). */
+static GArray *nameIndexFindTrigrams(ZMapWindowFToINameIndex name_index, const char *pattern)
+{
+  GArray *candidates = NULL ;
+  GArray *rarest = NULL ;
+  gboolean usable = FALSE, no_match = FALSE ;
+  const char *run ;
+  size_t run_len ;
+  size_t i ;
+
+  for (run = pattern ; *run && !usable ; run += (run_len + (run[run_len] ? 1 : 0)))
+    {
+      if ((run_len = strcspn(run, "*?")) >= 3)
+        usable = TRUE ;
+    }
+
+  if (usable)
+    {
+      if (!(name_index->trigrams))
+        {
+          name_index->trigrams = g_hash_table_new_full(NULL, NULL, NULL, freeTrigramCB) ;
+
+          for (i = 0 ; i < name_index->sorted->len ; i++)
+            {
+              NameIndexEntry entry = &g_array_index(name_index->sorted, NameIndexEntryStruct, i) ;
+
+              nameIndexAddTrigrams(name_index, entry->name, entry->id) ;
+            }
+        }
+
+      for (run = pattern ; *run && !no_match ; run += (run_len + (run[run_len] ? 1 : 0)))
+        {
+          run_len = strcspn(run, "*?") ;
+
+          for (i = 0 ; i + 3 <= run_len ; i++)
+            {
+              GArray *ids ;
+
+              if (!(ids = (GArray *)g_hash_table_lookup(name_index->trigrams,
+                                                         GUINT_TO_POINTER(NAME_INDEX_TRIGRAM(run + i)))))
+                {
+                  no_match = TRUE ;
+                  break ;
+                }
+              else if (!rarest || ids->len < rarest->len)
+                {
+                  rarest = ids ;
+                }
+            }
+        }
+
+      candidates = g_array_new(FALSE, FALSE, sizeof(GQuark)) ;
+
+      if (!no_match && rarest)
+        g_array_append_vals(candidates, rarest->data, rarest->len) ;
+    }
+
+  return candidates ;
+}
+
+
+/* qsort() callback to order index entries by name. */
+static int nameIndexCompareCB(const void *a, const void *b)
+{
+  NameIndexEntry entry_a = (NameIndexEntry)a, entry_b = (NameIndexEntry)b ;
+
+  return strcmp(entry_a->name, entry_b->name) ;
+}
+
+
+static void freeTrigramCB(gpointer data)
+{
+  g_array_free((GArray *)data, TRUE) ;
+
+  return ;
+}
@@ -1332,7 +1332,7 @@ static void itemMenuCB(int menu_item_id, gpointer callback_data)
 
       break ;
     case ITEM_MENU_PFETCH:
-      zmapWindowPfetchEntry(menu_data->window, (char *)g_quark_to_string(feature->original_id)) ;
+      zmapWindowPfetchEntry(menu_data->window, (char *)zMapFeatureIDToString(feature->original_id)) ;
       break ;
 
     case ITEM_MENU_SEQUENCE_SEARCH_DNA:
@@ -1758,8 +1758,8 @@ gint style_menu_sort(gconstpointer a, gconstpointer b, gpointer data)
       return 1;
     }
 
-  na = g_quark_to_string(sa->unique_id);
-  nb = g_quark_to_string(sb->unique_id);
+  na = zMapFeatureIDToString(sa->unique_id);
+  nb = zMapFeatureIDToString(sb->unique_id);
 
   return strcmp(na,nb);
 }
@@ -2144,7 +2144,7 @@ static void dnaMenuCB(int menu_item_id, gpointer callback_data)
   if (feature->mode == ZMAPSTYLE_MODE_TRANSCRIPT)
     {
       molecule_type = "DNA" ;
-      gene_name = (char *)g_quark_to_string(feature->original_id) ;
+      gene_name = (char *)zMapFeatureIDToString(feature->original_id) ;
     }
 
   if (menu_item_id == ZMAPCHOOSERANGE || menu_item_id == ZMAPCHOOSERANGE_FILE)
@@ -2290,7 +2290,7 @@ static void peptideMenuCB(int menu_item_id, gpointer callback_data)
     }
 
   molecule_type = "Protein" ;
-  gene_name = (char *)g_quark_to_string(feature->original_id) ;
+  gene_name = (char *)zMapFeatureIDToString(feature->original_id) ;
 
   if ((dna = zMapFeatureGetTranscriptDNA(feature, spliced, cds)))
     {
@@ -2909,7 +2909,7 @@ static void developerMenuCB(int menu_item_id, gpointer callback_data)
 
             msg_text = g_strdup_printf("\n%s\n", feature_text) ;
 
-            zMapGUIShowText((char *)g_quark_to_string(feature->original_id), feature_text, FALSE) ;
+            zMapGUIShowText((char *)zMapFeatureIDToString(feature->original_id), feature_text, FALSE) ;
 
             g_free(msg_text) ;
             g_free(feature_text) ;
@@ -2942,7 +2942,7 @@ static void developerMenuCB(int menu_item_id, gpointer callback_data)
 
             msg_text = g_strdup_printf("\n%s\n%s\n", canvas_feature_text->str, feature_text) ;
 
-            zMapGUIShowText((char *)g_quark_to_string(feature->original_id), msg_text, FALSE) ;
+            zMapGUIShowText((char *)zMapFeatureIDToString(feature->original_id), msg_text, FALSE) ;
 
             g_free(msg_text) ;
             g_string_free(canvas_feature_text, TRUE) ;
@@ -2983,7 +2983,7 @@ static void developerMenuCB(int menu_item_id, gpointer callback_data)
 
             msg_text = g_strdup_printf("\n%s\n%s\n%s\n", canvas_featureset_text->str, canvas_feature_text->str, feature_text) ;
 
-            zMapGUIShowText((char *)g_quark_to_string(feature->original_id), msg_text, FALSE) ;
+            zMapGUIShowText((char *)zMapFeatureIDToString(feature->original_id), msg_text, FALSE) ;
 
             g_free(msg_text) ;
             g_free(feature_text) ;
@@ -4428,7 +4428,15 @@ static gboolean exportFeatures(ZMapWindow window,
         }
     }
 
-  if (ok &&
+  if (ok && filepath && zMapGFFIsBGZFFilename(filepath))
+    {
+      /* A ".gz" file gets sorted, bgzip'd GFF with a tabix index alongside it. */
+      if (zMapGFFDumpRegionBGZF(feature, window->context_map->styles, region_span, filepath, &tmp_error))
+        result = TRUE ;
+      else if (tmp_error)
+        g_propagate_error(error, tmp_error) ;
+    }
+  else if (ok &&
       (!filepath
        || !(file = g_io_channel_new_file(filepath, "w", &tmp_error))
        || !zMapGFFDumpRegion(feature, window->context_map->styles, region_span, file, &tmp_error)))
@@ -4699,7 +4707,7 @@ static ZMapFeatureContextExecuteStatus alignBlockMenusDataListForeach(GQuark key
       g_string_printf(item_name, "%s%sAlign %s",
                       (stem ? stem : ""),
                       (stem ? "/"  : ""),
-                      g_quark_to_string( feature_any->original_id ));
+                      zMapFeatureIDToString( feature_any->original_id ));
 
       item->name   = g_strdup(item_name->str); /* memory leak */
       item->type   = ZMAPGUI_MENU_BRANCH;
@@ -4726,7 +4734,7 @@ static ZMapFeatureContextExecuteStatus alignBlockMenusDataListForeach(GQuark key
                       (stem ? stem : ""),
                       (stem ? "/"  : ""),
                       g_quark_to_string( feature_any->parent->original_id ),
-                      g_quark_to_string( feature_any->original_id ));
+                      zMapFeatureIDToString( feature_any->original_id ));
 
       item->name   = g_strdup(item_name->str); /* memory leak */
       item->type   = ZMAPGUI_MENU_BRANCH;
@@ -66,12 +66,16 @@ typedef struct
 
 } NavigateDrawStruct, *NavigateDraw;
 
-typedef struct
+/* The navigator's own record of the features it draws for one of its featuresets. This is
+ * kept up to date from the merge and erase deltas so that drawing the navigator never has to
+ * look through the rest of the feature context, however many features have been loaded. */
+typedef struct NavigatorSummaryStructType
 {
-  double start, end;
-  ZMapStrand strand;
-  ZMapFeature feature;
-} LocusEntryStruct, *LocusEntry;
+  GQuark set_id ;                                           /* unique id of the featureset. */
+
+  GHashTable *entries ;                                     /* draw key -> GList of ZMapFeature, only
+                                                             * the first of these in a block is drawn. */
+} NavigatorSummaryStruct, *NavigatorSummary ;
 
 
 
@@ -118,12 +122,11 @@ static gboolean factoryItemHandler(FooCanvasItem       *new_item,
 
 
 
-static GHashTable *zmapWindowNavigatorLDHCreate(void);
-static LocusEntry zmapWindowNavigatorLDHFind(GHashTable *ghash, GQuark key);
-static LocusEntry zmapWindowNavigatorLDHInsert(GHashTable *ghash,
-                                               ZMapFeature feature);
-static void zmapWindowNavigatorLDHDestroy(GHashTable **destroy);
-static void destroyLocusEntry(gpointer data);
+static void summariesBuild(ZMapWindowNavigator navigate, ZMapFeatureContext context);
+static gboolean summariesUpdate(ZMapWindowNavigator navigate, ZMapFeatureContext context, gboolean add);
+static gboolean summaryUpdateSet(ZMapWindowNavigator navigate, GQuark set_id, ZMapFeatureSet feature_set, gboolean add);
+static void drawSummarySets(NavigateDraw draw_data);
+static void destroySummary(gpointer data);
 
 
 
@@ -133,7 +136,7 @@ static void default_locus_names_filter(GList **filter_out);
 
 
 
-static void navigatorRunSet(ZMapFeatureSet set, FooCanvasGroup *container, ZMapFrame frame,
+static void navigatorRunSet(NavigatorSummary summary, ZMapFeatureSet set, FooCanvasGroup *container, ZMapFrame frame,
                             ZMapWindowNavigator navigate);
 
 
@@ -220,7 +223,7 @@ ZMapWindowNavigator zMapWindowNavigatorCreate(GtkWidget *canvas_widget)
 
   navigate->ftoi_hash = zmapWindowFToICreate();
 
-  navigate->locus_display_hash = zmapWindowNavigatorLDHCreate();
+  navigate->summaries = g_hash_table_new_full(NULL, NULL, NULL, destroySummary);
 
   navigate->locus_id = g_quark_from_string("locus");
 
@@ -337,9 +340,7 @@ void zMapWindowNavigatorReset(ZMapWindowNavigator navigate)
   zmapWindowFToIDestroy(navigate->ftoi_hash);
   navigate->ftoi_hash = zmapWindowFToICreate();
 
-
-  zmapWindowNavigatorLDHDestroy(&(navigate->locus_display_hash));
-  navigate->locus_display_hash = zmapWindowNavigatorLDHCreate();
+  /* The summaries only reference features so they are kept for the redraw. */
 
   return ;
 }
@@ -398,9 +399,43 @@ void zMapWindowNavigatorMergeInFeatureSetNames(ZMapWindowNavigator navigate,
   navigator_sets = g_list_copy(navigator_sets);
   navigate->feature_set_names = g_list_concat(navigate->feature_set_names, navigator_sets);
 
+  /* There may be new sets to summarise, force a rebuild on the next draw. */
+  navigate->summary_context = NULL;
+
+  return ;
+}
+
+
+/* Update the summaries with the features just merged into full_context, these are the
+ * features in diff_context. Call this before zMapWindowNavigatorDrawFeatures() after a merge. */
+void zMapWindowNavigatorMergeFeatures(ZMapWindowNavigator navigate,
+                                      ZMapFeatureContext full_context, ZMapFeatureContext diff_context)
+{
+  if (!navigate || !full_context || !diff_context)
+    return ;
+
+  /* A first load gives a diff that is the whole context. */
+  if (navigate->summary_context != full_context || diff_context == full_context)
+    summariesBuild(navigate, full_context);
+  else
+    summariesUpdate(navigate, diff_context, TRUE);
+
   return ;
 }
 
+
+/* Remove features erased from the context, must be called before they are destroyed.
+ * Returns TRUE if any were drawn in the navigator, which then needs redrawing. */
+gboolean zMapWindowNavigatorRemoveFeatures(ZMapWindowNavigator navigate, ZMapFeatureContext diff_context)
+{
+  gboolean changed = FALSE;
+
+  if (navigate && diff_context && navigate->summary_context)
+    changed = summariesUpdate(navigate, diff_context, FALSE);
+
+  return changed;
+}
+
 /* draw features */
 void zMapWindowNavigatorDrawFeatures(ZMapWindowNavigator navigate,
                                      ZMapFeatureContext full_context,
@@ -414,6 +449,10 @@ void zMapWindowNavigatorDrawFeatures(ZMapWindowNavigator navigate,
   navigate->full_span.x1 = full_context->master_align->sequence_span.x1;
   navigate->full_span.x2 = full_context->master_align->sequence_span.x2 + 1.0;
 
+  /* Normally kept up to date by zMapWindowNavigatorMergeFeatures(). */
+  if (navigate->summary_context != full_context)
+    summariesBuild(navigate, full_context);
+
   canvas = fetchCanvas(navigate);
 
   if(!GTK_WIDGET_MAPPED(GTK_WIDGET(canvas)))
@@ -517,7 +556,7 @@ void zMapWindowNavigatorDestroy(ZMapWindowNavigator navigate)
 
   zmapWindowFToIDestroy(navigate->ftoi_hash);
 
-  zmapWindowNavigatorLDHDestroy(&(navigate->locus_display_hash));
+  g_hash_table_destroy(navigate->summaries);
 
   g_free(navigate);             /* possibly not enough ... */
 
@@ -596,9 +635,10 @@ static void navigateDrawFunc(NavigateDraw nav_draw, GtkWidget *widget)
 #endif
   foo_canvas_busy(navigate->canvas, TRUE);
 
-  /* Everything to get a context drawn, raised to top and visible. */
+  /* Everything to get a context drawn, raised to top and visible. The features come from
+   * the summaries, not the context, so no need to go below the blocks. */
   zMapFeatureContextExecuteComplete((ZMapFeatureAny)(nav_draw->context),
-                                    ZMAPFEATURE_STRUCT_FEATURE,
+                                    ZMAPFEATURE_STRUCT_BLOCK,
                                     drawContext,
                                     NULL, nav_draw);
 
@@ -642,7 +682,6 @@ static ZMapFeatureContextExecuteStatus drawContext(GQuark key_id,
   ZMapFeatureAny feature_any = (ZMapFeatureAny)data;
   NavigateDraw draw_data = (NavigateDraw)user_data;
   ZMapFeatureBlock     feature_block = NULL;
-  ZMapFeatureSet       feature_set   = NULL;
   ZMapFeatureLevelType feature_type = ZMAPFEATURE_STRUCT_INVALID;
   ZMapFeatureContextExecuteStatus status = ZMAP_CONTEXT_EXEC_STATUS_OK;
   ZMapWindowNavigator navigate = NULL;
@@ -754,52 +793,13 @@ static ZMapFeatureContextExecuteStatus drawContext(GQuark key_id,
 
         if(drawScaleRequired(draw_data))
           drawScale(draw_data);
-      }
-      break;
-    case ZMAPFEATURE_STRUCT_FEATURESET:
-      {
-        FooCanvasItem *item = NULL;
-        ZMapFeatureSetDesc gffset;
-        feature_set = (ZMapFeatureSet)feature_any;
-        GQuark col_id = feature_set->unique_id;
-
-        gffset = (ZMapFeatureSetDesc)g_hash_table_lookup(draw_data->navigate->current_window->context_map->featureset_2_column,
-                                                         GUINT_TO_POINTER(feature_set->unique_id));
-
-        if (gffset)
-          col_id = gffset->column_id;
-
-        draw_data->current_set = feature_set;
-
-        status = ZMAP_CONTEXT_EXEC_STATUS_DONT_DESCEND;
-
-        if ((item = zmapWindowContainerFeatureSetFindCanvasColumn(draw_data->navigate->container_root,
-                                                                  draw_data->current_align->unique_id,
-                                                                  draw_data->current_block->unique_id,
-                                                                  col_id,
-                                                                  ZMAPSTRAND_FORWARD, ZMAPFRAME_NONE)))
-          {
-            ZMapWindowContainerFeatureSet container_feature_set;
-            FooCanvasGroup *group_feature_set;
-            ZMapStyleBumpMode bump_mode;
-
-            group_feature_set = FOO_CANVAS_GROUP(item);
-            container_feature_set = (ZMapWindowContainerFeatureSet)item;
-
-            navigatorRunSet(feature_set, group_feature_set, ZMAPFRAME_NONE, draw_data->navigate) ;
 
-            if ((bump_mode = zmapWindowContainerFeatureSetGetBumpMode(container_feature_set)) != ZMAPBUMP_UNBUMP)
-              zmapWindowColumnBumpRange(item, bump_mode, ZMAPWINDOW_COMPRESS_ALL) ;
-            //printf("nav draw context %p -> %p %s %s\n", draw_data->navigate, draw_data->navigate->current_window, g_quark_to_string(feature_set->unique_id), g_quark_to_string(col_id));
-          }
-        else
-          {
-            /* do not draw, the vast majority, of the feature context. */
-          }
+        drawSummarySets(draw_data);
       }
       break;
+    case ZMAPFEATURE_STRUCT_FEATURESET:
     case ZMAPFEATURE_STRUCT_FEATURE:
-      /* FeatureSet draws it all ;) */
+      /* drawn from the summaries by the block. */
       break;
     case ZMAPFEATURE_STRUCT_INVALID:
     default:
@@ -811,6 +811,65 @@ static ZMapFeatureContextExecuteStatus drawContext(GQuark key_id,
   return status;
 }
 
+
+/* Draw the navigator's sets in the current block from their summaries. */
+static void drawSummarySets(NavigateDraw draw_data)
+{
+  ZMapWindowNavigator navigate = draw_data->navigate;
+  GList *l, *done = NULL;
+
+  for (l = navigate->feature_set_names ; l ; l = l->next)
+    {
+      GQuark set_id = zMapFeatureSetCreateID((char *)g_quark_to_string(GPOINTER_TO_UINT(l->data)));
+      NavigatorSummary summary;
+      ZMapFeatureSet feature_set;
+      FooCanvasItem *item = NULL;
+      ZMapFeatureSetDesc gffset;
+      GQuark col_id = set_id;
+
+      /* names may be repeated. */
+      if (g_list_find(done, GUINT_TO_POINTER(set_id)))
+        continue;
+
+      done = g_list_prepend(done, GUINT_TO_POINTER(set_id));
+
+      if (!(summary = (NavigatorSummary)g_hash_table_lookup(navigate->summaries, GUINT_TO_POINTER(set_id)))
+          || !(feature_set = zMapFeatureBlockGetSetByID(draw_data->current_block, set_id)))
+        continue;
+
+      gffset = (ZMapFeatureSetDesc)g_hash_table_lookup(navigate->current_window->context_map->featureset_2_column,
+                                                       GUINT_TO_POINTER(set_id));
+
+      if (gffset)
+        col_id = gffset->column_id;
+
+      draw_data->current_set = feature_set;
+
+      if ((item = zmapWindowContainerFeatureSetFindCanvasColumn(navigate->container_root,
+                                                                draw_data->current_align->unique_id,
+                                                                draw_data->current_block->unique_id,
+                                                                col_id,
+                                                                ZMAPSTRAND_FORWARD, ZMAPFRAME_NONE)))
+        {
+          ZMapWindowContainerFeatureSet container_feature_set;
+          FooCanvasGroup *group_feature_set;
+          ZMapStyleBumpMode bump_mode;
+
+          group_feature_set = FOO_CANVAS_GROUP(item);
+          container_feature_set = (ZMapWindowContainerFeatureSet)item;
+
+          navigatorRunSet(summary, feature_set, group_feature_set, ZMAPFRAME_NONE, navigate) ;
+
+          if ((bump_mode = zmapWindowContainerFeatureSetGetBumpMode(container_feature_set)) != ZMAPBUMP_UNBUMP)
+            zmapWindowColumnBumpRange(item, bump_mode, ZMAPWINDOW_COMPRESS_ALL) ;
+        }
+    }
+
+  g_list_free(done);
+
+  return ;
+}
+
 static gboolean initialiseScaleIfNotExists(ZMapFeatureBlock block)
 {
   ZMapFeatureSet scale;
@@ -1366,119 +1425,143 @@ static gboolean factoryItemHandler(FooCanvasItem       *new_item,
 
 
 
-static gboolean variantFeature(ZMapFeature feature, ZMapWindowNavigator navigate)
+/* mini package for the navigator summaries ... */
+/*
+ * \brief Rebuild all the summaries from the whole context.
+ */
+static void summariesBuild(ZMapWindowNavigator navigate, ZMapFeatureContext context)
 {
-  gboolean outside = FALSE;
+  g_hash_table_remove_all(navigate->summaries);
 
-  if(feature && navigate->locus_id == feature->parent->unique_id)
-    {
-      if(zmapWindowNavigatorLDHFind(navigate->locus_display_hash,
-                                    feature->original_id))
-        {
-          /* we only ever draw the first one of these. */
-          outside = TRUE;
-        }
-      else if(zmapWindowNavigatorLDHInsert(navigate->locus_display_hash, feature))
-        {
-          outside = FALSE;
-        }
-      else
-        {
-          zMapWarnIfReached();
-        }
-    }
+  navigate->summary_context = context;
 
+  summariesUpdate(navigate, context, TRUE);
 
-  return outside;
+  return ;
 }
 
+/*
+ * \brief Add or remove the features of the navigator's sets in context, this only looks at
+ * those sets so its cost depends on the size of the navigator not the context.
+ * Returns TRUE if any summary changed.
+ */
+static gboolean summariesUpdate(ZMapWindowNavigator navigate, ZMapFeatureContext context, gboolean add)
+{
+  gboolean changed = FALSE;
+  GHashTableIter align_iter;
+  gpointer align_data;
 
+  if (!context->alignments)
+    return changed;
 
+  g_hash_table_iter_init(&align_iter, context->alignments);
 
+  while (g_hash_table_iter_next(&align_iter, NULL, &align_data))
+    {
+      ZMapFeatureAlignment align = (ZMapFeatureAlignment)align_data;
+      GHashTableIter block_iter;
+      gpointer block_data;
 
+      g_hash_table_iter_init(&block_iter, align->blocks);
 
+      while (g_hash_table_iter_next(&block_iter, NULL, &block_data))
+        {
+          ZMapFeatureBlock block = (ZMapFeatureBlock)block_data;
+          GList *l;
 
+          for (l = navigate->feature_set_names; l; l = l->next)
+            {
+              GQuark set_id = zMapFeatureSetCreateID((char *)g_quark_to_string(GPOINTER_TO_UINT(l->data)));
+              ZMapFeatureSet feature_set;
 
-/* mini package for the locus_display_hash ... */
-/*
- * \brief Create a hash for the locus display.
- *
- * Hash is keyed on GUINT_TO_POINTER(feature->original_id)
- * Contains LocusEntry items.
- */
-static GHashTable *zmapWindowNavigatorLDHCreate(void)
-{
-  GHashTable *ghash = NULL;
-
-  ghash = g_hash_table_new_full(NULL, NULL, NULL, destroyLocusEntry);
+              if ((feature_set = zMapFeatureBlockGetSetByID(block, set_id)))
+                {
+                  if (summaryUpdateSet(navigate, set_id, feature_set, add))
+                    changed = TRUE;
+                }
+            }
+        }
+    }
 
-  return ghash;
+  return changed;
 }
 
 /*
- * \brief finds the entry.
+ * \brief Add or remove the features of one set. Variants of a locus have the same
+ * original id and only the first one is drawn so they share an entry, in other sets
+ * every feature has its own.
  */
-static LocusEntry zmapWindowNavigatorLDHFind(GHashTable *ghash, GQuark key)
+static gboolean summaryUpdateSet(ZMapWindowNavigator navigate, GQuark set_id, ZMapFeatureSet feature_set, gboolean add)
 {
-  LocusEntry hash_entry = NULL;
+  gboolean changed = FALSE;
+  NavigatorSummary summary;
+  GHashTableIter iter;
+  gpointer data;
 
-  hash_entry = (LocusEntry)g_hash_table_lookup(ghash, GUINT_TO_POINTER(key));
+  if (!(summary = (NavigatorSummary)g_hash_table_lookup(navigate->summaries, GUINT_TO_POINTER(set_id))))
+    {
+      if (!add)
+        return changed;
 
-  return hash_entry;
-}
-/*
- * \brief creates a new entry from feature, start and end (scaled) and returns it.
- */
-static LocusEntry zmapWindowNavigatorLDHInsert(GHashTable *ghash,
-                                               ZMapFeature feature)
-{
-  LocusEntry hash_entry = NULL;
+      summary = g_new0(NavigatorSummaryStruct, 1);
+      summary->set_id = set_id;
+      summary->entries = g_hash_table_new(NULL, NULL);
 
-  if((hash_entry = g_new0(LocusEntryStruct, 1)))
-    {
-      hash_entry->start   = feature->x1;                /* these are never used */
-      hash_entry->end     = feature->x2;
-      hash_entry->strand  = feature->strand;
-      hash_entry->feature = feature; /* So we can find the item */
-      g_hash_table_insert(ghash,
-                          GUINT_TO_POINTER(feature->original_id),
-                          (gpointer)hash_entry);
-    }
-  else
-    {
-      zMapWarnIfReached();
+      g_hash_table_insert(navigate->summaries, GUINT_TO_POINTER(set_id), summary);
     }
 
-  return hash_entry;
-}
+  g_hash_table_iter_init(&iter, feature_set->features);
 
-/*
- * \brief Destroy the hash **! NULL's for you.
- */
-static void zmapWindowNavigatorLDHDestroy(GHashTable **destroy_me)
-{
-  if (!destroy_me || !*destroy_me)
-    return ;
+  while (g_hash_table_iter_next(&iter, NULL, &data))
+    {
+      ZMapFeature feature = (ZMapFeature)data;
+      GQuark key = (set_id == navigate->locus_id ? feature->original_id : feature->unique_id);
+      GList *variants, *variant;
 
-  g_hash_table_destroy(*destroy_me);
+      variants = (GList *)g_hash_table_lookup(summary->entries, GUINT_TO_POINTER(key));
+      variant = g_list_find(variants, feature);
 
-  *destroy_me = NULL;
+      if (add && !variant)
+        {
+          /* appending keeps the head, and the head only changes if the list was empty. */
+          if (!variants)
+            g_hash_table_insert(summary->entries, GUINT_TO_POINTER(key), g_list_append(NULL, feature));
+          else
+            variants = g_list_append(variants, feature);
 
-  return ;
-}
+          changed = TRUE;
+        }
+      else if (!add && variant)
+        {
+          if ((variants = g_list_delete_link(variants, variant)))
+            g_hash_table_insert(summary->entries, GUINT_TO_POINTER(key), variants);
+          else
+            g_hash_table_remove(summary->entries, GUINT_TO_POINTER(key));
 
+          changed = TRUE;
+        }
+    }
 
+  return changed;
+}
 
-static void destroyLocusEntry(gpointer data)
+static void destroySummary(gpointer data)
 {
-  LocusEntry locus_entry = (LocusEntry)data;
+  NavigatorSummary summary = (NavigatorSummary)data;
+  GHashTableIter iter;
+  gpointer variants;
 
   if (!data)
     return ;
 
-  locus_entry->feature = NULL;
+  g_hash_table_iter_init(&iter, summary->entries);
 
-  g_free(locus_entry);
+  while (g_hash_table_iter_next(&iter, NULL, &variants))
+    g_list_free((GList *)variants);
+
+  g_hash_table_destroy(summary->entries);
+
+  g_free(summary);
 
   return ;
 }
@@ -1536,25 +1619,38 @@ static void default_locus_names_filter(GList **filter_out)
 
 
 
-void navigatorRunSet(  ZMapFeatureSet set,
+void navigatorRunSet(  NavigatorSummary summary,
+                       ZMapFeatureSet set,
                        FooCanvasGroup *container,
                        ZMapFrame frame,
                        ZMapWindowNavigator navigate)
 {
   ZMapWindowFeatureStackStruct feature_stack = { NULL };
-  GList *l;
+  GHashTableIter iter;
+  gpointer data;
   ZMapWindowContainerFeatures features = zmapWindowContainerGetFeatures((ZMapWindowContainerGroup) container) ;
   ZMapWindowFeaturesetItem locus_featureset = NULL;
 
   feature_stack.feature = NULL;
   zmapGetFeatureStack(&feature_stack,set,NULL,frame);
 
-  zMap_g_hash_table_get_data(&l, set->features);
+  g_hash_table_iter_init(&iter, summary->entries);
 
-  for(; l ; l = l->next)
+  while (g_hash_table_iter_next(&iter, NULL, &data))
     {
-      ZMapFeature feature = (ZMapFeature)l->data;
+      ZMapFeature feature = NULL;
       FooCanvasItem *foo = NULL;
+      GList *l;
+
+      /* we only ever draw the first variant in this set. */
+      for (l = (GList *)data ; l && !feature ; l = l->next)
+        {
+          if (((ZMapFeature)(l->data))->parent == (ZMapFeatureAny)set)
+            feature = (ZMapFeature)(l->data);
+        }
+
+      if (!feature)
+        continue;
 
       /* filter on frame! */
       if((frame != ZMAPFRAME_NONE) && frame  != zmapWindowFeatureFrame(feature))
@@ -1571,12 +1667,6 @@ void navigatorRunSet(  ZMapFeatureSet set,
             feature_stack.frame = zmapWindowFeatureFrame(feature);
         }
 
-      //        if(zMapStyleGetMode(*feature->style) == ZMAPSTYLE_MODE_TEXT)        variant feature handles this
-      {
-        if(variantFeature(feature, navigate))
-          continue;
-      }
-
       foo = zmapWindowFeatureFactoryRunSingle(navigate->ftoi_hash,
                                               (ZMapWindowContainerFeatureSet)container,
                                               features, foo, &feature_stack) ;
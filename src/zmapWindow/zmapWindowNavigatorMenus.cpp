@@ -170,7 +170,7 @@ void zmapWindowNavigatorShowSameNameList(ZMapWindowNavigator navigate, FooCanvas
        * WindowList and it does that with a callback. It must
        * be the same window! */
       zmapWindowListWindowCreate(window, item,
-                                 (char *)(g_quark_to_string(feature->original_id)),
+                                 (char *)(zMapFeatureIDToString(feature->original_id)),
                                  access_window_context_to_item, window,
                                  NULL, NULL,
                                  zoom_to_item);
@@ -184,7 +184,7 @@ void zmapWindowNavigatorShowSameNameList(ZMapWindowNavigator navigate, FooCanvas
     gboolean zoom_to_item = TRUE ;
     char *wild_name ;
 
-    wild_name = g_strdup_printf("%s*", g_quark_to_string(feature->original_id)) ;
+    wild_name = g_strdup_printf("%s*", zMapFeatureIDToString(feature->original_id)) ;
     g_free(wild_name) ;
 
     search_data = zmapWindowFToISetSearchCreateFull((void *)zmapWindowFToIFindItemSetFull,
@@ -201,7 +201,7 @@ void zmapWindowNavigatorShowSameNameList(ZMapWindowNavigator navigate, FooCanvas
                                                     NULL) ;
 
     zmapWindowListWindowCreate(window, item,
-                               (char *)(g_quark_to_string(feature->original_id)),
+                               (char *)(zMapFeatureIDToString(feature->original_id)),
                                access_window_context_to_item,  window,
                                window->context_map,
                                (ZMapWindowListSearchHashFunc)zmapWindowFToISetSearchPerform, search_data,
@@ -380,7 +380,7 @@ static void navigatorColumnMenuCB(int menu_item_id, gpointer callback_data)
 
         zmapWindowListWindowCreate(menu_data->navigate->current_window,
                                    NULL,
-                                   (char *)g_quark_to_string(feature->original_id),
+                                   (char *)zMapFeatureIDToString(feature->original_id),
 #ifdef ED_G_NEVER_INCLUDE_THIS_CODE
                                    access_navigator_context_to_item,
 #endif /* ED_G_NEVER_INCLUDE_THIS_CODE */
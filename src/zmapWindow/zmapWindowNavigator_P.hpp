@@ -86,7 +86,8 @@ typedef struct _ZMapWindowNavigatorStruct
   GdkColor        column_background;
 
   GHashTable     *ftoi_hash;
-  GHashTable     *locus_display_hash;
+  GHashTable     *summaries;        /* set unique id -> what we draw for that set. */
+  ZMapFeatureContext summary_context; /* the context the summaries are for. */
 
   GQuark          locus_id;
   GList          *feature_set_names;
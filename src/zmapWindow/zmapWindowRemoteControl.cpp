@@ -537,7 +537,7 @@ static void zoomWindowToFeature(ZMapWindow window, RequestData request_data,
       *command_rc_out = REMOTE_COMMAND_RC_FAILED ;
 
       *reason_out = zMapXMLUtilsEscapeStrPrintf("Zoom feature %s failed",
-                                                (char *)g_quark_to_string(feature->original_id));
+                                                (char *)zMapFeatureIDToString(feature->original_id));
     }
   else
     {
@@ -546,14 +546,14 @@ static void zoomWindowToFeature(ZMapWindow window, RequestData request_data,
           *command_rc_out = REMOTE_COMMAND_RC_FAILED ;
 
           *reason_out = zMapXMLUtilsEscapeStrPrintf("Select feature %s failed",
-                                                    (char *)g_quark_to_string(feature->original_id)) ;
+                                                    (char *)zMapFeatureIDToString(feature->original_id)) ;
         }
       else
         {
           char *message ;
 
           message = g_strdup_printf("Zoom to feature %s ok",
-                                    (char *)g_quark_to_string(feature->original_id)) ; 
+                                    (char *)zMapFeatureIDToString(feature->original_id)) ; 
           *reply_out = makeMessageElement(message) ;
           *command_rc_out = REMOTE_COMMAND_RC_OK ;
         }
@@ -521,7 +521,7 @@ ZMapFeatureContextExecuteStatus xmlDumpCB(GQuark key,
       cs = ZMAP_CONTEXT_EXEC_STATUS_ERROR;
       if(error && !*error)
         *error = g_strdup_printf("Failed to dump xml from feature '%s'.",
-                                 g_quark_to_string(feature_any->unique_id));
+                                 zMapFeatureIDToString(feature_any->unique_id));
     }
 
   return cs;
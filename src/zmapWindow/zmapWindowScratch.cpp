@@ -159,7 +159,7 @@ static void doScratchCallbackCommand(ZMapWindowCommandType command_type,
         {
           ok = FALSE ;
           zMapWarning("Cannot find subfeature for feature '%s' at position %f,%f",
-                      g_quark_to_string(feature->original_id), world_x, world_y) ;
+                      zMapFeatureIDToString(feature->original_id), world_x, world_y) ;
         }
     }
 
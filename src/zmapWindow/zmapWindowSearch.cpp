@@ -867,7 +867,7 @@ static void printListDataCB(gpointer data, gpointer user_data_unused)
   if (!feature)
     return ;
 
-  printf("%s\n", g_quark_to_string(feature->unique_id)) ;
+  printf("%s\n", zMapFeatureIDToString(feature->unique_id)) ;
 
   return ;
 }
@@ -900,7 +900,7 @@ static void setFieldDefaults(SearchData search_data)
           {
             ZMapFeature feature = (ZMapFeature)feature_any ;
 
-            search_data->feature_txt = (char *)g_quark_to_string(feature->original_id) ;
+            search_data->feature_txt = (char *)zMapFeatureIDToString(feature->original_id) ;
             search_data->feature_id = feature->unique_id ;
             search_data->feature_original_id = feature->original_id ;
 
@@ -333,11 +333,16 @@ typedef struct ZMapWindowHighlightDataStructType
 /* We store ids with the group or item that represents them in the canvas.
  * May want to consider more efficient way of storing these than malloc... */
 /* NOTE also used for user hidden items stack */
+typedef struct ZMapWindowFToINameIndexStructType *ZMapWindowFToINameIndex ;
+
 typedef struct
 {
   FooCanvasItem *item ;					    /* could be group or item. */
   GHashTable *hash_table ;
 
+  ZMapWindowFToINameIndex name_index ;			    /* Sets only: sorted feature ids for
+							       wildcard searches of hash_table. */
+
   ZMapFeatureAny feature_any;
   	/* direct link to feature instead if via item */
   	/* need if we have composite items eg density plots */
@@ -419,7 +424,7 @@ typedef struct _zmapWindowFeatureStack
   ZMapWindowContainerFeatureSet set_column[N_STRAND_ALLOC];	/* all possible strand and frame combinations */
   ZMapWindowContainerFeatures set_features[N_STRAND_ALLOC];
   FooCanvasItem *col_featureset[N_STRAND_ALLOC];			/* the canvas featureset as allocated by the item factory */
-  GHashTable *col_hash[N_STRAND_ALLOC];
+  ID2Canvas col_set[N_STRAND_ALLOC];			/* the FToI set for each column */
 
 #endif
 
@@ -1191,10 +1196,10 @@ gboolean zmapWindowFToIAddSet(GHashTable *feature_to_context_hash,
 gboolean zmapWindowFToIRemoveSet(GHashTable *feature_to_context_hash,
 				 GQuark align_id, GQuark block_id, GQuark set_id,
 				 ZMapStrand strand, ZMapFrame frame, gboolean remove_features) ;
-GHashTable *zmapWindowFToIGetSetHash(GHashTable *feature_context_to_item,
-				  GQuark align_id, GQuark block_id,
-				  GQuark set_id, ZMapStrand set_strand, ZMapFrame set_frame);
-gboolean zmapWindowFToIAddSetFeature(GHashTable *set,	GQuark feature_id, FooCanvasItem *feature_item, ZMapFeature feature);
+ID2Canvas zmapWindowFToIGetSet(GHashTable *feature_context_to_item,
+			       GQuark align_id, GQuark block_id,
+			       GQuark set_id, ZMapStrand set_strand, ZMapFrame set_frame);
+gboolean zmapWindowFToIAddSetFeature(ID2Canvas iset, GQuark feature_id, FooCanvasItem *feature_item, ZMapFeature feature);
 gboolean zmapWindowFToIAddFeature(GHashTable *feature_to_context_hash,
 				  GQuark align_id, GQuark block_id,
 				  GQuark set_id, ZMapStrand set_strand, ZMapFrame set_frame,
@@ -1433,6 +1438,7 @@ void zmapWindowUpdateInfoPanel(ZMapWindow window, ZMapFeature feature,
                                ZMapWindowDisplayStyle display_style) ;
 
 void zmapWindowDrawZoom(ZMapWindow window) ;
+void zmapWindowDrawPrepareIndexes(ZMapWindow window) ;
 void zmapWindowDrawManageWindowWidth(ZMapWindow window);
 
 void zmapWindowColumnConfigure(ZMapWindow window, FooCanvasGroup *column_group,
@@ -54,6 +54,14 @@
 # associated "so_to_mode_map_hack.txt" file that contains the ZMapStyleMode 
 # for these. 
 #
+# Each table is followed by two index arrays giving the table in order of
+# name and in order of ID, these are used for binary search lookups:
+#
+#    static const unsigned short ZMAP_SO_DATA_TABLE01_BY_NAME[ZMAP_SO_DATA_TABLE01_NUM_ITEMS] =
+#    {
+#      1, 0
+#    } ;
+#
 
 use Getopt::Long;
 my $download;
@@ -403,16 +411,7 @@ sub Convert_Data
   my $mode = "" ;
   my $homol = "" ; 
 
-  $i = 0 ;
-  $id = $SOIDS[$i] ;
-  $nam = $Names[$i] ;
-  $mode  = $so_to_mode_map{$nam} ;
-  $homol = $so_to_homol_map{$nam} ; 
-  if (defined $mode)
-  {
-    $result .= "  \{ $id, \"$nam\", $mode, $homol \}" ;
-  }
-  for ($i=1; $i < $sizeNames ; $i++)
+  for ($i=0; $i < $sizeNames ; $i++)
   {
     $id = $SOIDS[$i] ;
     $nam = $Names[$i] ;
@@ -426,8 +425,65 @@ sub Convert_Data
     {
       $homol = "ZMAPHOMOL_NONE" ; 
     }
-    $result .= ",\n  \{ $id, \"$nam\", $mode, $homol \}" ;
+    if ($i)
+    {
+      $result .= ",\n" ;
+    }
+    $result .= "  \{ $id, \"$nam\", $mode, $homol \}" ;
+
+  }
+  $result .= "\n\} ;\n\n" ;
+
+  #
+  # Index arrays sorted by name and by ID, ties are broken by position so that
+  # a lookup finds the same entry as a linear search would. Names are compared
+  # bytewise to match strcmp().
+  #
+  if ($sizeNames > 65535)
+  {
+    die "Too many terms in $arg for the index arrays.\n" ;
+  }
+  my @by_name ;
+  my @by_id ;
+  {
+    no locale ;
+    @by_name = sort { $Names[$a] cmp $Names[$b] or $a <=> $b } (0 .. $sizeNames - 1) ;
+  }
+  @by_id = sort { $SOIDS[$a] <=> $SOIDS[$b] or $a <=> $b } (0 .. $sizeNames - 1) ;
 
+  $result .= &Convert_Index($arg, "_BY_NAME", @by_name) ;
+  $result .= &Convert_Index($arg, "_BY_ID", @by_id) ;
+
+  return $result ;
+}
+
+
+
+#
+# Function to write out one of the index arrays for a table.
+#
+sub Convert_Index
+{
+  my ($arg, $suffix, @index) = @_ ;
+  my $result = "" ;
+  my $i = 0 ;
+
+  $result = "static const unsigned short $arg$suffix" ;
+  $result .= "[" ;
+  $result .= $arg ;
+  $result .= "_NUM_ITEMS] = \n" ;
+  $result .= "\{\n" ;
+  for ($i=0; $i < @index ; $i++)
+  {
+    if ($i)
+    {
+      $result .= ($i % 16) ? ", " : ",\n" ;
+    }
+    if (!($i % 16))
+    {
+      $result .= "  " ;
+    }
+    $result .= $index[$i] ;
   }
   $result .= "\n\} ;\n\n" ;
 